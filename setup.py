@@ -435,8 +435,8 @@ for pi in dbpi_dirs:
     pi_ext = Library(config.root + '.db_plugins.' + mod_name,
                      define_macros=config.macros() + [('MAKE_DB_PLUGIN_LIBRARY', 1)],
                      include_dirs=[os.path.join("src", "plugins", "common"),
-                                   _db_path, _tl_path, _gsi_path],
-                     extra_objects=[config.path_of('_tl', _tl_path), config.path_of('_gsi', _gsi_path), config.path_of('_db', _db_path)],
+                                   _db_path, _rdb_path, _tl_path, _gsi_path],
+                     extra_objects=[config.path_of('_tl', _tl_path), config.path_of('_gsi', _gsi_path), config.path_of('_db', _db_path), config.path_of('_rdb', _rdb_path)],
                      language='c++',
                      extra_link_args=config.link_args(mod_name),
                      extra_compile_args=config.compile_args(mod_name),
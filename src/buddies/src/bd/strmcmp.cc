@@ -54,7 +54,9 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
   bool dont_summarize_missing_layers = false;
   double tolerance = 0.0;
   int max_count = 0;
+  int threads = 0;
   bool print_properties = false;
+  bool hash_prefilter = false;
 
   tl::CommandLineOptions cmd;
   generic_reader_options_a.add_options (cmd);
@@ -126,6 +128,15 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
                   "If the value is >1, max-count-1 differences plus one warning about abbreviation is printed. "
                   "A value of 0 means \"no limitation\". To suppress all output, use --silent."
                  )
+      << tl::arg ("-j|--threads=n",            &threads, "Specifies the number of threads to use for the compare",
+                  "If this value is larger than 0, the cells are compared in parallel using the given number of threads. "
+                  "The output is the same than for the single-threaded compare."
+                 )
+      << tl::arg ("--hash-prefilter",          &hash_prefilter, "Skips layers with identical content hashes",
+                  "With this option, layers whose shapes deliver the same content hash are not compared in detail. "
+                  "This is faster, but probabilistic: in the rare case of a hash collision, differences are not reported. "
+                  "This option is ignored if a tolerance is given."
+                 )
     ;
 
   cmd.brief ("This program will compare two layout files on a per-object basis");
@@ -191,6 +202,9 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
   if (dont_summarize_missing_layers) {
     flags |= db::layout_diff::f_dont_summarize_missing_layers;
   }
+  if (hash_prefilter) {
+    flags |= db::layout_diff::f_hash_prefilter;
+  }
 
   db::Coord tolerance_dbu = db::coord_traits<db::Coord>::rounded (tolerance / std::min (layout_a.dbu (), layout_b.dbu ()));
   bool result = false;
@@ -231,10 +245,10 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
       throw tl::Exception ("'" + top_b + "' is not a valid cell name in second layout");
     }
 
-    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties, (unsigned int) std::max (0, threads));
 
   } else {
-    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties, (unsigned int) std::max (0, threads));
   }
 
   if (! result && ! silent) {
@@ -52,6 +52,7 @@ SOURCES = \
   dbPCellDeclaration.cc \
   dbPCellHeader.cc \
   dbPCellVariant.cc \
+  dbPCellVariantCache.cc \
   dbPoint.cc \
   dbPolygon.cc \
   dbPolygonTools.cc \
@@ -173,6 +174,7 @@ HEADERS = \
   dbPCellDeclaration.h \
   dbPCellHeader.h \
   dbPCellVariant.h \
+  dbPCellVariantCache.h \
   dbPoint.h \
   dbPolygon.h \
   dbPolygonTools.h \
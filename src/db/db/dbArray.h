@@ -30,6 +30,7 @@
 #include <algorithm> 
 #include <limits> 
 #include <vector> 
+#include <new> 
 
 #include "dbTypes.h"
 #include "dbMemStatistics.h"
@@ -73,7 +74,12 @@ struct basic_array_iterator
   
   virtual disp_type get () const = 0;
   
-  virtual basic_array_iterator<Coord> *clone () const = 0;
+  /**
+   *  @brief Creates a copy of this iterator in the given memory
+   *
+   *  The memory must be large enough to hold the iterator (see array_iterator).
+   */
+  virtual basic_array_iterator<Coord> *clone (void *mem) const = 0;
 };
 
 /**
@@ -143,11 +149,20 @@ struct basic_array
     //  .. nothing yet ..
   }
 
-  virtual std::pair<basic_array_iterator<Coord> *, bool> begin_touching (const box_type &b) const = 0;
+  //  NOTE: the iterator factories construct the iterator in the memory given by "mem".
+  //  This memory is provided by array_iterator and is large enough for all iterator types.
+  //  This way, iterating arrays does not require heap allocations.
+
+  virtual std::pair<basic_array_iterator<Coord> *, bool> begin_touching (const box_type &b, void *mem) const = 0;
   
-  virtual std::pair<basic_array_iterator<Coord> *, bool> begin () const = 0;
+  virtual std::pair<basic_array_iterator<Coord> *, bool> begin (void *mem) const = 0;
   
-  virtual std::pair<basic_array_iterator<Coord> *, bool> begin_regular (long /*a*/, long /*b*/) const { return begin (); }
+  virtual std::pair<basic_array_iterator<Coord> *, bool> begin_regular (long /*a*/, long /*b*/, void *mem) const { return begin (mem); }
+
+  virtual bool touching_range (const box_type & /*b*/, unsigned long & /*amin*/, unsigned long & /*amax*/, unsigned long & /*bmin*/, unsigned long & /*bmax*/) const
+  {
+    return false;
+  }
   
   virtual ArrayBase *basic_clone () const 
   {
@@ -335,9 +350,9 @@ struct regular_array_iterator
     return m_bi >= m_bmax;
   }
 
-  virtual basic_array_iterator<Coord> *clone () const 
+  virtual basic_array_iterator<Coord> *clone (void *mem) const 
   {
-    return new regular_array_iterator <Coord> (*this);
+    return new (mem) regular_array_iterator <Coord> (*this);
   }
 
   virtual long index_a () const 
@@ -387,15 +402,26 @@ struct regular_array
   }
 
   virtual std::pair<basic_array_iterator<Coord> *, bool>
-  begin_touching (const box_type &b) const
+  begin_touching (const box_type &b, void *mem) const
+  {
+    unsigned long amin = 0, amax = 0, bmin = 0, bmax = 0;
+    touching_range (b, amin, amax, bmin, bmax);
+    return std::make_pair (new (mem) regular_array_iterator <Coord> (m_a, m_b, amin, amax, bmin, bmax), false);
+  }
+
+  virtual bool
+  touching_range (const box_type &b, unsigned long &amin_out, unsigned long &amax_out, unsigned long &bmin_out, unsigned long &bmax_out) const
   {
     if (b.empty ()) {
 
-      return std::make_pair (new regular_array_iterator <Coord> (m_a, m_b, 0, 0, 0, 0), false);
+      amin_out = amax_out = bmin_out = bmax_out = 0;
 
-    } else if (fabs (m_det) < 0.5) {
+    } else if (fabs (m_det) < 0.5 || b == box_type::world ()) {
 
-      return begin ();
+      amin_out = 0;
+      amax_out = m_amax;
+      bmin_out = 0;
+      bmax_out = m_bmax;
 
     } else {
 
@@ -466,20 +492,26 @@ struct regular_array
         }
       }
       
-      return std::make_pair (new regular_array_iterator <Coord> (m_a, m_b, amini, amaxi, bmini, bmaxi), false);
+      amin_out = amini;
+      amax_out = amaxi;
+      bmin_out = bmini;
+      bmax_out = bmaxi;
+
     }
+
+    return true;
   }
   
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin_regular (long a, long b) const
+  begin_regular (long a, long b, void *mem) const
   {
-    return std::make_pair (new regular_array_iterator <Coord> (m_a, m_b, (unsigned long) std::max (long (0), a), m_amax, (unsigned long) std::max (long (0), b), m_bmax), false);
+    return std::make_pair (new (mem) regular_array_iterator <Coord> (m_a, m_b, (unsigned long) std::max (long (0), a), m_amax, (unsigned long) std::max (long (0), b), m_bmax), false);
   }
 
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin () const
+  begin (void *mem) const
   {
-    return std::make_pair (new regular_array_iterator <Coord> (m_a, m_b, 0, m_amax, 0, m_bmax), false);
+    return std::make_pair (new (mem) regular_array_iterator <Coord> (m_a, m_b, 0, m_amax, 0, m_bmax), false);
   }
 
   virtual basic_array <Coord> *clone () const 
@@ -749,9 +781,9 @@ struct iterated_array_iterator
     }
   }
 
-  virtual basic_array_iterator<Coord> *clone () const 
+  virtual basic_array_iterator<Coord> *clone (void *mem) const 
   {
-    return new iterated_array_iterator <Coord> (*this);
+    return new (mem) iterated_array_iterator <Coord> (*this);
   }
 
 private:
@@ -849,22 +881,22 @@ struct iterated_array
   }
 
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin_touching (const box_type &b) const
+  begin_touching (const box_type &b, void *mem) const
   {
     if (b.empty ()) {
-      return std::make_pair (new iterated_array_iterator <Coord> (m_v.begin (), m_v.end ()), false);
+      return std::make_pair (new (mem) iterated_array_iterator <Coord> (m_v.begin (), m_v.end ()), false);
     } else if (! b.touches (m_box)) {
-      return std::make_pair (new iterated_array_iterator <Coord> (m_v.end (), m_v.end ()), false);
+      return std::make_pair (new (mem) iterated_array_iterator <Coord> (m_v.end (), m_v.end ()), false);
     } else {
       box_convert_type bc;
-      return std::make_pair (new iterated_array_iterator <Coord> (m_v.begin_touching (b, bc)), false);
+      return std::make_pair (new (mem) iterated_array_iterator <Coord> (m_v.begin_touching (b, bc)), false);
     }
   }
   
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin () const
+  begin (void *mem) const
   {
-    return std::make_pair (new iterated_array_iterator <Coord> (m_v.begin (), m_v.end ()), false);
+    return std::make_pair (new (mem) iterated_array_iterator <Coord> (m_v.begin (), m_v.end ()), false);
   }
 
   virtual basic_array <Coord> *clone () const 
@@ -1088,13 +1120,13 @@ struct single_complex_inst
   }
 
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin_touching (const box_type &b) const
+  begin_touching (const box_type &b, void * /*mem*/) const
   {
     return std::make_pair ((basic_array_iterator <Coord> *) 0, ! b.contains (point_type (0, 0))); 
   }
   
   virtual std::pair <basic_array_iterator <Coord> *, bool>
-  begin () const
+  begin (void * /*mem*/) const
   {
     return std::make_pair ((basic_array_iterator <Coord> *) 0, false);
   }
@@ -1203,6 +1235,8 @@ struct compute_result_trans<C, fixpoint_trans<C> >
  *  with end() but rather querying the at_end() property.
  *  This iterator as well acts as a single or zero instance
  *  iterator if the base pointer is 0.
+ *  The basic_array iterator object is kept inside the array_iterator
+ *  object, so iterating an array does not require heap allocations.
  */
 
 template <class Coord, class Trans>
@@ -1213,6 +1247,7 @@ struct array_iterator
   typedef db::vector <coord_type> vector_type;
   typedef db::complex_trans <coord_type, coord_type> complex_trans_type;
   typedef Trans trans_type;
+  typedef db::box <coord_type> box_type;
   typedef typename compute_result_trans<coord_type, trans_type>::result_trans result_type;
   //  dummy definitions to satisfy iterator traits (without making much sense):
   typedef result_type reference;
@@ -1232,28 +1267,37 @@ struct array_iterator
   }
 
   /**
-   *  @brief The iterator constructor
+   *  @brief The iterator constructor for all members of the array
    *
-   *  The constructor will receive a basic_array_iterator object
-   *  and take over ownership over this.
-   *  This is a convenience constructor that combines the next two constructors.
+   *  The basic_array iterator object is created inside this object.
    */
-  array_iterator (const trans_type &trans, std::pair <db::basic_array_iterator <Coord> *, bool> base)
-    : m_trans (trans), mp_base (base.first), m_done (base.second)
+  array_iterator (const trans_type &trans, const basic_array <Coord> *base)
+    : m_trans (trans), mp_base (0), m_done (false)
   { 
-    // .. nothing yet ..
+    set_base (base->begin (m_d.iter));
   }
 
   /**
-   *  @brief The iterator constructor
+   *  @brief The iterator constructor for the members touching a box
    *
-   *  The constructor will receive a basic_array_iterator object
-   *  and take over ownership over this.
+   *  The box is given in displacement space (see basic_array::begin_touching).
+   *  The basic_array iterator object is created inside this object.
    */
-  array_iterator (const trans_type &trans, db::basic_array_iterator <Coord> *base)
-    : m_trans (trans), mp_base (base), m_done (false)
+  array_iterator (const trans_type &trans, const basic_array <Coord> *base, const box_type &b)
+    : m_trans (trans), mp_base (0), m_done (false)
   { 
-    // .. nothing yet ..
+    set_base (base->begin_touching (b, m_d.iter));
+  }
+
+  /**
+   *  @brief The iterator constructor for a regular array starting at the given member
+   *
+   *  The basic_array iterator object is created inside this object.
+   */
+  array_iterator (const trans_type &trans, const basic_array <Coord> *base, long a, long b)
+    : m_trans (trans), mp_base (0), m_done (false)
+  { 
+    set_base (base->begin_regular (a, b, m_d.iter));
   }
 
   /**
@@ -1274,10 +1318,7 @@ struct array_iterator
   array_iterator (const array_iterator &d)
     : m_trans (d.m_trans), mp_base (0), m_done (d.m_done)
   {
-    if (mp_base) {
-      delete mp_base;
-    }
-    mp_base = d.mp_base ? d.mp_base->clone () : 0;
+    mp_base = d.mp_base ? d.mp_base->clone (m_d.iter) : 0;
   }
 
   /**
@@ -1288,10 +1329,8 @@ struct array_iterator
     if (&d != this) {
       m_trans = d.m_trans;
       m_done = d.m_done;
-      if (mp_base) {
-        delete mp_base;
-      }
-      mp_base = d.mp_base ? d.mp_base->clone () : 0;
+      release ();
+      mp_base = d.mp_base ? d.mp_base->clone (m_d.iter) : 0;
     }
     return *this;
   }
@@ -1299,15 +1338,11 @@ struct array_iterator
   /**
    *  @brief The destructor
    *
-   *  This will delete the basic_array_iterator object passed
-   *  in the constructor
+   *  This will destroy the basic_array_iterator object
    */
   ~array_iterator ()
   {
-    if (mp_base) {
-      delete mp_base;
-    }
-    mp_base = 0;
+    release ();
   }
 
   /**
@@ -1369,9 +1404,36 @@ struct array_iterator
   }
 
 private:
+  //  this union is there to determine the maximum size required for the
+  //  basic_array iterators which are created in place
+  union iter_size {
+    char sz_r [sizeof (regular_array_iterator<Coord>)];
+    char sz_i [sizeof (iterated_array_iterator<Coord>)];
+  };
+
+  //  The strange construction and the local dummy class helps to guarantee alignment of the "iter" space
+  union {
+    struct _align_helper { long l; double d; } _ah;
+    char iter [sizeof (iter_size)];
+  } m_d;
+
   trans_type m_trans;
   basic_array_iterator <Coord> *mp_base;
   bool m_done;
+
+  void set_base (const std::pair <basic_array_iterator <Coord> *, bool> &base)
+  {
+    mp_base = base.first;
+    m_done = base.second;
+  }
+
+  void release ()
+  {
+    if (mp_base) {
+      mp_base->~basic_array_iterator<Coord> ();
+      mp_base = 0;
+    }
+  }
 };
 
 /**
@@ -1660,27 +1722,14 @@ struct array
   {
     if (b.empty ()) {
       if (mp_base) {
-        return array_iterator <coord_type, Trans> (m_trans, mp_base->begin_touching (box_type ()));
+        return array_iterator <coord_type, Trans> (m_trans, mp_base, box_type ());
       } else {
         return array_iterator <coord_type, Trans> (m_trans, true); 
       }
     } else if (b == box_type::world ()) {
       return begin ();
     } else if (mp_base) {
-      box_type ob (bc (m_obj));
-      if (ob.empty ()) {
-        return array_iterator <coord_type, Trans> (m_trans, mp_base->begin_touching (box_type ()));
-      } else {
-        if (mp_base->is_complex ()) {
-          complex_trans_type ct = mp_base->complex_trans (simple_trans_type (m_trans));
-          ct.disp (typename complex_trans_type::displacement_type ());
-          ob = box_type (ct * ob);
-        } else {
-          ob.transform (db::fixpoint_trans<coord_type> (m_trans.rot ()));
-        }
-        vector_type d = m_trans.disp ();
-        return array_iterator <coord_type, Trans> (m_trans, mp_base->begin_touching (box_type (point_type () + (b.p1 () - (ob.p2 () + d)), point_type () + (b.p2 () - (ob.p1 () + d)))));
-      }
+      return array_iterator <coord_type, Trans> (m_trans, mp_base, displacement_search_box (b, bc));
     } else {
       box_type ob (bc (m_obj));
       if (ob.empty ()) {
@@ -1692,6 +1741,32 @@ struct array
       }
     }
   }
+
+  /**
+   *  @brief Gets the index ranges of the members of a regular array touching the given box
+   *
+   *  For regular arrays, this method computes the ranges of the "a" and "b" indexes
+   *  of the members which touch the given box (and possibly some more) in closed form.
+   *  The members are those with amin <= a < amax and bmin <= b < bmax. Their 
+   *  displacements are a*A+b*B (see is_regular_array). The ranges are empty if the
+   *  box or the object's box is empty.
+   *
+   *  This method allows iterating the members of a regular array without an 
+   *  iterator object. 
+   *
+   *  @return false, if the array is not a regular one. In that case, the ranges are not set.
+   */
+  template <class BoxConv>
+  bool regular_touching_range (const box_type &b, const BoxConv &bc, unsigned long &amin, unsigned long &amax, unsigned long &bmin, unsigned long &bmax) const 
+  {
+    if (! mp_base) {
+      return false;
+    } else if (b.empty () || b == box_type::world ()) {
+      return mp_base->touching_range (b, amin, amax, bmin, bmax);
+    } else {
+      return mp_base->touching_range (displacement_search_box (b, bc), amin, amax, bmin, bmax);
+    }
+  }
   
   /**
    *  @brief The regular array member iterator
@@ -1705,7 +1780,7 @@ struct array
   array_iterator <coord_type, Trans> begin (long a, long b) const 
   {
     if (mp_base) {
-      return array_iterator <coord_type, Trans> (m_trans, mp_base->begin_regular (a, b));
+      return array_iterator <coord_type, Trans> (m_trans, mp_base, a, b);
     } else {
       return array_iterator <coord_type, Trans> (m_trans, false);
     }
@@ -1720,7 +1795,7 @@ struct array
   array_iterator <coord_type, Trans> begin () const 
   {
     if (mp_base) {
-      return array_iterator <coord_type, Trans> (m_trans, mp_base->begin ());
+      return array_iterator <coord_type, Trans> (m_trans, mp_base);
     } else {
       return array_iterator <coord_type, Trans> (m_trans, false);
     }
@@ -2220,6 +2295,28 @@ private:
   trans_type m_trans;
   basic_array <coord_type> *mp_base;
 
+  //  computes the box in displacement space which the displacements of the
+  //  members touching the given box fall into (for arrays with a base object)
+  template <class BoxConv>
+  box_type displacement_search_box (const box_type &b, const BoxConv &bc) const
+  {
+    box_type ob (bc (m_obj));
+    if (ob.empty ()) {
+      return box_type ();
+    }
+
+    if (mp_base->is_complex ()) {
+      complex_trans_type ct = mp_base->complex_trans (simple_trans_type (m_trans));
+      ct.disp (typename complex_trans_type::displacement_type ());
+      ob = box_type (ct * ob);
+    } else {
+      ob.transform (db::fixpoint_trans<coord_type> (m_trans.rot ()));
+    }
+
+    vector_type d = m_trans.disp ();
+    return box_type (point_type () + (b.p1 () - (ob.p2 () + d)), point_type () + (b.p2 () - (ob.p1 () + d)));
+  }
+
   void transform_into_from (const unit_trans_type & /*tr*/, const array<Obj, Trans> & /*d*/)
   {
     //  .. nothing to do ..
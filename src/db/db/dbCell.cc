@@ -26,6 +26,8 @@
 #include "dbManager.h"
 #include "dbBox.h"
 #include "dbPCellVariant.h"
+#include "dbShapeRepository.h"
+#include "dbPropertiesRepository.h"
 
 #include <limits>
 
@@ -89,8 +91,8 @@ Cell::box_type Cell::ms_empty_box = Cell::box_type ();
 
 Cell::Cell (cell_index_type ci, db::Layout &l) 
   : db::Object (l.manager ()), 
-    m_cell_index (ci), mp_layout (&l), m_instances (this), m_prop_id (0), m_hier_levels (0), m_bbox_needs_update (false), m_ghost_cell (false), 
-    mp_last (0), mp_next (0)
+    m_cell_index (ci), mp_layout (&l), m_instances (this), m_prop_id (0), m_content_hash (0), m_hier_levels (0), m_bbox_needs_update (false), m_ghost_cell (false), 
+    m_content_hash_valid (false), mp_last (0), mp_next (0)
 {
   //  .. nothing yet 
 }
@@ -98,8 +100,8 @@ Cell::Cell (cell_index_type ci, db::Layout &l)
 Cell::Cell (const Cell &d)
   : db::Object (d), 
     gsi::ObjectBase (),
-    mp_layout (d.mp_layout), m_instances (this), m_prop_id (d.m_prop_id), m_hier_levels (d.m_hier_levels),
-    mp_last (0), mp_next (0)
+    mp_layout (d.mp_layout), m_instances (this), m_prop_id (d.m_prop_id), m_content_hash (0), m_hier_levels (d.m_hier_levels),
+    m_content_hash_valid (false), mp_last (0), mp_next (0)
 {
   m_cell_index = d.m_cell_index;
   operator= (d);
@@ -127,6 +129,7 @@ Cell::operator= (const Cell &d)
     m_hier_levels = d.m_hier_levels;
     m_prop_id = d.m_prop_id;
     m_bbox_needs_update = d.m_bbox_needs_update;
+    m_content_hash_valid = false;
 
   }
   return *this;
@@ -134,6 +137,8 @@ Cell::operator= (const Cell &d)
 
 Cell::~Cell ()
 {
+  //  the cell may not be part of the hierarchy anymore, so don't propagate to the parents
+  m_content_hash_valid = false;
   clear_shapes ();
 }
 
@@ -409,6 +414,181 @@ Cell::bbox (unsigned int l) const
   }
 }
 
+static size_t
+properties_hash (const db::PropertiesRepository &rep, db::properties_id_type prop_id)
+{
+  size_t h = 0;
+  if (prop_id != 0) {
+    const db::PropertiesRepository::properties_set &props = rep.properties (prop_id);
+    for (db::PropertiesRepository::properties_set::const_iterator p = props.begin (); p != props.end (); ++p) {
+      h += db::repository_hash_mix (db::repository_hash_combine (db::hash_for_property_value (rep.prop_name (p->first)), db::hash_for_property_value (p->second)));
+    }
+  }
+  return h;
+}
+
+static inline size_t
+element_hash (size_t tag, size_t h, size_t ph)
+{
+  return db::repository_hash_mix (db::repository_hash_combine (db::repository_hash_combine (tag, h), ph));
+}
+
+static size_t
+shapes_hash (const db::Shapes &shapes, const db::PropertiesRepository &rep)
+{
+  size_t h = 0;
+
+  db::Polygon poly;
+  db::Path path;
+  db::Text text;
+  db::Box box;
+  db::Edge edge;
+
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+
+    size_t ph = properties_hash (rep, s->prop_id ());
+
+    if (s->is_polygon ()) {
+      s->polygon (poly);
+      h += element_hash (1, db::repository_hash (poly), ph);
+    } else if (s->is_path ()) {
+      s->path (path);
+      h += element_hash (2, db::repository_hash_combine (db::repository_hash (path), size_t (path.round ())), ph);
+    } else if (s->is_text ()) {
+      s->text (text);
+      size_t th = db::repository_hash (text);
+      th = db::repository_hash_combine (th, db::repository_hash_coord (text.size ()));
+      th = db::repository_hash_combine (th, size_t (text.font ()));
+      th = db::repository_hash_combine (th, size_t (text.halign ()));
+      th = db::repository_hash_combine (th, size_t (text.valign ()));
+      h += element_hash (3, th, ph);
+    } else if (s->is_box ()) {
+      s->box (box);
+      h += element_hash (4, db::repository_hash (box), ph);
+    } else if (s->is_edge ()) {
+      s->edge (edge);
+      h += element_hash (5, db::repository_hash (edge), ph);
+    } else {
+      //  user objects and others: use the bounding box
+      h += element_hash (6, db::repository_hash (s->bbox ()), ph);
+    }
+
+  }
+
+  return h;
+}
+
+static size_t
+instance_hash (const db::CellInstArray &inst, size_t ph)
+{
+  db::DCplxTrans t (inst.complex_trans ());
+
+  size_t h = db::repository_hash_coord (t.disp ().x ());
+  h = db::repository_hash_combine (h, db::repository_hash_coord (t.disp ().y ()));
+  h = db::repository_hash_combine (h, db::repository_hash_coord (t.angle ()));
+  h = db::repository_hash_combine (h, db::repository_hash_coord (t.mag ()));
+  h = db::repository_hash_combine (h, size_t (t.is_mirror ()));
+
+  db::Vector a, b;
+  unsigned long na = 1, nb = 1;
+  std::vector<db::Vector> v;
+
+  if (inst.is_regular_array (a, b, na, nb)) {
+    h = db::repository_hash_combine (h, db::repository_hash_points (&a, &a + 1, 1));
+    h = db::repository_hash_combine (h, db::repository_hash_points (&b, &b + 1, 2));
+    h = db::repository_hash_combine (h, size_t (na));
+    h = db::repository_hash_combine (h, size_t (nb));
+  } else if (inst.is_iterated_array (&v)) {
+    size_t vh = 0;
+    for (std::vector<db::Vector>::const_iterator i = v.begin (); i != v.end (); ++i) {
+      vh += db::repository_hash_mix (db::repository_hash_points (i, i + 1, 3));
+    }
+    h = db::repository_hash_combine (h, vh);
+  }
+
+  return db::repository_hash_combine (h, ph);
+}
+
+static size_t
+layer_key_hash (const db::Layout &layout, unsigned int layer)
+{
+  if (layout.is_valid_layer (layer)) {
+    const db::LayerProperties &lp = layout.get_properties (layer);
+    if (! lp.is_null ()) {
+      return db::hash_for_property_value (tl::Variant (lp.to_string ()));
+    }
+  }
+  return size_t (layer);
+}
+
+void
+Cell::update_content_hash () const
+{
+  if (m_content_hash_valid) {
+    return;
+  }
+
+  const db::PropertiesRepository &rep = mp_layout->properties_repository ();
+
+  m_layer_content_hashes.clear ();
+
+  for (shapes_map::const_iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
+    size_t h = shapes_hash (s->second, rep);
+    if (h != 0) {
+      m_layer_content_hashes [s->first] += h;
+    }
+  }
+
+  for (instances_type::const_iterator i = m_instances.begin (); ! i.at_end (); ++i) {
+
+    const db::Cell &child = mp_layout->cell (i->cell_index ());
+    child.update_content_hash ();
+
+    if (! child.m_layer_content_hashes.empty ()) {
+      size_t ih = instance_hash (i->cell_inst (), properties_hash (rep, i->prop_id ()));
+      for (std::map<unsigned int, size_t>::const_iterator l = child.m_layer_content_hashes.begin (); l != child.m_layer_content_hashes.end (); ++l) {
+        m_layer_content_hashes [l->first] += db::repository_hash_mix (db::repository_hash_combine (ih, l->second));
+      }
+    }
+
+  }
+
+  m_content_hash = 0;
+  for (std::map<unsigned int, size_t>::const_iterator l = m_layer_content_hashes.begin (); l != m_layer_content_hashes.end (); ++l) {
+    if (l->second != 0) {
+      m_content_hash += db::repository_hash_mix (db::repository_hash_combine (layer_key_hash (*mp_layout, l->first), l->second));
+    }
+  }
+
+  m_content_hash_valid = true;
+}
+
+size_t
+Cell::content_hash () const
+{
+  return mp_layout->cell_content_hash (cell_index ());
+}
+
+size_t
+Cell::content_hash (unsigned int layer) const
+{
+  return mp_layout->cell_content_hash (cell_index (), layer);
+}
+
+void
+Cell::invalidate_content_hash ()
+{
+  if (mp_layout->hier_dirty ()) {
+    //  parent relations are not reliable - invalidate all
+    mp_layout->invalidate_content_hashes ();
+  } else if (m_content_hash_valid) {
+    m_content_hash_valid = false;
+    for (parent_cell_iterator p = m_instances.begin_parent_cells (); p != m_instances.end_parent_cells (); ++p) {
+      mp_layout->cell (*p).invalidate_content_hash ();
+    }
+  }
+}
+
 Cell::const_iterator
 Cell::begin () const
 {
@@ -549,12 +729,14 @@ Cell::invalidate_insts ()
   mp_layout->invalidate_hier ();  //  HINT: must come before the change is done!
   mp_layout->invalidate_bboxes (std::numeric_limits<unsigned int>::max ());
   m_bbox_needs_update = true;
+  invalidate_content_hash ();
 }
 
 void 
 Cell::invalidate_hier ()
 {
   mp_layout->invalidate_hier ();  //  HINT: must come before the change is done!
+  invalidate_content_hash ();
 }
 
 void 
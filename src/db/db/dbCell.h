@@ -502,6 +502,40 @@ public:
    */
   const box_type &bbox (unsigned int l) const;
 
+  /**
+   *  @brief Gets the content hash of the cell
+   *
+   *  The content hash is computed from the shapes of the cell and the instances
+   *  of child cells. Child cells enter the hash through their own content hash, hence
+   *  the cell names and cell indexes do not matter. Shapes and instances enter the
+   *  hash in an order-independent way. Properties enter the hash through their names
+   *  and values and layers through their layer properties. Hence, content hashes 
+   *  can be compared between different layouts.
+   *
+   *  Identical cells have identical hashes, but the reverse is not necessarily true.
+   *  Hashes are hierarchical, so the same geometry organized in a different hierarchy
+   *  will produce a different hash. Empty cells have a hash value of 0.
+   *
+   *  Content hashes are cached and are invalidated when the cell or one of its
+   *  child cells changes.
+   */
+  size_t content_hash () const;
+
+  /**
+   *  @brief Gets the content hash of the cell for the given layer
+   *
+   *  This hash is computed from the shapes on the given layer in this
+   *  cell and in the child cells. It is 0 if there is no content on this layer.
+   */
+  size_t content_hash (unsigned int layer) const;
+
+  /**
+   *  @brief Invalidates the content hash of the cell and of the parent cells
+   *
+   *  This method is called by the shapes and instance containers.
+   */
+  void invalidate_content_hash ();
+
   /**
    *  @brief Region query for the instances in "overlapping" mode
    *
@@ -946,10 +980,14 @@ private:
   box_map m_bboxes;
   db::properties_id_type m_prop_id;
 
+  mutable size_t m_content_hash;
+  mutable std::map<unsigned int, size_t> m_layer_content_hashes;
+
   // packed fields
   unsigned int m_hier_levels : 29;
   bool m_bbox_needs_update : 1;
   bool m_ghost_cell : 1;
+  mutable bool m_content_hash_valid : 1;
 
   static box_type ms_empty_box;
 
@@ -959,6 +997,9 @@ private:
   //  clear the shapes without telling the graph
   void clear_shapes_no_invalidate ();
 
+  //  computes the content hashes if required (child cells first)
+  void update_content_hash () const;
+
   //  helper function for computing the number of hierarchy levels
   //  must be called bottom-up
   unsigned int count_hier_levels () const;
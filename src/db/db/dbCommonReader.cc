@@ -81,7 +81,11 @@ public:
       tl::make_member (&db::CommonReaderOptions::create_other_layers, "create-other-layers") +
       tl::make_member (&db::CommonReaderOptions::layer_map, "layer-map") +
       tl::make_member (&db::CommonReaderOptions::enable_properties, "enable-properties") +
-      tl::make_member (&db::CommonReaderOptions::enable_text_objects, "enable-text-objects")
+      tl::make_member (&db::CommonReaderOptions::enable_text_objects, "enable-text-objects") +
+      tl::make_member (&db::CommonReaderOptions::deduplicate_cells, "deduplicate-cells") +
+      tl::make_member (&db::CommonReaderOptions::pcell_threads, "pcell-threads") +
+      tl::make_member (&db::CommonReaderOptions::pack_polygons, "pack-polygons") +
+      tl::make_member (&db::CommonReaderOptions::arena_allocation, "arena-allocation")
     );
   }
 };
@@ -44,7 +44,11 @@ public:
   CommonReaderOptions ()
     : create_other_layers (true),
       enable_text_objects (true),
-      enable_properties (true)
+      enable_properties (true),
+      deduplicate_cells (false),
+      pcell_threads (0),
+      pack_polygons (false),
+      arena_allocation (false)
   {
     //  .. nothing yet ..
   }
@@ -83,6 +87,45 @@ public:
    */
   bool enable_properties;
 
+  /**
+   *  @brief A flag indicating whether to merge identical cells after reading
+   *
+   *  If this flag is set to true, db::deduplicate_cells is run on the layout after
+   *  the file has been read. Note that this will also merge identical cells which
+   *  have been present in the layout before.
+   */
+  bool deduplicate_cells;
+
+  /**
+   *  @brief The number of threads to use for producing library PCell variants
+   *
+   *  If this value is larger than 0, the library PCell variants referenced by the file
+   *  are produced in one go before the cells are read. Variants of PCells supporting
+   *  parallel production are produced with the given number of threads then.
+   *  Currently this option applies to GDS2 only.
+   */
+  unsigned int pcell_threads;
+
+  /**
+   *  @brief Pack the polygons read
+   *
+   *  If this flag is set to true, the contours of the polygons read are stored in a
+   *  packed (compressed) form. This saves memory for polygons with many points at the
+   *  expense of some performance when accessing the points.
+   *  Currently this option applies to GDS2 and OASIS only.
+   */
+  bool pack_polygons;
+
+  /**
+   *  @brief Use arena allocation for the polygons read
+   *
+   *  If this flag is set to true, the point storage of the polygons stored in the 
+   *  layout's shape repository while reading is allocated from big chunks rather than
+   *  individually. This reduces the allocation overhead and heap fragmentation for layouts
+   *  with many polygons. This option applies to all formats which deliver shape references.
+   */
+  bool arena_allocation;
+
   /** 
    *  @brief Implementation of FormatSpecificReaderOptions
    */
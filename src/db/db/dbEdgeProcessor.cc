@@ -959,6 +959,269 @@ BooleanOp2::compare_ns () const
   return compare_ns_impl (inside_a, inside_b);
 }
 
+// -------------------------------------------------------------------------------
+//  BooleanExpression implementation
+
+//  The maximum stack depth for the evaluation (given by the bit stack)
+const unsigned int max_boolean_expression_depth = 64;
+
+BooleanExpression::BooleanExpression ()
+  : m_layers (0), m_depth (0)
+{
+  //  .. nothing yet ..
+}
+
+BooleanExpression::BooleanExpression (const std::string &s)
+  : m_layers (0), m_depth (0)
+{
+  tl::Extractor ex (s.c_str ());
+  parse_or (ex);
+  ex.expect_end ();
+}
+
+BooleanExpression
+BooleanExpression::layer (unsigned int l)
+{
+  BooleanExpression e;
+  e.m_program.push_back (Instruction (Layer, l));
+  e.m_layers = l + 1;
+  e.m_depth = 1;
+  return e;
+}
+
+BooleanExpression
+BooleanExpression::combined (const BooleanExpression &other, Op op) const
+{
+  if (other.empty ()) {
+    return op == And ? other : *this;
+  } else if (empty ()) {
+    return op == And || op == ANotB ? *this : other;
+  }
+
+  BooleanExpression e (*this);
+  e.m_program.insert (e.m_program.end (), other.m_program.begin (), other.m_program.end ());
+  e.m_layers = std::max (m_layers, other.m_layers);
+  e.add (op, std::max (m_depth, other.m_depth + 1));
+  return e;
+}
+
+void
+BooleanExpression::add (Op op, unsigned int depth)
+{
+  if (depth > max_boolean_expression_depth) {
+    throw tl::Exception (tl::to_string (tr ("Boolean expression is nested too deeply")));
+  }
+  m_program.push_back (Instruction (op, 0));
+  m_depth = depth;
+}
+
+void
+BooleanExpression::parse_atom (tl::Extractor &ex)
+{
+  if (ex.test ("(")) {
+    parse_or (ex);
+    ex.expect (")");
+  } else {
+    unsigned int l = 0;
+    ex.read (l);
+    *this = layer (l);
+  }
+}
+
+void
+BooleanExpression::parse_and (tl::Extractor &ex)
+{
+  parse_atom (ex);
+  while (ex.test ("&")) {
+    BooleanExpression other;
+    other.parse_atom (ex);
+    *this = *this & other;
+  }
+}
+
+void
+BooleanExpression::parse_or (tl::Extractor &ex)
+{
+  parse_and (ex);
+  while (true) {
+    Op op;
+    if (ex.test ("|")) {
+      op = Or;
+    } else if (ex.test ("^")) {
+      op = Xor;
+    } else if (ex.test ("-")) {
+      op = ANotB;
+    } else {
+      break;
+    }
+    BooleanExpression other;
+    other.parse_and (ex);
+    *this = combined (other, op);
+  }
+}
+
+std::string
+BooleanExpression::to_string () const
+{
+  std::vector<std::string> stack;
+
+  for (std::vector<Instruction>::const_iterator i = m_program.begin (); i != m_program.end (); ++i) {
+
+    if (i->op == Layer) {
+      stack.push_back (tl::to_string (i->layer));
+    } else {
+
+      tl_assert (stack.size () >= 2);
+
+      std::string b = stack.back ();
+      stack.pop_back ();
+
+      const char *op = "";
+      switch (i->op) {
+      case And:
+        op = "&";
+        break;
+      case ANotB:
+        op = "-";
+        break;
+      case Xor:
+        op = "^";
+        break;
+      case Or:
+        op = "|";
+        break;
+      default:
+        break;
+      }
+
+      //  all terms except the top-level one are put into brackets
+      bool bra = (i + 1 != m_program.end ());
+      stack.back () = (bra ? "(" : "") + stack.back () + op + b + (bra ? ")" : "");
+
+    }
+
+  }
+
+  return stack.empty () ? std::string () : stack.back ();
+}
+
+// -------------------------------------------------------------------------------
+//  BooleanExpressionOp implementation
+
+//  Up to this number of layers, the expression is precomputed into a lookup table
+const unsigned int max_boolean_expression_table_layers = 16;
+
+namespace
+{
+
+struct MaskInsideFunc
+{
+  MaskInsideFunc (unsigned int mask) : m_mask (mask) { }
+  bool operator() (unsigned int l) const { return ((m_mask >> l) & 1) != 0; }
+  unsigned int m_mask;
+};
+
+struct WrapCountInsideFunc
+{
+  WrapCountInsideFunc (const std::vector<int> &wc) : mp_wc (&wc) { }
+  bool operator() (unsigned int l) const { return l < mp_wc->size () && (*mp_wc) [l] != 0; }
+  const std::vector<int> *mp_wc;
+};
+
+}
+
+BooleanExpressionOp::BooleanExpressionOp (const BooleanExpression &expr, unsigned int layers)
+  : m_expr (expr), m_layers (std::max (layers, expr.layers ())), m_mask_n (0), m_mask_s (0), m_zeroes (0)
+{
+  m_layers = std::max (m_layers, (unsigned int) 1);
+
+  m_wc_n.resize (m_layers, 0);
+  m_wc_s.resize (m_layers, 0);
+
+  if (m_layers <= max_boolean_expression_table_layers) {
+    m_table.reserve (size_t (1) << m_layers);
+    for (unsigned int m = 0; m < (1u << m_layers); ++m) {
+      m_table.push_back (m_expr.evaluate (MaskInsideFunc (m)) ? 1 : 0);
+    }
+  }
+}
+
+void
+BooleanExpressionOp::reset ()
+{
+  m_wcv_n.clear ();
+  m_wcv_s.clear ();
+  m_wc_n.clear ();
+  m_wc_s.clear ();
+  m_wc_n.resize (m_layers, 0);
+  m_wc_s.resize (m_layers, 0);
+  m_mask_n = m_mask_s = 0;
+  m_zeroes = 0;
+}
+
+void
+BooleanExpressionOp::reserve (size_t n)
+{
+  m_wcv_n.clear ();
+  m_wcv_s.clear ();
+  m_wcv_n.resize (n, 0);
+  m_wcv_s.resize (n, 0);
+  m_zeroes = 2 * n;
+}
+
+inline bool
+BooleanExpressionOp::result (const std::vector<int> &wc, unsigned int mask) const
+{
+  if (! m_table.empty ()) {
+    return m_table [mask] != 0;
+  } else {
+    return m_expr.evaluate (WrapCountInsideFunc (wc));
+  }
+}
+
+int
+BooleanExpressionOp::edge (bool north, bool enter, property_type p)
+{
+  tl_assert (p < m_wcv_n.size () && p < m_wcv_s.size ());
+
+  int *wcv = north ? &m_wcv_n [p] : &m_wcv_s [p];
+  std::vector<int> &wc = north ? m_wc_n : m_wc_s;
+  unsigned int &mask = north ? m_mask_n : m_mask_s;
+
+  bool inside_before = (*wcv != 0);
+  *wcv += (enter ? 1 : -1);
+  bool inside_after = (*wcv != 0);
+  m_zeroes += (!inside_after) - (!inside_before);
+  tl_assert (long (m_zeroes) >= 0);
+
+  if (inside_before == inside_after) {
+    return 0;
+  }
+
+  bool res_before = result (wc, mask);
+
+  unsigned int l = (unsigned int) (p % m_layers);
+  int &wcl = wc [l];
+  wcl += (inside_after - inside_before);
+  if (l < max_boolean_expression_table_layers) {
+    if (wcl != 0) {
+      mask |= (1u << l);
+    } else {
+      mask &= ~(1u << l);
+    }
+  }
+
+  bool res_after = result (wc, mask);
+
+  return res_after - res_before;
+}
+
+int
+BooleanExpressionOp::compare_ns () const
+{
+  return result (m_wc_n, m_mask_n) - result (m_wc_s, m_mask_s);
+}
+
 // -------------------------------------------------------------------------------
 //  EdgeProcessor implementation
 
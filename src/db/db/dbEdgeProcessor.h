@@ -536,6 +536,234 @@ private:
   int m_wc_mode_a, m_wc_mode_b;
 };
 
+/**
+ *  @brief A boolean expression over a number of layers
+ *
+ *  This object describes a boolean function of N layers. The layers are
+ *  identified by an index (0 to N-1). The expression is stored as a
+ *  postfix program, so evaluation does not require recursion.
+ *
+ *  Expressions can be built from layer terms with the boolean operators
+ *  or can be parsed from a string. The string notation uses the layer
+ *  indexes as terms and "&" (AND), "|" (OR), "^" (XOR) and "-" (NOT) as
+ *  operators. "&" has a higher precedence than the other operators, which
+ *  are evaluated left to right. Brackets can be used to group terms.
+ *  For example: "(0|1)-(2&3)".
+ */
+class DB_PUBLIC BooleanExpression
+{
+public:
+  enum Op {
+    Layer = 0, And = 1, ANotB = 2, Xor = 4, Or = 5
+  };
+
+  /**
+   *  @brief Creates an empty expression
+   *
+   *  An empty expression always renders "false".
+   */
+  BooleanExpression ();
+
+  /**
+   *  @brief Creates an expression from a string
+   *
+   *  See the class description for the syntax. This constructor will throw an
+   *  exception if the string is not a valid expression.
+   */
+  explicit BooleanExpression (const std::string &s);
+
+  /**
+   *  @brief Creates an expression representing a single layer
+   */
+  static BooleanExpression layer (unsigned int l);
+
+  /**
+   *  @brief Returns the AND combination of this expression with another one
+   */
+  BooleanExpression operator& (const BooleanExpression &other) const
+  {
+    return combined (other, And);
+  }
+
+  /**
+   *  @brief Returns the NOT combination of this expression with another one
+   */
+  BooleanExpression operator- (const BooleanExpression &other) const
+  {
+    return combined (other, ANotB);
+  }
+
+  /**
+   *  @brief Returns the XOR combination of this expression with another one
+   */
+  BooleanExpression operator^ (const BooleanExpression &other) const
+  {
+    return combined (other, Xor);
+  }
+
+  /**
+   *  @brief Returns the OR combination of this expression with another one
+   */
+  BooleanExpression operator| (const BooleanExpression &other) const
+  {
+    return combined (other, Or);
+  }
+
+  /**
+   *  @brief Returns true, if the expression is empty
+   */
+  bool empty () const
+  {
+    return m_program.empty ();
+  }
+
+  /**
+   *  @brief Gets the number of layers required by the expression
+   *
+   *  This is the highest layer index plus one.
+   */
+  unsigned int layers () const
+  {
+    return m_layers;
+  }
+
+  /**
+   *  @brief Converts the expression into a string
+   *
+   *  The string can be used to create the expression again.
+   */
+  std::string to_string () const;
+
+  /**
+   *  @brief Evaluates the expression
+   *
+   *  "inside" is a function object delivering true for a layer index if the
+   *  layer is present.
+   */
+  template <class InsideFunc>
+  bool evaluate (const InsideFunc &inside) const
+  {
+    //  NOTE: the stack is a bit stack with the top element in bit 0. The maximum
+    //  depth is limited to 64 by the parser and the combination methods.
+    uint64_t stack = 0;
+
+    for (std::vector<Instruction>::const_iterator i = m_program.begin (); i != m_program.end (); ++i) {
+
+      if (i->op == Layer) {
+        stack = (stack << 1) | (inside (i->layer) ? 1 : 0);
+      } else {
+
+        bool b = (stack & 1) != 0;
+        stack >>= 1;
+        bool a = (stack & 1) != 0;
+
+        bool r = false;
+        switch (i->op) {
+        case And:
+          r = a && b;
+          break;
+        case ANotB:
+          r = a && ! b;
+          break;
+        case Xor:
+          r = a != b;
+          break;
+        case Or:
+          r = a || b;
+          break;
+        default:
+          break;
+        }
+
+        stack = (stack & ~uint64_t (1)) | (r ? 1 : 0);
+
+      }
+
+    }
+
+    return (stack & 1) != 0;
+  }
+
+  /**
+   *  @brief Equality
+   */
+  bool operator== (const BooleanExpression &other) const
+  {
+    return m_program == other.m_program;
+  }
+
+  /**
+   *  @brief Inequality
+   */
+  bool operator!= (const BooleanExpression &other) const
+  {
+    return ! operator== (other);
+  }
+
+private:
+  struct Instruction
+  {
+    Instruction (Op _op, unsigned int _layer) : op (_op), layer (_layer) { }
+
+    bool operator== (const Instruction &other) const
+    {
+      return op == other.op && layer == other.layer;
+    }
+
+    Op op;
+    unsigned int layer;
+  };
+
+  std::vector<Instruction> m_program;
+  unsigned int m_layers;
+  unsigned int m_depth;
+
+  BooleanExpression combined (const BooleanExpression &other, Op op) const;
+  void parse_or (tl::Extractor &ex);
+  void parse_and (tl::Extractor &ex);
+  void parse_atom (tl::Extractor &ex);
+  void add (Op op, unsigned int depth);
+};
+
+/**
+ *  @brief A boolean operation with an arbitrary expression over N layers
+ *
+ *  This evaluator computes a boolean expression over N input layers in a single pass.
+ *  Like BooleanOp, it relies on the properties being set in a certain way: the
+ *  property modulo N gives the layer index while the remaining part is used to
+ *  distinguish the polygons. For each polygon, a non-zero wrap count rule is applied
+ *  before the expression is evaluated.
+ */
+class DB_PUBLIC BooleanExpressionOp
+  : public EdgeEvaluatorBase
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  @param expr The boolean expression to evaluate
+   *  @param layers The number of layers (N). If 0, the number of layers is taken from the expression.
+   */
+  BooleanExpressionOp (const BooleanExpression &expr, unsigned int layers = 0);
+
+  virtual void reset ();
+  virtual void reserve (size_t n);
+  virtual int edge (bool north, bool enter, property_type p);
+  virtual int compare_ns () const;
+  virtual bool is_reset () const { return m_zeroes == m_wcv_n.size () + m_wcv_s.size (); }
+
+private:
+  BooleanExpression m_expr;
+  unsigned int m_layers;
+  std::vector <int> m_wcv_n, m_wcv_s;
+  std::vector <int> m_wc_n, m_wc_s;
+  std::vector <char> m_table;
+  unsigned int m_mask_n, m_mask_s;
+  size_t m_zeroes;
+
+  bool result (const std::vector<int> &wc, unsigned int mask) const;
+};
+
 /**
  *  @brief Merge operation
  *
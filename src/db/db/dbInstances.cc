@@ -67,14 +67,14 @@ public:
   typedef db::unstable_box_tree<box_type, Inst, box_convert_type> tree_type;
 
   InstOp (bool insert, const Inst &sh)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
-    m_insts.push_back (sh);
+    add (sh);
   }
   
   template <class Iter>
   InstOp (bool insert, Iter from, Iter to)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
     size_t n = 0;
     for (Iter i = from; i != to; ++i) {
@@ -82,17 +82,17 @@ public:
     }
     m_insts.reserve (n);
     for (Iter i = from; i != to; ++i) {
-      m_insts.push_back (*i);
+      add (*i);
     }
   }
 
   template <class Iter>
   InstOp (bool insert, Iter from, Iter to, bool /*dummy*/)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
     m_insts.reserve (std::distance (from, to));
     for (Iter i = from; i != to; ++i) {
-      m_insts.push_back (**i);
+      add (**i);
     }
   }
 
@@ -114,9 +114,24 @@ public:
     }
   }
 
+  virtual size_t mem_size () const
+  {
+    return sizeof (*this) + m_insts.capacity () * sizeof (Inst) + m_heap_size;
+  }
+
 private:
   bool m_insert;
   std::vector<Inst> m_insts;
+  //  the memory held by the instances outside the vector (i.e. complex array parameters)
+  size_t m_heap_size;
+
+  void add (const Inst &inst)
+  {
+    m_insts.push_back (inst);
+    db::MemStatisticsSum ms;
+    db::mem_stat (&ms, db::MemStatistics::None, 0, inst, true);
+    m_heap_size += ms.size ();
+  }
 
   void insert (Instances *insts);
   void erase (Instances *insts);
@@ -122,8 +122,15 @@ struct NewRemoveCellOp
   : public LayoutOp
 {
   NewRemoveCellOp (db::cell_index_type i, const std::string &name, bool remove, db::Cell *cell)
-    : m_cell_index (i), m_name (name), m_remove (remove), mp_cell (cell)
-  { }
+    : m_cell_index (i), m_name (name), m_remove (remove), mp_cell (cell), m_mem_size (sizeof (NewRemoveCellOp) + name.size ())
+  {
+    //  the estimate is taken once as the cell travels between the layout and this object
+    if (mp_cell) {
+      db::MemStatisticsSum ms;
+      mp_cell->mem_stat (&ms, db::MemStatistics::CellInfo, 0);
+      m_mem_size += ms.size ();
+    }
+  }
 
   ~NewRemoveCellOp ()
   {
@@ -150,11 +157,17 @@ struct NewRemoveCellOp
     }
   }
 
+  virtual size_t mem_size () const
+  {
+    return m_mem_size;
+  }
+
 private:
   db::cell_index_type m_cell_index;
   std::string m_name;
   bool m_remove;
   mutable db::Cell *mp_cell;
+  size_t m_mem_size;
 
   virtual void new_cell (db::Layout *layout) const
   {
@@ -263,7 +276,8 @@ Layout::Layout (db::Manager *manager)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (db::default_editable_mode ())
+    m_editable (db::default_editable_mode ()),
+    m_content_hashes_dirty (false)
 {
   // .. nothing yet ..
 }
@@ -278,7 +292,8 @@ Layout::Layout (bool editable, db::Manager *manager)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (editable)
+    m_editable (editable),
+    m_content_hashes_dirty (false)
 {
   // .. nothing yet ..
 }
@@ -295,7 +310,8 @@ Layout::Layout (const db::Layout &layout)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (layout.m_editable)
+    m_editable (layout.m_editable),
+    m_content_hashes_dirty (false)
 {
   *this = layout;
 }
@@ -560,7 +576,9 @@ Layout::delete_cells (const std::set<cell_index_type> &cells_to_delete)
     if (manager () && manager ()->transacting ()) {
        
       //  note the "take" method - this takes out the cell
-      manager ()->queue (this, new NewRemoveCellOp (*c, cell_name (*c), true /*remove*/, take_cell (*c)));
+      //  NOTE: take_cell clears the name, so it needs to be fetched first
+      std::string name (cell_name (*c));
+      manager ()->queue (this, new NewRemoveCellOp (*c, name, true /*remove*/, take_cell (*c)));
 
     } else {
 
@@ -628,7 +646,9 @@ Layout::delete_cell (cell_index_type id)
   if (manager () && manager ()->transacting ()) {
      
     //  not the "take" method - this takes out the cell
-    manager ()->queue (this, new NewRemoveCellOp (id, cell_name (id), true /*remove*/, take_cell (id)));
+    //  NOTE: take_cell clears the name, so it needs to be fetched first
+    std::string name (cell_name (id));
+    manager ()->queue (this, new NewRemoveCellOp (id, name, true /*remove*/, take_cell (id)));
 
   } else {
 
@@ -1246,6 +1266,58 @@ Layout::force_update ()
   }
 }
 
+void
+Layout::do_invalidate_hier ()
+{
+  invalidate_content_hashes ();
+  LayoutStateModel::do_invalidate_hier ();
+}
+
+size_t
+Layout::content_hash () const
+{
+  update ();
+
+  size_t h = 0;
+  for (top_down_const_iterator c = begin_top_down (); c != end_top_cells (); ++c) {
+    h += db::repository_hash_mix (cell_content_hash (*c));
+  }
+  return h;
+}
+
+size_t
+Layout::cell_content_hash (cell_index_type ci) const
+{
+  //  instance iteration requires an updated layout
+  update ();
+
+  tl::MutexLocker locker (&m_content_hash_lock);
+
+  if (m_content_hashes_dirty) {
+    for (const_iterator c = begin (); c != end (); ++c) {
+      c->m_content_hash_valid = false;
+    }
+    m_content_hashes_dirty = false;
+  }
+
+  const cell_type &c = cell (ci);
+  c.update_content_hash ();
+  return c.m_content_hash;
+}
+
+size_t
+Layout::cell_content_hash (cell_index_type ci, unsigned int layer) const
+{
+  //  makes sure the per-layer hashes are computed
+  cell_content_hash (ci);
+
+  tl::MutexLocker locker (&m_content_hash_lock);
+
+  const cell_type &c = cell (ci);
+  std::map<unsigned int, size_t>::const_iterator l = c.m_layer_content_hashes.find (layer);
+  return l != c.m_layer_content_hashes.end () ? l->second : 0;
+}
+
 void 
 Layout::update () const
 {
@@ -1564,6 +1636,9 @@ Layout::set_properties (unsigned int i, const LayerProperties &props)
 
     m_layer_props [i] = props;
 
+    //  layer properties enter the cell content hashes
+    invalidate_content_hashes ();
+
     layer_properties_changed ();
 
   }
@@ -1698,29 +1773,9 @@ Layout::get_pcell_variant_dict (pcell_id_type pcell_id, const std::map<std::stri
 
   pcell_variant_type *variant = header->get_variant (*this, parameters);
   if (! variant) {
-
-    std::string b (header->get_name ());
-    if (m_cell_map.find (b.c_str ()) != m_cell_map.end ()) {
-      b = uniquify_cell_name (b.c_str ());
-    }
-
-    //  create a new cell 
-    cell_index_type new_index = allocate_new_cell ();
-
-    variant = new pcell_variant_type (new_index, *this, pcell_id, parameters);
-    m_cells.push_back_ptr (variant);
-    m_cell_ptrs [new_index] = variant;
-
-    //  enter it's index and cell_name
-    register_cell_name (b.c_str (), new_index);
-
-    if (manager () && manager ()->transacting ()) {
-      manager ()->queue (this, new NewRemoveCellOp (new_index, m_cell_names [new_index], false /*new*/, 0));
-    }
-
+    variant = create_pcell_variant (pcell_id, parameters);
     // produce the layout
     variant->update ();
-
   }
 
   return variant->cell_index ();
@@ -1737,32 +1792,72 @@ Layout::get_pcell_variant (pcell_id_type pcell_id, const std::vector<tl::Variant
 
   pcell_variant_type *variant = header->get_variant (*this, parameters);
   if (! variant) {
+    variant = create_pcell_variant (pcell_id, parameters);
+    // produce the layout
+    variant->update ();
+  }
 
-    std::string b (header->get_name ());
-    if (m_cell_map.find (b.c_str ()) != m_cell_map.end ()) {
-      b = uniquify_cell_name (b.c_str ());
-    }
+  return variant->cell_index ();
+}
 
-    //  create a new cell 
-    cell_index_type new_index = allocate_new_cell ();
+std::vector<cell_index_type>
+Layout::get_pcell_variants (pcell_id_type pcell_id, const std::vector<std::vector<tl::Variant> > &p, unsigned int threads)
+{
+  pcell_header_type *header = pcell_header (pcell_id);
+  tl_assert (header != 0);
 
-    variant = new pcell_variant_type (new_index, *this, pcell_id, parameters);
-    m_cells.push_back_ptr (variant);
-    m_cell_ptrs [new_index] = variant;
+  std::vector<cell_index_type> cell_indexes;
+  cell_indexes.reserve (p.size ());
 
-    //  enter it's index and cell_name
-    register_cell_name (b.c_str (), new_index);
+  std::vector<pcell_variant_type *> new_variants;
 
-    if (manager () && manager ()->transacting ()) {
-      manager ()->queue (this, new NewRemoveCellOp (new_index, m_cell_names [new_index], false /*new*/, 0));
+  std::vector<tl::Variant> buffer;
+  for (std::vector<std::vector<tl::Variant> >::const_iterator pp = p.begin (); pp != p.end (); ++pp) {
+
+    const std::vector<tl::Variant> &parameters = gauge_parameters (*pp, header->declaration (), buffer);
+
+    pcell_variant_type *variant = header->get_variant (*this, parameters);
+    if (! variant) {
+      variant = create_pcell_variant (pcell_id, parameters);
+      new_variants.push_back (variant);
     }
 
-    // produce the layout
-    variant->update ();
+    cell_indexes.push_back (variant->cell_index ());
 
   }
 
-  return variant->cell_index ();
+  // produce the layout of the new variants
+  pcell_variant_type::update_variants (new_variants, threads);
+
+  return cell_indexes;
+}
+
+Layout::pcell_variant_type *
+Layout::create_pcell_variant (pcell_id_type pcell_id, const std::vector<tl::Variant> &parameters)
+{
+  pcell_header_type *header = pcell_header (pcell_id);
+  tl_assert (header != 0);
+
+  std::string b (header->get_name ());
+  if (m_cell_map.find (b.c_str ()) != m_cell_map.end ()) {
+    b = uniquify_cell_name (b.c_str ());
+  }
+
+  //  create a new cell 
+  cell_index_type new_index = allocate_new_cell ();
+
+  pcell_variant_type *variant = new pcell_variant_type (new_index, *this, pcell_id, parameters);
+  m_cells.push_back_ptr (variant);
+  m_cell_ptrs [new_index] = variant;
+
+  //  enter it's index and cell_name
+  register_cell_name (b.c_str (), new_index);
+
+  if (manager () && manager ()->transacting ()) {
+    manager ()->queue (this, new NewRemoveCellOp (new_index, m_cell_names [new_index], false /*new*/, 0));
+  }
+
+  return variant;
 }
 
 const Layout::pcell_header_type *
@@ -2063,60 +2158,96 @@ Layout::get_context_info (cell_index_type cell_index, std::vector <std::string>
   return true;
 }
 
-bool
-Layout::recover_proxy_as (cell_index_type cell_index, std::vector <std::string>::const_iterator from, std::vector <std::string>::const_iterator to, ImportLayerMapping *layer_mapping)
+/**
+ *  @brief One level of a proxy context as stored in the layout files
+ *
+ *  A context is a list of strings. "LIB=name" refers to a library - the remaining
+ *  strings describe the cell inside the library's layout. "P(name)=value" lines followed
+ *  by "PCELL=name" describe a PCell variant. "CELL=name" describes a plain cell.
+ */
+struct ProxyContextLevel
 {
+  enum kind_type { Invalid, Lib, PCell, Cell };
+
+  ProxyContextLevel ()
+    : kind (Invalid)
+  { }
+
+  kind_type kind;
+  std::string name;
+  std::map<std::string, tl::Variant> parameters;
+};
+
+static ProxyContextLevel
+parse_proxy_context_level (std::vector <std::string>::const_iterator from, std::vector <std::string>::const_iterator to)
+{
+  ProxyContextLevel level;
   if (from == to) {
-    return false;
+    return level;
   }
 
   tl::Extractor ex (from->c_str ());
 
   if (ex.test ("LIB=")) {
+    level.kind = ProxyContextLevel::Lib;
+    level.name = ex.skip ();
+    return level;
+  }
 
-    std::string lib_name = ex.skip ();
-    Library *lib = db::LibraryManager::instance ().lib_ptr_by_name (lib_name);
-    if (! lib) {
-      return false;
-    }
+  while (from != to && (ex = tl::Extractor (from->c_str ())).test ("P(")) {
 
-    db::Cell *lib_cell = lib->layout ().recover_proxy (from + 1, to);
-    if (lib_cell) {
-      get_lib_proxy_as (lib, lib_cell->cell_index (), cell_index, layer_mapping);
-      return true;
-    }
+    std::string name;
+    ex.read_word_or_quoted (name);
+    ex.test (")");
+    ex.test ("=");
 
-  } else {
+    ex.read (level.parameters.insert (std::make_pair (name, tl::Variant ())).first->second);
 
-    std::map<std::string, tl::Variant> parameters;
+    ++from;
 
-    while (from != to && (ex = tl::Extractor (from->c_str ())).test ("P(")) {
+  }
 
-      std::string name;
-      ex.read_word_or_quoted (name);
-      ex.test (")");
-      ex.test ("=");
+  if (ex.test ("PCELL=")) {
+    level.kind = ProxyContextLevel::PCell;
+    level.name = ex.skip ();
+  } else if (ex.test ("CELL=")) {
+    level.kind = ProxyContextLevel::Cell;
+    level.name = ex.skip ();
+  }
 
-      ex.read (parameters.insert (std::make_pair (name, tl::Variant ())).first->second);
+  return level;
+}
+
+bool
+Layout::recover_proxy_as (cell_index_type cell_index, std::vector <std::string>::const_iterator from, std::vector <std::string>::const_iterator to, ImportLayerMapping *layer_mapping)
+{
+  ProxyContextLevel level = parse_proxy_context_level (from, to);
 
-      ++from;
+  if (level.kind == ProxyContextLevel::Lib) {
 
+    Library *lib = db::LibraryManager::instance ().lib_ptr_by_name (level.name);
+    if (! lib) {
+      return false;
     }
 
-    if (ex.test ("PCELL=")) {
+    db::Cell *lib_cell = lib->layout ().recover_proxy (from + 1, to);
+    if (lib_cell) {
+      get_lib_proxy_as (lib, lib_cell->cell_index (), cell_index, layer_mapping);
+      return true;
+    }
 
-      std::pair<bool, pcell_id_type> pc = pcell_by_name (ex.skip ());
-      if (pc.first) {
-        get_pcell_variant_as (pc.second, pcell_declaration (pc.second)->map_parameters (parameters), cell_index, layer_mapping);
-        return true;
-      }
+  } else if (level.kind == ProxyContextLevel::PCell) {
 
-    } else if (ex.test ("CELL=")) {
+    std::pair<bool, pcell_id_type> pc = pcell_by_name (level.name.c_str ());
+    if (pc.first) {
+      get_pcell_variant_as (pc.second, pcell_declaration (pc.second)->map_parameters (level.parameters), cell_index, layer_mapping);
+      return true;
+    }
 
-      //  This should not happen. A cell (given by the cell index) cannot be proxy to another cell in the same layout.
-      tl_assert (false);
+  } else if (level.kind == ProxyContextLevel::Cell) {
 
-    } 
+    //  This should not happen. A cell (given by the cell index) cannot be proxy to another cell in the same layout.
+    tl_assert (false);
 
   }
 
@@ -2126,16 +2257,11 @@ Layout::recover_proxy_as (cell_index_type cell_index, std::vector <std::string>:
 db::Cell *
 Layout::recover_proxy (std::vector <std::string>::const_iterator from, std::vector <std::string>::const_iterator to)
 {
-  if (from == to) {
-    return 0;
-  }
+  ProxyContextLevel level = parse_proxy_context_level (from, to);
 
-  tl::Extractor ex (from->c_str ());
-
-  if (ex.test ("LIB=")) {
+  if (level.kind == ProxyContextLevel::Lib) {
 
-    std::string lib_name = ex.skip ();
-    Library *lib = db::LibraryManager::instance ().lib_ptr_by_name (lib_name);
+    Library *lib = db::LibraryManager::instance ().lib_ptr_by_name (level.name);
     if (! lib) {
       return 0;
     }
@@ -2146,43 +2272,57 @@ Layout::recover_proxy (std::vector <std::string>::const_iterator from, std::vect
       return &cell (cell_index);
     }
 
-  } else {
+  } else if (level.kind == ProxyContextLevel::PCell) {
 
-    std::map<std::string, tl::Variant> parameters;
+    std::pair<bool, pcell_id_type> pc = pcell_by_name (level.name.c_str ());
+    if (pc.first) {
+      cell_index_type cell_index = get_pcell_variant (pc.second, pcell_declaration (pc.second)->map_parameters (level.parameters));
+      return &cell (cell_index);
+    }
 
-    while (from != to && (ex = tl::Extractor (from->c_str ())).test ("P(")) {
+  } else if (level.kind == ProxyContextLevel::Cell) {
 
-      std::string name;
-      ex.read_word_or_quoted (name);
-      ex.test (")");
-      ex.test ("=");
+    std::pair<bool, cell_index_type> cc = cell_by_name (level.name.c_str ());
+    if (cc.first) {
+      return &cell (cc.second);
+    }
 
-      ex.read (parameters.insert (std::make_pair (name, tl::Variant ())).first->second);
+  }
 
-      ++from;
+  return 0;
+}
 
-    }
+void
+Layout::prepare_proxies (const std::vector<std::vector<std::string> > &contexts, unsigned int threads)
+{
+  //  collect the parameter sets per library PCell
+  std::map<std::pair<Library *, pcell_id_type>, std::vector<std::vector<tl::Variant> > > variants;
 
-    if (ex.test ("PCELL=")) {
+  for (std::vector<std::vector<std::string> >::const_iterator c = contexts.begin (); c != contexts.end (); ++c) {
 
-      std::pair<bool, pcell_id_type> pc = pcell_by_name (ex.skip ());
-      if (pc.first) {
-        cell_index_type cell_index = get_pcell_variant (pc.second, pcell_declaration (pc.second)->map_parameters (parameters));
-        return &cell (cell_index);
-      }
+    ProxyContextLevel lib_level = parse_proxy_context_level (c->begin (), c->end ());
+    if (lib_level.kind != ProxyContextLevel::Lib) {
+      continue;
+    }
 
-    } else if (ex.test ("CELL=")) {
+    Library *lib = db::LibraryManager::instance ().lib_ptr_by_name (lib_level.name);
+    if (! lib) {
+      continue;
+    }
 
-      std::pair<bool, cell_index_type> cc = cell_by_name (ex.skip ());
-      if (cc.first) {
-        return &cell (cc.second);
+    ProxyContextLevel level = parse_proxy_context_level (c->begin () + 1, c->end ());
+    if (level.kind == ProxyContextLevel::PCell) {
+      std::pair<bool, pcell_id_type> pc = lib->layout ().pcell_by_name (level.name.c_str ());
+      if (pc.first) {
+        variants [std::make_pair (lib, pc.second)].push_back (lib->layout ().pcell_declaration (pc.second)->map_parameters (level.parameters));
       }
-
-    } 
+    }
 
   }
 
-  return 0;
+  for (std::map<std::pair<Library *, pcell_id_type>, std::vector<std::vector<tl::Variant> > >::const_iterator v = variants.begin (); v != variants.end (); ++v) {
+    v->first.first->layout ().get_pcell_variants (v->first.second, v->second, threads);
+  }
 }
 
 std::string 
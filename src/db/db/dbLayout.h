@@ -38,6 +38,7 @@
 #include "tlException.h"
 #include "tlVector.h"
 #include "tlString.h"
+#include "tlThreads.h"
 #include "gsi.h"
 
 #include <cstring>
@@ -774,6 +775,20 @@ public:
    */
   cell_index_type get_pcell_variant_dict (pcell_id_type pcell_id, const std::map<std::string, tl::Variant> &p);
 
+  /**
+   *  @brief Gets multiple PCell variants in one go
+   *
+   *  This method is equivalent to calling get_pcell_variant for each parameter set, but
+   *  the new variants of PCells supporting parallel production (see PCellDeclaration::can_produce_in_parallel)
+   *  are produced using the given number of threads.
+   *
+   *  @param pcell_id The Id of the PCell declaration
+   *  @param parameters The parameter sets
+   *  @param threads The number of threads to use (0 for producing the variants in the main thread)
+   *  @return The indexes of the variant cells in the order of the parameter sets
+   */
+  std::vector<cell_index_type> get_pcell_variants (pcell_id_type pcell_id, const std::vector<std::vector<tl::Variant> > &parameters, unsigned int threads);
+
   /** 
    *  @brief Get a PCell variant and replace the given cell
    *
@@ -968,6 +983,19 @@ public:
    */
   bool recover_proxy_as (cell_index_type cell_index, std::vector <std::string>::const_iterator from, std::vector <std::string>::const_iterator to, ImportLayerMapping *layer_mapping = 0);
 
+  /**
+   *  @brief Produces the library PCell variants required to recover the given proxies
+   *
+   *  "contexts" is a list of context informations as delivered by get_context_info.
+   *  The library PCell variants these contexts refer to are produced in one go with
+   *  get_pcell_variants, so a subsequent recover_proxy or recover_proxy_as will find 
+   *  them. This allows producing the variants in parallel when a layout is loaded.
+   *
+   *  @param contexts The context informations
+   *  @param threads The number of threads to use (see get_pcell_variants)
+   */
+  static void prepare_proxies (const std::vector<std::vector<std::string> > &contexts, unsigned int threads);
+
   /**
    *  @brief Delete a cell plus the subcells not used otherwise
    *
@@ -1392,9 +1420,47 @@ public:
    *  "under_construction" state is active. This allows to do the update
    *  in certain stages without triggering the update automatically and
    *  too frequently.
+   *
+   *  After the update, const access does not modify the layout object.
+   *  Hence an updated layout can be shared copy-on-write by forked processes.
    */
   void force_update ();
 
+  /**
+   *  @brief Gets the content hash of the layout
+   *
+   *  This hash is a combination of the content hashes of the top cells.
+   *  See Cell::content_hash for details about content hashes.
+   */
+  size_t content_hash () const;
+
+  /**
+   *  @brief Gets the content hash of the given cell
+   *
+   *  This is the same than Cell::content_hash.
+   *  This method is thread-safe as long as the layout is not modified.
+   */
+  size_t cell_content_hash (cell_index_type ci) const;
+
+  /**
+   *  @brief Gets the content hash of the given cell for the given layer
+   *
+   *  This is the same than Cell::content_hash (layer).
+   */
+  size_t cell_content_hash (cell_index_type ci, unsigned int layer) const;
+
+  /**
+   *  @brief Invalidates the content hashes of all cells
+   *
+   *  The content hashes are invalidated automatically when shapes or instances
+   *  change. This method needs to be called when the properties repository is
+   *  modified for properties IDs which are already in use.
+   */
+  void invalidate_content_hashes ()
+  {
+    m_content_hashes_dirty = true;
+  }
+
   /**
    *  @brief Cleans up the layout
    *
@@ -1602,6 +1668,11 @@ protected:
    */
   virtual void do_update ();
 
+  /**
+   *  @brief Reimplementation of LayoutStateModel::do_invalidate_hier
+   */
+  virtual void do_invalidate_hier ();
+
 private:
   enum LayerState { Normal, Free, Special };
 
@@ -1630,6 +1701,8 @@ private:
   int m_waste_layer;
   bool m_editable;
   meta_info m_meta_info;
+  mutable bool m_content_hashes_dirty;
+  mutable tl::Mutex m_content_hash_lock;
 
   /**
    *  @brief Sort the cells topologically
@@ -1657,6 +1730,7 @@ private:
    *  @brief Allocate a cell index for a new cell
    */
   cell_index_type allocate_new_cell ();
+  pcell_variant_type *create_pcell_variant (pcell_id_type pcell_id, const std::vector<tl::Variant> &parameters);
 
   /**  
    *  @brief Insert a new layer
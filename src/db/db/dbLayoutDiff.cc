@@ -26,8 +26,11 @@
 #include "dbCellMapping.h"
 #include "dbFuzzyCellMapping.h"
 #include "dbLayoutUtils.h"
+#include "dbShapeRepository.h"
 #include "tlLog.h"
 #include "tlExceptions.h"
+#include "tlThreadedWorkers.h"
+#include "tlProgress.h"
 
 namespace db
 {
@@ -552,6 +555,23 @@ collect_boxes (const db::Layout &, const db::Cell *c, unsigned int layer, unsign
   }
 }
 
+static void
+normalize_text (db::Text &text, unsigned int flags)
+{
+  if (flags & layout_diff::f_no_text_details) {
+    text.font (db::NoFont);
+    text.halign (db::NoHAlign);
+    text.valign (db::NoVAlign);
+  }
+
+  if (flags & layout_diff::f_no_text_orientation) {
+    db::Text::trans_type tt (text.trans ());
+    tt = db::Text::trans_type (tt.disp ());
+    text.trans (tt);
+    text.size (0);
+  }
+}
+
 static void
 collect_texts (const db::Layout &, const db::Cell *c, unsigned int layer, unsigned int flags, std::vector< std::pair<db::Text, db::properties_id_type> > &shapes, PropertyMapper &pn)
 {
@@ -570,18 +590,7 @@ collect_texts (const db::Layout &, const db::Cell *c, unsigned int layer, unsign
     //  layouts.
     shapes.back ().first.string (shapes.back ().first.string ());
 
-    if (flags & layout_diff::f_no_text_details) {
-      shapes.back ().first.font (db::NoFont);
-      shapes.back ().first.halign (db::NoHAlign);
-      shapes.back ().first.valign (db::NoVAlign);
-    }
-
-    if (flags & layout_diff::f_no_text_orientation) {
-      db::Text::trans_type tt (shapes.back ().first.trans ());
-      tt = db::Text::trans_type (tt.disp ());
-      shapes.back ().first.trans (tt);
-      shapes.back ().first.size (0);
-    }
+    normalize_text (shapes.back ().first, flags);
 
   }
 }
@@ -601,8 +610,776 @@ collect_paths (const db::Layout &, const db::Cell *c, unsigned int layer, unsign
   }
 }
 
+// -------------------------------------------------------------------------------
+//  Content hashes
+//
+//  The layer content hash is computed from the same objects than the detailed
+//  compare uses. It is an order-independent combination of the shape hashes.
+//  With "f_hash_prefilter", identical hashes are taken as an indication of
+//  identical layers - in that case the detailed compare is skipped. As hashes
+//  may collide, this is an opt-in only.
+
+static inline size_t
+shape_hash (size_t tag, size_t h, db::properties_id_type prop_id)
+{
+  return db::repository_hash_mix (db::repository_hash_combine (db::repository_hash_combine (tag, h), size_t (prop_id)));
+}
+
+static inline size_t
+text_hash (const db::Text &text)
+{
+  size_t h = db::repository_hash (text);
+  h = db::repository_hash_combine (h, db::repository_hash_coord (text.size ()));
+  h = db::repository_hash_combine (h, size_t (text.font ()));
+  h = db::repository_hash_combine (h, size_t (text.halign ()));
+  return db::repository_hash_combine (h, size_t (text.valign ()));
+}
+
+static size_t
+layer_content_hash (const db::Cell *c, bool is_valid, unsigned int layer, unsigned int flags, PropertyMapper &pn)
+{
+  size_t h = 0;
+  if (! is_valid) {
+    return h;
+  }
+
+  const db::Shapes &shapes = c->shapes (layer);
+
+  db::Polygon poly;
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Polygons | ((flags & db::layout_diff::f_paths_as_polygons) ? db::ShapeIterator::Paths : 0) | ((flags & db::layout_diff::f_boxes_as_polygons) ? db::ShapeIterator::Boxes : 0)); !s.at_end (); ++s) {
+    db::properties_id_type prop_id = (flags & layout_diff::f_no_properties) ? 0 : pn (s->prop_id ());
+    s->polygon (poly);
+    h += shape_hash (1, db::repository_hash (poly), prop_id);
+  }
+
+  if (! (flags & db::layout_diff::f_paths_as_polygons)) {
+    db::Path path;
+    for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Paths); !s.at_end (); ++s) {
+      db::properties_id_type prop_id = (flags & layout_diff::f_no_properties) ? 0 : pn (s->prop_id ());
+      s->path (path);
+      h += shape_hash (2, db::repository_hash_combine (db::repository_hash (path), size_t (path.round ())), prop_id);
+    }
+  }
+
+  db::Text text;
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Texts); !s.at_end (); ++s) {
+    db::properties_id_type prop_id = (flags & layout_diff::f_no_properties) ? 0 : pn (s->prop_id ());
+    s->text (text);
+    normalize_text (text, flags);
+    h += shape_hash (3, text_hash (text), prop_id);
+  }
+
+  if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
+    db::Box box;
+    for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Boxes); !s.at_end (); ++s) {
+      db::properties_id_type prop_id = (flags & layout_diff::f_no_properties) ? 0 : pn (s->prop_id ());
+      s->box (box);
+      h += shape_hash (4, db::repository_hash (box), prop_id);
+    }
+  }
+
+  db::Edge edge;
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Edges); !s.at_end (); ++s) {
+    db::properties_id_type prop_id = (flags & layout_diff::f_no_properties) ? 0 : pn (s->prop_id ());
+    s->edge (edge);
+    h += shape_hash (5, db::repository_hash (edge), prop_id);
+  }
+
+  return h;
+}
+
+// -------------------------------------------------------------------------------
+//  The cell compare
+
+/**
+ *  @brief The cell-independent data of a layout compare
+ */
+struct CellCompareData
+{
+  const db::Layout *a, *b;
+  unsigned int flags;
+  db::Coord tolerance;
+  bool verbose;
+  bool use_hashes;
+  bool log;
+  const db::Layout *n;
+  db::PropertyMapper *prop_normalize_a, *prop_normalize_b;
+  db::PropertyMapper *prop_remap_to_a, *prop_remap_to_b;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> *layers_a, *layers_b;
+  const std::vector<db::LayerProperties> *common_layers;
+  const std::vector <std::string> *common_cells;
+  const std::map <db::cell_index_type, db::cell_index_type> *common_cell_indices_a, *common_cell_indices_b;
+  const std::vector <db::cell_index_type> *common_cells_a, *common_cells_b;
+};
+
+/**
+ *  @brief The working buffers of the cell compare
+ */
+struct CellCompareBuffers
+{
+  std::vector <db::CellInstArrayWithProperties> insts_a;
+  std::vector <db::CellInstArrayWithProperties> insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
+};
+
+/**
+ *  @brief Compares the common cell with the given index
+ *
+ *  @return False, if the cells differ
+ */
+static bool
+compare_cell (const CellCompareData &d, unsigned int cci, DifferenceReceiver &r, CellCompareBuffers &buffers)
+{
+  const db::Layout &a = *d.a;
+  const db::Layout &b = *d.b;
+  unsigned int flags = d.flags;
+  db::Coord tolerance = d.tolerance;
+  bool verbose = d.verbose;
+
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_a = *d.layers_a;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_b = *d.layers_b;
+  const std::vector<db::LayerProperties> &common_layers = *d.common_layers;
+  const std::vector <std::string> &common_cells = *d.common_cells;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_a = *d.common_cell_indices_a;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_b = *d.common_cell_indices_b;
+  const std::vector <db::cell_index_type> &common_cells_a = *d.common_cells_a;
+  const std::vector <db::cell_index_type> &common_cells_b = *d.common_cells_b;
+
+  db::PropertyMapper &prop_normalize_a = *d.prop_normalize_a;
+  db::PropertyMapper &prop_normalize_b = *d.prop_normalize_b;
+  db::PropertyMapper &prop_remap_to_a = *d.prop_remap_to_a;
+  db::PropertyMapper &prop_remap_to_b = *d.prop_remap_to_b;
+
+  const db::Layout &n = *d.n;
+
+  std::vector <db::CellInstArrayWithProperties> &insts_a = buffers.insts_a;
+  std::vector <db::CellInstArrayWithProperties> &insts_b = buffers.insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_a = buffers.polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_b = buffers.polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_a = buffers.paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_b = buffers.paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_a = buffers.texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_b = buffers.texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_a = buffers.boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_b = buffers.boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_a = buffers.edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_b = buffers.edges_b;
+
+  bool differs = false;
+
+  const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
+  const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
+
+  r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
+
+  if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
+    differs = true;
+    if (flags & layout_diff::f_silent) {
+      return false;
+    }
+    r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
+  }
+
+  collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
+  collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
+
+  std::vector <db::CellInstArrayWithProperties> anotb;
+  std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
+
+  rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
+  collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
+
+  std::vector <db::CellInstArrayWithProperties> bnota;
+  std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
+
+  rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
+  collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
+
+  if (! anotb.empty () || ! bnota.empty ()) {
+
+    differs = true;
+
+    if (flags & layout_diff::f_silent) {
+      return false;
+    }
+
+    r.begin_inst_differences ();
+
+    if (verbose) {
+
+      r.instances_in_a (insts_a, common_cells, n.properties_repository ());
+      r.instances_in_b (insts_b, common_cells, n.properties_repository ());
+
+      r.instances_in_a_only (anotb, a);
+      r.instances_in_b_only (bnota, b);
+
+    }
+
+    r.end_inst_differences ();
+
+  }
+
+
+  //  compare layer by layer
+  
+  for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
+
+    if (d.log && tl::verbosity () >= 40) {
+      tl::info << "Layout diff - compare layer " << cl->to_string ();
+    }
+
+    bool is_valid_a = false, is_valid_b = false;
+    unsigned int layer_a = 0, layer_b = 0;
+
+    if (layers_a.find (*cl) != layers_a.end ()) { 
+      layer_a = layers_a.find (*cl)->second;
+      is_valid_a = true;
+    }
+    
+    if (layers_b.find (*cl) != layers_b.end ()) {
+      layer_b = layers_b.find (*cl)->second;
+      is_valid_b = true;
+    }
+
+    r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
+
+    if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
+    }
+
+    //  skip the detailed compare if the content hashes are identical
+
+    if (d.use_hashes &&
+        layer_content_hash (cell_a, is_valid_a, layer_a, flags, prop_normalize_a) == layer_content_hash (cell_b, is_valid_b, layer_b, flags, prop_normalize_b)) {
+      r.end_layer ();
+      continue;
+    }
+
+    //  compare polygons
+
+    polygons_a.clear();
+    polygons_b.clear();
+    if (is_valid_a) {
+      collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
+    } 
+    if (is_valid_b) {
+      collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
+    }
+
+    reduce (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance > 0);
+
+    if (!polygons_a.empty () || !polygons_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      r.begin_polygon_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
+      }
+      r.end_polygon_differences ();
+    }
+
+
+    //  compare paths
+
+    if (! (flags & db::layout_diff::f_paths_as_polygons)) {
+
+      paths_a.clear();
+      paths_b.clear();
+      if (is_valid_a) {
+        collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
+      }
+
+      reduce (paths_a, paths_b, make_path_compare_func (tolerance), tolerance > 0);
+
+      if (!paths_a.empty () || !paths_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return false;
+        }
+        r.begin_path_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), paths_a, paths_b);
+        }
+        r.end_path_differences ();
+      }
+
+    }
+
+    //  compare texts
+
+    texts_a.clear();
+    texts_b.clear();
+    if (is_valid_a) {
+      collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
+    }
+
+    reduce (texts_a, texts_b, make_text_compare_func (tolerance), tolerance > 0);
+
+    if (!texts_a.empty () || !texts_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      r.begin_text_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), texts_a, texts_b);
+      }
+      r.end_text_differences ();
+    }
+
+    //  compare boxes (unless this is done by the polygon compare code)
+    
+    if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
+
+      boxes_a.clear();
+      boxes_b.clear();
+      if (is_valid_a) {
+        collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
+      }
+
+      reduce (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance > 0);
+
+      if (!boxes_a.empty () || !boxes_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return false;
+        }
+        r.begin_box_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
+        }
+        r.end_box_differences ();
+      }
+
+    }
+
+    //  compare edges
+
+    edges_a.clear();
+    edges_b.clear();
+    if (is_valid_a) {
+      collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
+    }
+
+    reduce (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance > 0);
+
+    if (!edges_a.empty () || !edges_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      r.begin_edge_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), edges_a, edges_b);
+      }
+      r.end_edge_differences ();
+    }
+
+    r.end_layer ();
+
+  }
+
+  r.end_cell ();
+
+  return ! differs;
+}
+
+// -------------------------------------------------------------------------------
+//  Parallel compare
+
+/**
+ *  @brief A base class for a recorded difference event
+ */
+class DiffEvent
+{
+public:
+  virtual ~DiffEvent () { }
+  virtual void replay (DifferenceReceiver &r) const = 0;
+};
+
+/**
+ *  @brief An event without arguments
+ */
+class SimpleDiffEvent
+  : public DiffEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) ();
+
+  SimpleDiffEvent (method_type m)
+    : m_method (m)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) ();
+  }
+
+private:
+  method_type m_method;
+};
+
+/**
+ *  @brief An event reporting two boxes
+ */
+class BoxesDiffEvent
+  : public DiffEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const db::Box &, const db::Box &);
+
+  BoxesDiffEvent (method_type m, const db::Box &ba, const db::Box &bb)
+    : m_method (m), m_ba (ba), m_bb (bb)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_ba, m_bb);
+  }
+
+private:
+  method_type m_method;
+  db::Box m_ba, m_bb;
+};
+
+/**
+ *  @brief The "begin_cell" event
+ */
+class BeginCellDiffEvent
+  : public DiffEvent
+{
+public:
+  BeginCellDiffEvent (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib)
+    : m_cellname (cellname), m_cia (cia), m_cib (cib)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    r.begin_cell (m_cellname, m_cia, m_cib);
+  }
+
+private:
+  std::string m_cellname;
+  db::cell_index_type m_cia, m_cib;
+};
+
+/**
+ *  @brief The "begin_layer" event
+ */
+class BeginLayerDiffEvent
+  : public DiffEvent
+{
+public:
+  BeginLayerDiffEvent (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b)
+    : m_layer (layer), m_layer_index_a (layer_index_a), m_is_valid_a (is_valid_a), m_layer_index_b (layer_index_b), m_is_valid_b (is_valid_b)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    r.begin_layer (m_layer, m_layer_index_a, m_is_valid_a, m_layer_index_b, m_is_valid_b);
+  }
+
+private:
+  db::LayerProperties m_layer;
+  unsigned int m_layer_index_a;
+  bool m_is_valid_a;
+  unsigned int m_layer_index_b;
+  bool m_is_valid_b;
+};
+
+/**
+ *  @brief The "instances_in_a" and "instances_in_b" events
+ */
+class InstancesDiffEvent
+  : public DiffEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const std::vector <db::CellInstArrayWithProperties> &, const std::vector <std::string> &, const db::PropertiesRepository &);
+
+  InstancesDiffEvent (method_type m, const std::vector <db::CellInstArrayWithProperties> &insts, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props)
+    : m_method (m), m_insts (insts), mp_cell_names (&cell_names), mp_props (&props)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_insts, *mp_cell_names, *mp_props);
+  }
+
+private:
+  method_type m_method;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const std::vector <std::string> *mp_cell_names;
+  const db::PropertiesRepository *mp_props;
+};
+
+/**
+ *  @brief The "instances_in_a_only" and "instances_in_b_only" events
+ */
+class InstancesOnlyDiffEvent
+  : public DiffEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const std::vector <db::CellInstArrayWithProperties> &, const db::Layout &);
+
+  InstancesOnlyDiffEvent (method_type m, const std::vector <db::CellInstArrayWithProperties> &insts, const db::Layout &layout)
+    : m_method (m), m_insts (insts), mp_layout (&layout)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_insts, *mp_layout);
+  }
+
+private:
+  method_type m_method;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const db::Layout *mp_layout;
+};
+
+/**
+ *  @brief The "detailed_diff" events
+ */
+template <class SH>
+class DetailedDiffEvent
+  : public DiffEvent
+{
+public:
+  DetailedDiffEvent (const db::PropertiesRepository &pr, const std::vector <std::pair <SH, db::properties_id_type> > &a, const std::vector <std::pair <SH, db::properties_id_type> > &b)
+    : mp_pr (&pr), m_a (a), m_b (b)
+  { }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    r.detailed_diff (*mp_pr, m_a, m_b);
+  }
+
+private:
+  const db::PropertiesRepository *mp_pr;
+  std::vector <std::pair <SH, db::properties_id_type> > m_a, m_b;
+};
+
+/**
+ *  @brief A difference receiver recording the per-cell events for later delivery
+ */
+class RecordingDifferenceReceiver
+  : public DifferenceReceiver
+{
+public:
+  RecordingDifferenceReceiver ()
+    : m_identical (true)
+  { }
+
+  ~RecordingDifferenceReceiver ()
+  {
+    for (std::vector<DiffEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      delete *e;
+    }
+    m_events.clear ();
+  }
+
+  void set_identical (bool f)
+  {
+    m_identical = f;
+  }
+
+  bool identical () const
+  {
+    return m_identical;
+  }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    for (std::vector<DiffEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      (*e)->replay (r);
+    }
+  }
+
+  void bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxesDiffEvent (&DifferenceReceiver::bbox_differs, ba, bb)); }
+  void begin_cell (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib) { add (new BeginCellDiffEvent (cellname, cia, cib)); }
+  void begin_inst_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_inst_differences)); }
+  void instances_in_a (const std::vector <db::CellInstArrayWithProperties> &insts_a, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesDiffEvent (&DifferenceReceiver::instances_in_a, insts_a, cell_names, props)); }
+  void instances_in_b (const std::vector <db::CellInstArrayWithProperties> &insts_b, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesDiffEvent (&DifferenceReceiver::instances_in_b, insts_b, cell_names, props)); }
+  void instances_in_a_only (const std::vector <db::CellInstArrayWithProperties> &anotb, const db::Layout &a) { add (new InstancesOnlyDiffEvent (&DifferenceReceiver::instances_in_a_only, anotb, a)); }
+  void instances_in_b_only (const std::vector <db::CellInstArrayWithProperties> &bnota, const db::Layout &b) { add (new InstancesOnlyDiffEvent (&DifferenceReceiver::instances_in_b_only, bnota, b)); }
+  void end_inst_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_inst_differences)); }
+  void begin_layer (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b) { add (new BeginLayerDiffEvent (layer, layer_index_a, is_valid_a, layer_index_b, is_valid_b)); }
+  void per_layer_bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxesDiffEvent (&DifferenceReceiver::per_layer_bbox_differs, ba, bb)); }
+  void begin_polygon_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_polygon_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &a, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Polygon> (pr, a, b)); }
+  void end_polygon_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_polygon_differences)); }
+  void begin_path_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_path_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Path, db::properties_id_type> > &a, const std::vector <std::pair <db::Path, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Path> (pr, a, b)); }
+  void end_path_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_path_differences)); }
+  void begin_box_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_box_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Box, db::properties_id_type> > &a, const std::vector <std::pair <db::Box, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Box> (pr, a, b)); }
+  void end_box_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_box_differences)); }
+  void begin_edge_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_edge_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Edge, db::properties_id_type> > &a, const std::vector <std::pair <db::Edge, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Edge> (pr, a, b)); }
+  void end_edge_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_edge_differences)); }
+  void begin_text_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::begin_text_differences)); }
+  void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Text, db::properties_id_type> > &a, const std::vector <std::pair <db::Text, db::properties_id_type> > &b) { add (new DetailedDiffEvent<db::Text> (pr, a, b)); }
+  void end_text_differences () { add (new SimpleDiffEvent (&DifferenceReceiver::end_text_differences)); }
+  void end_layer () { add (new SimpleDiffEvent (&DifferenceReceiver::end_layer)); }
+  void end_cell () { add (new SimpleDiffEvent (&DifferenceReceiver::end_cell)); }
+
+private:
+  std::vector<DiffEvent *> m_events;
+  bool m_identical;
+
+  void add (DiffEvent *e)
+  {
+    m_events.push_back (e);
+  }
+
+  RecordingDifferenceReceiver (const RecordingDifferenceReceiver &);
+  RecordingDifferenceReceiver &operator= (const RecordingDifferenceReceiver &);
+};
+
+/**
+ *  @brief Fills the property mapper's table for all properties of the source layout
+ *
+ *  After this, the property mapper can be used read-only by multiple threads.
+ */
+static void
+prepare_property_mapper (db::PropertyMapper &pm, const db::Layout &source)
+{
+  for (db::PropertiesRepository::iterator p = source.properties_repository ().begin (); p != source.properties_repository ().end (); ++p) {
+    pm (p->first);
+  }
+}
+
+class LayoutDiffTask
+  : public tl::Task
+{
+public:
+  LayoutDiffTask (unsigned int cci)
+    : m_cci (cci)
+  { }
+
+  unsigned int cci () const
+  {
+    return m_cci;
+  }
+
+private:
+  unsigned int m_cci;
+};
+
+class LayoutDiffJob
+  : public tl::JobBase
+{
+public:
+  LayoutDiffJob (int nworkers, const CellCompareData *data, size_t ncells)
+    : tl::JobBase (nworkers), mp_data (data), m_progress (0)
+  {
+    m_results.reserve (ncells);
+    for (size_t i = 0; i < ncells; ++i) {
+      m_results.push_back (new RecordingDifferenceReceiver ());
+    }
+  }
+
+  ~LayoutDiffJob ()
+  {
+    for (std::vector<RecordingDifferenceReceiver *>::const_iterator r = m_results.begin (); r != m_results.end (); ++r) {
+      delete *r;
+    }
+    m_results.clear ();
+  }
+
+  const CellCompareData &data () const
+  {
+    return *mp_data;
+  }
+
+  RecordingDifferenceReceiver &result (unsigned int cci)
+  {
+    return *m_results [cci];
+  }
+
+  void next_progress ()
+  {
+    tl::MutexLocker locker (&m_mutex);
+    ++m_progress;
+  }
+
+  void update_progress (tl::RelativeProgress &progress)
+  {
+    size_t p;
+    {
+      tl::MutexLocker locker (&m_mutex);
+      p = m_progress;
+    }
+
+    progress.set (p, true /*force yield*/);
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  const CellCompareData *mp_data;
+  std::vector<RecordingDifferenceReceiver *> m_results;
+  size_t m_progress;
+  tl::Mutex m_mutex;
+};
+
+class LayoutDiffWorker
+  : public tl::Worker
+{
+public:
+  LayoutDiffWorker (LayoutDiffJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    LayoutDiffTask *diff_task = dynamic_cast <LayoutDiffTask *> (task);
+    if (diff_task) {
+      RecordingDifferenceReceiver &result = mp_job->result (diff_task->cci ());
+      result.set_identical (compare_cell (mp_job->data (), diff_task->cci (), result, m_buffers));
+      mp_job->next_progress ();
+    }
+  }
+
+private:
+  LayoutDiffJob *mp_job;
+  CellCompareBuffers m_buffers;
+};
+
+tl::Worker *
+LayoutDiffJob::create_worker ()
+{
+  return new LayoutDiffWorker (this);
+}
+
 static bool
-do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, unsigned int threads)
 {
   bool differs = false;
 
@@ -807,257 +1584,110 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
 
   tl::RelativeProgress progress (tl::to_string (tr ("Layout diff")), common_cells.size (), 1);
 
+  CellCompareData data;
+  data.a = &a;
+  data.b = &b;
+  data.flags = flags;
+  data.tolerance = tolerance;
+  data.verbose = verbose;
+  //  NOTE: with a tolerance, shapes are not compared exactly - hence the hash cannot be used
+  data.use_hashes = (tolerance == 0 && (flags & layout_diff::f_hash_prefilter) != 0);
+  data.log = (threads == 0);
+  data.n = &n;
+  data.prop_normalize_a = &prop_normalize_a;
+  data.prop_normalize_b = &prop_normalize_b;
+  data.prop_remap_to_a = &prop_remap_to_a;
+  data.prop_remap_to_b = &prop_remap_to_b;
+  data.layers_a = &layers_a;
+  data.layers_b = &layers_b;
+  data.common_layers = &common_layers;
+  data.common_cells = &common_cells;
+  data.common_cell_indices_a = &common_cell_indices_a;
+  data.common_cell_indices_b = &common_cell_indices_b;
+  data.common_cells_a = &common_cells_a;
+  data.common_cells_b = &common_cells_b;
+
   //  compare cell by cell
   
   if (tl::verbosity () >= 20) {
     tl::info << "Layout diff - cell by cell compare";
   }
 
-  std::vector <db::CellInstArrayWithProperties> insts_a;
-  std::vector <db::CellInstArrayWithProperties> insts_b;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
+  if (threads > 0) {
 
-  for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
+    //  In parallel mode, the cells are compared by the workers while the results are
+    //  recorded. The recorded results are delivered to the receiver in the original order.
+    //  The layouts and the property mappers must not be modified by the workers.
+    //  Hence, the layouts are updated and the property mappers are filled before.
 
-    const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
-    const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
-
-    if (tl::verbosity () >= 30) {
-      tl::info << "Layout diff - compare cell " << a.cell_name (cell_a->cell_index ()) << " and " << b.cell_name (cell_b->cell_index ());
-    }
+    a.update ();
+    b.update ();
 
-    r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
+    prepare_property_mapper (prop_normalize_a, a);
+    prepare_property_mapper (prop_normalize_b, b);
+    prepare_property_mapper (prop_remap_to_a, n);
+    prepare_property_mapper (prop_remap_to_b, n);
 
-    if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
-      differs = true;
-      if (flags & layout_diff::f_silent) {
-        return false;
-      }
-      r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
+    LayoutDiffJob job (threads, &data, common_cells.size ());
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
+      job.schedule (new LayoutDiffTask (cci));
     }
 
-    collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
-    collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
-
-    std::vector <db::CellInstArrayWithProperties> anotb;
-    std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
-
-    rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
-    collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
-
-    std::vector <db::CellInstArrayWithProperties> bnota;
-    std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
-
-    rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
-    collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
-
-    if (! anotb.empty () || ! bnota.empty ()) {
-
-      differs = true;
-
-      if (flags & layout_diff::f_silent) {
-        return false;
+    try {
+      job.start ();
+      while (job.is_running ()) {
+        //  This may throw an exception, if the cancel button has been pressed.
+        job.update_progress (progress);
+        job.wait (100);
       }
-
-      r.begin_inst_differences ();
-
-      if (verbose) {
-
-        r.instances_in_a (insts_a, common_cells, n.properties_repository ());
-        r.instances_in_b (insts_b, common_cells, n.properties_repository ());
-
-        r.instances_in_a_only (anotb, a);
-        r.instances_in_b_only (bnota, b);
-
-      }
-
-      r.end_inst_differences ();
-
+    } catch (...) {
+      job.terminate ();
+      throw;
     }
 
+    if (job.has_error ()) {
+      throw tl::Exception (tl::to_string (tr ("Errors occured during layout compare. First error message says:\n")) + job.error_messages ().front ());
+    }
 
-    //  compare layer by layer
-    
-    for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
-
-      if (tl::verbosity () >= 40) {
-        tl::info << "Layout diff - compare layer " << cl->to_string ();
-      }
-
-      bool is_valid_a = false, is_valid_b = false;
-      unsigned int layer_a = 0, layer_b = 0;
-
-      if (layers_a.find (*cl) != layers_a.end ()) { 
-        layer_a = layers_a.find (*cl)->second;
-        is_valid_a = true;
-      }
-      
-      if (layers_b.find (*cl) != layers_b.end ()) {
-        layer_b = layers_b.find (*cl)->second;
-        is_valid_b = true;
-      }
-
-      r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
-
-      if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
-      }
-
-      //  compare polygons
-
-      polygons_a.clear();
-      polygons_b.clear();
-      if (is_valid_a) {
-        collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
-      } 
-      if (is_valid_b) {
-        collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
-      }
-
-      reduce (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance > 0);
-
-      if (!polygons_a.empty () || !polygons_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_polygon_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
-        }
-        r.end_polygon_differences ();
-      }
-
-
-      //  compare paths
-
-      if (! (flags & db::layout_diff::f_paths_as_polygons)) {
-
-        paths_a.clear();
-        paths_b.clear();
-        if (is_valid_a) {
-          collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
-        }
-
-        reduce (paths_a, paths_b, make_path_compare_func (tolerance), tolerance > 0);
-
-        if (!paths_a.empty () || !paths_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
-          r.begin_path_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), paths_a, paths_b);
-          }
-          r.end_path_differences ();
-        }
-
-      }
-
-      //  compare texts
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
 
-      texts_a.clear();
-      texts_b.clear();
-      if (is_valid_a) {
-        collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
-      }
-      if (is_valid_b) {
-        collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
+      if (tl::verbosity () >= 30) {
+        tl::info << "Layout diff - compare cell " << a.cell_name (common_cells_a [cci]) << " and " << b.cell_name (common_cells_b [cci]);
       }
 
-      reduce (texts_a, texts_b, make_text_compare_func (tolerance), tolerance > 0);
+      const RecordingDifferenceReceiver &result = job.result (cci);
+      result.replay (r);
 
-      if (!texts_a.empty () || !texts_b.empty ()) {
+      if (! result.identical ()) {
         differs = true;
         if (flags & layout_diff::f_silent) {
           return false;
         }
-        r.begin_text_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), texts_a, texts_b);
-        }
-        r.end_text_differences ();
       }
 
-      //  compare boxes (unless this is done by the polygon compare code)
-      
-      if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
-
-        boxes_a.clear();
-        boxes_b.clear();
-        if (is_valid_a) {
-          collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
-        }
-
-        reduce (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance > 0);
+    }
 
-        if (!boxes_a.empty () || !boxes_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
-          r.begin_box_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
-          }
-          r.end_box_differences ();
-        }
+  } else {
 
-      }
+    CellCompareBuffers buffers;
 
-      //  compare edges
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
 
-      edges_a.clear();
-      edges_b.clear();
-      if (is_valid_a) {
-        collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
+      if (tl::verbosity () >= 30) {
+        tl::info << "Layout diff - compare cell " << a.cell_name (common_cells_a [cci]) << " and " << b.cell_name (common_cells_b [cci]);
       }
-      if (is_valid_b) {
-        collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
-      }
-
-      reduce (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance > 0);
 
-      if (!edges_a.empty () || !edges_b.empty ()) {
+      if (! compare_cell (data, cci, r, buffers)) {
         differs = true;
         if (flags & layout_diff::f_silent) {
           return false;
         }
-        r.begin_edge_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), edges_a, edges_b);
-        }
-        r.end_edge_differences ();
       }
 
-      r.end_layer ();
+      ++progress;
 
     }
 
-    r.end_cell ();
-
-    ++progress;
-
   }
 
   return ! differs;
@@ -1065,15 +1695,15 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
 }
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, unsigned int threads)
 {
-  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r);
+  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, unsigned int threads)
 {
-  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r);
+  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r, threads);
 }
 
 // -------------------------------------------------------------------------------
@@ -1560,21 +2190,21 @@ PrintingDifferenceReceiver::end_cell ()
 //  Implementation of a printing diff 
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, unsigned int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, b, flags, tolerance, r);
+  return compare_layouts (a, b, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, unsigned int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r);
+  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r, threads);
 }
 
 }
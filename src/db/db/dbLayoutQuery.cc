@@ -35,6 +35,8 @@
 #include <memory>
 #include <deque>
 #include <iostream>
+#include <cstring>
+#include <cctype>
 
 namespace db
 {
@@ -145,20 +147,26 @@ private:
 class DB_PUBLIC NameFilter
 {
 public:
-  NameFilter (const NameFilterArgument &arg, tl::Eval &eval)
-    : m_needs_eval (arg.m_needs_eval), mp_eval (&eval)
+  NameFilter (const NameFilterArgument &arg, tl::Eval &eval, bool cached = false)
+    : m_needs_eval (arg.m_needs_eval), mp_eval (&eval), m_cached (cached)
   { 
     if (m_needs_eval) {
       eval.parse (m_expression, arg.m_pattern, true);
     } else {
       m_pattern = arg.m_pattern;
+      //  patterns with brackets deliver substrings, so these need to be matched every time
+      m_cached = m_cached && arg.m_pattern.find ('(') == std::string::npos;
     }
   }
 
   void reset ()
   {
     if (m_needs_eval) {
-      m_pattern = m_expression.execute ().to_string ();
+      std::string p = m_expression.execute ().to_string ();
+      if (p != m_pattern.pattern ()) {
+        m_pattern = p;
+        m_cache.clear ();
+      }
     }
   }
 
@@ -167,11 +175,300 @@ public:
     return m_pattern.match (s, mp_eval->match_substrings ());
   }
 
+  /**
+   *  @brief Matches the qualified name of the given cell
+   *
+   *  In cached mode, the result is remembered per cell index. This avoids
+   *  producing and matching the cell names again and again when the same cells
+   *  are visited from many parents. Caching is only enabled for queries which
+   *  do not modify the layout.
+   */
+  bool match_cell (const db::Layout &layout, db::cell_index_type ci)
+  {
+    if (! m_cached || (m_needs_eval && m_pattern.pattern ().find ('(') != std::string::npos)) {
+      return match (layout.cell (ci).get_qualified_name ());
+    }
+
+    if (ci >= m_cache.size ()) {
+      m_cache.resize (ci + 1, 0);
+    }
+
+    char &c = m_cache [ci];
+    if (c == 0) {
+      c = match (layout.cell (ci).get_qualified_name ()) ? 2 : 1;
+    } else if (! mp_eval->match_substrings ().empty ()) {
+      mp_eval->match_substrings ().clear ();
+    }
+
+    return c == 2;
+  }
+
 private:
   tl::GlobPattern m_pattern;
   tl::Expression m_expression;
   bool m_needs_eval;
   tl::Eval *mp_eval;
+  bool m_cached;
+  std::vector<char> m_cache;
+};
+
+// --------------------------------------------------------------------------------
+//  ShapeFilterConstraints definition and implementation
+
+/**
+ *  @brief Scans an expression text for top-level operators
+ *
+ *  The scanner skips quoted strings and nested brackets. "pos" receives the positions
+ *  of top-level occurrences of "op". The method returns false if the expression is
+ *  not suitable for being taken apart - i.e. if it contains an assignment, one of
+ *  the "forbidden" top-level characters or one of the "forbidden" top-level operators.
+ */
+static bool
+scan_top_level (const std::string &expr, const char *op, const char *forbidden_chars, const char *forbidden_op, std::vector<size_t> &pos)
+{
+  size_t oplen = strlen (op);
+  size_t flen = forbidden_op ? strlen (forbidden_op) : 0;
+  int depth = 0;
+  char quote = 0;
+
+  for (size_t i = 0; i < expr.size (); ++i) {
+
+    char c = expr [i];
+
+    if (quote) {
+      if (c == '\\') {
+        ++i;
+      } else if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+
+    if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '(' || c == '[' || c == '{') {
+      ++depth;
+    } else if (c == ')' || c == ']' || c == '}') {
+      --depth;
+    } else if (c == '=' && (i == 0 || strchr ("=!<>", expr [i - 1]) == 0) && (i + 1 == expr.size () || strchr ("=~", expr [i + 1]) == 0)) {
+      //  assignments have side effects which must not be skipped
+      return false;
+    } else if (depth == 0) {
+      if (expr.compare (i, oplen, op) == 0) {
+        pos.push_back (i);
+        i += oplen - 1;
+      } else if (flen > 0 && expr.compare (i, flen, forbidden_op) == 0) {
+        return false;
+      } else if (strchr (forbidden_chars, c) != 0) {
+        return false;
+      }
+    }
+
+  }
+
+  return true;
+}
+
+/**
+ *  @brief Returns true if the expression text mentions one of the shape-level properties
+ */
+static bool
+mentions_shape_properties (const std::string &expr)
+{
+  static const char *names[] = { "shape", "bbox", "shape_bbox", "layer_info", "layer_index" };
+
+  char quote = 0;
+  for (size_t i = 0; i < expr.size (); ) {
+
+    char c = expr [i];
+
+    if (quote) {
+      if (c == '\\') {
+        ++i;
+      } else if (c == quote) {
+        quote = 0;
+      }
+      ++i;
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+      ++i;
+    } else if (isalpha (c) || c == '_') {
+      size_t i0 = i;
+      while (i < expr.size () && (isalnum (expr [i]) || expr [i] == '_')) {
+        ++i;
+      }
+      std::string w (expr, i0, i - i0);
+      for (size_t n = 0; n < sizeof (names) / sizeof (names [0]); ++n) {
+        if (w == names [n]) {
+          return true;
+        }
+      }
+    } else {
+      ++i;
+    }
+
+  }
+
+  return false;
+}
+
+/**
+ *  @brief Returns true if the given text is a constant expression 
+ *
+ *  "v" receives the value of the expression.
+ */
+static bool
+eval_constant (const std::string &expr, tl::Variant &v)
+{
+  try {
+    tl::Eval e;
+    tl::Expression x;
+    e.parse (x, expr, true);
+    v = x.execute ();
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+/**
+ *  @brief Conditions which are translated into restrictions of the shape iteration
+ *
+ *  These constraints are derived from the "where" clause following a shape filter.
+ *  They only narrow the set of shapes delivered to the condition - the "where" 
+ *  expression is still evaluated on each shape delivered. Hence the constraints 
+ *  are allowed to deliver a superset of the shapes selected by the condition.
+ *
+ *  The following terms of a top-level "&&" chain are recognized:
+ *
+ *  @code
+ *  layer_index == <expr>
+ *  bbox.touches(<expr>)                  (also: shape_bbox, shape.bbox, overlaps, inside)
+ *  shape.property(<const>) == <const>    (also with reversed arguments)
+ *  @/code
+ *
+ *  "<expr>" must not refer to shape-level properties. It is evaluated once per 
+ *  parent cell. "<const>" must be an expression which can be evaluated without
+ *  the query context.
+ */
+struct ShapeFilterConstraints
+{
+  ShapeFilterConstraints ()
+    : region_overlapping (false)
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Derives the constraints from the given condition
+   */
+  void analyze (const std::string &condition)
+  {
+    std::vector<size_t> pos;
+    if (! scan_top_level (condition, "&&", "?;", "||", pos)) {
+      return;
+    }
+
+    pos.push_back (condition.size ());
+
+    size_t p0 = 0;
+    for (std::vector<size_t>::const_iterator p = pos.begin (); p != pos.end (); ++p) {
+      analyze_term (tl::trim (std::string (condition, p0, *p - p0)));
+      p0 = *p + 2;
+    }
+  }
+
+  bool is_empty () const
+  {
+    return layer_expr.empty () && region_expr.empty () && prop_key.is_nil ();
+  }
+
+  std::string layer_expr;
+  std::string region_expr;
+  bool region_overlapping;
+  tl::Variant prop_key;
+  std::string prop_check_expr;
+
+private:
+  void analyze_term (const std::string &term)
+  {
+    if (region_expr.empty () && analyze_region_term (term)) {
+      return;
+    }
+
+    std::vector<size_t> pos;
+    if (! scan_top_level (term, "==", "<>!~", 0, pos) || pos.size () != 1) {
+      return;
+    }
+
+    std::string l = tl::trim (std::string (term, 0, pos.front ()));
+    std::string r = tl::trim (std::string (term, pos.front () + 2));
+
+    if (layer_expr.empty ()) {
+      if (l == "layer_index" && ! mentions_shape_properties (r)) {
+        layer_expr = r;
+        return;
+      } else if (r == "layer_index" && ! mentions_shape_properties (l)) {
+        layer_expr = l;
+        return;
+      }
+    }
+
+    if (prop_key.is_nil ()) {
+      tl::Variant v;
+      if (is_property_access (l, prop_key) && eval_constant (r, v)) {
+        prop_check_expr = "_pv == (" + r + ")";
+      } else if (is_property_access (r, prop_key) && eval_constant (l, v)) {
+        prop_check_expr = "(" + l + ") == _pv";
+      } else {
+        prop_key = tl::Variant ();
+      }
+    }
+  }
+
+  bool analyze_region_term (const std::string &term)
+  {
+    tl::Extractor ex (term.c_str ());
+    if (! ex.test ("shape_bbox") && ! (ex.test ("shape") && ex.test (".") && ex.test ("bbox"))) {
+      ex = tl::Extractor (term.c_str ());
+      if (! ex.test ("bbox")) {
+        return false;
+      }
+    }
+
+    bool overlapping = false;
+    if (! ex.test (".")) {
+      return false;
+    } else if (ex.test ("overlaps")) {
+      overlapping = true;
+    } else if (! ex.test ("touches") && ! ex.test ("inside")) {
+      return false;
+    }
+
+    if (! ex.test ("(")) {
+      return false;
+    }
+
+    std::string arg = tl::Eval::parse_expr (ex, true);
+    if (! ex.test (")") || ! ex.at_end () || mentions_shape_properties (arg)) {
+      return false;
+    }
+
+    region_expr = arg;
+    region_overlapping = overlapping;
+    return true;
+  }
+
+  static bool is_property_access (const std::string &expr, tl::Variant &key)
+  {
+    tl::Extractor ex (expr.c_str ());
+    if (! ex.test ("shape") || ! ex.test (".") || ! ex.test ("property") || ! ex.test ("(")) {
+      return false;
+    }
+
+    std::string k = tl::Eval::parse_expr (ex, true);
+    return ex.test (")") && ex.at_end () && eval_constant (k, key) && ! key.is_nil ();
+  }
 };
 
 // --------------------------------------------------------------------------------
@@ -202,16 +499,38 @@ class DB_PUBLIC ShapeFilterState
   : public FilterStateBase
 {
 public:
-  ShapeFilterState (const FilterBase *filter, const db::LayerMap &layers, db::ShapeIterator::flags_type flags, tl::Eval &eval, db::Layout *layout, bool reading, const ShapeFilterPropertyIDs &pids)
+  ShapeFilterState (const FilterBase *filter, const db::LayerMap &layers, db::ShapeIterator::flags_type flags, const ShapeFilterConstraints &constraints, tl::Eval &eval, db::Layout *layout, bool reading, const ShapeFilterPropertyIDs &pids)
     : FilterStateBase (filter, layout, eval),
-      m_flags (flags), mp_parent (0), m_reading (reading), m_pids (pids), m_lindex (0)
+      m_flags (flags), mp_parent (0), m_reading (reading), m_pids (pids), m_lindex (0),
+      m_has_layer_sel (false), m_has_region_sel (false), m_region_overlapping (constraints.region_overlapping), m_has_region (false),
+      m_has_prop_sel (false), m_prop_sel_valid (false), m_prop_key (constraints.prop_key), m_has_prop (false)
   {
     //  get the layers which we have to look for
     for (db::Layout::layer_iterator l = layout->begin_layers (); l != layout->end_layers (); ++l) {
       if (layers.is_empty () || layers.logical (*(*l).second).first) {
-        m_layers.push_back ((*l).first);
+        m_all_layers.push_back ((*l).first);
       }
     }
+
+    m_layers = m_all_layers;
+
+    if (! constraints.layer_expr.empty ()) {
+      eval.parse (m_layer_expression, constraints.layer_expr, true);
+      m_has_layer_sel = true;
+    }
+
+    //  NOTE: region queries are not used in modifying mode as the shapes' box trees
+    //  may change while we iterate
+    if (! constraints.region_expr.empty () && m_reading) {
+      eval.parse (m_region_expression, constraints.region_expr, true);
+      m_has_region_sel = true;
+    }
+
+    if (! m_prop_key.is_nil ()) {
+      m_prop_eval.set_var ("_pv", tl::Variant ());
+      m_prop_eval.parse (m_prop_check, constraints.prop_check_expr, true);
+      m_has_prop_sel = true;
+    }
   }
 
   virtual void reset (FilterStateBase *previous) 
@@ -227,10 +546,16 @@ public:
 
     m_ignored.clear ();
 
+    if (mp_parent) {
+      update_layers ();
+      update_region ();
+      update_prop_sel ();
+    }
+
     m_lindex = 0;
     if (mp_parent) {
       while (m_layers.size () > m_lindex) {
-        m_shape = mp_parent->shapes (m_layers [m_lindex]).begin (m_flags);
+        m_shape = begin_shapes (m_layers [m_lindex]);
         if (m_shape.at_end ()) {
           ++m_lindex;
         } else {
@@ -259,7 +584,7 @@ public:
         while (m_shape.at_end ()) {
           ++m_lindex;
           if (m_layers.size () > m_lindex) {
-            m_shape = mp_parent->shapes (m_layers [m_lindex]).begin (m_flags);
+            m_shape = begin_shapes (m_layers [m_lindex]);
             m_ignored.clear ();
           } else {
             break;
@@ -324,22 +649,128 @@ private:
   const db::Cell *mp_parent;
   bool m_reading;
   ShapeFilterPropertyIDs m_pids;
+  std::vector<unsigned int> m_all_layers;
   std::vector<unsigned int> m_layers;
   size_t m_lindex;
   db::ShapeIterator m_shape;
   db::Shape m_s;
   std::set<db::Shape> m_ignored;
+  bool m_has_layer_sel;
+  tl::Expression m_layer_expression;
+  bool m_has_region_sel;
+  bool m_region_overlapping;
+  tl::Expression m_region_expression;
+  bool m_has_region;
+  db::Box m_region;
+  bool m_has_prop_sel;
+  bool m_prop_sel_valid;
+  tl::Variant m_prop_key;
+  tl::Eval m_prop_eval;
+  tl::Expression m_prop_check;
+  bool m_has_prop;
+  db::ShapeIterator::property_selector m_prop_sel;
+
+  db::ShapeIterator begin_shapes (unsigned int layer) const
+  {
+    const db::Shapes &shapes = mp_parent->shapes (layer);
+    const db::ShapeIterator::property_selector *ps = m_has_prop ? &m_prop_sel : 0;
+    if (! m_has_region) {
+      return shapes.begin (m_flags, ps);
+    } else if (m_region_overlapping) {
+      return shapes.begin_overlapping (m_region, m_flags, ps);
+    } else {
+      return shapes.begin_touching (m_region, m_flags, ps);
+    }
+  }
+
+  void update_layers ()
+  {
+    if (! m_has_layer_sel) {
+      return;
+    }
+
+    m_layers = m_all_layers;
+
+    tl::Variant l;
+    try {
+      l = m_layer_expression.execute ();
+    } catch (tl::Exception &) {
+      //  errors are reported when the condition is evaluated
+    }
+
+    if (l.can_convert_to_ulong ()) {
+      std::vector<unsigned int>::iterator lw = m_layers.begin ();
+      for (std::vector<unsigned int>::const_iterator lr = m_all_layers.begin (); lr != m_all_layers.end (); ++lr) {
+        if (*lr == l.to_ulong ()) {
+          *lw++ = *lr;
+        }
+      }
+      m_layers.erase (lw, m_layers.end ());
+    }
+  }
+
+  void update_region ()
+  {
+    if (! m_has_region_sel) {
+      return;
+    }
+
+    tl::Variant r;
+    try {
+      r = m_region_expression.execute ();
+    } catch (tl::Exception &) {
+      //  errors are reported when the condition is evaluated
+    }
+
+    m_has_region = r.is_user<db::Box> ();
+    if (m_has_region) {
+      m_region = r.to_user<db::Box> ();
+    }
+  }
+
+  void update_prop_sel ()
+  {
+    //  In reading mode, the property IDs cannot change, so the selector is computed once
+    if (! m_has_prop_sel || (m_reading && m_prop_sel_valid)) {
+      return;
+    }
+
+    m_prop_sel.clear ();
+    m_prop_sel_valid = true;
+
+    //  If shapes without this property qualify, we cannot use a property selector
+    m_prop_eval.set_var ("_pv", tl::Variant ());
+    m_has_prop = ! m_prop_check.execute ().to_bool ();
+    if (! m_has_prop) {
+      return;
+    }
+
+    const db::PropertiesRepository &rep = layout ()->properties_repository ();
+    std::pair<bool, db::property_names_id_type> nid = rep.get_id_of_name (m_prop_key);
+    if (! nid.first) {
+      return;
+    }
+
+    for (db::PropertiesRepository::iterator p = rep.begin (); p != rep.end (); ++p) {
+      db::PropertiesRepository::properties_set::const_iterator v = p->second.find (nid.second);
+      m_prop_eval.set_var ("_pv", v != p->second.end () ? v->second : tl::Variant ());
+      if (m_prop_check.execute ().to_bool ()) {
+        m_prop_sel.insert (p->first);
+      }
+    }
+  }
 };
 
 class DB_PUBLIC ShapeFilter
   : public FilterBracket
 {
 public:
-  ShapeFilter (LayoutQuery *q, const db::LayerMap &layers, db::ShapeIterator::flags_type flags, bool reading)
+  ShapeFilter (LayoutQuery *q, const db::LayerMap &layers, db::ShapeIterator::flags_type flags, const ShapeFilterConstraints &constraints, bool reading)
     : FilterBracket (q), 
       m_pids (q),
       m_layers (layers),
       m_flags (flags), 
+      m_constraints (constraints),
       m_reading (reading)
   {
     // .. nothing yet ..
@@ -347,12 +778,12 @@ public:
 
   FilterStateBase *do_create_state (db::Layout *layout, tl::Eval &eval) const
   {
-    return new ShapeFilterState (this, m_layers, m_flags, eval, layout, m_reading, m_pids);
+    return new ShapeFilterState (this, m_layers, m_flags, m_constraints, eval, layout, m_reading, m_pids);
   }
 
   FilterBase *clone (LayoutQuery *q) const
   {
-    return new ShapeFilter (q, m_layers, m_flags, m_reading);
+    return new ShapeFilter (q, m_layers, m_flags, m_constraints, m_reading);
   }
 
   virtual void dump (unsigned int l) const
@@ -368,6 +799,7 @@ private:
   ShapeFilterPropertyIDs m_pids;
   db::LayerMap m_layers;
   db::ShapeIterator::flags_type m_flags;
+  ShapeFilterConstraints m_constraints;
   bool m_reading;
 };
 
@@ -483,7 +915,7 @@ class DB_PUBLIC ChildCellFilterState
 public:
   ChildCellFilterState (const FilterBase *filter, const NameFilterArgument &pattern, ChildCellFilterInstanceMode instance_mode, tl::Eval &eval, db::Layout *layout, bool reading, const ChildCellFilterPropertyIDs &pids)
     : FilterStateBase (filter, layout, eval),
-      m_pattern (pattern, eval), m_instance_mode (instance_mode), mp_parent (0), m_pids (pids),
+      m_pattern (pattern, eval, reading), m_instance_mode (instance_mode), mp_parent (0), m_pids (pids),
       m_weight (0), m_references (0), m_weight_set (false), m_references_set (false), m_reading (reading)
   {
     //  .. nothing yet ..
@@ -511,7 +943,7 @@ public:
 
       m_top_cell = layout ()->begin_top_down ();
       m_top_cell_end = layout ()->end_top_cells ();
-      while (m_top_cell != m_top_cell_end && (!layout ()->is_valid_cell_index (*m_top_cell) || !m_pattern.match (layout ()->cell (*m_top_cell).get_qualified_name ()))) {
+      while (m_top_cell != m_top_cell_end && (!layout ()->is_valid_cell_index (*m_top_cell) || !m_pattern.match_cell (*layout (), *m_top_cell))) {
         ++m_top_cell;
       }
 
@@ -524,7 +956,7 @@ public:
       if (m_instance_mode == NoInstances) {
 
         m_child_cell = mp_parent->begin_child_cells ();
-        while (! m_child_cell.at_end () && (!layout ()->is_valid_cell_index (*m_child_cell) || !m_pattern.match (layout ()->cell (*m_child_cell).get_qualified_name ()))) {
+        while (! m_child_cell.at_end () && (!layout ()->is_valid_cell_index (*m_child_cell) || !m_pattern.match_cell (*layout (), *m_child_cell))) {
           ++m_child_cell;
         } 
 
@@ -536,7 +968,7 @@ public:
         while (m_inst != m_inst_end) {
 
           db::cell_index_type cid = (*m_inst)->object ().cell_index ();
-          if (layout ()->is_valid_cell_index (cid) && m_pattern.match (layout ()->cell (cid).get_qualified_name ())) {
+          if (layout ()->is_valid_cell_index (cid) && m_pattern.match_cell (*layout (), cid)) {
             break;
           }
 
@@ -576,7 +1008,7 @@ public:
 
         do {
           ++m_child_cell;
-        } while (! m_child_cell.at_end () && (!layout ()->is_valid_cell_index (*m_child_cell) || !m_pattern.match (layout ()->cell (*m_child_cell).get_qualified_name ())));
+        } while (! m_child_cell.at_end () && (!layout ()->is_valid_cell_index (*m_child_cell) || !m_pattern.match_cell (*layout (), *m_child_cell)));
 
       } else {
 
@@ -600,7 +1032,7 @@ public:
               while (m_inst != m_inst_end) {
 
                 cid = (*m_inst)->object ().cell_index ();
-                if (layout ()->is_valid_cell_index (cid) && m_pattern.match (layout ()->cell (cid).get_qualified_name ())) {
+                if (layout ()->is_valid_cell_index (cid) && m_pattern.match_cell (*layout (), cid)) {
                   break;
                 }
 
@@ -636,7 +1068,7 @@ public:
 
       do {
         ++m_top_cell;
-      } while (m_top_cell != m_top_cell_end && (!layout ()->is_valid_cell_index (*m_top_cell) || !m_pattern.match (layout ()->cell (*m_top_cell).get_qualified_name ())));
+      } while (m_top_cell != m_top_cell_end && (!layout ()->is_valid_cell_index (*m_top_cell) || !m_pattern.match_cell (*layout (), *m_top_cell)));
 
     }
   }
@@ -1124,7 +1556,7 @@ public:
   CellFilterState (const FilterBase *filter, const NameFilterArgument &pattern, tl::Eval &eval, db::Layout *layout, bool reading, const CellFilterPropertyIDs &pids)
     : FilterStateBase (filter, layout, eval),
       m_pids (pids),
-      m_pattern (pattern, eval),
+      m_pattern (pattern, eval, reading),
       mp_parent (0),
       m_reading (reading)
   {
@@ -1140,7 +1572,7 @@ public:
     m_cell = layout ()->begin_top_down ();
     m_cell_end = layout ()->end_top_down ();
 
-    while (m_cell != m_cell_end && !m_pattern.match (layout ()->cell (*m_cell).get_qualified_name ())) {
+    while (m_cell != m_cell_end && !m_pattern.match_cell (*layout (), *m_cell)) {
       ++m_cell;
     }
 
@@ -1158,7 +1590,7 @@ public:
   {
     do {
       ++m_cell;
-    } while (m_cell != m_cell_end && !m_pattern.match (layout ()->cell (*m_cell).get_qualified_name ()));
+    } while (m_cell != m_cell_end && !m_pattern.match_cell (*layout (), *m_cell));
   }
 
   virtual bool at_end () 
@@ -2298,14 +2730,21 @@ parse_filter (tl::Extractor &ex, LayoutQuery *q, FilterBracket *bracket, bool re
     bracket->add_child (f);
     bracket->connect_entry (f);
 
+    std::string expr;
+    ShapeFilterConstraints constraints;
+
+    bool with_condition = ex.test ("where");
+    if (with_condition) {
+      expr = tl::Eval::parse_expr (ex, true);
+      constraints.analyze (expr);
+    }
+
     fl = f;
-    f = new ShapeFilter (q, lm, shapes, reading);
+    f = new ShapeFilter (q, lm, shapes, constraints, reading);
     bracket->add_child (f);
     fl->connect (f);
 
-    if (ex.test ("where")) {
-
-      std::string expr = tl::Eval::parse_expr (ex, true);
+    if (with_condition) {
 
       fl = f;
       f = new ConditionalFilter (q, expr);
@@ -395,6 +395,18 @@ private:
 
 /**
  *  @brief the layout query
+ *
+ *  A query is executed by the LayoutQueryIterator on the calling thread. The
+ *  expressions are compiled once per iterator and layer selections are resolved
+ *  when the shape filter state is created. For read-only queries, cell name
+ *  matches are remembered per cell. Conditions ("where" clauses) are evaluated
+ *  per object. For shape queries, some terms of a top-level "&&" chain in the
+ *  condition are translated into restrictions of the per-cell shape iteration:
+ *  "layer_index == ..." selects the layers, "bbox.touches(...)" (also "overlaps"
+ *  and "inside") selects a region in read-only queries and
+ *  "shape.property(key) == value" with constant key and value selects the
+ *  matching property IDs. Side effects of the condition are therefore only 
+ *  produced for shapes passing these restrictions.
  */
 class DB_PUBLIC LayoutQuery
   : public tl::Object
@@ -160,6 +160,14 @@ protected:
    */
   virtual void do_update () { }
 
+  /**
+   *  @brief This method is called when the hierarchy gets invalidated
+   *
+   *  The base implementation issues the "hier_changed" event. Reimplementations
+   *  need to call the base implementation.
+   */
+  virtual void do_invalidate_hier ();
+
   /**
    *  @brief Issue a "prop id's changed event"
    */
@@ -199,7 +207,6 @@ private:
   bool m_all_bboxes_dirty;
   bool m_busy;
 
-  void do_invalidate_hier ();
   void do_invalidate_bboxes (unsigned int index);
 };
 
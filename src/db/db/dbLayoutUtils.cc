@@ -24,6 +24,8 @@
 #include "dbLayoutUtils.h"
 #include "tlProgress.h"
 
+#include <algorithm>
+
 namespace db
 {
 
@@ -381,6 +383,202 @@ find_layout_context (const db::Layout &layout, db::cell_index_type from, db::cel
   }
 }
 
+// ------------------------------------------------------------
+//  Implementation of "deduplicate_cells"
+
+static void get_shape (const db::Shape &s, db::Polygon &p) { s.polygon (p); }
+static void get_shape (const db::Shape &s, db::Path &p) { s.path (p); }
+static void get_shape (const db::Shape &s, db::Text &t) { s.text (t); }
+static void get_shape (const db::Shape &s, db::Box &b) { s.box (b); }
+static void get_shape (const db::Shape &s, db::Edge &e) { s.edge (e); }
+
+template <class Sh>
+static void
+collect_shapes (const db::Shapes &shapes, unsigned int flags, std::vector<std::pair<Sh, db::properties_id_type> > &v)
+{
+  v.clear ();
+  for (db::ShapeIterator s = shapes.begin (flags); ! s.at_end (); ++s) {
+    v.push_back (std::make_pair (Sh (), s->prop_id ()));
+    get_shape (*s, v.back ().first);
+  }
+  std::sort (v.begin (), v.end ());
+}
+
+template <class Sh>
+static bool
+same_shapes (const db::Shapes &a, const db::Shapes &b, unsigned int flags)
+{
+  std::vector<std::pair<Sh, db::properties_id_type> > va, vb;
+  collect_shapes (a, flags, va);
+  collect_shapes (b, flags, vb);
+  return va == vb;
+}
+
+static void
+collect_instances (const db::Cell &cell, const std::map<db::cell_index_type, db::cell_index_type> &replaced, std::vector<db::CellInstArrayWithProperties> &v)
+{
+  v.clear ();
+  for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+    v.push_back (db::CellInstArrayWithProperties (i->cell_inst (), i->prop_id ()));
+    std::map<db::cell_index_type, db::cell_index_type>::const_iterator r = replaced.find (i->cell_index ());
+    if (r != replaced.end ()) {
+      v.back ().object () = db::CellInst (r->second);
+    }
+  }
+  std::sort (v.begin (), v.end ());
+}
+
+static bool
+same_cells (const db::Layout &layout, const db::Cell &a, const db::Cell &b, const std::map<db::cell_index_type, db::cell_index_type> &replaced)
+{
+  //  the cell properties do not contribute to the content hash
+  if (a.prop_id () != b.prop_id ()) {
+    return false;
+  }
+
+  if (a.cell_instances () != b.cell_instances ()) {
+    return false;
+  }
+
+  for (unsigned int l = 0; l < layout.layers (); ++l) {
+
+    const db::Shapes &sa = a.shapes (l);
+    const db::Shapes &sb = b.shapes (l);
+
+    if (sa.size () != sb.size ()) {
+      return false;
+    }
+    if (sa.empty ()) {
+      continue;
+    }
+
+    //  user objects are not compared - we consider the cells different in that case
+    if (! sa.begin (db::ShapeIterator::UserObjects).at_end () || ! sb.begin (db::ShapeIterator::UserObjects).at_end ()) {
+      return false;
+    }
+
+    if (! same_shapes<db::Polygon> (sa, sb, db::ShapeIterator::Polygons) ||
+        ! same_shapes<db::Path> (sa, sb, db::ShapeIterator::Paths) ||
+        ! same_shapes<db::Text> (sa, sb, db::ShapeIterator::Texts) ||
+        ! same_shapes<db::Box> (sa, sb, db::ShapeIterator::Boxes) ||
+        ! same_shapes<db::Edge> (sa, sb, db::ShapeIterator::Edges)) {
+      return false;
+    }
+
+  }
+
+  std::vector<db::CellInstArrayWithProperties> ia, ib;
+  collect_instances (a, replaced, ia);
+  collect_instances (b, replaced, ib);
+  return ia == ib;
+}
+
+size_t
+deduplicate_cells (db::Layout &layout)
+{
+  layout.update ();
+
+  //  Collect the candidates. Identical cells have the same number of hierarchy levels below them,
+  //  so processing the cells by levels makes sure the child cells are processed before.
+  std::vector<std::pair<unsigned int, db::cell_index_type> > candidates;
+  for (db::Layout::const_iterator c = layout.begin (); c != layout.end (); ++c) {
+    if (! c->is_top () && ! c->is_proxy () && ! c->is_ghost_cell ()) {
+      candidates.push_back (std::make_pair (c->hierarchy_levels (), c->cell_index ()));
+    }
+  }
+
+  std::sort (candidates.begin (), candidates.end ());
+
+  //  identify the duplicates
+  std::map<size_t, std::vector<db::cell_index_type> > representatives_by_hash;
+  std::map<db::cell_index_type, db::cell_index_type> replaced;
+
+  {
+    tl::RelativeProgress progress (tl::to_string (tr ("Identifying identical cells")), candidates.size (), 1);
+
+    for (std::vector<std::pair<unsigned int, db::cell_index_type> >::const_iterator c = candidates.begin (); c != candidates.end (); ++c) {
+
+      ++progress;
+
+      const db::Cell &cell = layout.cell (c->second);
+      size_t h = cell.content_hash ();
+      if (h == 0) {
+        continue;
+      }
+
+      std::vector<db::cell_index_type> &representatives = representatives_by_hash [h];
+
+      bool found = false;
+      for (std::vector<db::cell_index_type>::const_iterator r = representatives.begin (); r != representatives.end () && ! found; ++r) {
+        if (same_cells (layout, layout.cell (*r), cell, replaced)) {
+          replaced.insert (std::make_pair (c->second, *r));
+          found = true;
+        }
+      }
+
+      if (! found) {
+        representatives.push_back (c->second);
+      }
+
+    }
+  }
+
+  if (replaced.empty ()) {
+    return 0;
+  }
+
+  //  redirect the instances of the duplicates to the representatives
+  std::set<db::cell_index_type> parents;
+  for (std::map<db::cell_index_type, db::cell_index_type>::const_iterator r = replaced.begin (); r != replaced.end (); ++r) {
+    const db::Cell &cell = layout.cell (r->first);
+    for (db::Cell::parent_cell_iterator p = cell.begin_parent_cells (); p != cell.end_parent_cells (); ++p) {
+      parents.insert (*p);
+    }
+  }
+
+  for (std::set<db::cell_index_type>::const_iterator p = parents.begin (); p != parents.end (); ++p) {
+
+    if (replaced.find (*p) != replaced.end ()) {
+      //  no need to touch cells which are deleted anyway
+      continue;
+    }
+
+    db::Cell &parent = layout.cell (*p);
+
+    std::vector<db::Instance> to_erase;
+    std::vector<db::CellInstArrayWithProperties> to_insert;
+
+    for (db::Cell::const_iterator i = parent.begin (); ! i.at_end (); ++i) {
+      std::map<db::cell_index_type, db::cell_index_type>::const_iterator r = replaced.find (i->cell_index ());
+      if (r != replaced.end ()) {
+        to_erase.push_back (*i);
+        to_insert.push_back (db::CellInstArrayWithProperties (i->cell_inst (), i->prop_id ()));
+        to_insert.back ().object () = db::CellInst (r->second);
+      }
+    }
+
+    std::sort (to_erase.begin (), to_erase.end ());
+    parent.erase_insts (to_erase);
+
+    for (std::vector<db::CellInstArrayWithProperties>::const_iterator i = to_insert.begin (); i != to_insert.end (); ++i) {
+      if (i->properties_id () != 0) {
+        parent.insert (*i);
+      } else {
+        parent.insert (db::CellInstArray (*i));
+      }
+    }
+
+  }
+
+  std::set<db::cell_index_type> to_delete;
+  for (std::map<db::cell_index_type, db::cell_index_type>::const_iterator r = replaced.begin (); r != replaced.end (); ++r) {
+    to_delete.insert (r->first);
+  }
+  layout.delete_cells (to_delete);
+
+  return to_delete.size ();
+}
+
 // ------------------------------------------------------------
 //  Implementation of ContextCache
 
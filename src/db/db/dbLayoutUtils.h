@@ -174,6 +174,23 @@ move_shapes (db::Layout &target,
              const std::map<db::cell_index_type, db::cell_index_type> &cell_mapping,
              const std::map<unsigned int, unsigned int> &layer_mapping);
 
+/**
+ *  @brief Replaces identical cells by a single copy
+ *
+ *  This function looks for cells with identical content (shapes and child instances)
+ *  and replaces the instances of the duplicates by instances of a single representative.
+ *  The duplicates are deleted. Candidates are found by their content hash and are verified
+ *  by a full compare. Names do not matter, so identical cells under different names are
+ *  merged as well. The cell with the lowest index survives.
+ *
+ *  Top cells, empty cells, ghost cells and proxy cells (library and PCell variants) are
+ *  not considered.
+ *
+ *  @return The number of cells removed
+ */
+size_t DB_PUBLIC
+deduplicate_cells (db::Layout &layout);
+
 /**
  *  @brief Find an example cell instance from a child to a top cell
  *
@@ -36,7 +36,8 @@ namespace db
 Manager::Manager ()
   : m_transactions (),
     m_current (m_transactions.begin ()), 
-    m_opened (false), m_replay (false)
+    m_opened (false), m_replay (false), m_suspended (false),
+    m_max_memory (0), m_memory (0), m_last_op_size (0)
 {
   //  .. nothing yet ..
 }
@@ -100,13 +101,93 @@ void
 Manager::erase_transactions (transactions_t::iterator from, transactions_t::iterator to)
 {
   for (transactions_t::iterator i = from; i != to; ++i) {
-    for (operations_t::iterator o = i->first.begin (); o != i->first.end (); ++o) {
+    for (operations_t::iterator o = i->operations.begin (); o != i->operations.end (); ++o) {
       delete o->second;
     }
+    m_memory -= i->mem_size;
   }
   m_transactions.erase (from, to);
 }
 
+void
+Manager::set_max_memory (size_t max_memory)
+{
+  m_max_memory = max_memory;
+  if (! m_replay) {
+    update_last_op_size ();
+    enforce_max_memory ();
+  }
+}
+
+size_t
+Manager::memory () const
+{
+  if (m_opened && ! m_suspended && ! m_current->operations.empty ()) {
+    return m_memory + m_current->operations.back ().second->mem_size () - m_last_op_size;
+  } else {
+    return m_memory;
+  }
+}
+
+void
+Manager::update_last_op_size ()
+{
+  //  operations may grow after they have been queued (see last_queued) - account for that
+  if (m_opened && ! m_suspended && ! m_current->operations.empty ()) {
+    size_t s = m_current->operations.back ().second->mem_size ();
+    m_current->mem_size += s - m_last_op_size;
+    m_memory += s - m_last_op_size;
+    m_last_op_size = s;
+  }
+}
+
+void
+Manager::enforce_max_memory ()
+{
+  if (m_max_memory == 0 || m_memory <= m_max_memory) {
+    return;
+  }
+
+  //  drop the oldest transactions first
+  while (m_memory > m_max_memory && m_transactions.begin () != m_current) {
+    erase_transactions (m_transactions.begin (), ++m_transactions.begin ());
+  }
+
+  if (m_memory <= m_max_memory) {
+    return;
+  }
+
+  if (m_opened) {
+
+    //  the current transaction alone exceeds the budget: stop recording - the operations
+    //  are still performed, but the transaction cannot be undone
+    tl::warn << tl::to_string (tr ("Undo memory limit exceeded - transaction cannot be undone: ")) << m_current->description;
+
+    for (operations_t::iterator o = m_current->operations.begin (); o != m_current->operations.end (); ++o) {
+      delete o->second;
+    }
+    m_current->operations.clear ();
+    m_memory -= m_current->mem_size;
+    m_current->mem_size = 0;
+    m_last_op_size = 0;
+    m_suspended = true;
+
+  } else {
+
+    //  drop redo transactions starting with the latest one
+    while (m_memory > m_max_memory && m_current != m_transactions.end ()) {
+      transactions_t::iterator t = m_transactions.end ();
+      --t;
+      bool is_current = (t == m_current);
+      erase_transactions (t, m_transactions.end ());
+      if (is_current) {
+        m_current = m_transactions.end ();
+      }
+    }
+
+  }
+}
+
 Manager::transaction_id_t 
 Manager::transaction (const std::string &description, transaction_id_t join_with)
 {
@@ -114,22 +195,23 @@ Manager::transaction (const std::string &description, transaction_id_t join_with
 
     //  close transactions that are still open (was an assertion before)
     if (m_opened) {
-      tl::warn << tl::to_string (tr ("Transaction still opened: ")) << m_current->second;
+      tl::warn << tl::to_string (tr ("Transaction still opened: ")) << m_current->description;
       commit ();
     }
 
     tl_assert (! m_replay);
 
     if (! m_transactions.empty () && reinterpret_cast<transaction_id_t> (& m_transactions.back ()) == join_with) {
-      m_transactions.back ().second = description;
+      m_transactions.back ().description = description;
     } else {
       //  delete all following transactions and add a new one
       erase_transactions (m_current, m_transactions.end ());
-      m_transactions.push_back (transaction_t (operations_t (), description));
+      m_transactions.push_back (transaction_t (description));
     }
     m_current = m_transactions.end ();
     --m_current;
     m_opened = true;
+    m_last_op_size = m_current->operations.empty () ? 0 : m_current->operations.back ().second->mem_size ();
   
   }
 
@@ -150,10 +232,18 @@ Manager::commit ()
 
     tl_assert (m_opened);
     tl_assert (! m_replay);
+
+    update_last_op_size ();
+    enforce_max_memory ();
+
     m_opened = false;
 
-    //  delete transactions that are empty
-    if (m_current->first.begin () != m_current->first.end ()) {
+    //  delete transactions that are empty or have not been recorded
+    if (m_suspended) {
+      m_suspended = false;
+      erase_transactions (m_current, m_transactions.end ());
+      m_current = m_transactions.end ();
+    } else if (m_current->operations.begin () != m_current->operations.end ()) {
       ++m_current;
     } else {
       erase_transactions (m_current, m_transactions.end ());
@@ -177,11 +267,11 @@ Manager::undo ()
   m_replay = true;
   --m_current;
 
-  tl::RelativeProgress progress (tl::to_string (tr ("Undoing")), m_current->first.size (), 10);
+  tl::RelativeProgress progress (tl::to_string (tr ("Undoing")), m_current->operations.size (), 10);
 
   try {
 
-    for (operations_t::reverse_iterator o = m_current->first.rbegin (); o != m_current->first.rend (); ++o) {
+    for (operations_t::reverse_iterator o = m_current->operations.rbegin (); o != m_current->operations.rend (); ++o) {
 
       tl_assert (o->second->is_done ());
       db::Object *obj = object_by_id (o->first);
@@ -212,12 +302,12 @@ Manager::redo ()
   tl_assert (! m_opened);
   tl_assert (! m_replay);
 
-  tl::RelativeProgress progress (tl::to_string (tr ("Redoing")), m_current->first.size (), 10);
+  tl::RelativeProgress progress (tl::to_string (tr ("Redoing")), m_current->operations.size (), 10);
 
   try {
 
     m_replay = true;
-    for (operations_t::iterator o = m_current->first.begin (); o != m_current->first.end (); ++o) {
+    for (operations_t::iterator o = m_current->operations.begin (); o != m_current->operations.end (); ++o) {
 
       tl_assert (! o->second->is_done ());
       db::Object *obj = object_by_id (o->first);
@@ -245,7 +335,7 @@ Manager::available_undo () const
   } else {
     transactions_t::const_iterator t = m_current;
     --t;
-    return std::make_pair (true, t->second);
+    return std::make_pair (true, t->description);
   }
 }
 
@@ -255,7 +345,7 @@ Manager::available_redo () const
   if (m_opened || m_current == m_transactions.end ()) {
     return std::make_pair (false, std::string (""));
   } else {
-    return std::make_pair (true, m_current->second);
+    return std::make_pair (true, m_current->description);
   }
 }
 
@@ -265,10 +355,13 @@ Manager::last_queued (db::Object *object)
   tl_assert (m_opened);
   tl_assert (! m_replay);
 
-  if (m_current->first.empty () || m_current->first.back ().first != object->id ()) {
+  update_last_op_size ();
+  enforce_max_memory ();
+
+  if (m_suspended || m_current->operations.empty () || m_current->operations.back ().first != object->id ()) {
     return 0;
   } else {
-    return m_current->first.back ().second;
+    return m_current->operations.back ().second;
   }
 }
 
@@ -288,7 +381,21 @@ Manager::queue (db::Object *object, db::Op *op)
       op->set_done (true);
     }
 
-    m_current->first.push_back (std::make_pair (object->id (), op));
+    if (m_suspended) {
+      //  not recording (memory limit exceeded)
+      delete op;
+      return;
+    }
+
+    update_last_op_size ();
+
+    m_current->operations.push_back (std::make_pair (object->id (), op));
+
+    m_last_op_size = op->mem_size ();
+    m_current->mem_size += m_last_op_size;
+    m_memory += m_last_op_size;
+
+    enforce_max_memory ();
 
   }
 }
@@ -66,6 +66,18 @@ public:
   {
     return m_done;
   }
+
+  /**
+   *  @brief Gets the estimated memory footprint of the operation in bytes
+   *
+   *  This value is used by the manager to enforce the memory budget of the undo
+   *  history (see Manager::set_max_memory). Operations holding bulk data should
+   *  reimplement this method.
+   */
+  virtual size_t mem_size () const
+  {
+    return sizeof (Op);
+  }
 };
 
 /**
@@ -218,6 +230,31 @@ public:
    */
   void clear ();
 
+  /**
+   *  @brief Sets the memory budget for the undo/redo history
+   *
+   *  The budget is given in bytes and applies to the estimated memory footprint of the 
+   *  operations kept (see Op::mem_size). A value of 0 means "no limit" (the default).
+   *  If the budget is exceeded, the oldest transactions are discarded. If a single
+   *  transaction exceeds the budget, recording is stopped for this transaction and
+   *  the undo history is cleared: the operations are still performed, but the 
+   *  transaction cannot be undone.
+   */
+  void set_max_memory (size_t max_memory);
+
+  /**
+   *  @brief Gets the memory budget for the undo/redo history
+   */
+  size_t max_memory () const
+  {
+    return m_max_memory;
+  }
+
+  /**
+   *  @brief Gets the estimated memory footprint of the undo/redo history in bytes
+   */
+  size_t memory () const;
+
   /**
    *  @brief Query if we are within a transaction
    */
@@ -240,15 +277,32 @@ private:
 
   typedef std::pair<db::Manager::ident_t, db::Op *> operation_t;
   typedef std::list<operation_t> operations_t;
-  typedef std::pair<operations_t, std::string> transaction_t;
+
+  struct transaction_t
+  {
+    transaction_t (const std::string &d)
+      : description (d), mem_size (0)
+    { }
+
+    operations_t operations;
+    std::string description;
+    size_t mem_size;
+  };
+
   typedef std::list<transaction_t> transactions_t;
 
   transactions_t m_transactions;
   transactions_t::iterator m_current;
   bool m_opened;
   bool m_replay;
+  bool m_suspended;
+  size_t m_max_memory;
+  size_t m_memory;
+  size_t m_last_op_size;
 
   void erase_transactions (transactions_t::iterator from, transactions_t::iterator to);
+  void update_last_op_size ();
+  void enforce_max_memory ();
 };
 
 /**
@@ -32,6 +32,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_set>
+#include <unordered_map>
 #include <list>
 #include <typeinfo>
 #include "tlReuseVector.h"
@@ -79,6 +81,38 @@ public:
   virtual void add (const std::type_info & /*ti*/, void * /*ptr*/, size_t /*size*/, size_t /*used*/, void * /*parent*/, purpose_t /*purpose*/ = None, int /*cat*/ = 0) { }
 };
 
+/**
+ *  @brief A memory statistics collector which only sums up the sizes
+ *
+ *  This collector is useful for estimating the memory footprint of single objects.
+ */
+class DB_PUBLIC MemStatisticsSum
+  : public MemStatistics
+{
+public:
+  MemStatisticsSum ()
+    : m_size (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void add (const std::type_info & /*ti*/, void * /*ptr*/, size_t size, size_t /*used*/, void * /*parent*/, purpose_t /*purpose*/, int /*cat*/)
+  {
+    m_size += size;
+  }
+
+  /**
+   *  @brief Gets the total size collected
+   */
+  size_t size () const
+  {
+    return m_size;
+  }
+
+private:
+  size_t m_size;
+};
+
 /**
  *  @brief A generic memory statistics collector
  *  This collector will collect the summary of memory usage only.
@@ -192,6 +226,41 @@ void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, c
   }
 }
 
+template <class X, class H>
+void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, const std::unordered_set<X, H> &v, bool no_self = false, void *parent = 0)
+{
+  if (! no_self) {
+    stat->add (typeid (std::unordered_set<X, H>), (void *) &v, sizeof (std::unordered_set<X, H>), sizeof (std::unordered_set<X, H>), parent, purpose, cat);
+  }
+  for (typename std::unordered_set<X, H>::const_iterator i = v.begin (); i != v.end (); ++i) {
+    mem_stat (stat, purpose, cat, *i, false, (void *) &v);
+  }
+}
+
+template <class X, class Y, class H>
+void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, const std::unordered_map<X, Y, H> &v, bool no_self = false, void *parent = 0)
+{
+  if (! no_self) {
+    stat->add (typeid (std::unordered_map<X, Y, H>), (void *) &v, sizeof (std::unordered_map<X, Y, H>), sizeof (std::unordered_map<X, Y, H>), parent, purpose, cat);
+  }
+  for (typename std::unordered_map<X, Y, H>::const_iterator i = v.begin (); i != v.end (); ++i) {
+    mem_stat (stat, purpose, cat, i->first, false, (void *) &v);
+    mem_stat (stat, purpose, cat, i->second, false, (void *) &v);
+  }
+}
+
+template <class X, class Y, class H>
+void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, const std::unordered_multimap<X, Y, H> &v, bool no_self = false, void *parent = 0)
+{
+  if (! no_self) {
+    stat->add (typeid (std::unordered_multimap<X, Y, H>), (void *) &v, sizeof (std::unordered_multimap<X, Y, H>), sizeof (std::unordered_multimap<X, Y, H>), parent, purpose, cat);
+  }
+  for (typename std::unordered_multimap<X, Y, H>::const_iterator i = v.begin (); i != v.end (); ++i) {
+    mem_stat (stat, purpose, cat, i->first, false, (void *) &v);
+    mem_stat (stat, purpose, cat, i->second, false, (void *) &v);
+  }
+}
+
 template <class X>
 void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, const std::list<X> &v, bool no_self = false, void *parent = 0)
 {
@@ -207,6 +207,19 @@ typedef object_with_properties<DBox> DBoxWithProperties;
 typedef object_with_properties<db::array<db::CellInst, db::Trans> > CellInstArrayWithProperties;
 typedef object_with_properties<db::array<db::CellInst, db::DTrans> > DCellInstArrayWithProperties;
 
+/**
+ *  @brief Collect memory statistics
+ */
+template <class Obj>
+inline void
+mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, const object_with_properties<Obj> &x, bool no_self = false, void *parent = 0)
+{
+  if (! no_self) {
+    stat->add (typeid (object_with_properties<Obj>), (void *) &x, sizeof (object_with_properties<Obj>), sizeof (object_with_properties<Obj>), parent, purpose, cat);
+  }
+  mem_stat (stat, purpose, cat, (const Obj &) x, true, parent);
+}
+
 } // namespace db
 
 #endif
@@ -384,6 +384,21 @@ public:
     // .. nothing yet ..
   }
 
+  /**
+   *  @brief Returns true, if variants of this PCell can be produced in parallel
+   *
+   *  If this method returns true, "produce" and "get_display_name" may be called from 
+   *  multiple threads at the same time. In that case, "produce" receives a private layout 
+   *  object and a private cell. The production code must only create shapes on the layers 
+   *  given by "layer_ids" and must not create instances. Variants which violate that 
+   *  rule are produced again in the conventional way.
+   *  PCells implemented in scripts must not return true here.
+   */
+  virtual bool can_produce_in_parallel () const
+  {
+    return false;
+  }
+
   /**
    *  @brief Get the display name for a PCell with the given parameters
    *
@@ -23,8 +23,13 @@
 
 #include "dbPCellVariant.h"
 #include "dbPCellHeader.h"
+#include "dbPCellVariantCache.h"
+#include "dbLayoutUtils.h"
 
 #include "tlLog.h"
+#include "tlThreadedWorkers.h"
+
+#include <set>
 
 namespace db
 {
@@ -150,14 +155,14 @@ PCellVariant::update (ImportLayerMapping *layer_mapping)
   PCellHeader *header = pcell_header ();
   if (header && header->declaration ()) {
 
-    db::property_names_id_type pn = layout ()->properties_repository ().prop_name_id (tl::Variant ("name"));
-    db::property_names_id_type dn = layout ()->properties_repository ().prop_name_id (tl::Variant ("description"));
-
     std::vector<unsigned int> layer_ids;
     try {
       layer_ids = header->get_layer_indices (*layout (), m_parameters, layer_mapping);
-      header->declaration ()->produce (*layout (), layer_ids, m_parameters, *this);
-      m_display_name = header->declaration ()->get_display_name (m_parameters);
+      if (! PCellVariantCache::fetch (*header, m_parameters, layer_ids, *this, m_display_name)) {
+        header->declaration ()->produce (*layout (), layer_ids, m_parameters, *this);
+        m_display_name = header->declaration ()->get_display_name (m_parameters);
+        PCellVariantCache::store (*header, m_parameters, layer_ids, *this, m_display_name);
+      }
     } catch (tl::Exception &ex) {
       if (layer_ids.empty ()) {
         tl::error << ex.msg ();
@@ -167,70 +172,84 @@ PCellVariant::update (ImportLayerMapping *layer_mapping)
       }
     }
 
-    //  produce the shape parameters on the guiding shape layer so they can be edited
-    size_t i = 0;
-    const std::vector<db::PCellParameterDeclaration> &pcp = header->declaration ()->parameter_declarations ();
-    for (std::vector<db::PCellParameterDeclaration>::const_iterator p = pcp.begin (); p != pcp.end (); ++p, ++i) {
+    produce_guiding_shapes ();
 
-      if (i < m_parameters.size () && p->get_type () == db::PCellParameterDeclaration::t_shape && ! p->is_hidden ()) {
+  }
+}
 
-        //  use property with name "name" to indicate the parameter name
-        db::PropertiesRepository::properties_set props;
-        props.insert (std::make_pair (pn, tl::Variant (p->get_name ())));
+void
+PCellVariant::produce_guiding_shapes ()
+{
+  PCellHeader *header = pcell_header ();
+  if (! header || ! header->declaration ()) {
+    return;
+  }
 
-        if (! p->get_description ().empty ()) {
-          props.insert (std::make_pair (dn, tl::Variant (p->get_description ())));
-        }
+  db::property_names_id_type pn = layout ()->properties_repository ().prop_name_id (tl::Variant ("name"));
+  db::property_names_id_type dn = layout ()->properties_repository ().prop_name_id (tl::Variant ("description"));
 
-        if (m_parameters[i].is_user<db::DBox> ()) {
+  //  produce the shape parameters on the guiding shape layer so they can be edited
+  size_t i = 0;
+  const std::vector<db::PCellParameterDeclaration> &pcp = header->declaration ()->parameter_declarations ();
+  for (std::vector<db::PCellParameterDeclaration>::const_iterator p = pcp.begin (); p != pcp.end (); ++p, ++i) {
 
-          shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (m_parameters[i].to_user<db::DBox> () * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
+    if (i < m_parameters.size () && p->get_type () == db::PCellParameterDeclaration::t_shape && ! p->is_hidden ()) {
 
-        } else if (m_parameters[i].is_user<db::Box> ()) {
+      //  use property with name "name" to indicate the parameter name
+      db::PropertiesRepository::properties_set props;
+      props.insert (std::make_pair (pn, tl::Variant (p->get_name ())));
 
-          shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(m_parameters[i].to_user<db::Box> (), layout ()->properties_repository ().properties_id (props)));
+      if (! p->get_description ().empty ()) {
+        props.insert (std::make_pair (dn, tl::Variant (p->get_description ())));
+      }
 
-        } else if (m_parameters[i].is_user<db::DEdge> ()) {
+      if (m_parameters[i].is_user<db::DBox> ()) {
 
-          shapes (layout ()->guiding_shape_layer ()).insert (db::EdgeWithProperties(db::Edge (m_parameters[i].to_user<db::DEdge> () * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
+        shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (m_parameters[i].to_user<db::DBox> () * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::Edge> ()) {
+      } else if (m_parameters[i].is_user<db::Box> ()) {
 
-          shapes (layout ()->guiding_shape_layer ()).insert (db::EdgeWithProperties(m_parameters[i].to_user<db::Edge> (), layout ()->properties_repository ().properties_id (props)));
+        shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(m_parameters[i].to_user<db::Box> (), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::DPoint> ()) {
+      } else if (m_parameters[i].is_user<db::DEdge> ()) {
 
-          db::DPoint p = m_parameters[i].to_user<db::DPoint> ();
-          shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (db::DBox (p, p) * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
+        shapes (layout ()->guiding_shape_layer ()).insert (db::EdgeWithProperties(db::Edge (m_parameters[i].to_user<db::DEdge> () * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::Point> ()) {
+      } else if (m_parameters[i].is_user<db::Edge> ()) {
 
-          db::Point p = m_parameters[i].to_user<db::Point> ();
-          shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (p, p), layout ()->properties_repository ().properties_id (props)));
+        shapes (layout ()->guiding_shape_layer ()).insert (db::EdgeWithProperties(m_parameters[i].to_user<db::Edge> (), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::DPolygon> ()) {
+      } else if (m_parameters[i].is_user<db::DPoint> ()) {
 
-          db::complex_trans<db::DCoord, db::Coord> dbu_trans (1.0 / layout ()->dbu ());
-          db::Polygon poly = m_parameters[i].to_user<db::DPolygon> ().transformed (dbu_trans, false);
-          //  Hint: we don't compress the polygon since we don't want to loose information
-          shapes (layout ()->guiding_shape_layer ()).insert (db::PolygonWithProperties(poly, layout ()->properties_repository ().properties_id (props)));
+        db::DPoint p = m_parameters[i].to_user<db::DPoint> ();
+        shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (db::DBox (p, p) * (1.0 / layout ()->dbu ())), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::Polygon> ()) {
+      } else if (m_parameters[i].is_user<db::Point> ()) {
 
-          db::Polygon poly = m_parameters[i].to_user<db::Polygon> ();
-          //  Hint: we don't compress the polygon since we don't want to loose information
-          shapes (layout ()->guiding_shape_layer ()).insert (db::PolygonWithProperties(poly, layout ()->properties_repository ().properties_id (props)));
+        db::Point p = m_parameters[i].to_user<db::Point> ();
+        shapes (layout ()->guiding_shape_layer ()).insert (db::BoxWithProperties(db::Box (p, p), layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::DPath> ()) {
+      } else if (m_parameters[i].is_user<db::DPolygon> ()) {
 
-          db::complex_trans<db::DCoord, db::Coord> dbu_trans (1.0 / layout ()->dbu ());
-          shapes (layout ()->guiding_shape_layer ()).insert (db::PathWithProperties(dbu_trans * m_parameters[i].to_user<db::DPath> (), layout ()->properties_repository ().properties_id (props)));
+        db::complex_trans<db::DCoord, db::Coord> dbu_trans (1.0 / layout ()->dbu ());
+        db::Polygon poly = m_parameters[i].to_user<db::DPolygon> ().transformed (dbu_trans, false);
+        //  Hint: we don't compress the polygon since we don't want to loose information
+        shapes (layout ()->guiding_shape_layer ()).insert (db::PolygonWithProperties(poly, layout ()->properties_repository ().properties_id (props)));
 
-        } else if (m_parameters[i].is_user<db::Path> ()) {
+      } else if (m_parameters[i].is_user<db::Polygon> ()) {
 
-          shapes (layout ()->guiding_shape_layer ()).insert (db::PathWithProperties(m_parameters[i].to_user<db::Path> (), layout ()->properties_repository ().properties_id (props)));
+        db::Polygon poly = m_parameters[i].to_user<db::Polygon> ();
+        //  Hint: we don't compress the polygon since we don't want to loose information
+        shapes (layout ()->guiding_shape_layer ()).insert (db::PolygonWithProperties(poly, layout ()->properties_repository ().properties_id (props)));
 
-        }
+      } else if (m_parameters[i].is_user<db::DPath> ()) {
+
+        db::complex_trans<db::DCoord, db::Coord> dbu_trans (1.0 / layout ()->dbu ());
+        shapes (layout ()->guiding_shape_layer ()).insert (db::PathWithProperties(dbu_trans * m_parameters[i].to_user<db::DPath> (), layout ()->properties_repository ().properties_id (props)));
+
+      } else if (m_parameters[i].is_user<db::Path> ()) {
+
+        shapes (layout ()->guiding_shape_layer ()).insert (db::PathWithProperties(m_parameters[i].to_user<db::Path> (), layout ()->properties_repository ().properties_id (props)));
 
       }
 
@@ -239,5 +258,270 @@ PCellVariant::update (ImportLayerMapping *layer_mapping)
   }
 }
 
+// ----------------------------------------------------------------------------------------
+//  Parallel production of PCell variants
+
+/**
+ *  @brief The result of producing one variant in a private layout
+ */
+struct PCellVariantProductionResult
+{
+  PCellVariantProductionResult (const PCellVariant *v, const std::vector<unsigned int> &l)
+    : variant (v), layer_ids (l), cell_index (0), has_error (false)
+  {
+    layout.dbu (v->layout ()->dbu ());
+
+    unsigned int nlayers = 0;
+    for (std::vector<unsigned int>::const_iterator i = layer_ids.begin (); i != layer_ids.end (); ++i) {
+      nlayers = std::max (nlayers, *i + 1);
+    }
+    for (unsigned int i = 0; i < nlayers; ++i) {
+      layout.insert_layer ();
+    }
+
+    cell_index = layout.add_cell ("PCELL");
+  }
+
+  const PCellVariant *variant;
+  std::vector<unsigned int> layer_ids;
+  db::Layout layout;
+  db::cell_index_type cell_index;
+  std::string display_name;
+  std::string error;
+  bool has_error;
+};
+
+class PCellVariantProductionTask
+  : public tl::Task
+{
+public:
+  PCellVariantProductionTask (size_t index)
+    : m_index (index)
+  { }
+
+  size_t index () const
+  {
+    return m_index;
+  }
+
+private:
+  size_t m_index;
+};
+
+class PCellVariantProductionJob
+  : public tl::JobBase
+{
+public:
+  PCellVariantProductionJob (int nworkers, const PCellDeclaration *declaration)
+    : tl::JobBase (nworkers), mp_declaration (declaration)
+  { }
+
+  ~PCellVariantProductionJob ()
+  {
+    for (std::vector<PCellVariantProductionResult *>::const_iterator r = m_results.begin (); r != m_results.end (); ++r) {
+      delete *r;
+    }
+    m_results.clear ();
+  }
+
+  void add (const PCellVariant *variant, const std::vector<unsigned int> &layer_ids)
+  {
+    m_results.push_back (new PCellVariantProductionResult (variant, layer_ids));
+    schedule (new PCellVariantProductionTask (m_results.size () - 1));
+  }
+
+  size_t size () const
+  {
+    return m_results.size ();
+  }
+
+  PCellVariantProductionResult &result (size_t index)
+  {
+    return *m_results [index];
+  }
+
+  const PCellDeclaration *declaration () const
+  {
+    return mp_declaration;
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  const PCellDeclaration *mp_declaration;
+  std::vector<PCellVariantProductionResult *> m_results;
+};
+
+class PCellVariantProductionWorker
+  : public tl::Worker
+{
+public:
+  PCellVariantProductionWorker (PCellVariantProductionJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    PCellVariantProductionTask *production_task = dynamic_cast <PCellVariantProductionTask *> (task);
+    if (production_task) {
+
+      //  the production happens in a private layout, so the workers don't interfere
+      PCellVariantProductionResult &r = mp_job->result (production_task->index ());
+      try {
+        mp_job->declaration ()->produce (r.layout, r.layer_ids, r.variant->parameters (), r.layout.cell (r.cell_index));
+        r.display_name = mp_job->declaration ()->get_display_name (r.variant->parameters ());
+      } catch (tl::Exception &ex) {
+        r.error = ex.msg ();
+        r.has_error = true;
+      }
+
+    }
+  }
+
+private:
+  PCellVariantProductionJob *mp_job;
+};
+
+tl::Worker *
+PCellVariantProductionJob::create_worker ()
+{
+  return new PCellVariantProductionWorker (this);
+}
+
+/**
+ *  @brief Returns true, if the produced cell obeys the rules for parallel production
+ */
+static bool
+is_valid_parallel_production (const PCellVariantProductionResult &r)
+{
+  const db::Cell &cell = r.layout.cell (r.cell_index);
+  if (cell.cell_instances () > 0) {
+    return false;
+  }
+
+  std::set<unsigned int> declared_layers (r.layer_ids.begin (), r.layer_ids.end ());
+  for (db::Layout::layer_iterator l = r.layout.begin_layers (); l != r.layout.end_layers (); ++l) {
+    if (declared_layers.find ((*l).first) == declared_layers.end () && ! cell.shapes ((*l).first).empty ()) {
+      return false;
+    }
+  }
+
+  return r.layout.cells () == 1;
+}
+
+void
+PCellVariant::update_variants (const std::vector<PCellVariant *> &variants, unsigned int threads)
+{
+  //  one job per declaration, since the declaration decides whether parallel production is possible
+  std::map<const PCellDeclaration *, PCellVariantProductionJob *> jobs;
+
+  try {
+
+    for (std::vector<PCellVariant *>::const_iterator v = variants.begin (); v != variants.end (); ++v) {
+
+      PCellVariant *variant = *v;
+      tl_assert (variant->layout () != 0);
+
+      PCellHeader *header = variant->pcell_header ();
+      if (threads == 0 || ! header || ! header->declaration () || ! header->declaration ()->can_produce_in_parallel ()) {
+        variant->update ();
+        continue;
+      }
+
+      variant->clear_shapes ();
+      variant->clear_insts ();
+
+      std::vector<unsigned int> layer_ids;
+      try {
+        layer_ids = header->get_layer_indices (*variant->layout (), variant->m_parameters);
+      } catch (tl::Exception &ex) {
+        tl::error << ex.msg ();
+        variant->produce_guiding_shapes ();
+        continue;
+      }
+
+      if (PCellVariantCache::fetch (*header, variant->m_parameters, layer_ids, *variant, variant->m_display_name)) {
+        variant->produce_guiding_shapes ();
+        continue;
+      }
+
+      PCellVariantProductionJob *&job = jobs [header->declaration ()];
+      if (! job) {
+        job = new PCellVariantProductionJob (threads, header->declaration ());
+      }
+      job->add (variant, layer_ids);
+
+    }
+
+    for (std::map<const PCellDeclaration *, PCellVariantProductionJob *>::const_iterator j = jobs.begin (); j != jobs.end (); ++j) {
+
+      PCellVariantProductionJob &job = *j->second;
+
+      job.start ();
+      job.wait ();
+
+      if (job.has_error ()) {
+        throw tl::Exception (tl::to_string (tr ("Errors occured during PCell production. First error message says:\n")) + job.error_messages ().front ());
+      }
+
+      //  transfer the results into the variants
+      for (size_t i = 0; i < job.size (); ++i) {
+
+        PCellVariantProductionResult &r = job.result (i);
+        PCellVariant *variant = const_cast<PCellVariant *> (r.variant);
+
+        if (r.has_error) {
+
+          if (r.layer_ids.empty ()) {
+            tl::error << r.error;
+          } else {
+            //  put error messages into layout as text objects
+            variant->shapes (r.layer_ids [0]).insert (db::Text (r.error, db::Trans ()));
+          }
+
+        } else if (! is_valid_parallel_production (r)) {
+
+          //  produce the conventional way
+          variant->update ();
+          continue;
+
+        } else {
+
+          const db::Cell &produced = r.layout.cell (r.cell_index);
+          db::PropertyMapper pm (*variant->layout (), r.layout);
+
+          std::set<unsigned int> layers_seen;
+          for (std::vector<unsigned int>::const_iterator l = r.layer_ids.begin (); l != r.layer_ids.end (); ++l) {
+            if (layers_seen.insert (*l).second && ! produced.shapes (*l).empty ()) {
+              db::Shapes &target = variant->shapes (*l);
+              for (db::ShapeIterator sh = produced.shapes (*l).begin (db::ShapeIterator::All); ! sh.at_end (); ++sh) {
+                target.insert (*sh, pm);
+              }
+            }
+          }
+
+          variant->m_display_name = r.display_name;
+          PCellVariantCache::store (*variant->pcell_header (), variant->m_parameters, r.layer_ids, *variant, variant->m_display_name);
+
+        }
+
+        variant->produce_guiding_shapes ();
+
+      }
+
+    }
+
+  } catch (...) {
+    for (std::map<const PCellDeclaration *, PCellVariantProductionJob *>::const_iterator j = jobs.begin (); j != jobs.end (); ++j) {
+      j->second->terminate ();
+      delete j->second;
+    }
+    throw;
+  }
+
+  for (std::map<const PCellDeclaration *, PCellVariantProductionJob *>::const_iterator j = jobs.begin (); j != jobs.end (); ++j) {
+    delete j->second;
+  }
 }
 
+}
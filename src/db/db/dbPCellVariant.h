@@ -120,6 +120,16 @@ public:
    */
   virtual void update (ImportLayerMapping *layer_mapping = 0);
 
+  /**
+   *  @brief Updates the layout of multiple variants
+   *
+   *  This method is equivalent to calling "update" on every variant, but produces
+   *  the variants of PCells which support parallel production 
+   *  (see PCellDeclaration::can_produce_in_parallel) using the given number of threads.
+   *  With "threads" being 0, the variants are produced one by one.
+   */
+  static void update_variants (const std::vector<PCellVariant *> &variants, unsigned int threads);
+
   /**
    *  @brief Tell, if this cell is a proxy cell
    *
@@ -153,6 +163,8 @@ private:
   mutable std::string m_display_name;
   size_t m_pcell_id;
   bool m_registered;
+
+  void produce_guiding_shapes ();
 };
   
 }
@@ -0,0 +1,316 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbPCellVariantCache.h"
+#include "dbPCellHeader.h"
+#include "dbLibrary.h"
+#include "dbLibraryManager.h"
+#include "dbCell.h"
+
+#include "tlStream.h"
+#include "tlFileUtils.h"
+#include "tlString.h"
+#include "tlLog.h"
+
+#include <set>
+#include <cstdio>
+
+namespace db
+{
+
+static std::string s_cache_path;
+
+static const char *cache_file_header = "#%klayout-pcell-variant-cache 1";
+
+/**
+ *  @brief Gets the name of the library the layout belongs to or an empty string if it is not a library layout
+ */
+static std::string
+library_name (const db::Layout *layout)
+{
+  if (! layout || ! db::LibraryManager::initialized ()) {
+    return std::string ();
+  }
+
+  for (db::LibraryManager::iterator l = db::LibraryManager::instance ().begin (); l != db::LibraryManager::instance ().end (); ++l) {
+    db::Library *lib = db::LibraryManager::instance ().lib (l->second);
+    if (lib && &lib->layout () == layout) {
+      return lib->get_name ();
+    }
+  }
+
+  return std::string ();
+}
+
+/**
+ *  @brief Computes the cache key and the file name for the given variant
+ *
+ *  Returns false if the variant is not eligible for caching.
+ */
+static bool
+cache_key (const db::PCellHeader &header, const pcell_parameters_type &parameters, const db::Layout *layout, std::string &key, std::string &file_name)
+{
+  if (s_cache_path.empty () || ! layout) {
+    return false;
+  }
+
+  std::string lib_name = library_name (layout);
+  if (lib_name.empty ()) {
+    return false;
+  }
+
+  key = tl::to_quoted_string (lib_name);
+  key += " ";
+  key += tl::to_quoted_string (header.get_name ());
+  key += " ";
+  key += tl::to_string (layout->dbu ());
+  key += " ";
+  key += tl::Variant (parameters.begin (), parameters.end ()).to_parsable_string ();
+
+  //  FNV-1a hash for the file name - the key is stored inside the file to resolve collisions
+  unsigned long long h = 14695981039346656037ULL;
+  for (std::string::const_iterator c = key.begin (); c != key.end (); ++c) {
+    h ^= (unsigned char) *c;
+    h *= 1099511628211ULL;
+  }
+
+  char hex [32];
+  sprintf (hex, "%016llx", h);
+
+  file_name = tl::combine_path (s_cache_path, std::string (hex) + ".pcv");
+  return true;
+}
+
+void
+PCellVariantCache::set_path (const std::string &path)
+{
+  s_cache_path = path;
+  if (! path.empty () && ! tl::file_exists (path)) {
+    tl::mkpath (path);
+  }
+}
+
+const std::string &
+PCellVariantCache::path ()
+{
+  return s_cache_path;
+}
+
+bool
+PCellVariantCache::fetch (const db::PCellHeader &header, const pcell_parameters_type &parameters, const std::vector<unsigned int> &layer_ids, db::Cell &cell, std::string &display_name)
+{
+  std::string key, file_name;
+  if (! cache_key (header, parameters, cell.layout (), key, file_name) || ! tl::file_exists (file_name)) {
+    return false;
+  }
+
+  std::vector<std::pair<unsigned int, db::Box> > boxes;
+  std::vector<std::pair<unsigned int, db::Polygon> > polygons;
+  std::vector<std::pair<unsigned int, db::SimplePolygon> > simple_polygons;
+  std::vector<std::pair<unsigned int, db::Path> > paths;
+  std::vector<std::pair<unsigned int, db::Text> > texts;
+  std::string name;
+
+  try {
+
+    tl::InputStream stream (file_name);
+    tl::TextInputStream text_stream (stream);
+
+    if (text_stream.get_line () != cache_file_header || text_stream.get_line () != key) {
+      return false;
+    }
+
+    unsigned int layer = 0;
+    bool has_layer = false;
+    bool complete = false;
+
+    while (! text_stream.at_end ()) {
+
+      std::string line = text_stream.get_line ();
+      tl::Extractor ex (line.c_str ());
+
+      if (ex.at_end ()) {
+        //  skip empty lines
+      } else if (ex.test ("end")) {
+        complete = true;
+        break;
+      } else if (ex.test ("name")) {
+        ex.read_word_or_quoted (name);
+      } else if (ex.test ("layer")) {
+        unsigned int l = 0;
+        ex.read (l);
+        if (l >= layer_ids.size ()) {
+          return false;
+        }
+        layer = layer_ids [l];
+        has_layer = true;
+      } else if (! has_layer) {
+        return false;
+      } else if (ex.test ("box")) {
+        boxes.push_back (std::make_pair (layer, db::Box ()));
+        ex.read (boxes.back ().second);
+      } else if (ex.test ("polygon")) {
+        polygons.push_back (std::make_pair (layer, db::Polygon ()));
+        ex.read (polygons.back ().second);
+      } else if (ex.test ("spolygon")) {
+        simple_polygons.push_back (std::make_pair (layer, db::SimplePolygon ()));
+        ex.read (simple_polygons.back ().second);
+      } else if (ex.test ("path")) {
+        paths.push_back (std::make_pair (layer, db::Path ()));
+        ex.read (paths.back ().second);
+      } else if (ex.test ("text")) {
+        texts.push_back (std::make_pair (layer, db::Text ()));
+        db::Text &t = texts.back ().second;
+        int size = 0, font = 0, halign = 0, valign = 0;
+        ex.read (t);
+        ex.read (size);
+        ex.read (font);
+        ex.read (halign);
+        ex.read (valign);
+        t.size (size);
+        t.font (db::Font (font));
+        t.halign (db::HAlign (halign));
+        t.valign (db::VAlign (valign));
+      } else {
+        return false;
+      }
+
+    }
+
+    //  an incomplete file is ignored
+    if (! complete) {
+      return false;
+    }
+
+  } catch (tl::Exception &ex) {
+    //  a broken cache entry is not an error - the variant is simply produced again
+    tl::warn << tl::to_string (tr ("Unable to read PCell variant cache file ")) << file_name << ": " << ex.msg ();
+    return false;
+  }
+
+  for (std::vector<std::pair<unsigned int, db::Box> >::const_iterator s = boxes.begin (); s != boxes.end (); ++s) {
+    cell.shapes (s->first).insert (s->second);
+  }
+  for (std::vector<std::pair<unsigned int, db::Polygon> >::const_iterator s = polygons.begin (); s != polygons.end (); ++s) {
+    cell.shapes (s->first).insert (s->second);
+  }
+  for (std::vector<std::pair<unsigned int, db::SimplePolygon> >::const_iterator s = simple_polygons.begin (); s != simple_polygons.end (); ++s) {
+    cell.shapes (s->first).insert (s->second);
+  }
+  for (std::vector<std::pair<unsigned int, db::Path> >::const_iterator s = paths.begin (); s != paths.end (); ++s) {
+    cell.shapes (s->first).insert (s->second);
+  }
+  for (std::vector<std::pair<unsigned int, db::Text> >::const_iterator s = texts.begin (); s != texts.end (); ++s) {
+    cell.shapes (s->first).insert (s->second);
+  }
+
+  display_name = name;
+  return true;
+}
+
+void
+PCellVariantCache::store (const db::PCellHeader &header, const pcell_parameters_type &parameters, const std::vector<unsigned int> &layer_ids, const db::Cell &cell, const std::string &display_name)
+{
+  std::string key, file_name;
+  if (! cache_key (header, parameters, cell.layout (), key, file_name)) {
+    return;
+  }
+
+  //  instances refer to other cells and cannot be cached
+  if (cell.cell_instances () > 0) {
+    return;
+  }
+
+  //  shapes outside the declared layers cannot be cached
+  std::set<unsigned int> declared_layers (layer_ids.begin (), layer_ids.end ());
+  for (db::Layout::layer_iterator l = cell.layout ()->begin_layers (); l != cell.layout ()->end_layers (); ++l) {
+    if (declared_layers.find ((*l).first) == declared_layers.end () && ! cell.shapes ((*l).first).empty ()) {
+      return;
+    }
+  }
+
+  std::string data;
+  data += cache_file_header;
+  data += "\n";
+  data += key;
+  data += "\n";
+  data += "name ";
+  data += tl::to_quoted_string (display_name);
+  data += "\n";
+
+  std::set<unsigned int> layers_seen;
+
+  for (size_t i = 0; i < layer_ids.size (); ++i) {
+
+    //  a layer may appear multiple times (e.g. the waste layer): deliver the shapes once
+    if (! layers_seen.insert (layer_ids [i]).second || cell.shapes (layer_ids [i]).empty ()) {
+      continue;
+    }
+
+    data += "layer " + tl::to_string (i) + "\n";
+
+    for (db::ShapeIterator s = cell.shapes (layer_ids [i]).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+
+      if (s->has_prop_id ()) {
+        return;
+      }
+
+      if (s->is_box ()) {
+        data += "box " + s->box ().to_string () + "\n";
+      } else if (s->is_polygon ()) {
+        db::Polygon p;
+        s->polygon (p);
+        data += "polygon " + p.to_string () + "\n";
+      } else if (s->is_simple_polygon ()) {
+        db::SimplePolygon p;
+        s->simple_polygon (p);
+        data += "spolygon " + p.to_string () + "\n";
+      } else if (s->is_path ()) {
+        db::Path p;
+        s->path (p);
+        data += "path " + p.to_string () + "\n";
+      } else if (s->is_text ()) {
+        db::Text t;
+        s->text (t);
+        data += "text " + t.to_string () + " " + tl::to_string (int (t.size ())) + " " + tl::to_string (int (t.font ())) + " " + tl::to_string (int (t.halign ())) + " " + tl::to_string (int (t.valign ())) + "\n";
+      } else {
+        //  other shape types are not supported by the cache
+        return;
+      }
+
+    }
+
+  }
+
+  data += "end\n";
+
+  try {
+    tl::OutputStream os (file_name, tl::OutputStream::OM_Plain);
+    os.put (data.c_str (), data.size ());
+  } catch (tl::Exception &ex) {
+    tl::warn << tl::to_string (tr ("Unable to write PCell variant cache file ")) << file_name << ": " << ex.msg ();
+  }
+}
+
+}
+
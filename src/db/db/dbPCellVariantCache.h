@@ -0,0 +1,88 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbPCellVariantCache
+#define HDR_dbPCellVariantCache
+
+#include "dbCommon.h"
+#include "dbPCellDeclaration.h"
+
+#include <string>
+#include <vector>
+
+namespace db
+{
+
+class Cell;
+class PCellHeader;
+
+/**
+ *  @brief A persistent cache for the geometry of library PCell variants
+ *
+ *  The cache keeps the geometry produced by library PCells in files inside a cache
+ *  directory. The entries are keyed by library name, PCell name, database unit and
+ *  PCell parameters. When the same variant is required again (e.g. when a layout
+ *  referring to this variant is loaded), the geometry is taken from the cache instead
+ *  of running the PCell code.
+ *
+ *  Only variants of library PCells consisting of boxes, polygons, paths and texts
+ *  without properties are cached. The cache is disabled by default and is enabled
+ *  by specifying a cache directory. The cache cannot detect changes of the PCell
+ *  implementation - the cache directory needs to be cleared in that case.
+ */
+class DB_PUBLIC PCellVariantCache
+{
+public:
+  /**
+   *  @brief Sets the cache directory
+   *
+   *  An empty string disables the cache. The directory is created if required.
+   */
+  static void set_path (const std::string &path);
+
+  /**
+   *  @brief Gets the cache directory
+   */
+  static const std::string &path ();
+
+  /**
+   *  @brief Fetches the geometry of a variant from the cache
+   *
+   *  "layer_ids" are the layers as delivered by PCellHeader::get_layer_indices.
+   *  If the variant is found, the shapes are inserted into the cell, the display name
+   *  is delivered in "display_name" and true is returned.
+   */
+  static bool fetch (const db::PCellHeader &header, const pcell_parameters_type &parameters, const std::vector<unsigned int> &layer_ids, db::Cell &cell, std::string &display_name);
+
+  /**
+   *  @brief Stores the geometry of a freshly produced variant in the cache
+   *
+   *  Nothing is stored if the variant cannot be cached.
+   */
+  static void store (const db::PCellHeader &header, const pcell_parameters_type &parameters, const std::vector<unsigned int> &layer_ids, const db::Cell &cell, const std::string &display_name);
+};
+
+}
+
+#endif
+
@@ -22,6 +22,10 @@
 
 
 #include "dbPolygon.h"
+#include "tlArena.h"
+
+#include <limits>
+#include <cstring>
 
 namespace db
 {
@@ -469,6 +473,179 @@ void polygon_contour<C>::size (C dx, C dy, unsigned int mode)
 
 }
 
+template <class C>
+static inline bool fits_packed_anchor (C c)
+{
+  return c >= C (std::numeric_limits<int32_t>::min ()) && c <= C (std::numeric_limits<int32_t>::max ());
+}
+
+static inline void write_packed_delta (std::vector<unsigned char> &data, int64_t d)
+{
+  uint64_t v = (uint64_t (d) << 1) ^ uint64_t (d >> 63);
+  while (v >= 0x80) {
+    data.push_back ((unsigned char) ((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  data.push_back ((unsigned char) v);
+}
+
+template <class C>
+void polygon_contour<C>::pack ()
+{
+  //  packing is only available for integer coordinates
+  if (! std::numeric_limits<C>::is_integer || is_packed () || mp_points == 0) {
+    return;
+  }
+
+  //  small contours are not worth the decoding effort
+  size_type n = stored_size ();
+  if (n < size_type (packed_block_size / 2)) {
+    return;
+  }
+
+  const point_type *pts = (const point_type *) ((size_t) mp_points & ~3);
+  size_type blocks = (n + packed_block_size - 1) / packed_block_size;
+
+  std::vector<uint32_t> header;
+  header.reserve (blocks * 3);
+  std::vector<unsigned char> data;
+  data.reserve (n * 2);
+
+  for (size_type b = 0; b < blocks; ++b) {
+
+    const point_type &a = pts [b * packed_block_size];
+    if (! fits_packed_anchor (a.x ()) || ! fits_packed_anchor (a.y ()) || data.size () > size_t (std::numeric_limits<uint32_t>::max ())) {
+      return;
+    }
+
+    header.push_back (uint32_t (int32_t (a.x ())));
+    header.push_back (uint32_t (int32_t (a.y ())));
+    header.push_back (uint32_t (data.size ()));
+
+    size_type e = std::min (n, (b + 1) * packed_block_size);
+    for (size_type i = b * packed_block_size + 1; i < e; ++i) {
+      write_packed_delta (data, int64_t (pts [i].x ()) - int64_t (pts [i - 1].x ()));
+      write_packed_delta (data, int64_t (pts [i].y ()) - int64_t (pts [i - 1].y ()));
+    }
+
+  }
+
+  size_t words = 1 + header.size () + (data.size () + sizeof (uint32_t) - 1) / sizeof (uint32_t);
+
+  //  don't pack if there is no benefit
+  if (words * sizeof (uint32_t) >= n * sizeof (point_type)) {
+    return;
+  }
+
+  uint32_t *packed = new uint32_t [words];
+  packed [0] = uint32_t (words);
+  std::copy (header.begin (), header.end (), packed + 1);
+  if (! data.empty ()) {
+    packed [words - 1] = 0;
+    memcpy ((void *) (packed + 1 + header.size ()), (const void *) &data.front (), data.size ());
+  }
+
+  size_t flags = (size_t) mp_points & 3;
+  if (! is_external ()) {
+    delete [] pts;
+  }
+
+  tl_assert (((size_t) packed & 3) == 0);
+  mp_points = (point_type *) ((size_t) packed | flags);
+  m_size = n | packed_bit ();
+}
+
+template <class C>
+void polygon_contour<C>::unpack ()
+{
+  if (! is_packed ()) {
+    return;
+  }
+
+  size_type n = stored_size ();
+  point_type *pts = new point_type [n];
+  for (size_type i = 0; i < n; ++i) {
+    pts [i] = packed_point (i);
+  }
+
+  size_t flags = (size_t) mp_points & 3;
+  release ();
+
+  mp_points = (point_type *) ((size_t) pts | flags);
+  m_size = n;
+}
+
+template <class C>
+void polygon_contour<C>::assign (const polygon_contour &d, tl::Arena &arena)
+{
+  release ();
+
+  m_size = d.m_size & ~external_bit ();
+  if (d.mp_points == 0) {
+    mp_points = 0;
+    return;
+  }
+
+  size_t bytes = d.is_packed () ? sizeof (uint32_t) * d.packed_data () [0] : sizeof (point_type) * d.stored_size ();
+  void *mem = arena.allocate (bytes);
+  memcpy (mem, (const void *) ((size_t) d.mp_points & ~3), bytes);
+
+  tl_assert (((size_t) mem & 3) == 0);
+  mp_points = (point_type *) ((size_t) mem | ((size_t) d.mp_points & 3));
+  m_size |= external_bit ();
+}
+
+template <class C>
+typename polygon_contour<C>::box_type polygon_contour<C>::packed_bbox () const
+{
+  box_type box;
+
+  //  decode the blocks sequentially rather than point by point
+  const uint32_t *d = packed_data ();
+  size_type n = stored_size ();
+  size_type blocks = (n + packed_block_size - 1) / packed_block_size;
+  const unsigned char *bp = (const unsigned char *) (d + 1 + 3 * blocks);
+
+  for (size_type b = 0; b < blocks; ++b) {
+    const uint32_t *h = d + 1 + 3 * b;
+    int64_t x = int32_t (h [0]), y = int32_t (h [1]);
+    box += point_type (coord_type (x), coord_type (y));
+    size_type e = std::min (n, (b + 1) * packed_block_size);
+    for (size_type i = b * packed_block_size + 1; i < e; ++i) {
+      x += read_packed_delta (bp);
+      y += read_packed_delta (bp);
+      box += point_type (coord_type (x), coord_type (y));
+    }
+  }
+
+  return box;
+}
+
+template <class C>
+bool polygon_contour<C>::move_packed (const vector_type &d)
+{
+  uint32_t *pd = (uint32_t *) packed_data ();
+  size_type blocks = (stored_size () + packed_block_size - 1) / packed_block_size;
+
+  for (size_type b = 0; b < blocks; ++b) {
+    const uint32_t *h = pd + 1 + 3 * b;
+    if (! fits_packed_anchor (int64_t (int32_t (h [0])) + int64_t (d.x ())) || ! fits_packed_anchor (int64_t (int32_t (h [1])) + int64_t (d.y ()))) {
+      //  the anchor points would leave the 32 bit range: move the unpacked contour
+      unpack ();
+      return false;
+    }
+  }
+
+  //  only the anchor points need to be moved
+  for (size_type b = 0; b < blocks; ++b) {
+    uint32_t *h = pd + 1 + 3 * b;
+    h [0] = uint32_t (int32_t (int64_t (int32_t (h [0])) + int64_t (d.x ())));
+    h [1] = uint32_t (int32_t (int64_t (int32_t (h [1])) + int64_t (d.y ())));
+  }
+
+  return true;
+}
+
 // explicit instantiations for polygon<T> and simple_polygon<T>
 template class polygon_contour<db::Coord>;
 template class polygon_contour<db::DCoord>;
@@ -46,6 +46,11 @@
 #include <iterator>
 #include <algorithm>
 
+namespace tl
+{
+  class Arena;
+}
+
 namespace db {
 
 template <class Coord> class generic_repository;
@@ -135,10 +140,15 @@ public:
    *  @brief Copy ctor
    */
   polygon_contour (const polygon_contour &d)
-    : m_size (d.m_size)
+    : m_size (d.m_size & ~external_bit ())
   {
     if (d.mp_points == 0) {
       mp_points = 0;
+    } else if (d.is_packed ()) {
+      const uint32_t *pd = d.packed_data ();
+      uint32_t *p = new uint32_t [pd [0]];
+      std::copy (pd, pd + pd [0], p);
+      mp_points = (point_type *)((size_t) p | ((size_t) d.mp_points & 3));
     } else {
       point_type *p = new point_type [m_size];
       point_type *pp = (point_type *) ((size_t) d.mp_points & ~3);
@@ -606,8 +616,11 @@ public:
    */
   polygon_contour<C> &move (const vector_type &d)
   {
+    if (is_packed () && move_packed (d)) {
+      return *this;
+    }
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
+    for (size_type i = 0; i < stored_size (); ++i, ++p) {
       *p += d;
     }
     return *this;
@@ -729,12 +742,13 @@ public:
     if (((size_t) mp_points & 1) != 0) {
       return true;
     }
-    if (m_size < 2) {
+    size_type n = stored_size ();
+    if (n < 2) {
       return false;
     }
-    point_type pl = mp_points [m_size - 1];
-    for (size_t i = 0; i < m_size; ++i) {
-      point_type p = mp_points [i];
+    point_type pl = stored_point (n - 1);
+    for (size_t i = 0; i < n; ++i) {
+      point_type p = stored_point (i);
       if (! coord_traits::equals (p.x (), pl.x ()) && ! coord_traits::equals (p.y (), pl.y ())) {
         return false;
       }
@@ -799,24 +813,43 @@ public:
    *  @brief Random access operator
    *
    *  The time for the access operation is guaranteed to be constant.
+   *  For packed contours, the access time is bounded by the packing block size.
    */
   point_type operator[] (size_type index) const
   {
-    size_t f = (size_t) mp_points;
-    point_type *pts = (point_type *) (f & ~3);
-    if ((f & 1) != 0) {
-      if ((index & 1) != 0) {
-        if ((f & 2) != 0) {
-          return point_type (pts [((index + 1) / 2) % m_size].x (), pts [(index - 1) / 2].y ());
-        } else {
-          return point_type (pts [(index - 1) / 2].x (), pts [((index + 1) / 2) % m_size].y ());
-        }
-      } else {
-        return pts [index / 2];
-      }
-    } else {
-      return pts [index];
+    return point_at (index, 0);
+  }
+
+  /**
+   *  @brief A cursor for sequential access to packed contours
+   *
+   *  Decoding a point of a packed contour from the first point of its block costs
+   *  up to one block of coordinate differences. The cursor keeps the point decoded
+   *  last, so stepping to a neighbouring point decodes a single coordinate difference.
+   */
+  struct packed_cursor
+  {
+    packed_cursor ()
+      : index (size_type (-1)), bp (0), x (0), y (0)
+    {
+      //  .. nothing yet ..
     }
+
+    size_type index;
+    const unsigned char *bp;
+    int64_t x, y;
+  };
+
+  /**
+   *  @brief Point access with a cursor
+   *
+   *  This method delivers the same point than operator[]. For packed contours, 
+   *  sequential access in both directions takes constant time. The cursor must
+   *  only be used with one contour.
+   */
+  point_type get (size_type index, packed_cursor &cursor) const
+  {
+    return point_at (index, is_packed () ? &cursor : 0);
   }
 
   /**
@@ -844,9 +877,9 @@ public:
   size_type size () const 
   {
     if ((size_t) mp_points & 1) {
-      return m_size * 2;
+      return stored_size () * 2;
     } else {
-      return m_size;
+      return stored_size ();
     }
   }
 
@@ -860,9 +893,12 @@ public:
    */
   box_type bbox () const
   {
+    if (is_packed ()) {
+      return packed_bbox ();
+    }
     box_type box;
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
+    for (size_type i = 0; i < stored_size (); ++i, ++p) {
       box += *p;
     }
     return box;
@@ -993,18 +1029,215 @@ public:
     if (! no_self) {
       stat->add (typeid (*this), (void *) this, sizeof (*this), sizeof (*this), parent, purpose, cat);
     }
-    stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * m_size, sizeof (point_type) * m_size, (void *) this, purpose, cat);
+    if (is_packed ()) {
+      stat->add (typeid (uint32_t []), (void *) mp_points, sizeof (uint32_t) * packed_data () [0], sizeof (uint32_t) * packed_data () [0], (void *) this, purpose, cat);
+    } else {
+      stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * stored_size (), sizeof (point_type) * stored_size (), (void *) this, purpose, cat);
+    }
+  }
+
+  /**
+   *  @brief Packs the contour into a compressed representation
+   *
+   *  A packed contour stores the points as variable-length coordinate differences
+   *  in blocks of points. Packing saves memory for contours with many points
+   *  at the cost of decoding the points on access. The contour is left unchanged
+   *  if packing does not save memory or is not possible (e.g. for floating-point
+   *  coordinates). Packing does not change the value of the contour.
+   *  Modifications which recompute the contour (e.g. transformations) deliver an
+   *  unpacked contour again.
+   */
+  void pack ();
+
+  /**
+   *  @brief Converts a packed contour back into the normal representation
+   */
+  void unpack ();
+
+  /**
+   *  @brief Returns true, if the contour is packed
+   */
+  bool is_packed () const
+  {
+    return (m_size & packed_bit ()) != 0;
+  }
+
+  /**
+   *  @brief Assigns a copy of the given contour with the point storage taken from the given arena
+   *
+   *  After this operation, the contour does not own its point storage. The
+   *  arena must not be cleared or destroyed before the contour is destroyed.
+   *  Copies of the contour will use heap memory again.
+   *  This feature is intended for contours which live as long as the arena,
+   *  i.e. the entries of the shape repository.
+   */
+  void assign (const polygon_contour &d, tl::Arena &arena);
+
+  /**
+   *  @brief Returns true, if the point storage of the contour is held by an arena
+   */
+  bool is_external () const
+  {
+    return (m_size & external_bit ()) != 0;
   }
 
 private:
   point_type *mp_points;
   size_type m_size;
 
+  //  the number of points per block in the packed representation
+  enum { packed_block_size = 16 };
+
+  //  the flag in m_size indicating the packed representation
+  static size_type packed_bit ()
+  {
+    return size_type (1) << (sizeof (size_type) * 8 - 1);
+  }
+
+  //  the flag in m_size indicating storage not owned by the contour
+  static size_type external_bit ()
+  {
+    return size_type (1) << (sizeof (size_type) * 8 - 2);
+  }
+
+  size_type stored_size () const
+  {
+    return m_size & ~(packed_bit () | external_bit ());
+  }
+
+  //  The packed representation is an array of 32 bit words: the first word is the total
+  //  number of words. It is followed by a header of three words per block (x and y of the first
+  //  point of the block, byte offset of the block's data). The block data is a sequence of zigzag
+  //  encoded variable-length coordinate differences to the previous point.
+  const uint32_t *packed_data () const
+  {
+    return (const uint32_t *) ((size_t) mp_points & ~3);
+  }
+
+  point_type stored_point (size_type i) const
+  {
+    if (is_packed ()) {
+      return packed_point (i);
+    } else {
+      return ((const point_type *) ((size_t) mp_points & ~3)) [i];
+    }
+  }
+
+  point_type point_at (size_type index, packed_cursor *c) const
+  {
+    size_t f = (size_t) mp_points;
+    if ((f & 1) != 0) {
+      if ((index & 1) != 0) {
+        if ((f & 2) != 0) {
+          return point_type (stored_point (((index + 1) / 2) % stored_size (), c).x (), stored_point ((index - 1) / 2, c).y ());
+        } else {
+          return point_type (stored_point ((index - 1) / 2, c).x (), stored_point (((index + 1) / 2) % stored_size (), c).y ());
+        }
+      } else {
+        return stored_point (index / 2, c);
+      }
+    } else {
+      return stored_point (index, c);
+    }
+  }
+
+  point_type stored_point (size_type i, packed_cursor *c) const
+  {
+    if (! c) {
+      return stored_point (i);
+    }
+
+    if (i != c->index) {
+
+      if (c->index != size_type (-1) && i == c->index + 1 && (i % packed_block_size) != 0) {
+
+        //  next point in the same block
+        c->x += read_packed_delta (c->bp);
+        c->y += read_packed_delta (c->bp);
+
+      } else if (c->index != size_type (-1) && i + 1 == c->index && (c->index % packed_block_size) != 0) {
+
+        //  previous point in the same block: undo the coordinate difference of the current point
+        const unsigned char *yp = c->bp - 1;
+        while ((yp [-1] & 0x80) != 0) {
+          --yp;
+        }
+        const unsigned char *xp;
+        if ((c->index % packed_block_size) == 1) {
+          xp = packed_block_data (c->index / packed_block_size);
+        } else {
+          xp = yp - 1;
+          while ((xp [-1] & 0x80) != 0) {
+            --xp;
+          }
+        }
+        c->bp = xp;
+        c->x -= read_packed_delta (xp);
+        c->y -= read_packed_delta (xp);
+
+      } else {
+        seek_packed (i, *c);
+      }
+
+      c->index = i;
+
+    }
+
+    return point_type (coord_type (c->x), coord_type (c->y));
+  }
+
+  const unsigned char *packed_block_data (size_type b) const
+  {
+    const uint32_t *d = packed_data ();
+    size_type blocks = (stored_size () + packed_block_size - 1) / packed_block_size;
+    return (const unsigned char *) (d + 1 + 3 * blocks) + d [1 + 3 * b + 2];
+  }
+
+  void seek_packed (size_type i, packed_cursor &c) const
+  {
+    const uint32_t *h = packed_data () + 1 + 3 * (i / packed_block_size);
+    c.x = int32_t (h [0]);
+    c.y = int32_t (h [1]);
+    c.bp = packed_block_data (i / packed_block_size);
+    for (size_type j = i % packed_block_size; j > 0; --j) {
+      c.x += read_packed_delta (c.bp);
+      c.y += read_packed_delta (c.bp);
+    }
+  }
+
+  point_type packed_point (size_type i) const
+  {
+    packed_cursor c;
+    seek_packed (i, c);
+    return point_type (coord_type (c.x), coord_type (c.y));
+  }
+
+  static int64_t read_packed_delta (const unsigned char *&bp)
+  {
+    uint64_t v = 0;
+    unsigned int s = 0;
+    while ((*bp & 0x80) != 0) {
+      v |= uint64_t (*bp++ & 0x7f) << s;
+      s += 7;
+    }
+    v |= uint64_t (*bp++) << s;
+    return int64_t (v >> 1) ^ -int64_t (v & 1);
+  }
+
+  box_type packed_bbox () const;
+  bool move_packed (const vector_type &d);
+
   void release ()
   {
-    point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    if (p) {
-      delete [] p;
+    if (is_external ()) {
+      //  the storage is owned by an arena
+    } else if (is_packed ()) {
+      delete [] (uint32_t *) packed_data ();
+    } else {
+      point_type *p = (point_type *) ((size_t) mp_points & ~3);
+      if (p) {
+        delete [] p;
+      }
     }
     mp_points = 0;
     m_size = 0;
@@ -1078,7 +1311,7 @@ public:
    */
   template <class T> 
   polygon_contour_iterator (const polygon_contour_iterator<Contour, T> &d, const trans_type &trans, bool reverse = false) 
-    : mp_contour (d.mp_contour), m_index (d.m_index), m_trans (trans), m_reverse (reverse)
+    : mp_contour (d.mp_contour), m_index (d.m_index), m_trans (trans), m_reverse (reverse), m_cursor (d.m_cursor)
   {
     //  .. nothing yet .. 
   }
@@ -1112,7 +1345,7 @@ public:
    */
   point_type operator* () const 
   {
-    return m_trans ((*mp_contour) [m_index]);
+    return m_trans (mp_contour->get (m_index, m_cursor));
   }
 
   /**
@@ -1211,6 +1444,7 @@ private:
   size_t m_index;
   trans_type m_trans;
   bool m_reverse;
+  mutable typename contour_type::packed_cursor m_cursor;
 };
 
 /**
@@ -1316,8 +1550,8 @@ public:
   {
     const contour_type *c = get_ctr ();
     
-    point_type p1 (m_trans ((*c) [m_pt]));
-    point_type p2 (m_trans ((*c) [m_pt + 1 >= c->size () ? 0 : m_pt + 1]));
+    point_type p1 (m_trans (c->get (m_pt, m_cursor)));
+    point_type p2 (m_trans (c->get (m_pt + 1 >= c->size () ? 0 : m_pt + 1, m_cursor)));
 
     //  to maintain the edge orientation we need to swap start end end point
     //  if the transformation is mirroring
@@ -1336,6 +1570,7 @@ public:
     const contour_type *c = get_ctr ();
     if (++m_pt == c->size ()) {
       m_pt = 0;
+      m_cursor = typename contour_type::packed_cursor ();
       //  polygons may contain empty contours (holes): skip those
       do { 
         ++m_ctr;
@@ -1350,6 +1585,7 @@ public:
   polygon_edge_iterator &operator-- () 
   {
     if (m_pt == 0) {
+      m_cursor = typename contour_type::packed_cursor ();
       //  polygons may contain empty contours (holes): skip those
       do {
         --m_ctr;
@@ -1366,6 +1602,7 @@ private:
   unsigned int m_ctr, m_num_ctr;
   size_t m_pt;
   trans_type m_trans;
+  mutable typename contour_type::packed_cursor m_cursor;
 
   //  fetch the contour pointer to the current contour
   const contour_type *get_ctr () const
@@ -1422,6 +1659,20 @@ public:
     m_ctrs.push_back (contour_type ());
   }
 
+  /**
+   *  @brief Copy constructor with the point storage taken from the given arena
+   *
+   *  See polygon_contour::assign for details.
+   */
+  polygon (const polygon &d, tl::Arena &arena)
+    : m_bbox (d.m_bbox)
+  {
+    m_ctrs.resize (d.m_ctrs.size ());
+    for (size_t i = 0; i < d.m_ctrs.size (); ++i) {
+      m_ctrs [i].assign (d.m_ctrs [i], arena);
+    }
+  }
+
   /**
    *  @brief The copy constructor from another polygon with a transformation
    *
@@ -1734,6 +1985,19 @@ public:
     return *this;
   }
 
+  /**
+   *  @brief Packs the contours of the polygon
+   *
+   *  See polygon_contour::pack for details.
+   */
+  void pack ()
+  {
+    for (typename contour_list_type::iterator h = m_ctrs.begin (); h != m_ctrs.end (); ++h) {
+      h->pack ();
+    }
+  }
+
+
   /**
    *  @brief Transform the polygon.
    *
@@ -2377,6 +2641,17 @@ public:
     // .. nothing yet ..
   }
 
+  /**
+   *  @brief Copy constructor with the point storage taken from the given arena
+   *
+   *  See polygon_contour::assign for details.
+   */
+  simple_polygon (const simple_polygon &d, tl::Arena &arena)
+    : m_bbox (d.m_bbox)
+  {
+    m_hull.assign (d.m_hull, arena);
+  }
+
   /**
    *  @brief The box constructor.
    *  
@@ -2578,6 +2853,17 @@ public:
     return *this;
   }
 
+  /**
+   *  @brief Packs the hull of the polygon
+   *
+   *  See polygon_contour::pack for details.
+   */
+  void pack ()
+  {
+    m_hull.pack ();
+  }
+
+
   /**
    *  @brief Transform the polygon.
    *
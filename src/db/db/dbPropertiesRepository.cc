@@ -30,6 +30,79 @@
 namespace db
 {
 
+// ----------------------------------------------------------------------------------
+//  Hash functions
+
+static inline size_t
+hash_combine (size_t h, size_t v)
+{
+  return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+static inline size_t
+hash_for_double (double d)
+{
+  //  NOTE: +0.0 and -0.0 are equal but have a different representation
+  if (d == 0.0) {
+    return 0;
+  } else {
+    return std::hash<double> () (d);
+  }
+}
+
+static inline size_t
+hash_for_cstring (const char *cp)
+{
+  //  FNV-1a
+  size_t h = size_t (2166136261u);
+  while (*cp) {
+    h = (h ^ size_t ((unsigned char) *cp++)) * size_t (16777619u);
+  }
+  return h;
+}
+
+size_t 
+hash_for_property_value (const tl::Variant &v)
+{
+  switch (v.type_code ()) {
+  case tl::Variant::t_nil:
+    return 0;
+  case tl::Variant::t_bool:
+    return v.to_bool () ? 1 : 2;
+  case tl::Variant::t_char:
+  case tl::Variant::t_schar:
+  case tl::Variant::t_short:
+  case tl::Variant::t_int:
+  case tl::Variant::t_long:
+  case tl::Variant::t_longlong:
+  case tl::Variant::t_uchar:
+  case tl::Variant::t_ushort:
+  case tl::Variant::t_uint:
+  case tl::Variant::t_ulong:
+  case tl::Variant::t_ulonglong:
+  case tl::Variant::t_float:
+  case tl::Variant::t_double:
+    //  integer and floating-point values compare equal if their values are the same
+    return hash_for_double (v.to_double ());
+  case tl::Variant::t_id:
+    return std::hash<size_t> () (v.to_id ());
+  case tl::Variant::t_string:
+  case tl::Variant::t_stdstring:
+    return hash_for_cstring (v.to_string ());
+  case tl::Variant::t_list:
+    {
+      size_t h = 3;
+      for (tl::Variant::const_iterator i = v.begin (); i != v.end (); ++i) {
+        h = hash_combine (h, hash_for_property_value (*i));
+      }
+      return h;
+    }
+  default:
+    //  other types are rare in properties - they are resolved by the equality test
+    return size_t (v.type_code ());
+  }
+}
+
 // ----------------------------------------------------------------------------------
 //  PropertiesRepository implementation
 
@@ -49,7 +122,7 @@ PropertiesRepository::operator= (const PropertiesRepository &d)
     m_propnames_by_id            = d.m_propnames_by_id;
     m_propname_ids_by_name       = d.m_propname_ids_by_name;
     m_properties_by_id           = d.m_properties_by_id;
-    m_properties_ids_by_set      = d.m_properties_ids_by_set;
+    m_properties_ids_by_hash     = d.m_properties_ids_by_hash;
     m_properties_component_table = d.m_properties_component_table;
   }
   return *this;
@@ -58,7 +131,7 @@ PropertiesRepository::operator= (const PropertiesRepository &d)
 std::pair<bool, property_names_id_type>
 PropertiesRepository::get_id_of_name (const tl::Variant &name) const
 {
-  std::map <tl::Variant, property_names_id_type>::const_iterator pi = m_propname_ids_by_name.find (name);
+  std::unordered_map <tl::Variant, property_names_id_type, PropertyValueHash>::const_iterator pi = m_propname_ids_by_name.find (name);
   if (pi == m_propname_ids_by_name.end ()) {
     return std::make_pair (false, property_names_id_type (0));
   } else {
@@ -69,7 +142,7 @@ PropertiesRepository::get_id_of_name (const tl::Variant &name) const
 property_names_id_type 
 PropertiesRepository::prop_name_id (const tl::Variant &name)
 {
-  std::map <tl::Variant, property_names_id_type>::const_iterator pi = m_propname_ids_by_name.find (name);
+  std::unordered_map <tl::Variant, property_names_id_type, PropertyValueHash>::const_iterator pi = m_propname_ids_by_name.find (name);
   if (pi == m_propname_ids_by_name.end ()) {
     property_names_id_type id = m_propnames_by_id.size ();
     m_propnames_by_id.insert (std::make_pair (id, name));
@@ -83,15 +156,16 @@ PropertiesRepository::prop_name_id (const tl::Variant &name)
 void 
 PropertiesRepository::change_properties (property_names_id_type id, const properties_set &new_props)
 {
-  const properties_set &old_props = properties (id);
+  std::map <properties_id_type, properties_set>::iterator p = m_properties_by_id.find (id);
+  if (p != m_properties_by_id.end ()) {
 
-  std::map <properties_set, properties_id_type>::const_iterator pi = m_properties_ids_by_set.find (old_props);
-  if (pi != m_properties_ids_by_set.end ()) {
+    const properties_set &old_props = p->second;
 
     //  erase the id from the component table
     for (properties_set::const_iterator nv = old_props.begin (); nv != old_props.end (); ++nv) {
-      if (m_properties_component_table.find (*nv) != m_properties_component_table.end ()) {
-        properties_id_vector &v = m_properties_component_table [*nv];
+      std::unordered_map <name_value_pair, properties_id_vector, PropertyValueHash>::iterator ct = m_properties_component_table.find (*nv);
+      if (ct != m_properties_component_table.end ()) {
+        properties_id_vector &v = ct->second;
         for (size_t i = 0; i < v.size (); ) {
           if (v[i] == id) {
             v.erase (v.begin () + i);
@@ -102,11 +176,18 @@ PropertiesRepository::change_properties (property_names_id_type id, const proper
       }
     }
 
-    //  and insert again
-    m_properties_ids_by_set.erase (old_props);
-    m_properties_ids_by_set.insert (std::make_pair (new_props, id));
+    //  erase the id from the hash table
+    std::pair<properties_ids_by_hash_map::iterator, properties_ids_by_hash_map::iterator> hr = m_properties_ids_by_hash.equal_range (hash_for_properties_set (old_props));
+    for (properties_ids_by_hash_map::iterator h = hr.first; h != hr.second; ++h) {
+      if (h->second == id) {
+        m_properties_ids_by_hash.erase (h);
+        break;
+      }
+    }
 
-    m_properties_by_id [id] = new_props;
+    //  and insert again
+    p->second = new_props;
+    m_properties_ids_by_hash.insert (std::make_pair (hash_for_properties_set (new_props), id));
 
     for (properties_set::const_iterator nv = new_props.begin (); nv != new_props.end (); ++nv) {
       m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (id);
@@ -137,14 +218,48 @@ PropertiesRepository::prop_name (property_names_id_type id) const
   return m_propnames_by_id.find (id)->second;
 }
 
+size_t 
+PropertiesRepository::hash_for_properties_set (const properties_set &props)
+{
+  size_t h = props.size ();
+  for (properties_set::const_iterator nv = props.begin (); nv != props.end (); ++nv) {
+    h = hash_combine (h, size_t (nv->first));
+    h = hash_combine (h, hash_for_property_value (nv->second));
+  }
+  return h;
+}
+
+PropertiesRepository::properties_ids_by_hash_map::const_iterator
+PropertiesRepository::find_properties_set (const properties_set &props, size_t h) const
+{
+  std::pair<properties_ids_by_hash_map::const_iterator, properties_ids_by_hash_map::const_iterator> hr = m_properties_ids_by_hash.equal_range (h);
+  for (properties_ids_by_hash_map::const_iterator i = hr.first; i != hr.second; ++i) {
+    iterator p = m_properties_by_id.find (i->second);
+    if (p != m_properties_by_id.end () && p->second == props) {
+      return i;
+    }
+  }
+  return m_properties_ids_by_hash.end ();
+}
+
 properties_id_type 
 PropertiesRepository::properties_id (const properties_set &props)
 {
-  std::map <properties_set, properties_id_type>::const_iterator pi = m_properties_ids_by_set.find (props);
-  if (pi == m_properties_ids_by_set.end ()) {
+  //  fast path: the empty set is Id 0 unless Id 0 has been changed
+  if (props.empty ()) {
+    std::map <properties_id_type, properties_set>::const_iterator p0 = m_properties_by_id.begin ();
+    if (p0 != m_properties_by_id.end () && p0->first == 0 && p0->second.empty ()) {
+      return 0;
+    }
+  }
 
-    properties_id_type id = m_properties_ids_by_set.size ();
-    m_properties_ids_by_set.insert (std::make_pair (props, id));
+  size_t h = hash_for_properties_set (props);
+
+  properties_ids_by_hash_map::const_iterator pi = find_properties_set (props, h);
+  if (pi == m_properties_ids_by_hash.end ()) {
+
+    properties_id_type id = m_properties_by_id.size ();
+    m_properties_ids_by_hash.insert (std::make_pair (h, id));
     m_properties_by_id.insert (std::make_pair (id, props));
     for (properties_set::const_iterator nv = props.begin (); nv != props.end (); ++nv) {
       m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (id);
@@ -184,7 +299,7 @@ PropertiesRepository::is_valid_properties_id (properties_id_type id) const
 const PropertiesRepository::properties_id_vector &
 PropertiesRepository::properties_ids_by_name_value (const name_value_pair &nv) const
 {
-  std::map <name_value_pair, properties_id_vector>::const_iterator idv = m_properties_component_table.find (nv);
+  std::unordered_map <name_value_pair, properties_id_vector, PropertyValueHash>::const_iterator idv = m_properties_component_table.find (nv);
   if (idv == m_properties_component_table.end ()) {
     static properties_id_vector empty;
     return empty;
@@ -207,5 +322,19 @@ PropertiesRepository::translate (const PropertiesRepository &rep, properties_id_
   return properties_id (new_pset);
 }
 
+void
+PropertiesRepository::rehash ()
+{
+  m_properties_ids_by_hash.clear ();
+  m_properties_component_table.clear ();
+
+  for (iterator p = m_properties_by_id.begin (); p != m_properties_by_id.end (); ++p) {
+    m_properties_ids_by_hash.insert (std::make_pair (hash_for_properties_set (p->second), p->first));
+    for (properties_set::const_iterator nv = p->second.begin (); nv != p->second.end (); ++nv) {
+      m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (p->first);
+    }
+  }
+}
+
 } // namespace db
 
@@ -33,12 +33,38 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 namespace db
 {
 
 class LayoutStateModel;
 
+/**
+ *  @brief A hash function for property names and values
+ *
+ *  The hash value is compatible with tl::Variant's equality: values which
+ *  compare equal (i.e. an integer and a double with the same value) deliver
+ *  the same hash value.
+ */
+DB_PUBLIC size_t hash_for_property_value (const tl::Variant &v);
+
+/**
+ *  @brief A hash functor for tl::Variant objects used as property names or values
+ */
+struct PropertyValueHash
+{
+  size_t operator() (const tl::Variant &v) const
+  {
+    return hash_for_property_value (v);
+  }
+
+  size_t operator() (const std::pair<property_names_id_type, tl::Variant> &nv) const
+  {
+    return size_t (nv.first) * 31 + hash_for_property_value (nv.second);
+  }
+};
+
 /**
  *  @brief The properties repository
  *
@@ -46,6 +72,9 @@ class LayoutStateModel;
  *  an unique Id which can be stored with a object_with_properties element.
  *  For performance reasons property names (which are strings) are not
  *  stored as such but as integers.
+ *
+ *  Each property set is stored only once. The lookup of the Id for a 
+ *  given set is based on a hash of the set's name Ids and values.
  */
 
 class DB_PUBLIC PropertiesRepository
@@ -140,6 +169,9 @@ public:
 
   /**
    *  @brief Iterate over Id/Properties sets (non-const)
+   *
+   *  If the properties sets are modified through this iterator, "rehash" 
+   *  needs to be called after the modifications have been done.
    */
   non_const_iterator begin_non_const () 
   {
@@ -207,6 +239,14 @@ public:
    */
   properties_id_type translate (const PropertiesRepository &rep, properties_id_type id);
 
+  /**
+   *  @brief Rebuilds the lookup tables after the properties sets have been modified in place
+   *
+   *  This method needs to be called after the properties sets have been modified through
+   *  the non-const iterator.
+   */
+  void rehash ();
+
   /**
    *  @brief Collect memory statistics
    */
@@ -219,21 +259,26 @@ public:
     db::mem_stat (stat, purpose, cat, m_propnames_by_id, true, parent);
     db::mem_stat (stat, purpose, cat, m_propname_ids_by_name, true, parent);
     db::mem_stat (stat, purpose, cat, m_properties_by_id, true, parent);
-    db::mem_stat (stat, purpose, cat, m_properties_ids_by_set, true, parent);
+    db::mem_stat (stat, purpose, cat, m_properties_ids_by_hash, true, parent);
     db::mem_stat (stat, purpose, cat, m_properties_component_table, true, parent);
   }
 
 private:
+  typedef std::unordered_multimap <size_t, properties_id_type> properties_ids_by_hash_map;
+
   std::map <property_names_id_type, tl::Variant> m_propnames_by_id;
-  std::map <tl::Variant, property_names_id_type> m_propname_ids_by_name;
+  std::unordered_map <tl::Variant, property_names_id_type, PropertyValueHash> m_propname_ids_by_name;
 
   std::map <properties_id_type, properties_set> m_properties_by_id;
-  std::map <properties_set, properties_id_type> m_properties_ids_by_set;
-  std::map <name_value_pair, properties_id_vector> m_properties_component_table;
+  properties_ids_by_hash_map m_properties_ids_by_hash;
+  std::unordered_map <name_value_pair, properties_id_vector, PropertyValueHash> m_properties_component_table;
 
   db::LayoutStateModel *mp_state_model;
 
   PropertiesRepository (const PropertiesRepository &d);
+
+  static size_t hash_for_properties_set (const properties_set &props);
+  properties_ids_by_hash_map::const_iterator find_properties_set (const properties_set &props, size_t h) const;
 };
 
 /**
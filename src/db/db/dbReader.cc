@@ -23,6 +23,8 @@
 
 #include "dbReader.h"
 #include "dbStream.h"
+#include "dbCommonReader.h"
+#include "dbLayout.h"
 #include "tlClassRegistry.h"
 
 namespace db
@@ -74,5 +76,26 @@ Reader::~Reader ()
   }
 }
 
+const db::LayerMap &
+Reader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
+{
+  if (! options.get_options<db::CommonReaderOptions> ().arena_allocation) {
+    return mp_actual_reader->read (layout, options);
+  }
+
+  //  arena mode is enabled while reading only
+  bool use_arena = layout.shape_repository ().use_arena ();
+  layout.shape_repository ().set_use_arena (true);
+
+  try {
+    const db::LayerMap &lm = mp_actual_reader->read (layout, options);
+    layout.shape_repository ().set_use_arena (use_arena);
+    return lm;
+  } catch (...) {
+    layout.shape_repository ().set_use_arena (use_arena);
+    throw;
+  }
+}
+
 }
 
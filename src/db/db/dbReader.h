@@ -125,10 +125,7 @@ public:
    *  @param layout The layout object to write to
    *  @param options The LayerMap object
    */
-  const db::LayerMap &read (db::Layout &layout, const db::LoadLayoutOptions &options) 
-  {
-    return mp_actual_reader->read (layout, options);
-  }
+  const db::LayerMap &read (db::Layout &layout, const db::LoadLayoutOptions &options);
 
   /** 
    *  @brief The basic read method (without mapping)
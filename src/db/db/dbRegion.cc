@@ -822,6 +822,60 @@ Region::operator+= (const Region &other)
   return *this;
 }
 
+Region
+Region::boolean_expression (const std::vector<const Region *> &inputs, const db::BooleanExpression &expr)
+{
+  if (expr.layers () > inputs.size ()) {
+    throw tl::Exception (tl::to_string (tr ("Boolean expression requires %d inputs, but only %d are given")), int (expr.layers ()), int (inputs.size ()));
+  }
+
+  Region res;
+
+  const Region *first = 0;
+  size_t n = 0;
+  for (std::vector<const Region *>::const_iterator i = inputs.begin (); i != inputs.end (); ++i) {
+    if (*i && ! (*i)->empty ()) {
+      if (! first) {
+        first = *i;
+      }
+      for (const_iterator p = (*i)->begin (); ! p.at_end (); ++p) {
+        n += p->vertices ();
+      }
+    }
+  }
+
+  if (! first || expr.empty ()) {
+    //  Nothing to do
+    return res;
+  }
+
+  db::EdgeProcessor ep (first->m_report_progress, first->m_progress_desc);
+
+  ep.reserve (n);
+
+  //  insert the polygons into the processor: property modulo the number of inputs is the layer index
+  size_t nlayers = inputs.size ();
+  for (size_t l = 0; l < nlayers; ++l) {
+    if (inputs [l]) {
+      n = l;
+      for (const_iterator p = inputs [l]->begin (); ! p.at_end (); ++p, n += nlayers) {
+        ep.insert (*p, n);
+      }
+    }
+  }
+
+  db::BooleanExpressionOp op (expr, (unsigned int) nlayers);
+  db::ShapeGenerator pc (res.m_polygons, true /*clear*/);
+  db::PolygonGenerator pg (pc, false /*don't resolve holes*/, first->m_merge_min_coherence);
+  ep.process (pg, op);
+
+  res.m_is_merged = true;
+  res.invalidate_cache ();
+  res.set_valid_polygons ();
+
+  return res;
+}
+
 Region
 Region::selected_interacting_generic (const Region &other, int mode, bool touching, bool inverse) const
 {
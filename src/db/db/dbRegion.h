@@ -43,6 +43,8 @@
 
 namespace db {
 
+class BooleanExpression;
+
 /**
  *  @brief A perimeter filter for use with Region::filter or Region::filtered
  *
@@ -1196,6 +1198,17 @@ public:
    */
   Region &operator+= (const Region &other);
 
+  /**
+   *  @brief Computes a boolean expression over a number of regions in a single pass
+   *
+   *  The layer indexes of the expression refer to the regions given in "inputs".
+   *  Null pointers in "inputs" are taken as empty regions. Compared to a sequence
+   *  of individual boolean operations, no intermediate results are produced.
+   *
+   *  The result is merged.
+   */
+  static Region boolean_expression (const std::vector<const Region *> &inputs, const db::BooleanExpression &expr);
+
   /**
    *  @brief Selects all polygons of this region which are completly outside polygons from the other region
    *
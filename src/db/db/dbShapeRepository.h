@@ -30,8 +30,13 @@
 #include "dbTrans.h"
 #include "dbBox.h"
 #include "dbMemStatistics.h"
+#include "tlThreads.h"
+#include "tlArena.h"
 
-#include <set>
+#include <unordered_set>
+#include <functional>
+#include <cmath>
+#include <stdint.h>
 
 namespace db {
 
@@ -42,12 +47,171 @@ template <class C> class edge;
 template <class C> class text;
 template <class C> class user_object;
 
+/**
+ *  @brief Hash value helpers for the shape repository
+ *
+ *  These functions are templates so they can be declared before the shape
+ *  classes are defined. They must be consistent with the shape's equality
+ *  operators.
+ */
+
+/**
+ *  @brief Scrambles a hash value
+ *
+ *  Use this function to turn a hash value into a summand for order-independent
+ *  hashes of shape collections.
+ */
+inline size_t repository_hash_mix (size_t h)
+{
+  h ^= (h >> 15);
+  h *= size_t (0x9e3779b97f4a7c15ULL);
+  h ^= (h >> 13);
+  return h;
+}
+
+/**
+ *  @brief Combines a hash value with another value
+ *
+ *  NOTE: every step is scrambled. A linear combination would map small, structured
+ *  coordinate changes to identical hash values.
+ */
+inline size_t repository_hash_combine (size_t h, size_t v)
+{
+  return repository_hash_mix (h ^ (v + size_t (0x9e3779b97f4a7c15ULL) + (h << 6) + (h >> 2)));
+}
+
+inline size_t repository_hash_coord (db::Coord c)
+{
+  return size_t (c);
+}
+
+inline size_t repository_hash_coord (db::DCoord c)
+{
+  //  NOTE: the shape's equality operators compare coordinates exactly, so the hash is
+  //  taken from the exact value. 0.0 and -0.0 are equal, so they must give the same hash value.
+  return c == 0.0 ? 0 : std::hash<double> () (c);
+}
+
+template <class Iter>
+inline size_t repository_hash_points (Iter from, Iter to, size_t h)
+{
+  for ( ; from != to; ++from) {
+    h = repository_hash_combine (h, repository_hash_coord ((*from).x ()));
+    h = repository_hash_combine (h, repository_hash_coord ((*from).y ()));
+  }
+  return h;
+}
+
+template <class C>
+inline size_t repository_hash (const db::polygon<C> &p)
+{
+  size_t h = p.holes ();
+  h = repository_hash_points (p.begin_hull (), p.end_hull (), h);
+  for (unsigned int i = 0; i < p.holes (); ++i) {
+    h = repository_hash_points (p.begin_hole (i), p.end_hole (i), h);
+  }
+  return h;
+}
+
+template <class C>
+inline size_t repository_hash (const db::simple_polygon<C> &p)
+{
+  return repository_hash_points (p.begin_hull (), p.end_hull (), 0);
+}
+
+template <class C>
+inline size_t repository_hash (const db::path<C> &p)
+{
+  size_t h = repository_hash_coord (p.width ());
+  h = repository_hash_combine (h, repository_hash_coord (p.bgn_ext ()));
+  h = repository_hash_combine (h, repository_hash_coord (p.end_ext ()));
+  return repository_hash_points (p.begin (), p.end (), h);
+}
+
+template <class C>
+inline size_t repository_hash (const db::text<C> &t)
+{
+  size_t h = repository_hash_combine (size_t (t.trans ().rot ()), repository_hash_coord (t.trans ().disp ().x ()));
+  h = repository_hash_combine (h, repository_hash_coord (t.trans ().disp ().y ()));
+  for (const char *cp = t.string (); *cp; ++cp) {
+    h = repository_hash_combine (h, size_t ((unsigned char) *cp));
+  }
+  return h;
+}
+
+template <class C, class R>
+inline size_t repository_hash (const db::box<C, R> &b)
+{
+  size_t h = repository_hash_coord (b.left ());
+  h = repository_hash_combine (h, repository_hash_coord (b.bottom ()));
+  h = repository_hash_combine (h, repository_hash_coord (b.right ()));
+  return repository_hash_combine (h, repository_hash_coord (b.top ()));
+}
+
+template <class C>
+inline size_t repository_hash (const db::edge<C> &e)
+{
+  size_t h = repository_hash_coord (e.x1 ());
+  h = repository_hash_combine (h, repository_hash_coord (e.y1 ()));
+  h = repository_hash_combine (h, repository_hash_coord (e.x2 ()));
+  return repository_hash_combine (h, repository_hash_coord (e.y2 ()));
+}
+
+/**
+ *  @brief Inserts a new entry into the repository set with the point storage taken from an arena
+ *
+ *  Only polygons employ arena storage. Their entries are constructed in place, so the
+ *  point storage is built in the arena directly. Other shapes are simply inserted.
+ */
+template <class Set, class Sh>
+inline typename Set::iterator repository_insert_into_arena (Set &set, const Sh &s, tl::Arena & /*arena*/)
+{
+  return set.insert (s).first;
+}
+
+template <class Set, class C>
+inline typename Set::iterator repository_insert_into_arena (Set &set, const db::polygon<C> &p, tl::Arena &arena)
+{
+  return set.emplace (p, arena).first;
+}
+
+template <class Set, class C>
+inline typename Set::iterator repository_insert_into_arena (Set &set, const db::simple_polygon<C> &p, tl::Arena &arena)
+{
+  return set.emplace (p, arena).first;
+}
+
+/**
+ *  @brief The hash function object for the shape repository
+ */
+template <class Sh>
+struct repository_hash_func
+{
+  size_t operator() (const Sh &s) const
+  {
+    return repository_hash (s);
+  }
+};
+
 /**
  *  @brief A repository for a certain shape type
  *
  *  The repository is basically a set of shapes that
  *  can be used to store duplicates of shapes in an
  *  efficient way.
+ *
+ *  The repository is implemented as a hash set. The hash values are 
+ *  kept with the entries, so equal shapes are usually identified by a single
+ *  full comparison. Entries do not move once they are inserted, so the pointers
+ *  delivered by "insert" stay valid.
+ *
+ *  "insert" is thread-safe: multiple threads (i.e. readers running in parallel)
+ *  may insert shapes into the same repository concurrently. Iterating the 
+ *  repository while inserting is not safe.
+ *
+ *  In arena mode, the point storage of new polygon entries is taken from an arena
+ *  owned by the repository. As entries are never removed, this memory is released
+ *  in one step when the repository is cleared or destroyed.
  */
 
 template <class Sh>
@@ -55,27 +219,62 @@ class repository
 {
 public:
   typedef typename Sh::coord_type coord_type;
-  typedef std::set<Sh> set_type;
+  typedef std::unordered_set<Sh, repository_hash_func<Sh> > set_type;
   typedef typename set_type::const_iterator iterator;
 
   /** 
    *  @brief The standard constructor
    */
   repository ()
-    : m_set ()
+    : m_set (), m_use_arena (false)
   {
     //  .. nothing yet ..
   }
 
   /** 
    *  @brief The copy constructor
+   *
+   *  The entries of the copy use heap memory.
    */
   repository (const repository<Sh> &d)
-    : m_set (d.m_set)
+    : m_set (d.m_set), m_use_arena (d.m_use_arena)
   {
     //  .. nothing yet ..
   }
 
+  /** 
+   *  @brief The assignment operator
+   */
+  repository &operator= (const repository<Sh> &d)
+  {
+    if (this != &d) {
+      m_set = d.m_set;
+      //  the new entries are copies using heap memory, so the arena is no longer required
+      m_arena.clear ();
+      m_use_arena = d.m_use_arena;
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief Enables or disables arena mode
+   *
+   *  In arena mode, the point storage of new entries is allocated from an arena
+   *  rather than individually from the heap.
+   */
+  void set_use_arena (bool f)
+  {
+    m_use_arena = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether arena mode is enabled
+   */
+  bool use_arena () const
+  {
+    return m_use_arena;
+  }
+
   /**
    *  @brief Insert a shape into the repository
    *
@@ -85,7 +284,17 @@ public:
    */
   const Sh *insert (const Sh &shape)
   {
-    typename std::set<Sh>::iterator f = m_set.insert (shape).first;
+    tl::MutexLocker locker (&m_lock);
+
+    if (! m_use_arena) {
+      return &(*m_set.insert (shape).first);
+    }
+
+    //  look up first, so only new entries take memory from the arena
+    typename set_type::iterator f = m_set.find (shape);
+    if (f == m_set.end ()) {
+      f = repository_insert_into_arena (m_set, shape, m_arena);
+    }
     return &(*f);
   }
 
@@ -119,7 +328,11 @@ public:
   }
 
 private:
+  //  NOTE: the arena must be declared before the set, so the entries are destroyed first
+  tl::Arena m_arena;
   set_type m_set;
+  tl::Mutex m_lock;
+  bool m_use_arena;
 };
 
 /**
@@ -176,6 +389,25 @@ public:
     return m_text_repository;
   }
 
+  /**
+   *  @brief Enables or disables arena mode for all repositories
+   */
+  void set_use_arena (bool f)
+  {
+    m_polygon_repository.set_use_arena (f);
+    m_simple_polygon_repository.set_use_arena (f);
+    m_path_repository.set_use_arena (f);
+    m_text_repository.set_use_arena (f);
+  }
+
+  /**
+   *  @brief Gets a value indicating whether arena mode is enabled
+   */
+  bool use_arena () const
+  {
+    return m_polygon_repository.use_arena ();
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const
   {
     db::mem_stat (stat, purpose, cat, m_polygon_repository, no_self, parent);
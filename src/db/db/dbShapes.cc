@@ -222,6 +222,10 @@ Shapes::invalidate_state ()
       }
     }
   }
+
+  if (cell ()) {
+    cell ()->invalidate_content_hash ();
+  }
 }
 
 void  
@@ -1607,26 +1607,26 @@ class DB_PUBLIC_TEMPLATE layer_op
 {
 public:
   layer_op (bool insert, const Sh &sh)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
     m_shapes.reserve (1);
-    m_shapes.push_back (sh);
+    add (sh);
   }
   
   template <class Iter>
   layer_op (bool insert, Iter from, Iter to)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
-    m_shapes.insert (m_shapes.end (), from, to);
+    add (from, to);
   }
 
   template <class Iter>
   layer_op (bool insert, Iter from, Iter to, bool /*dummy*/)
-    : m_insert (insert)
+    : m_insert (insert), m_heap_size (0)
   {
     m_shapes.reserve (std::distance (from, to));
     for (Iter i = from; i != to; ++i) {
-      m_shapes.push_back (**i);
+      add (**i);
     }
   }
 
@@ -1648,13 +1648,18 @@ public:
     }
   }
 
+  virtual size_t mem_size () const
+  {
+    return sizeof (*this) + m_shapes.capacity () * sizeof (Sh) + m_heap_size;
+  }
+
   static void queue_or_append (db::Manager *manager, db::Shapes *shapes, bool insert, const Sh &sh)
   {
     db::layer_op<Sh, StableTag> *old_op = dynamic_cast <db::layer_op<Sh, StableTag> *> (manager->last_queued (shapes));
     if (! old_op || old_op->m_insert != insert) {
       manager->queue (shapes, new db::layer_op<Sh, StableTag> (insert, sh));
     } else {
-      old_op->m_shapes.push_back (sh);
+      old_op->add (sh);
     }
   }
 
@@ -1665,7 +1670,7 @@ public:
     if (! old_op || old_op->m_insert != insert) {
       manager->queue (shapes, new db::layer_op<Sh, StableTag> (insert, from, to));
     } else {
-      old_op->m_shapes.insert (old_op->m_shapes.end (), from, to);
+      old_op->add (from, to);
     }
   }
 
@@ -1677,7 +1682,7 @@ public:
       manager->queue (shapes, new db::layer_op<Sh, StableTag> (insert, from, to, dummy));
     } else {
       for (Iter i = from; i != to; ++i) {
-        old_op->m_shapes.push_back (**i);
+        old_op->add (**i);
       }
     }
   }
@@ -1685,6 +1690,30 @@ public:
 private:
   bool m_insert;
   std::vector<Sh> m_shapes;
+  //  the memory held by the shapes outside the vector (i.e. polygon points)
+  size_t m_heap_size;
+
+  void add (const Sh &sh)
+  {
+    m_shapes.push_back (sh);
+    m_heap_size += heap_size (sh);
+  }
+
+  template <class Iter>
+  void add (Iter from, Iter to)
+  {
+    m_shapes.insert (m_shapes.end (), from, to);
+    for (Iter i = from; i != to; ++i) {
+      m_heap_size += heap_size (*i);
+    }
+  }
+
+  static size_t heap_size (const Sh &sh)
+  {
+    db::MemStatisticsSum ms;
+    db::mem_stat (&ms, db::MemStatistics::None, 0, sh, true);
+    return ms.size ();
+  }
 
   void insert (Shapes *shapes);
   void erase (Shapes *shapes);
@@ -734,8 +734,6 @@ TilingProcessor::receiver (const std::vector<tl::Variant> &args)
 void 
 TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, const std::vector<tl::Variant> &args)
 {
-  tl::MutexLocker locker (&m_output_mutex);
-
   if (args.size () < 2 || args.size () > 3) {
     throw tl::Exception (tl::to_string (tr ("_output function requires two or three arguments: handle and object and a clip flag (optional)")));
   }
@@ -747,7 +745,15 @@ TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, const std::vect
     throw tl::Exception (tl::to_string (tr ("Invalid handle (first argument) in _output function call")));
   }
 
-  m_outputs[index].receiver->put (ix, iy, tile, m_outputs[index].id, args[1], dbu (), m_outputs[index].trans, clip);
+  OutputSpec &spec = m_outputs[index];
+
+  //  receivers capable of concurrent delivery synchronize themselves
+  if (spec.receiver->concurrent_put ()) {
+    spec.receiver->put (ix, iy, tile, spec.id, args[1], dbu (), spec.trans, clip);
+  } else {
+    tl::MutexLocker locker (&m_output_mutex);
+    spec.receiver->put (ix, iy, tile, spec.id, args[1], dbu (), spec.trans, clip);
+  }
 }
 
 void  
@@ -892,6 +898,8 @@ TilingProcessor::execute (const std::string &desc)
       }
 
     } catch (...) {
+      //  stop the workers before finishing the receivers - otherwise "put" may still be called
+      job.terminate ();
       for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
         if (o->receiver) {
           o->receiver->finish (false);
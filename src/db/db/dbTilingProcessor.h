@@ -86,11 +86,23 @@ public:
    */
   virtual void begin (size_t /*nx*/, size_t /*ny*/, const db::DPoint &/*p0*/, double /*dx*/, double /*dy*/, const db::DBox & /*frame*/) { }
 
+  /**
+   *  @brief Returns a value indicating whether the receiver accepts concurrent deliveries
+   *
+   *  By default, delivery is serialized. Receivers which return true here are
+   *  called from the worker threads without holding the output mutex and are
+   *  responsible for synchronizing "put" themselves.
+   */
+  virtual bool concurrent_put () const
+  {
+    return false;
+  }
+
   /**
    *  @brief Deliver an object for one tile
    *
-   *  Delivery is protected by a mutex - only one thread will access the 
-   *  receiver at one time.
+   *  Unless "concurrent_put" returns true, delivery is protected by a mutex - only
+   *  one thread will access the receiver at one time.
    *
    *  The interpretation of the object remains subject to the implementation.
    *
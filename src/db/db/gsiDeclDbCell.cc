@@ -2550,6 +2550,28 @@ Class<db::Cell> decl_Cell ("db", "Cell",
     "\n"
     "The bounding box is the box enclosing all shapes on the given layer.\n"
   ) +
+  gsi::method ("content_hash", (size_t (db::Cell::*) () const) &db::Cell::content_hash,
+    "@brief Gets a hash value for the content of the cell\n"
+    "\n"
+    "The content hash is computed from the shapes of the cell and the child cell instances. Child cells enter "
+    "the hash through their own content hash, so the names of the cells do not matter. The order of shapes and "
+    "instances does not matter either. Properties enter the hash through their names and values and layers "
+    "through their layer properties. Hence the hash can be used to compare cells across layouts.\n"
+    "\n"
+    "Identical cells have identical content hashes, but identical hashes do not guarantee identical cells. "
+    "The hash reflects the hierarchy, so the same geometry organized in different hierarchies will give different hashes. "
+    "Empty cells have a hash of 0. Content hashes are cached and recomputed when the cell or one of its child cells changes.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
+  gsi::method ("content_hash", (size_t (db::Cell::*) (unsigned int) const) &db::Cell::content_hash, gsi::arg ("layer_index"),
+    "@brief Gets a hash value for the content of the cell on the given layer\n"
+    "\n"
+    "This hash is computed from the shapes on the given layer in this cell and the child cells. It is 0 "
+    "if the cell and its child cells do not have shapes on this layer. See \\content_hash for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
   gsi::method_ext ("dbbox", &cell_dbbox,
     "@brief Gets the bounding box of the cell in micrometer units\n"
     "\n"
@@ -84,6 +84,46 @@ static void set_properties_enabled (db::LoadLayoutOptions *options, bool l)
   options->get_options<db::CommonReaderOptions> ().enable_properties = l;
 }
 
+static bool get_cell_deduplication_enabled (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::CommonReaderOptions> ().deduplicate_cells;
+}
+
+static void set_cell_deduplication_enabled (db::LoadLayoutOptions *options, bool l)
+{
+  options->get_options<db::CommonReaderOptions> ().deduplicate_cells = l;
+}
+
+static unsigned int get_pcell_threads (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::CommonReaderOptions> ().pcell_threads;
+}
+
+static void set_pcell_threads (db::LoadLayoutOptions *options, unsigned int n)
+{
+  options->get_options<db::CommonReaderOptions> ().pcell_threads = n;
+}
+
+static bool get_pack_polygons (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::CommonReaderOptions> ().pack_polygons;
+}
+
+static void set_pack_polygons (db::LoadLayoutOptions *options, bool f)
+{
+  options->get_options<db::CommonReaderOptions> ().pack_polygons = f;
+}
+
+static bool get_arena_allocation (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::CommonReaderOptions> ().arena_allocation;
+}
+
+static void set_arena_allocation (db::LoadLayoutOptions *options, bool f)
+{
+  options->get_options<db::CommonReaderOptions> ().arena_allocation = f;
+}
+
 //  extend lay::LoadLayoutOptions with the Common options
 static
 gsi::ClassExt<db::LoadLayoutOptions> common_reader_options (
@@ -154,6 +194,64 @@ gsi::ClassExt<db::LoadLayoutOptions> common_reader_options (
     "@param enabled True, if properties should be read."
     "\n"
     "Starting with version 0.25 this option only applies to GDS2 and OASIS format. Other formats provide their own configuration."
+  ) +
+  gsi::method_ext ("cell_deduplication_enabled?", &get_cell_deduplication_enabled,
+    "@brief Gets a value indicating whether identical cells are merged after reading\n"
+    "See \\cell_deduplication_enabled= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 and OASIS format."
+  ) +
+  gsi::method_ext ("cell_deduplication_enabled=", &set_cell_deduplication_enabled, gsi::arg ("enabled"),
+    "@brief Specifies whether identical cells are merged after reading\n"
+    "If this option is enabled, \\Layout#deduplicate_cells is called after the file has been read. "
+    "Instances of identical cells are redirected to a single copy and the duplicates are deleted. "
+    "Note that this also applies to cells which have been present in the layout before.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 and OASIS format."
+  ) +
+  gsi::method_ext ("pcell_threads", &get_pcell_threads,
+    "@brief Gets the number of threads used for producing library PCell variants\n"
+    "See \\pcell_threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 format."
+  ) +
+  gsi::method_ext ("pcell_threads=", &set_pcell_threads, gsi::arg ("threads"),
+    "@brief Sets the number of threads used for producing library PCell variants\n"
+    "If this value is larger than 0, the library PCell variants referenced by the file are produced "
+    "in one go before the cells are read. Variants of PCells which support parallel production are produced "
+    "using the given number of threads. PCells implemented in scripts are always produced one by one.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 format."
+  ) +
+  gsi::method_ext ("pack_polygons?", &get_pack_polygons,
+    "@brief Gets a value indicating whether the polygons read are stored in packed form\n"
+    "See \\pack_polygons= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 and OASIS format."
+  ) +
+  gsi::method_ext ("pack_polygons=", &set_pack_polygons, gsi::arg ("flag"),
+    "@brief Specifies whether the polygons read shall be stored in packed form\n"
+    "If this flag is set to true, the points of polygons are stored as compressed coordinate differences. "
+    "This saves memory for layouts with many polygons having many points (e.g. flat post-OPC data), "
+    "but makes access to the points somewhat slower. Polygons which do not benefit from packing are "
+    "stored in the normal way. Polygons created from packed polygons by transformations or other operations "
+    "are not packed.\n"
+    "\n"
+    "This method has been introduced in version 0.26. It applies to GDS2 and OASIS format."
+  ) +
+  gsi::method_ext ("arena_allocation?", &get_arena_allocation,
+    "@brief Gets a value indicating whether arena allocation is used for the polygons read\n"
+    "See \\arena_allocation= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
+  gsi::method_ext ("arena_allocation=", &set_arena_allocation, gsi::arg ("flag"),
+    "@brief Specifies whether arena allocation shall be used for the polygons read\n"
+    "If this flag is set to true, the point storage of the polygons read is allocated from big memory chunks "
+    "owned by the layout rather than individually. This reduces the memory overhead and fragmentation "
+    "for layouts with many polygons. The memory is released when the layout is cleared or destroyed.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
   ),
   ""
 );
@@ -661,6 +661,11 @@ static db::Layout *editable_layout_default_ctor(bool editable)
   return new db::Layout (editable);
 }
 
+static size_t deduplicate_cells (db::Layout *layout)
+{
+  return db::deduplicate_cells (*layout);
+}
+
 static db::cell_index_type add_lib_pcell_variant (db::Layout *layout, db::Library *lib, db::pcell_id_type pcell_id, const std::vector<tl::Variant> &parameters)
 {
   db::cell_index_type lib_cell = lib->layout ().get_pcell_variant (pcell_id, parameters);
@@ -1261,7 +1266,43 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "@brief Updates the internals of the layout\n"
     "This method updates the internal state of the layout. Usually this is done automatically\n"
     "This method is provided to ensure this explicitly. This can be useful while using \\start_changes and \\end_changes to wrap a performance-critical operation. "
-    "See \\start_changes for more details."
+    "See \\start_changes for more details.\n"
+    "\n"
+    "After \\update, read-only queries (shape and instance iteration, region queries, bounding boxes) do not modify "
+    "the layout object any more. This allows sharing a large layout between processes: read the layout once, "
+    "call \\update and then fork the worker processes (e.g. with Python's \"multiprocessing\" module and the \"fork\" start method). "
+    "The workers will share the layout's memory pages copy-on-write as long as they do not modify the layout. "
+    "Non-editable layouts (see \\is_editable?) are more compact and are recommended for this purpose.\n"
+  ) +
+  gsi::method ("content_hash", &db::Layout::content_hash,
+    "@brief Gets a hash value for the content of the layout\n"
+    "\n"
+    "This hash is a combination of the content hashes of the top cells. See \\Cell#content_hash for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
+  gsi::method_ext ("deduplicate_cells", &deduplicate_cells,
+    "@brief Replaces identical cells by a single copy\n"
+    "@return The number of cells removed\n"
+    "\n"
+    "This method looks for cells with identical shapes and child instances. The instances of such duplicates "
+    "are redirected to a single copy - the one with the lowest cell index - and the duplicates are deleted. "
+    "Cell names do not matter, so this method is useful to remove identical cells which are present under different "
+    "names after merging layouts. Candidates are found by their content hash (see \\Cell#content_hash) and are "
+    "verified by a full compare.\n"
+    "\n"
+    "Top cells, empty cells, ghost cells and library or PCell proxies are not considered.\n"
+    "See also \\LoadLayoutOptions#cell_deduplication_enabled= for running this method automatically after reading a file.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
+  gsi::method ("invalidate_content_hashes", &db::Layout::invalidate_content_hashes,
+    "@brief Invalidates the cached content hashes of all cells\n"
+    "\n"
+    "The content hashes are invalidated automatically when shapes or instances change. Calling this method "
+    "is only required if the properties of existing properties IDs have been modified.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
   ) +
   gsi::method ("cleanup", &db::Layout::cleanup,
     "@brief Cleans up the layout\n"
@@ -1717,7 +1758,7 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "variant with two parameters automatically determines the compression mode from the file name. "
     "The gzip parameter is ignored staring with version 0.23.\n"
   ) +
-  gsi::method_ext ("write", &write_options1,
+  gsi::allow_threads (gsi::method_ext ("write", &write_options1,
     "@brief Writes the layout to a stream file\n"
     "@args filename, options\n"
     "@param filename The file to which to write the layout\n"
@@ -1727,12 +1768,12 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "The file is written with zlib compression if the suffix is \".gz\" or \".gzip\".\n"
     "\n"
     "This variant has been introduced in version 0.23.\n"
-  ) +
-  gsi::method_ext ("write", &write_simple,
+  )) +
+  gsi::allow_threads (gsi::method_ext ("write", &write_simple,
     "@brief Writes the layout to a stream file\n"
     "@args filename\n"
     "@param filename The file to which to write the layout\n"
-  ) + 
+  )) + 
   gsi::method_ext ("clip", &clip,
     "@brief Clips the given cell by the given rectangle and produce a new cell with the clip\n"
     "@args cell, box\n"
@@ -1863,6 +1904,15 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "\n"
     "This method has been introduced in version 0.22.\n"
   ) +  
+  gsi::method ("add_pcell_variants", &db::Layout::get_pcell_variants, gsi::arg ("pcell_id"), gsi::arg ("parameters"), gsi::arg ("threads"),
+    "@brief Creates multiple PCell variants for the given PCell ID in one go\n"
+    "@return The cell indexes of the pcell variant proxy cells in the order of the parameter sets\n"
+    "This method is equivalent to calling \\add_pcell_variant for each parameter set (a list of parameter values). "
+    "New variants of PCells which support parallel production are produced with the given number of threads. "
+    "PCells implemented in scripts are always produced one by one.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
   gsi::method_ext ("add_pcell_variant", &add_lib_pcell_variant_dict,
     "@brief Creates a PCell variant for a PCell located in an external library with the parameters given as a name/value dictionary\n"
     "@args library, pcell_id, parameters\n"
@@ -37,11 +37,22 @@ class LayoutDiff
 public:
   LayoutDiff ()
     : mp_layout_a (0), mp_cell_a (0), m_layer_index_a (0),
-      mp_layout_b (0), mp_cell_b (0), m_layer_index_b (0)
+      mp_layout_b (0), mp_cell_b (0), m_layer_index_b (0),
+      m_threads (0)
   {
     // .. nothing yet ..
   }
 
+  void set_threads (int n)
+  {
+    m_threads = std::max (0, n);
+  }
+
+  int threads () const
+  {
+    return m_threads;
+  }
+
   bool compare_layouts (const db::Layout *a, const db::Layout *b, unsigned int flags, db::Coord tolerance)
   {
     if (!a || !b) {
@@ -53,7 +64,7 @@ public:
     mp_layout_a = a;
     mp_layout_b = b;
     try {
-      res = db::compare_layouts(*a, *b, flags, tolerance, *this);
+      res = db::compare_layouts(*a, *b, flags, tolerance, *this, (unsigned int) m_threads);
       mp_layout_a = mp_layout_b = 0;
     } catch (...) {
       mp_layout_a = mp_layout_b = 0;
@@ -76,7 +87,7 @@ public:
     tl_assert (mp_layout_b != 0);
 
     try {
-      res = db::compare_layouts(*mp_layout_a, a->cell_index (), *mp_layout_b, b->cell_index (), flags, tolerance, *this);
+      res = db::compare_layouts(*mp_layout_a, a->cell_index (), *mp_layout_b, b->cell_index (), flags, tolerance, *this, (unsigned int) m_threads);
       mp_layout_a = mp_layout_b = 0;
     } catch (...) {
       mp_layout_a = mp_layout_b = 0;
@@ -367,6 +378,7 @@ private:
   const db::Layout *mp_layout_b;
   const db::Cell *mp_cell_b;
   int m_layer_index_b;
+  int m_threads;
 };
 
 }
@@ -431,6 +443,10 @@ static unsigned int f_no_text_details () {
   return db::layout_diff::f_no_text_details;
 }
 
+static unsigned int f_hash_prefilter () {
+  return db::layout_diff::f_hash_prefilter;
+}
+
 gsi::Class<LayoutDiff> decl_LayoutDiff ("db", "LayoutDiff",
   gsi::constant ("Silent", &f_silent,
     "@brief Silent compare - just report whether the layouts are identical\n"
@@ -501,6 +517,17 @@ gsi::Class<LayoutDiff> decl_LayoutDiff ("db", "LayoutDiff",
     "This constant can be used for the flags parameter of \\compare_layouts and \\compare_cells. It can be "
     "compared with other contants to form a flag set."
   ) +
+  gsi::constant ("HashPrefilter", &f_hash_prefilter,
+    "@brief Skips the detailed compare of layers with identical content hashes\n"
+    "With this flag, layers whose shapes deliver the same content hash are taken as identical and "
+    "are not compared in detail. This is faster, but probabilistic: in the rare case of a hash collision, "
+    "differences are not reported. The flag is ignored if a tolerance is specified.\n"
+    "\n"
+    "This constant can be used for the flags parameter of \\compare_layouts and \\compare_cells. It can be "
+    "compared with other contants to form a flag set.\n"
+    "\n"
+    "This constant has been introduced in version 0.26."
+  ) +
   gsi::method ("compare", &LayoutDiff::compare_layouts,
     gsi::arg("a"),
     gsi::arg("b"),
@@ -537,6 +564,20 @@ gsi::Class<LayoutDiff> decl_LayoutDiff ("db", "LayoutDiff",
     "\n"
     "@return True, if the cells are identical\n"
   ) +
+  gsi::method ("threads=", &LayoutDiff::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for the compare\n"
+    "If this value is larger than 0, the cells are compared in parallel using the given number of threads. "
+    "The events are delivered in the same order than for the single-threaded compare and from the "
+    "thread which called \\compare. The default value is 0 (single-threaded compare).\n"
+    "\n"
+    "This attribute has been introduced in version 0.26."
+  ) +
+  gsi::method ("threads", &LayoutDiff::threads,
+    "@brief Gets the number of threads to use for the compare\n"
+    "See \\threads= for details.\n"
+    "\n"
+    "This attribute has been introduced in version 0.26."
+  ) +
   gsi::method ("layout_a", &LayoutDiff::layout_a,
     "@brief Gets the first layout the difference detector runs on"
   ) +
@@ -28,6 +28,7 @@
 #include "dbPCellDeclaration.h"
 #include "dbLibrary.h"
 #include "dbLibraryManager.h"
+#include "dbPCellVariantCache.h"
 
 namespace gsi
 {
@@ -68,6 +69,16 @@ static void delete_lib (db::Library *lib)
   db::LibraryManager::instance ().delete_lib (lib);
 }
 
+static void set_pcell_cache_path (const std::string &path)
+{
+  db::PCellVariantCache::set_path (path);
+}
+
+static std::string pcell_cache_path ()
+{
+  return db::PCellVariantCache::path ();
+}
+
 Class<db::Library> decl_Library ("db", "Library",
   gsi::constructor ("new", &new_lib,
     "@brief Creates a new, empty library"
@@ -99,6 +110,26 @@ Class<db::Library> decl_Library ("db", "Library",
     "\n"
     "This method has been introduced in version 0.25.\n"
   ) +
+  gsi::method ("pcell_cache_path=", &set_pcell_cache_path, gsi::arg ("path"),
+    "@brief Sets the directory of the PCell variant cache\n"
+    "\n"
+    "If a directory is given, the geometry produced by library PCells is kept in files inside this directory. "
+    "When the same variant is required again - for example when a layout using this variant is loaded - "
+    "the geometry is taken from the cache instead of running the PCell code. The entries are keyed by "
+    "library name, PCell name, database unit and parameters. Only variants consisting of boxes, polygons, "
+    "paths and texts without properties are cached.\n"
+    "\n"
+    "The cache cannot detect changes of the PCell code. Hence, the directory needs to be cleared when "
+    "the PCell implementation changes. An empty string disables the cache (the default).\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method ("pcell_cache_path", &pcell_cache_path,
+    "@brief Gets the directory of the PCell variant cache\n"
+    "See \\pcell_cache_path= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
   gsi::method ("name", &db::Library::get_name, 
     "@brief Returns the libraries' name\n"
     "The name is set when the library is registered and cannot be changed\n"
@@ -118,6 +118,29 @@ Class<db::Manager> decl_Manager ("db", "Manager",
   ) +
   gsi::method_ext ("transaction_for_redo", &transaction_for_redo,
     "@brief Return the description of the next transaction for 'redo'\n"
+  ) +
+  gsi::method ("max_memory=", &db::Manager::set_max_memory,
+    "@brief Sets the memory limit for the undo/redo history\n"
+    "@args bytes\n"
+    "\n"
+    "The limit is given in bytes and applies to the estimated memory required to hold the "
+    "undo/redo information. A value of 0 disables the limit (the default). "
+    "If the limit is exceeded, the oldest transactions are discarded. If a single transaction "
+    "exceeds the limit, recording stops for this transaction: the operations are still performed, "
+    "but the transaction cannot be undone.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method ("max_memory", &db::Manager::max_memory,
+    "@brief Gets the memory limit for the undo/redo history\n"
+    "See \\max_memory= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method ("memory", &db::Manager::memory,
+    "@brief Gets the estimated memory in bytes used by the undo/redo history\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
   ),
   "@brief A transaction manager class\n"
   "\n"
@@ -27,10 +27,42 @@
 #include "dbPolygonTools.h"
 #include "dbPolygonGenerators.h"
 #include "dbHash.h"
+#include "tlInternational.h"
 
 namespace gsi
 {
 
+// ---------------------------------------------------------------
+//  bulk coordinate access for contours
+
+template <class Contour>
+static std::vector<typename Contour::coord_type> contour_to_coords (const Contour &ctr)
+{
+  std::vector<typename Contour::coord_type> coords;
+  coords.reserve (ctr.size () * 2);
+  for (size_t i = 0; i < ctr.size (); ++i) {
+    typename Contour::point_type p = ctr [i];
+    coords.push_back (p.x ());
+    coords.push_back (p.y ());
+  }
+  return coords;
+}
+
+template <class P>
+static std::vector<P> coords_to_points (const std::vector<typename P::coord_type> &coords)
+{
+  if (coords.size () % 2 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The number of coordinates must be even (x and y for each point)")));
+  }
+
+  std::vector<P> pts;
+  pts.reserve (coords.size () / 2);
+  for (size_t i = 0; i < coords.size (); i += 2) {
+    pts.push_back (P (coords [i], coords [i + 1]));
+  }
+  return pts;
+}
+
 // ---------------------------------------------------------------
 //  simple polygon binding
 
@@ -75,6 +107,16 @@ struct simple_polygon_defs
     return c->hull ().size ();
   }
 
+  static std::vector<coord_type> coords (const C *c)
+  {
+    return contour_to_coords (c->hull ());
+  }
+
+  static void set_coords (C *c, const std::vector<coord_type> &coords, bool raw)
+  {
+    set_points (c, coords_to_points<point_type> (coords), raw);
+  }
+
   static C *from_string (const char *s)
   {
     tl::Extractor ex (s);
@@ -332,6 +374,25 @@ struct simple_polygon_defs
     iterator ("each_point", &C::begin_hull, &C::end_hull, 
       "@brief Iterate over the points that make up the simple polygon"
     ) +
+    method_ext ("coords", &coords,
+      "@brief Gets the points of the simple polygon as a flat list of coordinates\n"
+      "\n"
+      "The list contains the x and y coordinates of the points in the order x1, y1, x2, y2 ... "
+      "This method is considerably faster than \\each_point for large polygons as it "
+      "does not create a point object per vertex.\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
+    method_ext ("set_coords", &set_coords, gsi::arg ("coords"), gsi::arg ("raw", false),
+      "@brief Sets the points of the simple polygon from a flat list of coordinates\n"
+      "\n"
+      "@param coords The x and y coordinates of the points in the order x1, y1, x2, y2 ...\n"
+      "@param raw If true, the points are taken as they are\n"
+      "\n"
+      "This is the counterpart of \\coords. The number of coordinates must be even.\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
     iterator ("each_edge", &C::begin_edge, 
       "@brief Iterate over the edges that make up the simple polygon"
     ) +
@@ -901,6 +962,35 @@ struct polygon_defs
     return c->contour (n + 1).size ();
   }
 
+  static std::vector<coord_type> hull_coords (const C *c)
+  {
+    return contour_to_coords (c->hull ());
+  }
+
+  static std::vector<coord_type> hole_coords (const C *c, unsigned int n)
+  {
+    if (c->holes () > n) {
+      return contour_to_coords (c->hole (n));
+    } else {
+      return std::vector<coord_type> ();
+    }
+  }
+
+  static void set_hull_coords (C *c, const std::vector<coord_type> &coords, bool raw)
+  {
+    set_hull (c, coords_to_points<point_type> (coords), raw);
+  }
+
+  static void insert_hole_coords (C *c, const std::vector<coord_type> &coords, bool raw)
+  {
+    std::vector<point_type> pts = coords_to_points<point_type> (coords);
+    if (raw) {
+      c->insert_hole (pts.begin (), pts.end (), false);
+    } else {
+      c->insert_hole (pts.begin (), pts.end ());
+    }
+  }
+
   static void insert_hole (C *c, const std::vector<point_type> &pts, bool raw)
   {
     if (raw) {
@@ -1237,6 +1327,40 @@ struct polygon_defs
       "@args n\n"
       "The hole number must be less than the number of holes (see \\holes)"
     ) +
+    method_ext ("hull_coords", &hull_coords,
+      "@brief Gets the points of the hull as a flat list of coordinates\n"
+      "\n"
+      "The list contains the x and y coordinates of the points in the order x1, y1, x2, y2 ... "
+      "This method is considerably faster than \\each_point_hull for large polygons as it "
+      "does not create a point object per vertex.\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
+    method_ext ("hole_coords", &hole_coords, gsi::arg ("n"),
+      "@brief Gets the points of the nth hole as a flat list of coordinates\n"
+      "\n"
+      "See \\hull_coords for details. If the hole index is not valid, an empty list is returned.\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
+    method_ext ("set_hull_coords", &set_hull_coords, gsi::arg ("coords"), gsi::arg ("raw", false),
+      "@brief Sets the hull from a flat list of coordinates\n"
+      "\n"
+      "@param coords The x and y coordinates of the points in the order x1, y1, x2, y2 ...\n"
+      "@param raw If true, the points are taken as they are (see \\assign_hull)\n"
+      "\n"
+      "This is the counterpart of \\hull_coords. The number of coordinates must be even.\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
+    method_ext ("insert_hole_coords", &insert_hole_coords, gsi::arg ("coords"), gsi::arg ("raw", false),
+      "@brief Inserts a hole from a flat list of coordinates\n"
+      "\n"
+      "@param coords The x and y coordinates of the points in the order x1, y1, x2, y2 ...\n"
+      "@param raw If true, the points are taken as they are (see \\insert_hole)\n"
+      "\n"
+      "This method has been added in version 0.26.\n"
+    ) +
     method_ext ("size", &size_xy,
       "@brief Sizing (biasing)\n"
       "@args dx, dy, mode\n"
@@ -23,6 +23,7 @@
 #include "gsiDecl.h"
 
 #include "dbRegion.h"
+#include "dbEdgeProcessor.h"
 #include "dbPolygonTools.h"
 #include "dbLayoutUtils.h"
 #include "dbShapes.h"
@@ -262,6 +263,11 @@ static void insert_r (db::Region *r, const db::Region &a)
   }
 }
 
+static db::Region boolean_expression (const std::vector<const db::Region *> &inputs, const std::string &expr)
+{
+  return db::Region::boolean_expression (inputs, db::BooleanExpression (expr));
+}
+
 template <class Trans>
 static void insert_st (db::Region *r, const db::Shapes &a, const Trans &t)
 {
@@ -991,12 +997,12 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
   ) +
-  method ("strange_polygon_check", &db::Region::strange_polygon_check, 
+  allow_threads (method ("strange_polygon_check", &db::Region::strange_polygon_check, 
     "@brief Returns a region containing those parts of polygons which are \"strange\"\n"
     "Strange parts of polygons are self-overlapping parts or non-orientable parts (i.e. in the \"8\" configuration).\n"
     "\n"
     "Merged semantics does not apply for this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
+  )) +
   method ("snapped", &db::Region::snapped, 
     "@brief Returns the snapped region\n"
     "@args gx, gy\n"
@@ -1012,7 +1018,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
   ) +
-  method ("grid_check", &db::Region::grid_check, 
+  allow_threads (method ("grid_check", &db::Region::grid_check, 
     "@brief Returns a marker for all vertices not being on the given grid\n"
     "@args gx, gy\n"
     "This method will return an edge pair object for every vertex whose x coordinate is not a multiple of gx or whose "
@@ -1022,7 +1028,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "If gx or gy is 0 or less, the grid is not checked in that direction.\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
+  )) +
   method_ext ("with_angle", angle_check1, 
     "@brief Returns markers on every corner with the given angle (or not with the given angle)\n"
     "@args angle, inverse\n"
@@ -1179,15 +1185,15 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "This function has been introduced in version 0.25.\n"
   ) +
-  method ("merge", (db::Region &(db::Region::*) ()) &db::Region::merge,
+  allow_threads (method ("merge", (db::Region &(db::Region::*) ()) &db::Region::merge,
     "@brief Merge the region\n"
     "\n"
     "@return The region after is has been merged (self).\n"
     "\n"
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing\n"
-  ) +
-  method_ext ("merge", &merge_ext1,
+  )) +
+  allow_threads (method_ext ("merge", &merge_ext1,
     "@brief Merge the region with options\n"
     "\n"
     "@args min_wc\n"
@@ -1200,8 +1206,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "This method is equivalent to \"merge(false, min_wc).\n"
-  ) +
-  method_ext ("merge", &merge_ext2,
+  )) +
+  allow_threads (method_ext ("merge", &merge_ext2,
     "@brief Merge the region with options\n"
     "\n"
     "@args min_coherence, min_wc\n"
@@ -1214,8 +1220,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "resolved by producing separate polygons. \"min_wc\" controls whether output is only produced if multiple "
     "polygons overlap. The value specifies the number of polygons that need to overlap. A value of 2 "
     "means that output is only produced if two or more polygons overlap.\n"
-  ) +
-  method ("merged", (db::Region (db::Region::*) () const) &db::Region::merged,
+  )) +
+  allow_threads (method ("merged", (db::Region (db::Region::*) () const) &db::Region::merged,
     "@brief Returns the merged region\n"
     "\n"
     "@return The region after is has been merged.\n"
@@ -1223,8 +1229,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing.\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
-  method_ext ("merged", &merged_ext1,
+  )) +
+  allow_threads (method_ext ("merged", &merged_ext1,
     "@brief Returns the merged region (with options)\n"
     "@args min_wc\n"
     "\n"
@@ -1237,8 +1243,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is equivalent to \"merged(false, min_wc)\".\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
-  method_ext ("merged", &merged_ext2,
+  )) +
+  allow_threads (method_ext ("merged", &merged_ext2,
     "@brief Returns the merged region (with options)\n"
     "\n"
     "@args min_coherence, min_wc\n"
@@ -1253,7 +1259,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
+  )) +
   method ("round_corners", &db::Region::round_corners,
     "@brief Corner rounding\n"
     "@args r_inner, r_outer, n\n"
@@ -1298,7 +1304,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "See \\smooth for a description of this method. This version returns a new region instead of "
     "modifying self (out-of-place). It has been introduced in version 0.25."
   ) +
-  method ("size", (db::Region & (db::Region::*) (db::Coord, db::Coord, unsigned int)) &db::Region::size,
+  allow_threads (method ("size", (db::Region & (db::Region::*) (db::Coord, db::Coord, unsigned int)) &db::Region::size,
     "@brief Anisotropic sizing (biasing)\n"
     "\n"
     "@args dx, dy, mode\n"
@@ -1327,8 +1333,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "r.merge(false, 1)\n"
     "# r now is (50,-50;50,100;100,100;100,-50)\n"
     "@/code\n"
-  ) + 
-  method ("size", (db::Region & (db::Region::*) (db::Coord, unsigned int)) &db::Region::size,
+  )) + 
+  allow_threads (method ("size", (db::Region & (db::Region::*) (db::Coord, unsigned int)) &db::Region::size,
     "@brief Isotropic sizing (biasing)\n"
     "\n"
     "@args d, mode\n"
@@ -1337,8 +1343,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is equivalent to \"size(d, d, mode)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
-  method_ext ("size", size_ext,
+  )) + 
+  allow_threads (method_ext ("size", size_ext,
     "@brief Isotropic sizing (biasing)\n"
     "\n"
     "@args d, mode\n"
@@ -1347,8 +1353,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is equivalent to \"size(d, d, 2)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
-  method ("sized", (db::Region (db::Region::*) (db::Coord, db::Coord, unsigned int) const) &db::Region::sized,
+  )) + 
+  allow_threads (method ("sized", (db::Region (db::Region::*) (db::Coord, db::Coord, unsigned int) const) &db::Region::sized,
     "@brief Returns the anisotropically sized region\n"
     "\n"
     "@args dx, dy, mode\n"
@@ -1357,8 +1363,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is returns the sized region (see \\size), but does not modify self.\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
-  method ("sized", (db::Region (db::Region::*) (db::Coord, unsigned int) const) &db::Region::sized,
+  )) + 
+  allow_threads (method ("sized", (db::Region (db::Region::*) (db::Coord, unsigned int) const) &db::Region::sized,
     "@brief Returns the isotropically sized region\n"
     "\n"
     "@args d, mode\n"
@@ -1367,8 +1373,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is returns the sized region (see \\size), but does not modify self.\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
-  method_ext ("sized", sized_ext,
+  )) + 
+  allow_threads (method_ext ("sized", sized_ext,
     "@brief Isotropic sizing (biasing)\n"
     "\n"
     "@args d, mode\n"
@@ -1377,8 +1383,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method is equivalent to \"sized(d, d, 2)\".\n"
     "\n"
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
-  ) + 
-  method ("&", &db::Region::operator&,
+  )) + 
+  allow_threads (method ("&", &db::Region::operator&,
     "@brief Returns the boolean AND between self and the other region\n"
     "\n"
     "@args other\n"
@@ -1386,7 +1392,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "This method will compute the boolean AND (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  )) + 
   method ("&=", &db::Region::operator&=,
     "@brief Performs the boolean AND between self and the other region\n"
     "\n"
@@ -1396,7 +1402,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method will compute the boolean AND (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
   ) + 
-  method ("-", &db::Region::operator-,
+  allow_threads (method ("-", &db::Region::operator-,
     "@brief Returns the boolean NOT between self and the other region\n"
     "\n"
     "@args other\n"
@@ -1404,7 +1410,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "This method will compute the boolean NOT (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  )) + 
   method ("-=", &db::Region::operator-=,
     "@brief Performs the boolean NOT between self and the other region\n"
     "\n"
@@ -1414,7 +1420,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "This method will compute the boolean NOT (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
   ) + 
-  method ("^", &db::Region::operator^,
+  allow_threads (method ("^", &db::Region::operator^,
     "@brief Returns the boolean NOT between self and the other region\n"
     "\n"
     "@args other\n"
@@ -1422,7 +1428,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "This method will compute the boolean XOR (intersection) between two regions. "
     "The result is often but not necessarily always merged.\n"
-  ) + 
+  )) + 
   method ("^=", &db::Region::operator^=,
     "@brief Performs the boolean XOR between self and the other region\n"
     "\n"
@@ -1468,6 +1474,23 @@ Class<db::Region> decl_Region ("db", "Region",
     "This operator adds the polygons of the other region to self. "
     "This usually creates unmerged regions and polygons may overlap. Use \\merge if you want to ensure the result region is merged.\n"
   ) + 
+  method ("boolean_expression", &boolean_expression, gsi::arg ("inputs"), gsi::arg ("expression"),
+    "@brief Computes a boolean expression over a number of regions in a single pass\n"
+    "\n"
+    "@param inputs The input regions\n"
+    "@param expression The boolean expression\n"
+    "@return The resulting region\n"
+    "\n"
+    "The expression uses the index of the input region in \"inputs\" as terms and "
+    "\"&\" (AND), \"|\" (OR), \"^\" (XOR) and \"-\" (NOT) as operators. \"&\" binds stronger than the other operators. "
+    "Brackets can be used for grouping. For example, \"(0|1)-(2&3)\" computes \"(a | b) - (c & d)\" with a, b, c and d "
+    "being the first four inputs.\n"
+    "\n"
+    "This method is equivalent to a sequence of individual boolean operations, but does not produce intermediate results "
+    "and needs a single pass only. Merged semantics applies for all inputs. The result is merged.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
   method ("inside", &db::Region::selected_inside,
     "@brief Returns the polygons of this region which are completely inside polygons from the other region\n"
     "\n"
@@ -1896,7 +1919,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "\n"
     "@return The transformed region.\n"
   ) +
-  method_ext ("width_check", &width1,
+  allow_threads (method_ext ("width_check", &width1,
     "@brief Performs a width check\n"
     "@args d\n"
     "@param d The minimum width for which the polygons are checked\n"
@@ -1907,8 +1930,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "See \\EdgePairs for a description of that collection object.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("width_check", &width2,
+  )) +
+  allow_threads (method_ext ("width_check", &width2,
     "@brief Performs a width check with options\n"
     "@args d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum width for which the polygons are checked\n"
@@ -1939,8 +1962,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("space_check", &space1,
+  )) +
+  allow_threads (method_ext ("space_check", &space1,
     "@brief Performs a space check\n"
     "@args d\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -1954,8 +1977,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "\\isolated_check is a version which checks spacing between different polygons only.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("space_check", &space2,
+  )) +
+  allow_threads (method_ext ("space_check", &space2,
     "@brief Performs a space check with options\n"
     "@args d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -1986,8 +2009,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("notch_check", &notch1,
+  )) +
+  allow_threads (method_ext ("notch_check", &notch1,
     "@brief Performs a space check between edges of the same polygon\n"
     "@args d\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -2003,8 +2026,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "\\isolated_check is a version which checks spacing between different polygons only.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("notch_check", &notch2,
+  )) +
+  allow_threads (method_ext ("notch_check", &notch2,
     "@brief Performs a space check between edges of the same polygon with options\n"
     "@args d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -2035,8 +2058,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("isolated_check", &isolated1,
+  )) +
+  allow_threads (method_ext ("isolated_check", &isolated1,
     "@brief Performs a space check between edges of different polygons\n"
     "@args d\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -2052,8 +2075,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "\\notch_check is a version which checks spacing of polygons edges of the same polygon only.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("isolated_check", &isolated2,
+  )) +
+  allow_threads (method_ext ("isolated_check", &isolated2,
     "@brief Performs a space check between edges of different polygons with options\n"
     "@args d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum space for which the polygons are checked\n"
@@ -2084,8 +2107,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("inside_check", &inside1,
+  )) +
+  allow_threads (method_ext ("inside_check", &inside1,
     "@brief Performs a check whether polygons of this region are inside polygons of the other region by some amount\n"
     "@args other, d\n"
     "@param d The minimum overlap for which the polygons are checked\n"
@@ -2096,8 +2119,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "whether there is enough overlap of the other polygons vs. polygons of this region. "
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("inside_check", &inside2,
+  )) +
+  allow_threads (method_ext ("inside_check", &inside2,
     "@brief Performs an inside check with options\n"
     "@args other, d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum distance for which the polygons are checked\n"
@@ -2129,8 +2152,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("overlap_check", &overlap1,
+  )) +
+  allow_threads (method_ext ("overlap_check", &overlap1,
     "@brief Performs a check whether polygons of this region overlap polygons of the other region by some amount\n"
     "@args other, d\n"
     "@param d The minimum overlap for which the polygons are checked\n"
@@ -2139,8 +2162,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "by less than the given value \"d\". "
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("overlap_check", &overlap2,
+  )) +
+  allow_threads (method_ext ("overlap_check", &overlap2,
     "@brief Performs an overlap check with options\n"
     "@args other, d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum overlap for which the polygons are checked\n"
@@ -2172,8 +2195,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("enclosing_check", &enclosing1,
+  )) +
+  allow_threads (method_ext ("enclosing_check", &enclosing1,
     "@brief Performs a check whether polygons of this region enclose polygons of the other region by some amount\n"
     "@args other, d\n"
     "@param d The minimum overlap for which the polygons are checked\n"
@@ -2182,8 +2205,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "by less than the given value \"d\". "
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("enclosing_check", &enclosing2,
+  )) +
+  allow_threads (method_ext ("enclosing_check", &enclosing2,
     "@brief Performs an enclosing check with options\n"
     "@args other, d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum enclosing distance for which the polygons are checked\n"
@@ -2215,8 +2238,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("separation_check", &separation1,
+  )) +
+  allow_threads (method_ext ("separation_check", &separation1,
     "@brief Performs a check whether polygons of this region are separated from polygons of the other region by some amount\n"
     "@args other, d\n"
     "@param d The minimum separation for which the polygons are checked\n"
@@ -2225,8 +2248,8 @@ Class<db::Region> decl_Region ("db", "Region",
     "by less than the given value \"d\". "
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
-  method_ext ("separation_check", &separation2,
+  )) +
+  allow_threads (method_ext ("separation_check", &separation2,
     "@brief Performs a separation check with options\n"
     "@args other, d, whole_edges, metrics, ignore_angle, min_projection, max_projection\n"
     "@param d The minimum separation for which the polygons are checked\n"
@@ -2258,7 +2281,7 @@ Class<db::Region> decl_Region ("db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
+  )) +
   method_ext ("area", &area1,
     "@brief The area of the region\n"
     "\n"
@@ -28,6 +28,7 @@
 #include "dbRegion.h"
 #include "dbEdgePairs.h"
 #include "dbEdges.h"
+#include "dbRecursiveShapeIterator.h"
 
 namespace gsi
 {
@@ -294,6 +295,191 @@ static void insert_region (db::Shapes *sh, const db::Region &r)
   }
 }
 
+static std::vector<db::Coord> box_coords (const db::Shapes *sh)
+{
+  std::vector<db::Coord> coords;
+  for (db::Shapes::shape_iterator s = sh->begin (db::ShapeIterator::Boxes); ! s.at_end (); ++s) {
+    db::Box b = s->bbox ();
+    coords.push_back (b.left ());
+    coords.push_back (b.bottom ());
+    coords.push_back (b.right ());
+    coords.push_back (b.top ());
+  }
+  return coords;
+}
+
+static void insert_boxes_from_coords (db::Shapes *sh, const std::vector<db::Coord> &coords)
+{
+  if (coords.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The number of coordinates must be a multiple of four (left, bottom, right and top for each box)")));
+  }
+
+  db::LayoutLocker locker (sh->layout ());
+  for (size_t i = 0; i < coords.size (); i += 4) {
+    sh->insert (db::Box (coords [i], coords [i + 1], coords [i + 2], coords [i + 3]));
+  }
+}
+
+// ---------------------------------------------------------------
+//  flat coordinate lists for polygons, paths and edges
+//
+//  Each object is encoded into a sequence of integers and the sequences are concatenated:
+//  - polygons: number of contours (hull first, then the holes). For each contour, the
+//    number of points followed by x and y for each point.
+//  - paths: width, begin extension, end extension, round flag (0 or 1), number of points,
+//    followed by x and y for each point.
+//  - edges: x1, y1, x2, y2
+
+static void append_polygon_coords (std::vector<db::Coord> &coords, const db::Polygon &poly)
+{
+  coords.push_back (db::Coord (poly.holes () + 1));
+  for (unsigned int c = 0; c <= poly.holes (); ++c) {
+    const db::Polygon::contour_type &ctr = poly.contour (c);
+    coords.push_back (db::Coord (ctr.size ()));
+    for (db::Polygon::contour_type::simple_iterator p = ctr.begin (); p != ctr.end (); ++p) {
+      coords.push_back ((*p).x ());
+      coords.push_back ((*p).y ());
+    }
+  }
+}
+
+static void append_path_coords (std::vector<db::Coord> &coords, const db::Path &path)
+{
+  coords.push_back (path.width ());
+  coords.push_back (path.bgn_ext ());
+  coords.push_back (path.end_ext ());
+  coords.push_back (path.round () ? 1 : 0);
+  coords.push_back (db::Coord (path.points ()));
+  for (db::Path::iterator p = path.begin (); p != path.end (); ++p) {
+    coords.push_back ((*p).x ());
+    coords.push_back ((*p).y ());
+  }
+}
+
+static void append_edge_coords (std::vector<db::Coord> &coords, const db::Edge &edge)
+{
+  coords.push_back (edge.x1 ());
+  coords.push_back (edge.y1 ());
+  coords.push_back (edge.x2 ());
+  coords.push_back (edge.y2 ());
+}
+
+/**
+ *  @brief Reads the number of points and the points of a contour or path spine
+ */
+static void read_points (const std::vector<db::Coord> &coords, size_t &i, std::vector<db::Point> &pts)
+{
+  if (i >= coords.size () || coords [i] < 0 || size_t (coords [i]) > (coords.size () - i - 1) / 2) {
+    throw tl::Exception (tl::to_string (tr ("Invalid point count or not enough coordinates at position %ld")), long (i));
+  }
+
+  size_t n = size_t (coords [i++]);
+
+  pts.clear ();
+  pts.reserve (n);
+  for ( ; n > 0; --n, i += 2) {
+    pts.push_back (db::Point (coords [i], coords [i + 1]));
+  }
+}
+
+static std::vector<db::Coord> polygon_coords (const db::Shapes *sh)
+{
+  std::vector<db::Coord> coords;
+  db::Polygon poly;
+  for (db::Shapes::shape_iterator s = sh->begin (db::ShapeIterator::Polygons); ! s.at_end (); ++s) {
+    s->polygon (poly);
+    append_polygon_coords (coords, poly);
+  }
+  return coords;
+}
+
+static void insert_polygons_from_coords (db::Shapes *sh, const std::vector<db::Coord> &coords)
+{
+  db::LayoutLocker locker (sh->layout ());
+
+  std::vector<db::Point> pts;
+  db::Polygon poly;
+
+  size_t i = 0;
+  while (i < coords.size ()) {
+
+    db::Coord nctrs = coords [i++];
+    if (nctrs < 1) {
+      throw tl::Exception (tl::to_string (tr ("Invalid contour count at position %ld (must be 1 for the hull plus the number of holes)")), long (i - 1));
+    }
+
+    poly.clear ();
+    for (db::Coord c = 0; c < nctrs; ++c) {
+      read_points (coords, i, pts);
+      if (c == 0) {
+        poly.assign_hull (pts.begin (), pts.end ());
+      } else {
+        poly.insert_hole (pts.begin (), pts.end ());
+      }
+    }
+
+    sh->insert (poly);
+
+  }
+}
+
+static std::vector<db::Coord> path_coords (const db::Shapes *sh)
+{
+  std::vector<db::Coord> coords;
+  db::Path path;
+  for (db::Shapes::shape_iterator s = sh->begin (db::ShapeIterator::Paths); ! s.at_end (); ++s) {
+    s->path (path);
+    append_path_coords (coords, path);
+  }
+  return coords;
+}
+
+static void insert_paths_from_coords (db::Shapes *sh, const std::vector<db::Coord> &coords)
+{
+  db::LayoutLocker locker (sh->layout ());
+
+  std::vector<db::Point> pts;
+
+  size_t i = 0;
+  while (i < coords.size ()) {
+
+    if (coords.size () - i < 5) {
+      throw tl::Exception (tl::to_string (tr ("Not enough coordinates for a path at position %ld")), long (i));
+    }
+
+    db::Coord w = coords [i];
+    db::Coord bgn_ext = coords [i + 1];
+    db::Coord end_ext = coords [i + 2];
+    bool round = coords [i + 3] != 0;
+    i += 4;
+
+    read_points (coords, i, pts);
+    sh->insert (db::Path (pts.begin (), pts.end (), w, bgn_ext, end_ext, round));
+
+  }
+}
+
+static std::vector<db::Coord> edge_coords (const db::Shapes *sh)
+{
+  std::vector<db::Coord> coords;
+  for (db::Shapes::shape_iterator s = sh->begin (db::ShapeIterator::Edges); ! s.at_end (); ++s) {
+    append_edge_coords (coords, s->edge ());
+  }
+  return coords;
+}
+
+static void insert_edges_from_coords (db::Shapes *sh, const std::vector<db::Coord> &coords)
+{
+  if (coords.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The number of coordinates must be a multiple of four (x1, y1, x2 and y2 for each edge)")));
+  }
+
+  db::LayoutLocker locker (sh->layout ());
+  for (size_t i = 0; i < coords.size (); i += 4) {
+    sh->insert (db::Edge (coords [i], coords [i + 1], coords [i + 2], coords [i + 3]));
+  }
+}
+
 static void insert_region_with_trans (db::Shapes *sh, const db::Region &r, const db::ICplxTrans &trans)
 {
   //  NOTE: if the source (r) is from the same layout than the shapes live in, we better
@@ -495,6 +681,77 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
     "\n"
     "This method has been introduced in version 0.25.3.\n"
   ) +
+  gsi::method_ext ("box_coords", &box_coords,
+    "@brief Gets the boxes of this shape container as a flat list of coordinates\n"
+    "\n"
+    "The list contains left, bottom, right and top coordinates of each box in the order the boxes are "
+    "delivered by \\each with the \\SBoxes flag. This method is considerably faster than iterating "
+    "the shapes if only the box coordinates are required, because no shape objects are created.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("insert_boxes", &insert_boxes_from_coords, gsi::arg ("coords"),
+    "@brief Inserts boxes from a flat list of coordinates\n"
+    "@param coords The coordinates of the boxes (left, bottom, right and top for each box)\n"
+    "\n"
+    "This is the counterpart of \\box_coords. The number of coordinates must be a multiple of four.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("polygon_coords", &polygon_coords,
+    "@brief Gets the polygons of this shape container as a flat list of integers\n"
+    "\n"
+    "The polygons are taken in the order they are delivered by \\each with the \\SPolygons flag. "
+    "Each polygon is encoded as the number of contours (1 for the hull plus the number of holes), followed "
+    "by the contours, hull first. Each contour is given by the number of points, followed by the x and y "
+    "coordinates of each point. The encoded polygons are concatenated into a single list.\n"
+    "\n"
+    "This method is considerably faster than iterating the shapes if only the polygon geometry is "
+    "required, because no shape, polygon or point objects are created.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("insert_polygons", &insert_polygons_from_coords, gsi::arg ("coords"),
+    "@brief Inserts polygons from a flat list of integers\n"
+    "@param coords The encoded polygons\n"
+    "\n"
+    "This is the counterpart of \\polygon_coords. See there for a description of the encoding.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("path_coords", &path_coords,
+    "@brief Gets the paths of this shape container as a flat list of integers\n"
+    "\n"
+    "The paths are taken in the order they are delivered by \\each with the \\SPaths flag. "
+    "Each path is encoded as width, begin extension, end extension, round flag (0 or 1) and the number of points, "
+    "followed by the x and y coordinates of each point. The encoded paths are concatenated into a single list.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("insert_paths", &insert_paths_from_coords, gsi::arg ("coords"),
+    "@brief Inserts paths from a flat list of integers\n"
+    "@param coords The encoded paths\n"
+    "\n"
+    "This is the counterpart of \\path_coords. See there for a description of the encoding.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("edge_coords", &edge_coords,
+    "@brief Gets the edges of this shape container as a flat list of coordinates\n"
+    "\n"
+    "The list contains x1, y1, x2 and y2 of each edge in the order the edges are "
+    "delivered by \\each with the \\SEdges flag.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("insert_edges", &insert_edges_from_coords, gsi::arg ("coords"),
+    "@brief Inserts edges from a flat list of coordinates\n"
+    "@param coords The coordinates of the edges (x1, y1, x2 and y2 for each edge)\n"
+    "\n"
+    "This is the counterpart of \\edge_coords. The number of coordinates must be a multiple of four.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
   gsi::method_ext ("insert", &insert_region, gsi::arg ("region"),
     "@brief Inserts the polygons from the region into this shape container\n"
     "@param region The region to insert\n"
@@ -1158,5 +1415,90 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
   "one Shapes object per layer.\n"
 );
 
+// ---------------------------------------------------------------
+//  flat coordinate lists for db::RecursiveShapeIterator
+//  (using the same encoding than the db::Shapes methods)
+
+static std::vector<db::Coord> si_polygon_coords (const db::RecursiveShapeIterator *r)
+{
+  std::vector<db::Coord> coords;
+  db::Polygon poly;
+
+  db::RecursiveShapeIterator i (*r);
+  i.reset ();
+  for ( ; ! i.at_end (); ++i) {
+    if (i.shape ().is_polygon ()) {
+      i.shape ().polygon (poly);
+      append_polygon_coords (coords, poly.transformed (i.trans ()));
+    }
+  }
+
+  return coords;
+}
+
+static std::vector<db::Coord> si_path_coords (const db::RecursiveShapeIterator *r)
+{
+  std::vector<db::Coord> coords;
+  db::Path path;
+
+  db::RecursiveShapeIterator i (*r);
+  i.reset ();
+  for ( ; ! i.at_end (); ++i) {
+    if (i.shape ().is_path ()) {
+      i.shape ().path (path);
+      append_path_coords (coords, path.transformed (i.trans ()));
+    }
+  }
+
+  return coords;
+}
+
+static std::vector<db::Coord> si_edge_coords (const db::RecursiveShapeIterator *r)
+{
+  std::vector<db::Coord> coords;
+
+  db::RecursiveShapeIterator i (*r);
+  i.reset ();
+  for ( ; ! i.at_end (); ++i) {
+    if (i.shape ().is_edge ()) {
+      append_edge_coords (coords, i.shape ().edge ().transformed (i.trans ()));
+    }
+  }
+
+  return coords;
+}
+
+static
+gsi::ClassExt<db::RecursiveShapeIterator> decl_RecursiveShapeIterator_coords (
+  gsi::method_ext ("polygon_coords", &si_polygon_coords,
+    "@brief Gets the polygons delivered by this iterator as a flat list of integers\n"
+    "\n"
+    "The polygons are transformed into the coordinate system of the initial cell. "
+    "The encoding is the same than for \\Shapes#polygon_coords. The list is produced "
+    "by iterating a copy of this iterator from the beginning: this iterator is not modified.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("path_coords", &si_path_coords,
+    "@brief Gets the paths delivered by this iterator as a flat list of integers\n"
+    "\n"
+    "The paths are transformed into the coordinate system of the initial cell. "
+    "The encoding is the same than for \\Shapes#path_coords. The list is produced "
+    "by iterating a copy of this iterator from the beginning: this iterator is not modified.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ) +
+  gsi::method_ext ("edge_coords", &si_edge_coords,
+    "@brief Gets the edges delivered by this iterator as a flat list of coordinates\n"
+    "\n"
+    "The edges are transformed into the coordinate system of the initial cell. "
+    "The list contains x1, y1, x2 and y2 for each edge. It is produced "
+    "by iterating a copy of this iterator from the beginning: this iterator is not modified.\n"
+    "\n"
+    "This method has been introduced in version 0.26.\n"
+  ),
+  ""
+);
+
 }
 
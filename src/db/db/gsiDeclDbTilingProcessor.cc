@@ -640,13 +640,13 @@ Class<db::TilingProcessor> decl_TilingProcessor ("db", "TilingProcessor",
     "The scripts have \"Expressions\" syntax and can make use of several predefined variables and functions.\n"
     "See the \\TilingProcessor class description for details.\n"
   ) + 
-  method ("execute", &db::TilingProcessor::execute,
+  allow_threads (method ("execute", &db::TilingProcessor::execute,
     "@brief Runs the job\n"
     "@args desc\n"
     "\n"
     "This method will initiate execution of the queued scripts, once for every tile. The desc is a text "
     "shown in the progress bar for example.\n"
-  ),
+  )),
   "@brief A processor for layout which distributes tasks over tiles\n"
   "\n"
   "The tiling processor executes one or several scripts on one or multiple layouts providing "
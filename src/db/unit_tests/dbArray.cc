@@ -463,3 +463,56 @@ TEST(11)
   EXPECT_EQ (ba1cplx == ba2x3cplx, false);
 }
 
+
+TEST(12)
+{
+  //  closed-form index ranges and in-place iterators
+
+  BoxArray ba (db::Box (0, 0, 50, 50), db::Trans (), db::Vector (100, 0), db::Vector (0, 200), 10, 5);
+
+  unsigned long amin = 0, amax = 0, bmin = 0, bmax = 0;
+  db::box_convert<db::Box> bc;
+
+  EXPECT_EQ (ba.regular_touching_range (db::Box (120, 190, 330, 250), bc, amin, amax, bmin, bmax), true);
+  EXPECT_EQ (amin, (unsigned long) 1);
+  EXPECT_EQ (amax, (unsigned long) 4);
+  EXPECT_EQ (bmin, (unsigned long) 1);
+  EXPECT_EQ (bmax, (unsigned long) 2);
+  EXPECT_EQ (positions (ba, db::Point (), ba.begin_touching (db::Box (120, 190, 330, 250), bc)), "100,200;200,200;300,200");
+
+  EXPECT_EQ (ba.regular_touching_range (db::Box::world (), bc, amin, amax, bmin, bmax), true);
+  EXPECT_EQ (amin, (unsigned long) 0);
+  EXPECT_EQ (amax, (unsigned long) 10);
+  EXPECT_EQ (bmin, (unsigned long) 0);
+  EXPECT_EQ (bmax, (unsigned long) 5);
+
+  EXPECT_EQ (ba.regular_touching_range (db::Box (), bc, amin, amax, bmin, bmax), true);
+  EXPECT_EQ (amin == amax && bmin == bmax, true);
+
+  std::vector<db::Vector> v;
+  v.push_back (db::Vector (0, 0));
+  v.push_back (db::Vector (100, 0));
+  BoxArray bai (db::Box (0, 0, 50, 50), db::Trans (), new db::iterated_array<db::Coord> (v.begin (), v.end ()));
+  EXPECT_EQ (bai.regular_touching_range (db::Box (120, 190, 330, 250), bc, amin, amax, bmin, bmax), false);
+
+  BoxArray ba1 (db::Box (0, 0, 50, 50), db::Trans ());
+  EXPECT_EQ (ba1.regular_touching_range (db::Box (120, 190, 330, 250), bc, amin, amax, bmin, bmax), false);
+
+  //  copies of iterators continue independently
+  BoxArray::iterator i1 = ba.begin_touching (db::Box (120, 190, 330, 250), bc);
+  ++i1;
+  BoxArray::iterator i2 = i1;
+  ++i1;
+  EXPECT_EQ (positions (ba, db::Point (), i2), "200,200;300,200");
+  EXPECT_EQ (positions (ba, db::Point (), i1), "300,200");
+  i2 = i1;
+  ++i1;
+  EXPECT_EQ (i1.at_end (), true);
+  EXPECT_EQ (positions (ba, db::Point (), i2), "300,200");
+
+  BoxArray::iterator ii = bai.begin ();
+  BoxArray::iterator ii2 = ii;
+  ++ii;
+  EXPECT_EQ (positions (bai, db::Point (), ii), "100,0");
+  EXPECT_EQ (positions (bai, db::Point (), ii2), "0,0;100,0");
+}
@@ -939,3 +939,105 @@ TEST(6)
 
 }
 
+
+//  content hashes
+TEST(7)
+{
+  db::Layout g (true);
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &a = g.cell (g.add_cell ("A"));
+  db::Cell &b = g.cell (g.add_cell ("B"));
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+  db::Cell &empty = g.cell (g.add_cell ("EMPTY"));
+
+  a.shapes (l1).insert (db::Box (0, 0, 100, 200));
+  a.shapes (l1).insert (db::Polygon (db::Box (0, 0, 10, 20)));
+  b.shapes (l1).insert (db::Box (10, 0, 110, 200));
+  top.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans (db::Vector (0, 1000))));
+  top.insert (db::CellInstArray (db::CellInst (b.cell_index ()), db::Trans (db::Vector (0, 2000))));
+  top.insert (db::CellInstArray (db::CellInst (empty.cell_index ()), db::Trans ()));
+
+  size_t ha = a.content_hash ();
+  size_t hb = b.content_hash ();
+  size_t htop = top.content_hash ();
+
+  EXPECT_EQ (empty.content_hash (), size_t (0));
+  EXPECT_EQ (ha != 0, true);
+  EXPECT_EQ (ha != hb, true);
+  EXPECT_EQ (htop != ha, true);
+  EXPECT_EQ (a.content_hash (l1) != 0, true);
+  EXPECT_EQ (a.content_hash (l2), size_t (0));
+  EXPECT_EQ (top.content_hash (l2), size_t (0));
+  EXPECT_EQ (g.content_hash () != 0, true);
+
+  //  same content with different names, layer indexes and order in a different layout
+  db::Layout h (true);
+  unsigned int hl2 = h.insert_layer (db::LayerProperties (2, 0));
+  unsigned int hl1 = h.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &htopc = h.cell (h.add_cell ("X"));
+  db::Cell &hb_c = h.cell (h.add_cell ("Y"));
+  db::Cell &ha_c = h.cell (h.add_cell ("Z"));
+
+  ha_c.shapes (hl1).insert (db::Polygon (db::Box (0, 0, 10, 20)));
+  ha_c.shapes (hl1).insert (db::Box (0, 0, 100, 200));
+  hb_c.shapes (hl1).insert (db::Box (10, 0, 110, 200));
+  htopc.insert (db::CellInstArray (db::CellInst (hb_c.cell_index ()), db::Trans (db::Vector (0, 2000))));
+  htopc.insert (db::CellInstArray (db::CellInst (ha_c.cell_index ()), db::Trans (db::Vector (0, 1000))));
+
+  EXPECT_EQ (ha_c.content_hash (), ha);
+  EXPECT_EQ (hb_c.content_hash (), hb);
+  EXPECT_EQ (htopc.content_hash (), htop);
+  EXPECT_EQ (h.content_hash (), g.content_hash ());
+  EXPECT_EQ (htopc.content_hash (hl2), size_t (0));
+
+  //  changing a child cell changes the parents, but not the siblings
+  db::Shape s = a.shapes (l1).insert (db::Box (0, 0, 1, 1));
+  EXPECT_EQ (a.content_hash () != ha, true);
+  EXPECT_EQ (top.content_hash () != htop, true);
+  EXPECT_EQ (b.content_hash (), hb);
+
+  a.shapes (l1).erase_shape (s);
+  EXPECT_EQ (a.content_hash (), ha);
+  EXPECT_EQ (top.content_hash (), htop);
+
+  //  per-layer hashes
+  b.shapes (l2).insert (db::Edge (0, 0, 100, 100));
+  EXPECT_EQ (b.content_hash (l1), hb_c.content_hash (hl1));
+  EXPECT_EQ (b.content_hash (l2) != 0, true);
+  EXPECT_EQ (top.content_hash (l1), htopc.content_hash (hl1));
+  EXPECT_EQ (top.content_hash (l2) != 0, true);
+  EXPECT_EQ (top.content_hash () != htop, true);
+
+  hb_c.shapes (hl2).insert (db::Edge (0, 0, 100, 100));
+  EXPECT_EQ (htopc.content_hash (), top.content_hash ());
+
+  //  instances: changes are detected also after an update of the layout
+  db::Instance i = htopc.insert (db::CellInstArray (db::CellInst (ha_c.cell_index ()), db::Trans (db::Vector (0, 3000))));
+  h.update ();
+  EXPECT_EQ (htopc.content_hash () != top.content_hash (), true);
+  htopc.erase (i);
+  EXPECT_EQ (htopc.content_hash (), top.content_hash ());
+
+  //  properties enter by name and value
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant ("net")), tl::Variant ("VDD")));
+  db::properties_id_type pid = g.properties_repository ().properties_id (ps);
+  a.shapes (l2).insert (db::BoxWithProperties (db::Box (0, 0, 1, 1), pid));
+
+  h.properties_repository ().prop_name_id (tl::Variant ("dummy"));
+  ps.clear ();
+  ps.insert (std::make_pair (h.properties_repository ().prop_name_id (tl::Variant ("net")), tl::Variant ("VDD")));
+  pid = h.properties_repository ().properties_id (ps);
+  db::Shape hs = ha_c.shapes (hl2).insert (db::Box (0, 0, 1, 1));
+  EXPECT_EQ (htopc.content_hash () != top.content_hash (), true);
+  ha_c.shapes (hl2).replace_prop_id (hs, pid);
+  EXPECT_EQ (htopc.content_hash (), top.content_hash ());
+
+  //  layer properties enter the hash
+  size_t hh = htopc.content_hash ();
+  h.set_properties (hl2, db::LayerProperties (3, 0));
+  EXPECT_EQ (htopc.content_hash () != hh, true);
+  EXPECT_EQ (htopc.content_hash (hl2), top.content_hash (l2));
+}
@@ -2483,3 +2483,100 @@ TEST(135b)
   EXPECT_EQ (run_test135b (_this, db::Trans (db::Trans::m90)), "(-78,25;-33,34;-36,33;-37,33)");
   EXPECT_EQ (run_test135b (_this, db::Trans (db::Trans::m135)), "(-26,-78;-35,-33;-33,-36;-33,-37)");
 }
+
+TEST(200)
+{
+  //  BooleanExpression parser and string conversion
+  EXPECT_EQ (db::BooleanExpression ().to_string (), "");
+  EXPECT_EQ (db::BooleanExpression ("1").to_string (), "1");
+  EXPECT_EQ (db::BooleanExpression ("1").layers (), (unsigned int) 2);
+  EXPECT_EQ (db::BooleanExpression ("(0|1)-(2&3)").to_string (), "(0|1)-(2&3)");
+  EXPECT_EQ (db::BooleanExpression ("(0|1)-(2&3)").layers (), (unsigned int) 4);
+  EXPECT_EQ (db::BooleanExpression ("0|1&2").to_string (), "0|(1&2)");
+  EXPECT_EQ (db::BooleanExpression ("0&1|2").to_string (), "(0&1)|2");
+  EXPECT_EQ (db::BooleanExpression (" 0 ^ 1 - 2 ").to_string (), "(0^1)-2");
+  EXPECT_EQ (db::BooleanExpression ("0^(1-2)").to_string (), "0^(1-2)");
+
+  EXPECT_EQ (db::BooleanExpression ("(0|1)-(2&3)") == ((db::BooleanExpression::layer (0) | db::BooleanExpression::layer (1)) - (db::BooleanExpression::layer (2) & db::BooleanExpression::layer (3))), true);
+  EXPECT_EQ (db::BooleanExpression ("(0|1)-(2&3)") == db::BooleanExpression ("0|1-2&3"), true);
+  EXPECT_EQ (db::BooleanExpression ("0|(1-2)") != db::BooleanExpression ("0|1-2"), true);
+
+  std::string err;
+  try {
+    db::BooleanExpression ("0|");
+  } catch (tl::Exception &) {
+    err = "error";
+  }
+  EXPECT_EQ (err, "error");
+
+  err.clear ();
+  try {
+    db::BooleanExpression ("(0|1");
+  } catch (tl::Exception &) {
+    err = "error";
+  }
+  EXPECT_EQ (err, "error");
+}
+
+namespace
+{
+
+struct BitInsideFunc
+{
+  BitInsideFunc (unsigned int bits) : m_bits (bits) { }
+  bool operator() (unsigned int l) const { return ((m_bits >> l) & 1) != 0; }
+  unsigned int m_bits;
+};
+
+}
+
+TEST(201)
+{
+  //  BooleanExpression evaluation
+  db::BooleanExpression e ("(0|1)-(2&3)");
+  for (unsigned int m = 0; m < 16; ++m) {
+    bool a = (m & 1) != 0, b = (m & 2) != 0, c = (m & 4) != 0, d = (m & 8) != 0;
+    EXPECT_EQ (e.evaluate (BitInsideFunc (m)), (a || b) && ! (c && d));
+  }
+
+  db::BooleanExpression x ("0^1^2");
+  for (unsigned int m = 0; m < 8; ++m) {
+    EXPECT_EQ (x.evaluate (BitInsideFunc (m)), (m == 1 || m == 2 || m == 4 || m == 7));
+  }
+
+  EXPECT_EQ (db::BooleanExpression ().evaluate (BitInsideFunc (1)), false);
+}
+
+TEST(202)
+{
+  //  BooleanExpressionOp against BooleanOp
+  std::vector<db::Polygon> out1, out2;
+
+  for (int i = 0; i < 2; ++i) {
+
+    db::EdgeProcessor ep;
+
+    ep.insert (db::Polygon (db::Box (0, 0, 1000, 1000)), 0);
+    ep.insert (db::Polygon (db::Box (500, 500, 1500, 1500)), 1);
+    //  overlapping polygons on the same layer must not count twice
+    ep.insert (db::Polygon (db::Box (200, 200, 800, 800)), 2);
+    ep.insert (db::Polygon (db::Box (600, 600, 1200, 1200)), 3);
+
+    db::PolygonContainer pc (i == 0 ? out1 : out2);
+    db::PolygonGenerator pg (pc, false, true);
+    if (i == 0) {
+      db::BooleanOp op (db::BooleanOp::Xor);
+      ep.process (pg, op);
+    } else {
+      db::BooleanExpressionOp op (db::BooleanExpression ("0^1"), 2);
+      ep.process (pg, op);
+    }
+
+  }
+
+  EXPECT_EQ (out1.size (), out2.size ());
+  EXPECT_EQ (out1.size (), size_t (2));
+  for (size_t i = 0; i < out1.size () && i < out2.size (); ++i) {
+    EXPECT_EQ (out2 [i].to_string (), out1 [i].to_string ());
+  }
+}
@@ -23,6 +23,7 @@
 
 
 #include "dbLayout.h"
+#include "dbRecursiveShapeIterator.h"
 #include "tlString.h"
 #include "tlUnitTest.h"
 
@@ -464,3 +465,154 @@ TEST(4)
   prop_id = g.properties_repository ().properties_id (ps);
   EXPECT_EQ (el.property_ids_dirty, true);
 }
+
+TEST(5)
+{
+  //  Read-only access after update does not modify the layout
+  //  (required for sharing a layout copy-on-write with forked processes)
+
+  db::Layout g (false);
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = g.add_cell ("TOP");
+  db::cell_index_type c1 = g.add_cell ("C1");
+
+  g.cell (c1).shapes (l1).insert (db::Box (0, 0, 100, 200));
+  g.cell (c1).shapes (l1).insert (db::Box (1000, 0, 1100, 200));
+  for (int i = 0; i < 10; ++i) {
+    g.cell (top).insert (db::CellInstArray (db::CellInst (c1), db::Trans (db::Vector (i * 2000, 0))));
+  }
+
+  EXPECT_EQ (g.hier_dirty (), true);
+  EXPECT_EQ (g.bboxes_dirty (), true);
+
+  g.force_update ();
+
+  EXPECT_EQ (g.hier_dirty (), false);
+  EXPECT_EQ (g.bboxes_dirty (), false);
+
+  EventListener el;
+  g.hier_changed_event.add (&el, &EventListener::hier_changed);
+  g.bboxes_changed_any_event.add (&el, &EventListener::bboxes_any_changed);
+  g.bboxes_changed_event.add (&el, &EventListener::bboxes_changed);
+
+  const db::Layout &cg = g;
+
+  std::string bboxes_before = cg.cell (top).bbox ().to_string () + ";" + cg.cell (top).bbox (l1).to_string () + ";" + cg.cell (c1).bbox ().to_string ();
+
+  size_t n = 0;
+  for (db::RecursiveShapeIterator si (cg, cg.cell (top), l1, db::Box (0, 0, 5000, 100)); ! si.at_end (); ++si) {
+    ++n;
+  }
+  EXPECT_EQ (n, size_t (6));
+  EXPECT_EQ (cg.cell (top).bbox ().to_string (), "(0,0;19100,200)");
+  EXPECT_EQ (std::distance (cg.begin_top_down (), cg.end_top_down ()), 2);
+  cg.update ();
+
+  std::string bboxes_after = cg.cell (top).bbox ().to_string () + ";" + cg.cell (top).bbox (l1).to_string () + ";" + cg.cell (c1).bbox ().to_string ();
+  EXPECT_EQ (bboxes_after, bboxes_before);
+
+  //  no state change is signalled
+  EXPECT_EQ (el.hier_dirty, false);
+  EXPECT_EQ (el.bboxes_dirty, false);
+  EXPECT_EQ (el.bboxes_all_dirty, false);
+  EXPECT_EQ (el.flags, (unsigned int) 0);
+
+  EXPECT_EQ (g.hier_dirty (), false);
+  EXPECT_EQ (g.bboxes_dirty (), false);
+}
+
+TEST(6)
+{
+  //  Deleting a large cell is accounted for in the undo memory budget
+
+  db::Manager m;
+  db::Layout g (&m);
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = g.add_cell ("TOP");
+  db::cell_index_type c1 = g.add_cell ("C1");
+
+  for (int i = 0; i < 10000; ++i) {
+    g.cell (c1).shapes (l1).insert (db::Box (i * 10, 0, i * 10 + 5, 5));
+  }
+  g.cell (top).insert (db::CellInstArray (db::CellInst (c1), db::Trans ()));
+
+  m.transaction ("delete");
+  g.delete_cell (c1);
+  m.commit ();
+
+  EXPECT_EQ (g.is_valid_cell_index (c1), false);
+  EXPECT_EQ (m.memory () >= 10000 * sizeof (db::Box), true);
+
+  m.undo ();
+  EXPECT_EQ (g.is_valid_cell_index (c1), true);
+  EXPECT_EQ (g.cell (c1).shapes (l1).size (), size_t (10000));
+  EXPECT_EQ (g.cell (top).cell_instances (), size_t (1));
+
+  //  the redo transaction exceeds the budget and is dropped
+  m.set_max_memory (10000);
+  EXPECT_EQ (m.available_redo ().first, false);
+  EXPECT_EQ (m.memory (), size_t (0));
+
+  //  under the budget, the delete is performed, but cannot be undone
+  m.transaction ("delete again");
+  g.delete_cell (c1);
+  m.commit ();
+
+  EXPECT_EQ (g.is_valid_cell_index (c1), false);
+  EXPECT_EQ (g.cell (top).cell_instances (), size_t (0));
+  EXPECT_EQ (m.available_undo ().first, false);
+  EXPECT_EQ (m.memory (), size_t (0));
+}
+
+TEST(7)
+{
+  //  The memory held by polygons in shape operations is accounted for in the undo memory budget
+
+  db::Manager m;
+  db::Layout g (&m);
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type top = g.add_cell ("TOP");
+
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 1000; ++i) {
+    pts.push_back (db::Point (i * 10, (i % 2) * 7 + (i / 2) * 3));
+  }
+  pts.push_back (db::Point (10000, -1000));
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end (), false /*no compression*/);
+
+  m.transaction ("insert");
+  for (int i = 0; i < 10; ++i) {
+    g.cell (top).shapes (l1).insert (poly.moved (db::Vector (0, i * 10000)));
+  }
+  m.commit ();
+
+  EXPECT_EQ (g.cell (top).shapes (l1).size (), size_t (10));
+  EXPECT_EQ (m.memory () >= 10 * 1000 * sizeof (db::Point), true);
+
+  m.transaction ("erase");
+  g.cell (top).shapes (l1).clear ();
+  m.commit ();
+
+  EXPECT_EQ (m.memory () >= 2 * 10 * 1000 * sizeof (db::Point), true);
+
+  m.undo ();
+  EXPECT_EQ (g.cell (top).shapes (l1).size (), size_t (10));
+
+  //  a budget below the size of the polygons drops the history
+  m.set_max_memory (50000);
+  EXPECT_EQ (m.available_undo ().first, false);
+  EXPECT_EQ (m.available_redo ().first, false);
+  EXPECT_EQ (m.memory (), size_t (0));
+
+  //  the insert is performed, but cannot be undone
+  m.transaction ("insert again");
+  for (int i = 0; i < 10; ++i) {
+    g.cell (top).shapes (l1).insert (poly.moved (db::Vector (0, i * 10000 + 5000)));
+  }
+  m.commit ();
+
+  EXPECT_EQ (g.cell (top).shapes (l1).size (), size_t (20));
+  EXPECT_EQ (m.available_undo ().first, false);
+  EXPECT_EQ (m.memory (), size_t (0));
+}
@@ -1471,3 +1471,130 @@ TEST(7)
 }
 
 
+//  parallel compare and content hash prefilter
+TEST(8)
+{
+  db::Layout g;
+  g.insert_layer (0);
+  g.set_properties (0, db::LayerProperties (1, 0));
+  g.insert_layer (1);
+  g.set_properties (1, db::LayerProperties (2, 0));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("net1")));
+  db::properties_id_type pid = g.properties_repository ().properties_id (ps);
+
+  std::vector<db::cell_index_type> cells;
+  for (unsigned int i = 0; i < 20; ++i) {
+
+    db::cell_index_type ci = g.add_cell (("C" + tl::to_string (i)).c_str ());
+    db::Cell &c = g.cell (ci);
+
+    for (db::Coord j = 0; j < 50; ++j) {
+      c.shapes (0).insert (db::Box (j * 10, i, j * 10 + 5, i + 100));
+      c.shapes (1).insert (db::object_with_properties<db::Box> (db::Box (j * 10, -i, j * 10 + 5, 100 - i), pid));
+    }
+
+    db::Point pts[] = { db::Point (0, 0), db::Point (100, 0), db::Point (100, i * 10) };
+    c.shapes (1).insert (db::Path (pts, pts + sizeof (pts) / sizeof (pts[0]), 10));
+    c.shapes (0).insert (db::Text ("T" + tl::to_string (i), db::Trans (db::Vector (i, 0))));
+    c.shapes (0).insert (db::Edge (0, 0, db::Coord (i), 10));
+
+    if (! cells.empty ()) {
+      c.insert (db::CellInstArray (db::CellInst (cells.back ()), db::Trans (db::Vector (0, 1000))));
+    }
+    cells.push_back (ci);
+
+  }
+
+  db::Layout h = g;
+
+  TestDifferenceReceiver r, rp;
+  bool eq, eqp;
+
+  //  identical layouts
+  unsigned int flags[] = {
+    0,
+    db::layout_diff::f_verbose,
+    db::layout_diff::f_verbose | db::layout_diff::f_boxes_as_polygons | db::layout_diff::f_paths_as_polygons,
+    db::layout_diff::f_verbose | db::layout_diff::f_no_properties,
+    db::layout_diff::f_verbose | db::layout_diff::f_hash_prefilter,
+    db::layout_diff::f_silent
+  };
+
+  for (unsigned int i = 0; i < sizeof (flags) / sizeof (flags[0]); ++i) {
+    rp.clear ();
+    eqp = db::compare_layouts (g, h, flags[i], 0, rp, 4);
+    EXPECT_EQ (eqp, true);
+    EXPECT_EQ (rp.text (), "");
+  }
+
+  //  some differences, in particular ones not visible in the bounding boxes
+  h.cell (cells [3]).shapes (0).insert (db::Box (12, 13, 15, 17));
+  h.cell (cells [7]).shapes (1).insert (db::object_with_properties<db::Box> (db::Box (10, -7, 15, 93), pid));
+  h.cell (cells [12]).shapes (0).insert (db::Text ("X", db::Trans ()));
+  h.cell (cells [15]).insert (db::CellInstArray (db::CellInst (cells [2]), db::Trans ()));
+
+  for (unsigned int i = 0; i < sizeof (flags) / sizeof (flags[0]); ++i) {
+
+    for (db::Coord tolerance = 0; tolerance < 2; ++tolerance) {
+
+      r.clear ();
+      eq = db::compare_layouts (g, h, flags[i], tolerance, r);
+      rp.clear ();
+      eqp = db::compare_layouts (g, h, flags[i], tolerance, rp, 4);
+
+      EXPECT_EQ (eq, false);
+      EXPECT_EQ (eqp, eq);
+      EXPECT_EQ (rp.text (), r.text ());
+
+    }
+
+  }
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r, 4);
+  EXPECT_EQ (r.text ().find ("layout_diff: boxes differ for layer 2/0 in cell C7") != std::string::npos, true);
+  EXPECT_EQ (r.text ().find ("layout_diff: texts differ for layer 1/0 in cell C12") != std::string::npos, true);
+  EXPECT_EQ (r.text ().find ("layout_diff: instances differ in cell C15") != std::string::npos, true);
+}
+
+//  equal content hashes do not make layers identical unless requested
+TEST(9)
+{
+  db::Layout g;
+  g.insert_layer (0);
+  g.set_properties (0, db::LayerProperties (1, 0));
+  db::cell_index_type ci = g.add_cell ("TOP");
+
+  db::Layout h = g;
+
+  //  the enclosing box makes the bounding boxes identical
+  g.cell (ci).shapes (0).insert (db::Box (-100, -100, 200, 200));
+  g.cell (ci).shapes (0).insert (db::Box (0, 0, 100, 100));
+  h.cell (ci).shapes (0).insert (db::Box (-100, -100, 200, 200));
+  h.cell (ci).shapes (0).insert (db::Box (1, 16, 100, 100));
+
+  TestDifferenceReceiver r;
+  bool eq;
+
+  for (unsigned int threads = 0; threads < 5; threads += 4) {
+
+    r.clear ();
+    eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r, threads);
+
+    EXPECT_EQ (eq, false);
+    EXPECT_EQ (r.text (),
+      "layout_diff: boxes differ for layer 1/0 in cell TOP\n"
+      "Not in b but in a:\n"
+      "  (0,0;100,100)\n"
+      "Not in a but in b:\n"
+      "  (1,16;100,100)\n"
+    );
+
+    r.clear ();
+    eq = db::compare_layouts (g, h, db::layout_diff::f_silent, 0, r, threads);
+    EXPECT_EQ (eq, false);
+
+  }
+}
@@ -1415,3 +1415,166 @@ TEST(62)
     EXPECT_EQ (s, "T2,T1,T1");
   }
 }
+
+TEST(63)
+{
+  //  cell name matching from many parents (cached name matches in reading mode)
+  db::Layout g;
+  db::Cell &top (g.cell (g.add_cell ("top")));
+  db::Cell &a1 (g.cell (g.add_cell ("a1")));
+  db::Cell &a2 (g.cell (g.add_cell ("a2")));
+  db::Cell &b1 (g.cell (g.add_cell ("b1")));
+
+  for (int i = 0; i < 3; ++i) {
+    db::Cell &p (g.cell (g.add_cell (("p" + tl::to_string (i + 1)).c_str ())));
+    p.insert (db::CellInstArray (db::CellInst (a1.cell_index ()), db::Trans ()));
+    p.insert (db::CellInstArray (db::CellInst (a2.cell_index ()), db::Trans ()));
+    p.insert (db::CellInstArray (db::CellInst (b1.cell_index ()), db::Trans ()));
+    top.insert (db::CellInstArray (db::CellInst (p.cell_index ()), db::Trans ()));
+  }
+
+  {
+    db::LayoutQuery q ("select path_names[1] + '.' + cell_name from instances of top.*.a*");
+    db::LayoutQueryIterator iq (q, &g);
+    std::string s = q2s_var (iq, "data");
+    EXPECT_EQ (s, "p1.a1,p1.a2,p2.a1,p2.a2,p3.a1,p3.a2");
+  }
+
+  {
+    //  the pattern changes with the parent
+    db::LayoutQuery q ("select path_names[1] + '.' + cell_name from instances of top.*.$(cell_name=='p2'?'b*':'a1')");
+    db::LayoutQueryIterator iq (q, &g);
+    std::string s = q2s_var (iq, "data");
+    EXPECT_EQ (s, "p1.a1,p2.b1,p3.a1");
+  }
+
+  {
+    //  substrings are delivered in cached mode too
+    db::LayoutQuery q ("select $1 from instances of top.*.'(a)*'");
+    db::LayoutQueryIterator iq (q, &g);
+    std::string s = q2s_var (iq, "data");
+    EXPECT_EQ (s, "a,a,a,a,a,a");
+  }
+
+  g.rename_cell (b1.cell_index (), "a3");
+
+  {
+    db::LayoutQuery q ("select path_names[1] + '.' + cell_name from instances of top.*.a*");
+    db::LayoutQueryIterator iq (q, &g);
+    std::string s = q2s_var (iq, "data");
+    EXPECT_EQ (s, "p1.a1,p1.a2,p1.a3,p2.a1,p2.a2,p2.a3,p3.a1,p3.a2,p3.a3");
+  }
+}
+
+namespace
+{
+
+class CountingFunction
+  : public tl::EvalFunction
+{
+public:
+  CountingFunction (size_t *count)
+    : mp_count (count)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext &, tl::Variant &out, const std::vector<tl::Variant> &) const
+  {
+    ++*mp_count;
+    out = true;
+  }
+
+private:
+  size_t *mp_count;
+};
+
+}
+
+static std::string q2s_visited (db::Layout &g, const std::string &query, size_t &visited)
+{
+  visited = 0;
+
+  tl::Eval ctx;
+  ctx.define_function ("visit", new CountingFunction (&visited));
+
+  db::LayoutQuery q (query);
+  db::LayoutQueryIterator iq (q, &g, &ctx);
+  std::string res;
+  while (! iq.at_end ()) {
+    if (!res.empty ()) {
+      res += ",";
+    }
+    tl::Variant v;
+    iq.get ("shape", v);
+    res += v.to_string ();
+    ++iq;
+  }
+  return res;
+}
+
+TEST(64)
+{
+  //  pushdown of "where" terms into the shape iteration
+  db::Layout g;
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top (g.cell (g.add_cell ("TOP")));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("A")));
+  db::properties_id_type pa = g.properties_repository ().properties_id (ps);
+  ps.clear ();
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("B")));
+  db::properties_id_type pb = g.properties_repository ().properties_id (ps);
+
+  for (int i = 0; i < 100; ++i) {
+    top.shapes (l1).insert (db::Box (i * 100, 0, i * 100 + 50, 50));
+    top.shapes (l2).insert (db::Box (i * 100, 0, i * 100 + 50, 50));
+  }
+  top.shapes (l1).insert (db::BoxWithProperties (db::Box (0, 1000, 50, 1050), pa));
+  top.shapes (l1).insert (db::BoxWithProperties (db::Box (100, 1000, 150, 1050), pb));
+  top.shapes (l2).insert (db::BoxWithProperties (db::Box (200, 1000, 250, 1050), pa));
+
+  size_t n = 0;
+
+  //  without a pushdown term, each shape is visited
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && (shape.property(1) == 'A')", n), "box (0,1000;50,1050) prop_id=1,box (200,1000;250,1050) prop_id=1");
+  EXPECT_EQ (n, size_t (203));
+
+  //  property prefilter
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && shape.property(1) == 'A'", n), "box (0,1000;50,1050) prop_id=1,box (200,1000;250,1050) prop_id=1");
+  EXPECT_EQ (n, size_t (2));
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && 'B' == shape.property(1)", n), "box (100,1000;150,1050) prop_id=2");
+  EXPECT_EQ (n, size_t (1));
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && shape.property(1) == 'X'", n), "");
+  EXPECT_EQ (n, size_t (0));
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && shape.property(2) == 'A'", n), "");
+  EXPECT_EQ (n, size_t (0));
+
+  //  nil values can't be prefiltered
+  EXPECT_EQ (q2s_visited (g, "shapes on layer 1/0 from TOP where visit && shape.property(1) == nil && shape.bbox.top > 100", n), "");
+  EXPECT_EQ (n, size_t (102));
+
+  //  "||" and assignments disable the pushdown
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && shape.property(1) == 'A' || false", n), "box (0,1000;50,1050) prop_id=1,box (200,1000;250,1050) prop_id=1");
+  EXPECT_EQ (n, size_t (203));
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && shape.property(1) == 'A' && (layout = layout)", n), "box (0,1000;50,1050) prop_id=1,box (200,1000;250,1050) prop_id=1");
+  EXPECT_EQ (n, size_t (203));
+
+  //  layer prefilter
+  EXPECT_EQ (q2s_visited (g, "shapes from TOP where visit && layer_index == " + tl::to_string (l2) + " && shape.property(1) == 'A'", n), "box (200,1000;250,1050) prop_id=1");
+  EXPECT_EQ (n, size_t (1));
+
+  //  region prefilter
+  EXPECT_EQ (q2s_visited (g, "shapes on layer 1/0 from TOP where visit && bbox.touches(Box.new(120, 0, 180, 1000))", n), "box (100,0;150,50),box (100,1000;150,1050) prop_id=2");
+  EXPECT_EQ (n, size_t (2));
+  EXPECT_EQ (q2s_visited (g, "shapes on layer 1/0 from TOP where visit && shape.bbox.overlaps(Box.new(120, 0, 180, 1000))", n), "box (100,0;150,50)");
+  EXPECT_EQ (n, size_t (1));
+  EXPECT_EQ (q2s_visited (g, "shapes on layer 1/0 from TOP where visit && shape_bbox.inside(Box.new(120, 0, 180, 1000)) && shape.property(1) == 'B'", n), "");
+  EXPECT_EQ (n, size_t (1));
+
+  //  a region depending on the shape is not pushed down
+  EXPECT_EQ (q2s_visited (g, "shapes on layer 1/0 from TOP where visit && bbox.touches(shape.bbox) && shape.property(1) == 'B'", n), "box (100,1000;150,1050) prop_id=2");
+  EXPECT_EQ (n, size_t (1));
+}
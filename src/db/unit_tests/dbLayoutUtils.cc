@@ -25,6 +25,8 @@
 #include "dbCellMapping.h"
 #include "dbTestSupport.h"
 #include "dbReader.h"
+#include "dbWriter.h"
+#include "dbCommonReader.h"
 #include "tlString.h"
 #include "tlUnitTest.h"
 
@@ -615,3 +617,138 @@ TEST(16)
 
 }
 
+
+//  Tests deduplicate_cells
+TEST(17)
+{
+  db::Layout l;
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = l.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &top = l.cell (l.add_cell ("TOP"));
+  db::Cell &ip1 = l.cell (l.add_cell ("IP1"));
+  db::Cell &ip2 = l.cell (l.add_cell ("IP2"));
+  db::Cell &inv = l.cell (l.add_cell ("INV"));
+  db::Cell &inv1 = l.cell (l.add_cell ("INV$1"));
+  db::Cell &nand = l.cell (l.add_cell ("NAND"));
+  db::Cell &nand1 = l.cell (l.add_cell ("NAND$1"));
+  db::Cell &blk = l.cell (l.add_cell ("BLK"));
+  db::Cell &blk1 = l.cell (l.add_cell ("BLK$1"));
+  db::Cell &empty = l.cell (l.add_cell ("EMPTY"));
+  db::Cell &empty1 = l.cell (l.add_cell ("EMPTY$1"));
+
+  inv.shapes (l1).insert (db::Box (0, 0, 100, 200));
+  inv.shapes (l2).insert (db::Text ("A", db::Trans ()));
+  //  same shapes in different order
+  inv1.shapes (l2).insert (db::Text ("A", db::Trans ()));
+  inv1.shapes (l1).insert (db::Box (0, 0, 100, 200));
+
+  nand.shapes (l1).insert (db::Box (0, 0, 200, 200));
+  //  differs in one shape
+  nand1.shapes (l1).insert (db::Box (0, 0, 200, 201));
+
+  blk.insert (db::CellInstArray (db::CellInst (inv.cell_index ()), db::Trans (db::Vector (0, 0))));
+  blk.insert (db::CellInstArray (db::CellInst (empty.cell_index ()), db::Trans (db::Vector (0, 0))));
+  blk1.insert (db::CellInstArray (db::CellInst (inv1.cell_index ()), db::Trans (db::Vector (0, 0))));
+  blk1.insert (db::CellInstArray (db::CellInst (empty.cell_index ()), db::Trans (db::Vector (0, 0))));
+
+  ip1.insert (db::CellInstArray (db::CellInst (inv.cell_index ()), db::Trans (db::Vector (0, 0))));
+  ip1.insert (db::CellInstArray (db::CellInst (nand.cell_index ()), db::Trans (db::Vector (1000, 0))));
+  ip1.insert (db::CellInstArray (db::CellInst (blk.cell_index ()), db::Trans (db::Vector (2000, 0))));
+  ip2.insert (db::CellInstArray (db::CellInst (inv1.cell_index ()), db::Trans (db::Vector (0, 0))));
+  ip2.insert (db::CellInstArray (db::CellInst (nand1.cell_index ()), db::Trans (db::Vector (1000, 0))));
+  ip2.insert (db::CellInstArray (db::CellInst (blk1.cell_index ()), db::Trans (db::Vector (2000, 0))));
+  //  empty cells are not merged
+  ip2.insert (db::CellInstArray (db::CellInst (empty1.cell_index ()), db::Trans (db::Vector (3000, 0))));
+
+  top.insert (db::CellInstArray (db::CellInst (ip1.cell_index ()), db::Trans (db::Vector (0, 0))));
+  top.insert (db::CellInstArray (db::CellInst (ip2.cell_index ()), db::Trans (db::Vector (0, 10000))));
+
+  db::cell_index_type top_index = top.cell_index ();
+  db::cell_index_type ip2_index = ip2.cell_index ();
+  size_t h = top.content_hash ();
+
+  EXPECT_EQ (db::deduplicate_cells (l), size_t (2));
+
+  std::string names;
+  for (db::Layout::const_iterator c = l.begin (); c != l.end (); ++c) {
+    if (! names.empty ()) {
+      names += ",";
+    }
+    names += l.cell_name (c->cell_index ());
+  }
+  EXPECT_EQ (names, "TOP,IP1,IP2,INV,NAND,NAND$1,BLK,EMPTY,EMPTY$1");
+
+  std::string children;
+  for (db::Cell::child_cell_iterator c = l.cell (ip2_index).begin_child_cells (); ! c.at_end (); ++c) {
+    if (! children.empty ()) {
+      children += ",";
+    }
+    children += l.cell_name (*c);
+  }
+  EXPECT_EQ (children, "INV,NAND$1,BLK,EMPTY$1");
+
+  //  the geometry did not change
+  EXPECT_EQ (l.cell (top_index).content_hash (), h);
+
+  EXPECT_EQ (db::deduplicate_cells (l), size_t (0));
+
+  //  cells with the same content hash, but different cell properties are not merged
+
+  db::Layout lp;
+  unsigned int lp1 = lp.insert_layer (db::LayerProperties (1, 0));
+
+  db::Cell &ptop = lp.cell (lp.add_cell ("TOP"));
+  db::Cell &pa = lp.cell (lp.add_cell ("A"));
+  db::Cell &pa1 = lp.cell (lp.add_cell ("A$1"));
+  db::Cell &pb = lp.cell (lp.add_cell ("B"));
+
+  pa.shapes (lp1).insert (db::Box (0, 0, 100, 200));
+  pa1.shapes (lp1).insert (db::Box (0, 0, 100, 200));
+  pb.shapes (lp1).insert (db::Box (0, 0, 100, 200));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (lp.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("B")));
+  pb.prop_id (lp.properties_repository ().properties_id (ps));
+
+  ptop.insert (db::CellInstArray (db::CellInst (pa.cell_index ()), db::Trans (db::Vector (0, 0))));
+  ptop.insert (db::CellInstArray (db::CellInst (pa1.cell_index ()), db::Trans (db::Vector (1000, 0))));
+  ptop.insert (db::CellInstArray (db::CellInst (pb.cell_index ()), db::Trans (db::Vector (2000, 0))));
+
+  EXPECT_EQ (pa.content_hash () == pb.content_hash (), true);
+
+  std::string tmp_file = _this->tmp_file ("tmp_17.gds");
+  {
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+    options.set_option_by_name ("gds2_write_cell_properties", true);
+    db::Writer writer (options);
+    tl::OutputStream stream (tmp_file);
+    writer.write (lp, stream);
+  }
+
+  //  the same with the reader's "deduplicate_cells" option
+  db::Layout lr;
+  {
+    db::LoadLayoutOptions options;
+    options.get_options<db::CommonReaderOptions> ().deduplicate_cells = true;
+    tl::InputStream stream (tmp_file);
+    db::Reader reader (stream);
+    reader.read (lr, options);
+  }
+
+  names.clear ();
+  for (db::Layout::const_iterator c = lr.begin (); c != lr.end (); ++c) {
+    if (! names.empty ()) {
+      names += ",";
+    }
+    names += lr.cell_name (c->cell_index ());
+    if (c->prop_id () != 0) {
+      names += "[props]";
+    }
+  }
+  EXPECT_EQ (names, "B[props],A$1,TOP");
+
+  EXPECT_EQ (db::deduplicate_cells (lp), size_t (1));
+  EXPECT_EQ (lp.cell_by_name ("B").first, true);
+}
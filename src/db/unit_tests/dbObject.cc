@@ -230,3 +230,151 @@ TEST(2)
   EXPECT_EQ (BO::inst_count (), 0);
 }
 
+
+//  Memory limit for the undo/redo history
+
+namespace
+{
+
+struct CO : public db::Op
+{
+  CO (int d) { values.push_back (d); ++co_inst; }
+  ~CO () { --co_inst; }
+  std::vector<int> values;
+  static int inst_count () { return co_inst; }
+  static int co_inst;
+
+  int sum () const
+  {
+    int s = 0;
+    for (std::vector<int>::const_iterator v = values.begin (); v != values.end (); ++v) {
+      s += *v;
+    }
+    return s;
+  }
+
+  virtual size_t mem_size () const
+  {
+    return values.size () * 100;
+  }
+};
+
+int CO::co_inst = 0;
+
+struct C : public db::Object 
+{
+  C (db::Manager *m) : db::Object (m), x (0) { }
+
+  void add (int d, bool append = false)
+  {
+    if (transacting ()) {
+      CO *op = append ? dynamic_cast<CO *> (manager ()->last_queued (this)) : 0;
+      if (op) {
+        op->values.push_back (d);
+      } else {
+        manager ()->queue (this, new CO (d));
+      }
+    }
+    x += d;
+  }
+  
+  void undo (db::Op *op)
+  {
+    x -= dynamic_cast<CO *> (op)->sum ();
+  }
+
+  void redo (db::Op *op)
+  {
+    x += dynamic_cast<CO *> (op)->sum ();
+  }
+
+  int x;
+};
+
+}
+
+TEST(3) 
+{
+  db::Manager *man = new db::Manager ();
+  {
+    EXPECT_EQ (man->max_memory (), size_t (0));
+    man->set_max_memory (1000);
+    EXPECT_EQ (man->max_memory (), size_t (1000));
+
+    C c (man);
+    for (int i = 1; i <= 4; ++i) {
+      man->transaction ("t" + tl::to_string (i));
+      c.add (i);
+      c.add (i);
+      c.add (i);
+      man->commit ();
+    }
+
+    //  the first transaction has been dropped
+    EXPECT_EQ (c.x, 30);
+    EXPECT_EQ (man->memory (), size_t (900));
+    EXPECT_EQ (CO::inst_count (), 9);
+
+    man->undo ();
+    man->undo ();
+    EXPECT_EQ (man->available_undo ().first, true);
+    EXPECT_EQ (man->available_undo ().second, "t2");
+    man->undo ();
+    EXPECT_EQ (c.x, 3);
+    EXPECT_EQ (man->available_undo ().first, false);
+    man->redo ();
+    man->redo ();
+    man->redo ();
+    EXPECT_EQ (c.x, 30);
+
+    //  operations growing after they have been queued are accounted for too
+    man->transaction ("grow");
+    c.add (1);
+    for (int i = 0; i < 8; ++i) {
+      c.add (1, true);
+    }
+    //  older transactions are dropped while the operation grows
+    EXPECT_EQ (man->memory (), size_t (900));
+    man->commit ();
+
+    EXPECT_EQ (c.x, 39);
+    EXPECT_EQ (man->memory (), size_t (900));
+    EXPECT_EQ (CO::inst_count (), 1);
+    man->undo ();
+    EXPECT_EQ (c.x, 30);
+    EXPECT_EQ (man->available_undo ().first, false);
+    man->redo ();
+    EXPECT_EQ (c.x, 39);
+
+    //  a transaction exceeding the limit is performed, but cannot be undone
+    man->transaction ("big");
+    for (int i = 0; i < 11; ++i) {
+      c.add (1);
+    }
+    man->commit ();
+
+    EXPECT_EQ (c.x, 50);
+    EXPECT_EQ (man->available_undo ().first, false);
+    EXPECT_EQ (man->available_redo ().first, false);
+    EXPECT_EQ (man->memory (), size_t (0));
+    EXPECT_EQ (CO::inst_count (), 0);
+
+    //  recording resumes with the next transaction
+    man->transaction ("small");
+    c.add (2);
+    man->commit ();
+    EXPECT_EQ (man->memory (), size_t (100));
+    man->undo ();
+    EXPECT_EQ (c.x, 50);
+    man->redo ();
+    EXPECT_EQ (c.x, 52);
+
+    //  lowering the limit drops the history
+    man->set_max_memory (50);
+    EXPECT_EQ (man->available_undo ().first, false);
+    EXPECT_EQ (man->memory (), size_t (0));
+  }
+
+  delete man;
+  EXPECT_EQ (CO::inst_count (), 0);
+}
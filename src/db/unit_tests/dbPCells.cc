@@ -25,11 +25,17 @@
 #include "dbPCellHeader.h"
 #include "dbPCellDeclaration.h"
 #include "dbPCellVariant.h"
+#include "dbPCellVariantCache.h"
+#include "dbLibrary.h"
+#include "dbLibraryManager.h"
 #include "dbWriter.h"
 #include "dbReader.h"
+#include "dbCommonReader.h"
 #include "dbLayoutDiff.h"
 #include "dbTestSupport.h"
 #include "tlStream.h"
+#include "tlFileUtils.h"
+#include "tlThreads.h"
 #include "tlUnitTest.h"
 
 class PD 
@@ -252,3 +258,258 @@ TEST(1)
   }
 }
 
+static tl::Mutex s_pd2_lock;
+static int s_pd2_produced = 0;
+
+//  A PCell which supports parallel production
+class PD2
+  : public db::PCellDeclaration
+{
+  virtual std::vector<db::PCellLayerDeclaration> get_layer_declarations (const db::pcell_parameters_type &) const
+  {
+    std::vector<db::PCellLayerDeclaration> layers;
+    layers.push_back (db::PCellLayerDeclaration (db::LayerProperties (1, 0)));
+    layers.push_back (db::PCellLayerDeclaration (db::LayerProperties (2, 0)));
+    return layers;
+  }
+
+  virtual std::vector<db::PCellParameterDeclaration> get_parameter_declarations () const
+  {
+    std::vector<db::PCellParameterDeclaration> parameters;
+    parameters.push_back (db::PCellParameterDeclaration ("w", db::PCellParameterDeclaration::t_int, "Width"));
+    parameters.push_back (db::PCellParameterDeclaration ("n", db::PCellParameterDeclaration::t_int, "Count"));
+    return parameters;
+  }
+
+  virtual void produce (const db::Layout & /*layout*/, const std::vector<unsigned int> &layer_ids, const db::pcell_parameters_type &parameters, db::Cell &cell) const
+  {
+    {
+      tl::MutexLocker locker (&s_pd2_lock);
+      ++s_pd2_produced;
+    }
+
+    db::Coord w = db::Coord (parameters [0].to_long ());
+    int n = int (parameters [1].to_long ());
+    if (n < 0) {
+      throw tl::Exception ("negative count");
+    }
+
+    for (int i = 0; i < n; ++i) {
+      cell.shapes (layer_ids [0]).insert (db::Box (i * 2 * w, 0, i * 2 * w + w, w));
+      db::Point pts[] = { db::Point (i * 2 * w, 2 * w), db::Point (i * 2 * w, 4 * w), db::Point (i * 2 * w + w, 2 * w) };
+      db::Polygon poly;
+      poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+      cell.shapes (layer_ids [1]).insert (poly);
+    }
+    cell.shapes (layer_ids [1]).insert (db::Text ("W" + tl::to_string (w), db::Trans (db::Vector (0, -w))));
+  }
+
+  virtual std::string get_display_name (const db::pcell_parameters_type &parameters) const
+  {
+    return std::string ("PD2(w=") + parameters [0].to_string () + ",n=" + parameters [1].to_string () + ")";
+  }
+
+  virtual bool can_produce_in_parallel () const
+  {
+    return true;
+  }
+};
+
+static std::vector<tl::Variant> pd2_parameters (long w, long n)
+{
+  std::vector<tl::Variant> p;
+  p.push_back (tl::Variant (w));
+  p.push_back (tl::Variant (n));
+  return p;
+}
+
+//  parallel production
+TEST(2)
+{
+  db::Layout serial, parallel;
+  db::pcell_id_type pd_serial = serial.register_pcell ("PD2", new PD2 ());
+  db::pcell_id_type pd_parallel = parallel.register_pcell ("PD2", new PD2 ());
+
+  std::vector<std::vector<tl::Variant> > parameters;
+  for (long i = 0; i < 50; ++i) {
+    parameters.push_back (pd2_parameters (10 + i % 20, i % 7));
+  }
+  parameters.push_back (pd2_parameters (10, 0));
+  parameters.push_back (pd2_parameters (10, -1));
+
+  std::vector<db::cell_index_type> serial_cells;
+  for (std::vector<std::vector<tl::Variant> >::const_iterator p = parameters.begin (); p != parameters.end (); ++p) {
+    serial_cells.push_back (serial.get_pcell_variant (pd_serial, *p));
+  }
+
+  std::vector<db::cell_index_type> parallel_cells = parallel.get_pcell_variants (pd_parallel, parameters, 4);
+
+  EXPECT_EQ (parallel_cells.size (), parameters.size ());
+  EXPECT_EQ (parallel.cells (), serial.cells ());
+  EXPECT_EQ (parallel_cells == serial_cells, true);
+
+  //  duplicate parameter sets deliver the same variant
+  EXPECT_EQ (parallel_cells [0], parallel_cells [50]);
+
+  for (size_t i = 0; i < parallel_cells.size (); ++i) {
+    EXPECT_EQ (parallel.display_name (parallel_cells [i]), serial.display_name (serial_cells [i]));
+  }
+
+  EXPECT_EQ (parallel.display_name (parallel_cells [3]), "PD2(w=13,n=3)");
+  EXPECT_EQ (parallel.cell (parallel_cells [3]).shapes (0).size (), size_t (3));
+  EXPECT_EQ (parallel.cell (parallel_cells [3]).shapes (1).size (), size_t (4));
+
+  //  errors are reported as texts like in serial production
+  db::ShapeIterator s = parallel.cell (parallel_cells.back ()).shapes (0).begin (db::ShapeIterator::All);
+  EXPECT_EQ (s.at_end (), false);
+  EXPECT_EQ (s->is_text (), true);
+  EXPECT_EQ (std::string (s->text_string ()), "negative count");
+
+  EXPECT_EQ (db::compare_layouts (parallel, serial, db::layout_diff::f_verbose, 0, 100), true);
+}
+
+static std::string cell_content (const db::Cell &cell)
+{
+  std::string s;
+  for (db::Layout::layer_iterator l = cell.layout ()->begin_layers (); l != cell.layout ()->end_layers (); ++l) {
+    std::set<std::string> shapes;
+    for (db::ShapeIterator sh = cell.shapes ((*l).first).begin (db::ShapeIterator::All); ! sh.at_end (); ++sh) {
+      shapes.insert (sh->to_string ());
+    }
+    s += tl::to_string ((*l).first) + ":" + tl::join (std::vector<std::string> (shapes.begin (), shapes.end ()), ";") + "\n";
+  }
+  return s;
+}
+
+//  PCell variant cache
+TEST(3)
+{
+  db::Library *lib = new db::Library ();
+  lib->set_name ("PCellVariantCacheTestLib");
+  db::pcell_id_type pd = lib->layout ().register_pcell ("PD2", new PD2 ());
+  db::LibraryManager::instance ().register_lib (lib);
+
+  std::string cache_path = tl::combine_path (tl::testtmp (), "pcell_cache");
+  tl::rm_dir_recursive (cache_path);
+  db::PCellVariantCache::set_path (cache_path);
+  EXPECT_EQ (tl::file_exists (cache_path), true);
+
+  try {
+
+    s_pd2_produced = 0;
+
+    db::cell_index_type ci = lib->layout ().get_pcell_variant (pd, pd2_parameters (20, 4));
+    EXPECT_EQ (s_pd2_produced, 1);
+
+    std::string produced = cell_content (lib->layout ().cell (ci));
+    EXPECT_EQ (produced.empty (), false);
+
+    //  producing the variant again takes the geometry from the cache
+    db::PCellVariant *variant = dynamic_cast<db::PCellVariant *> (&lib->layout ().cell (ci));
+    tl_assert (variant != 0);
+    variant->update ();
+    EXPECT_EQ (s_pd2_produced, 1);
+    EXPECT_EQ (lib->layout ().display_name (ci), "PD2(w=20,n=4)");
+
+    EXPECT_EQ (cell_content (lib->layout ().cell (ci)), produced);
+
+    //  a new parameter set is produced
+    lib->layout ().get_pcell_variant (pd, pd2_parameters (20, 5));
+    EXPECT_EQ (s_pd2_produced, 2);
+
+    //  variants in non-library layouts are not cached
+    db::Layout local;
+    db::pcell_id_type pd_local = local.register_pcell ("PD2", new PD2 ());
+    db::cell_index_type ci_local = local.get_pcell_variant (pd_local, pd2_parameters (20, 4));
+    EXPECT_EQ (s_pd2_produced, 3);
+    dynamic_cast<db::PCellVariant *> (&local.cell (ci_local))->update ();
+    EXPECT_EQ (s_pd2_produced, 4);
+
+  } catch (...) {
+    db::PCellVariantCache::set_path (std::string ());
+    db::LibraryManager::instance ().delete_lib (lib);
+    throw;
+  }
+
+  db::PCellVariantCache::set_path (std::string ());
+  db::LibraryManager::instance ().delete_lib (lib);
+}
+
+//  reading library PCell variants with "pcell_threads"
+TEST(4)
+{
+  const char *lib_name = "PCellThreadsTestLib";
+
+  db::Library *lib = new db::Library ();
+  lib->set_name (lib_name);
+  db::pcell_id_type pd = lib->layout ().register_pcell ("PD2", new PD2 ());
+  db::LibraryManager::instance ().register_lib (lib);
+
+  std::string tmp_file = _this->tmp_file ("tmp_pcell_threads.gds");
+
+  {
+    db::Layout ly;
+    db::Cell &top = ly.cell (ly.add_cell ("TOP"));
+
+    //  40 instances of 20 different variants
+    for (long i = 0; i < 40; ++i) {
+      db::cell_index_type lib_ci = lib->layout ().get_pcell_variant (pd, pd2_parameters (10 + i % 10, 1 + i % 4));
+      db::cell_index_type ci = ly.get_lib_proxy (lib, lib_ci);
+      top.insert (db::CellInstArray (db::CellInst (ci), db::Trans (db::Vector (0, i * 1000))));
+    }
+
+    db::Writer writer = db::Writer (db::SaveLayoutOptions ());
+    tl::OutputStream stream (tmp_file);
+    writer.write (ly, stream);
+  }
+
+  //  a fresh library without variants
+  db::LibraryManager::instance ().delete_lib (lib);
+  lib = new db::Library ();
+  lib->set_name (lib_name);
+  lib->layout ().register_pcell ("PD2", new PD2 ());
+  db::LibraryManager::instance ().register_lib (lib);
+
+  try {
+
+    s_pd2_produced = 0;
+
+    db::Layout parallel;
+    {
+      db::LoadLayoutOptions options;
+      options.get_options<db::CommonReaderOptions> ().pcell_threads = 4;
+      tl::InputStream stream (tmp_file);
+      db::Reader reader (stream);
+      reader.read (parallel, options);
+    }
+
+    //  every variant is produced once
+    EXPECT_EQ (s_pd2_produced, 20);
+
+    db::Layout serial;
+    {
+      tl::InputStream stream (tmp_file);
+      db::Reader reader (stream);
+      reader.read (serial);
+    }
+
+    //  the serial reader finds the variants prepared before
+    EXPECT_EQ (s_pd2_produced, 20);
+
+    size_t proxies = 0;
+    for (db::Layout::const_iterator c = parallel.begin (); c != parallel.end (); ++c) {
+      if (c->is_proxy ()) {
+        ++proxies;
+      }
+    }
+    EXPECT_EQ (proxies, size_t (20));
+
+    EXPECT_EQ (db::compare_layouts (parallel, serial, db::layout_diff::f_verbose, 0, 100), true);
+
+  } catch (...) {
+    db::LibraryManager::instance ().delete_lib (lib);
+    throw;
+  }
+
+  db::LibraryManager::instance ().delete_lib (lib);
+}
@@ -1339,3 +1339,177 @@ TEST(28)
   db::Polygon b (db::Box (-1000000000, -1000000000, 1000000000, 1000000000));
   EXPECT_EQ (b.perimeter (), 8000000000.0);
 }
+
+TEST(29)
+{
+  //  packed contours
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 200; ++i) {
+    double a = M_PI * 2.0 * i / 200.0;
+    pts.push_back (db::Point (100000000 + db::coord_traits<db::Coord>::rounded (10000.0 * cos (a)), -200000000 + db::coord_traits<db::Coord>::rounded (5000.0 * sin (a))));
+  }
+
+  std::vector<db::Point> hole;
+  for (int i = 0; i < 50; ++i) {
+    hole.push_back (db::Point (100000000 - 2000 + i * 80, -200000000 + (i % 2) * 15));
+  }
+  hole.push_back (db::Point (100000000 + 2000, -200000000 + 1000));
+  hole.push_back (db::Point (100000000 - 2000, -200000000 + 1000));
+
+  db::Polygon p;
+  p.assign_hull (pts.begin (), pts.end ());
+  p.insert_hole (hole.begin (), hole.end ());
+
+  db::Polygon pp (p);
+  EXPECT_EQ (pp.hull ().is_packed (), false);
+  pp.pack ();
+  EXPECT_EQ (pp.hull ().is_packed (), true);
+  EXPECT_EQ (pp.hole (0).is_packed (), true);
+
+  EXPECT_EQ (pp == p, true);
+  EXPECT_EQ (pp < p || p < pp, false);
+  EXPECT_EQ (pp.to_string (), p.to_string ());
+  EXPECT_EQ (pp.hull ().size (), p.hull ().size ());
+  EXPECT_EQ (pp.hull ().bbox ().to_string (), p.hull ().bbox ().to_string ());
+  EXPECT_EQ (pp.hull ().is_hole (), false);
+  EXPECT_EQ (pp.hole (0).is_hole (), true);
+  EXPECT_EQ (pp.area (), p.area ());
+  EXPECT_EQ (pp.perimeter (), p.perimeter ());
+  EXPECT_EQ (pp.is_rectilinear (), false);
+
+  //  copies stay packed
+  db::Polygon pc (pp);
+  EXPECT_EQ (pc.hull ().is_packed (), true);
+  EXPECT_EQ (pc.to_string (), p.to_string ());
+
+  //  moving keeps the packed representation
+  pc.move (db::Vector (-100000000, 200000000));
+  EXPECT_EQ (pc.hull ().is_packed (), true);
+  EXPECT_EQ (pc.to_string (), p.moved (db::Vector (-100000000, 200000000)).to_string ());
+
+  //  transformation delivers unpacked contours
+  db::Polygon pt = pp.transformed (db::Trans (db::Trans::r90));
+  EXPECT_EQ (pt.hull ().is_packed (), false);
+  EXPECT_EQ (pt.to_string (), p.transformed (db::Trans (db::Trans::r90)).to_string ());
+
+  //  references from packed polygons
+  db::GenericRepository rep;
+  db::PolygonRef ref1 (p, rep);
+  db::PolygonRef ref2 (pp, rep);
+  EXPECT_EQ (ref1.ptr () == ref2.ptr (), true);
+  EXPECT_EQ (ref2.instantiate ().to_string (), p.to_string ());
+
+  db::Polygon::contour_type cu (pp.hull ());
+  EXPECT_EQ (cu.is_packed (), true);
+  cu.unpack ();
+  EXPECT_EQ (cu.is_packed (), false);
+  EXPECT_EQ (cu == p.hull (), true);
+
+  //  rectilinear contours are packed on top of the manhattan compression
+  std::vector<db::Point> stairs;
+  for (int i = 0; i < 100; ++i) {
+    stairs.push_back (db::Point (i * 10, i * 12));
+    stairs.push_back (db::Point (i * 10 + 10, i * 12));
+  }
+  stairs.push_back (db::Point (1000, 0));
+
+  db::SimplePolygon sp;
+  sp.assign_hull (stairs.begin (), stairs.end ());
+  db::SimplePolygon spp (sp);
+  spp.pack ();
+  EXPECT_EQ (spp.hull ().is_packed (), true);
+  EXPECT_EQ (spp.is_rectilinear (), true);
+  EXPECT_EQ (spp.to_string (), sp.to_string ());
+  EXPECT_EQ (spp.area (), sp.area ());
+  EXPECT_EQ (spp.box ().to_string (), sp.box ().to_string ());
+
+  //  small contours are not packed
+  db::SimplePolygon box (db::Box (0, 0, 100, 200));
+  box.pack ();
+  EXPECT_EQ (box.hull ().is_packed (), false);
+  EXPECT_EQ (box.to_string (), "(0,0;0,200;100,200;100,0)");
+}
+
+TEST(30)
+{
+  //  sequential access to packed contours through iterators in both directions
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 300; ++i) {
+    double a = M_PI * 2.0 * i / 300.0;
+    double r = (i % 7 == 0) ? 900000.0 : 1000.0 + (i % 3) * 17.0;
+    pts.push_back (db::Point (db::coord_traits<db::Coord>::rounded (r * cos (a)), db::coord_traits<db::Coord>::rounded (r * sin (a))));
+  }
+
+  db::Polygon p;
+  p.assign_hull (pts.begin (), pts.end ());
+
+  std::vector<db::Point> stairs;
+  for (int i = 0; i < 100; ++i) {
+    stairs.push_back (db::Point (i * 10, i * (i % 5 == 0 ? 20000 : 12)));
+    stairs.push_back (db::Point (i * 10 + 10, i * (i % 5 == 0 ? 20000 : 12)));
+  }
+  stairs.push_back (db::Point (1000, 0));
+  p.insert_hole (stairs.begin (), stairs.end ());
+
+  db::Polygon pp (p);
+  pp.pack ();
+  EXPECT_EQ (pp.hull ().is_packed (), true);
+  EXPECT_EQ (pp.hole (0).is_packed (), true);
+
+  for (unsigned int c = 0; c < 2; ++c) {
+
+    const db::Polygon::contour_type &ctr = pp.contour (c);
+    const db::Polygon::contour_type &ref = p.contour (c);
+    EXPECT_EQ (ctr.size (), ref.size ());
+
+    //  forward
+    size_t n = 0;
+    bool same = true;
+    for (db::Polygon::polygon_contour_iterator i = ctr.begin (); i != ctr.end (); ++i, ++n) {
+      same = same && (*i == ref [n]);
+    }
+    EXPECT_EQ (same, true);
+    EXPECT_EQ (n, ref.size ());
+
+    //  backward
+    db::Polygon::polygon_contour_iterator i = ctr.end ();
+    same = true;
+    while (i != ctr.begin ()) {
+      --i;
+      --n;
+      same = same && (*i == ref [n]);
+    }
+    EXPECT_EQ (same, true);
+    EXPECT_EQ (n, size_t (0));
+
+    //  back and forth
+    i = ctr.begin () + 20;
+    same = true;
+    for (size_t k = 0; k < 40; ++k) {
+      if ((k / 3) % 2 == 0) {
+        ++i;
+      } else {
+        --i;
+      }
+      same = same && (*i == ref [i - ctr.begin ()]);
+    }
+    EXPECT_EQ (same, true);
+
+  }
+
+  //  edges
+  db::Polygon::polygon_edge_iterator e = pp.begin_edge ();
+  db::Polygon::polygon_edge_iterator er = p.begin_edge ();
+  size_t ne = 0;
+  bool same = true;
+  while (! e.at_end () && ! er.at_end ()) {
+    same = same && (*e == *er);
+    ++e;
+    ++er;
+    ++ne;
+  }
+  EXPECT_EQ (same, true);
+  EXPECT_EQ (e.at_end (), true);
+  EXPECT_EQ (er.at_end (), true);
+  EXPECT_EQ (ne, p.vertices ());
+}
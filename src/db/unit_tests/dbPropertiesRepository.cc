@@ -259,3 +259,67 @@ TEST(6)
   EXPECT_EQ (pid2, size_t (2));
 }
 
+
+TEST(7)
+{
+  db::PropertiesRepository rep;
+
+  //  hash values are compatible with tl::Variant's equality
+  EXPECT_EQ (db::hash_for_property_value (tl::Variant (2)) == db::hash_for_property_value (tl::Variant (2.0)), true);
+  EXPECT_EQ (db::hash_for_property_value (tl::Variant (0.0)) == db::hash_for_property_value (tl::Variant (-0.0)), true);
+  EXPECT_EQ (db::hash_for_property_value (tl::Variant ("A")) == db::hash_for_property_value (tl::Variant (std::string ("A"))), true);
+
+  db::PropertiesRepository::properties_set set1;
+  set1.insert (std::make_pair (0, tl::Variant (2)));
+  set1.insert (std::make_pair (1, tl::Variant ("NET1")));
+
+  db::PropertiesRepository::properties_set set2;
+  set2.insert (std::make_pair (0, tl::Variant (2.0)));
+  set2.insert (std::make_pair (1, tl::Variant (std::string ("NET1"))));
+
+  db::PropertiesRepository::properties_set set3;
+  set3.insert (std::make_pair (1, tl::Variant ("NET2")));
+
+  EXPECT_EQ (rep.properties_id (db::PropertiesRepository::properties_set ()), db::properties_id_type (0));
+  EXPECT_EQ (rep.properties_id (set1), db::properties_id_type (1));
+  EXPECT_EQ (rep.properties_id (set2), db::properties_id_type (1));
+  EXPECT_EQ (rep.properties_id (set3), db::properties_id_type (2));
+  EXPECT_EQ (rep.properties_ids_by_name_value (std::make_pair (db::property_names_id_type (1), tl::Variant ("NET2"))).size (), size_t (1));
+
+  //  change_properties updates the lookup tables
+  rep.change_properties (2, set2);
+  EXPECT_EQ (rep.properties_ids_by_name_value (std::make_pair (db::property_names_id_type (1), tl::Variant ("NET2"))).size (), size_t (0));
+  EXPECT_EQ (rep.properties_id (set3), db::properties_id_type (3));
+
+  //  in-place modification requires "rehash"
+  for (db::PropertiesRepository::non_const_iterator p = rep.begin_non_const (); p != rep.end_non_const (); ++p) {
+    if (p->first == 3) {
+      p->second.begin ()->second = tl::Variant ("NET3");
+    }
+  }
+  rep.rehash ();
+
+  db::PropertiesRepository::properties_set set4;
+  set4.insert (std::make_pair (1, tl::Variant ("NET3")));
+  EXPECT_EQ (rep.properties_id (set4), db::properties_id_type (3));
+  EXPECT_EQ (rep.properties_ids_by_name_value (std::make_pair (db::property_names_id_type (1), tl::Variant ("NET3"))).size (), size_t (1));
+}
+
+TEST(8)
+{
+  db::PropertiesRepository rep;
+
+  db::PropertiesRepository::properties_set empty;
+  db::PropertiesRepository::properties_set set1;
+  set1.insert (std::make_pair (0, tl::Variant ("A")));
+
+  EXPECT_EQ (rep.properties_id (empty), db::properties_id_type (0));
+
+  //  once Id 0 is changed, the empty set is no longer Id 0
+  rep.change_properties (0, set1);
+  db::properties_id_type pid = rep.properties_id (empty);
+  EXPECT_EQ (pid != db::properties_id_type (0), true);
+  EXPECT_EQ (rep.properties (pid).empty (), true);
+  EXPECT_EQ (rep.properties_id (empty), pid);
+  EXPECT_EQ (rep.properties_id (set1), db::properties_id_type (0));
+}
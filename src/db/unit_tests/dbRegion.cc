@@ -25,6 +25,7 @@
 
 #include "dbRegion.h"
 #include "dbBoxScanner.h"
+#include "dbEdgeProcessor.h"
 
 #include <cstdio>
 
@@ -1329,3 +1330,42 @@ TEST(30c)
   EXPECT_EQ (r.to_string (), "(-100,-100;-100,0;0,0;0,200;100,200;100,0;0,0;0,-100)");
 }
 
+TEST(31)
+{
+  db::Region a, b, c, d;
+  a.insert (db::Box (db::Point (0, 0), db::Point (100, 100)));
+  a.insert (db::Box (db::Point (50, 50), db::Point (150, 150)));
+  b.insert (db::Box (db::Point (200, 0), db::Point (300, 100)));
+  c.insert (db::Box (db::Point (80, -50), db::Point (250, 50)));
+  d.insert (db::Box (db::Point (-50, 0), db::Point (280, 20)));
+
+  std::vector<const db::Region *> inputs;
+  inputs.push_back (&a);
+  inputs.push_back (&b);
+  inputs.push_back (&c);
+  inputs.push_back (&d);
+
+  db::Region r = db::Region::boolean_expression (inputs, db::BooleanExpression ("(0|1)-(2&3)"));
+  EXPECT_EQ (r.is_merged (), true);
+  EXPECT_EQ ((r ^ ((a | b) - (c & d))).empty (), true);
+  EXPECT_EQ (r.area (), ((a | b) - (c & d)).area ());
+
+  r = db::Region::boolean_expression (inputs, db::BooleanExpression ("0^1^2"));
+  EXPECT_EQ ((r ^ ((a ^ b) ^ c)).empty (), true);
+
+  r = db::Region::boolean_expression (inputs, db::BooleanExpression ("0&2|1&3"));
+  EXPECT_EQ ((r ^ ((a & c) | (b & d))).empty (), true);
+
+  //  null inputs are taken as empty regions
+  inputs [1] = 0;
+  r = db::Region::boolean_expression (inputs, db::BooleanExpression ("0|1"));
+  EXPECT_EQ (r.to_string (), "(0,0;0,100;50,100;50,150;150,150;150,50;100,50;100,0)");
+
+  std::string err;
+  try {
+    db::Region::boolean_expression (inputs, db::BooleanExpression ("4"));
+  } catch (tl::Exception &) {
+    err = "error";
+  }
+  EXPECT_EQ (err, "error");
+}
@@ -32,6 +32,7 @@
 #include "dbEdge.h"
 #include "dbUserObject.h"
 #include "tlUnitTest.h"
+#include "tlThreads.h"
 
 
 TEST(1) 
@@ -408,3 +409,219 @@ TEST(4)
 
 }
 
+
+TEST(5) 
+{
+  //  hashed repository: equal shapes are shared, different ones are not
+
+  db::repository<db::Polygon> rep;
+
+  db::Polygon p1 (db::Box (0, 0, 100, 200));
+  db::Polygon p2 (db::Box (0, 0, 200, 100));
+
+  db::Polygon p3 (db::Box (0, 0, 1000, 1000));
+  db::Polygon h (db::Box (100, 100, 200, 200));
+  p3.insert_hole (h.begin_hull (), h.end_hull ());
+
+  const db::Polygon *r1 = rep.insert (p1);
+  const db::Polygon *r2 = rep.insert (p2);
+  const db::Polygon *r3 = rep.insert (p3);
+  EXPECT_EQ (rep.size (), size_t (3));
+  EXPECT_EQ (r1 != r2, true);
+  EXPECT_EQ (r2 != r3, true);
+
+  for (int i = 0; i < 1000; ++i) {
+    rep.insert (db::Polygon (db::Box (0, 0, 10 + i, 10)));
+  }
+  EXPECT_EQ (rep.size (), size_t (1003));
+
+  //  pointers stay valid after rehashing
+  EXPECT_EQ (rep.insert (db::Polygon (db::Box (0, 0, 100, 200))) == r1, true);
+  EXPECT_EQ (rep.insert (p3) == r3, true);
+  EXPECT_EQ (r1->to_string (), "(0,0;0,200;100,200;100,0)");
+  EXPECT_EQ (rep.size (), size_t (1003));
+
+  db::repository<db::Text> trep;
+  const db::Text *t1 = trep.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  const db::Text *t2 = trep.insert (db::Text ("B", db::Trans (db::Vector (1, 2))));
+  const db::Text *t3 = trep.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  EXPECT_EQ (t1 != t2, true);
+  EXPECT_EQ (t1 == t3, true);
+  EXPECT_EQ (trep.size (), size_t (2));
+}
+
+namespace
+{
+
+class RepositoryInsertThread
+  : public tl::Thread
+{
+public:
+  RepositoryInsertThread (db::GenericRepository *rep)
+    : mp_rep (rep)
+  { }
+
+  std::vector<db::PolygonRef> refs;
+
+protected:
+  void run ()
+  {
+    for (int i = 0; i < 10000; ++i) {
+      refs.push_back (db::PolygonRef (db::Polygon (db::Box (0, 0, 100 + (i % 100), 100)), *mp_rep));
+    }
+  }
+
+private:
+  db::GenericRepository *mp_rep;
+};
+
+}
+
+TEST(6) 
+{
+  //  concurrent inserts
+
+  db::GenericRepository rep;
+
+  std::vector<RepositoryInsertThread *> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back (new RepositoryInsertThread (&rep));
+  }
+  for (std::vector<RepositoryInsertThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->start ();
+  }
+  for (std::vector<RepositoryInsertThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->wait ();
+  }
+
+  EXPECT_EQ (rep.repository (db::Polygon::tag ()).size (), size_t (100));
+
+  for (size_t i = 0; i < 100; ++i) {
+    const db::Polygon *p = threads.front ()->refs [i].ptr ();
+    for (std::vector<RepositoryInsertThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+      EXPECT_EQ ((*t)->refs [i].ptr () == p, true);
+    }
+  }
+
+  for (std::vector<RepositoryInsertThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    delete *t;
+  }
+}
+
+TEST(7)
+{
+  //  arena mode
+
+  db::GenericRepository *rep = new db::GenericRepository ();
+  EXPECT_EQ (rep->use_arena (), false);
+
+  db::Polygon p0 (db::Box (0, 0, 100, 300));
+  db::PolygonRef r0 (p0, *rep);
+  EXPECT_EQ (r0.ptr ()->hull ().is_external (), false);
+
+  rep->set_use_arena (true);
+  EXPECT_EQ (rep->use_arena (), true);
+
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 50; ++i) {
+    pts.push_back (db::Point (i * 10, (i % 2) * 5));
+  }
+  pts.push_back (db::Point (500, 1000));
+  pts.push_back (db::Point (0, 1000));
+
+  db::Polygon p1;
+  p1.assign_hull (pts.begin (), pts.end ());
+  db::Polygon p2 (p1);
+  p2.pack ();
+  db::SimplePolygon p3;
+  p3.assign_hull (pts.begin (), pts.end ());
+
+  std::vector<db::PolygonRef> refs;
+  for (int i = 0; i < 100; ++i) {
+    refs.push_back (db::PolygonRef (p1.moved (db::Vector (i * 1000, 0)), *rep));
+    refs.push_back (db::PolygonRef (db::Polygon (db::Box (0, 0, 100 + i, 200)), *rep));
+  }
+  db::PolygonRef r2 (p2, *rep);
+  db::SimplePolygonRef r3 (p3, *rep);
+
+  EXPECT_EQ (rep->repository (db::Polygon::tag ()).size (), size_t (102));
+  EXPECT_EQ (r0.ptr ()->hull ().is_external (), false);
+  EXPECT_EQ (refs [0].ptr () == refs [2].ptr (), true);
+  EXPECT_EQ (refs [0].ptr () == r2.ptr (), true);
+  EXPECT_EQ (refs [1].ptr ()->hull ().is_external (), true);
+  EXPECT_EQ (refs [0].ptr ()->hull ().is_external (), true);
+  EXPECT_EQ (r3.ptr ()->hull ().is_external (), true);
+
+  EXPECT_EQ (refs [10].instantiate ().to_string (), p1.moved (db::Vector (5000, 0)).to_string ());
+  EXPECT_EQ (refs [11].instantiate ().to_string (), "(0,0;0,200;105,200;105,0)");
+  EXPECT_EQ (r3.instantiate ().to_string (), p3.to_string ());
+
+  //  copies are regular objects again
+  db::Polygon pc (*refs [0].ptr ());
+  EXPECT_EQ (pc.hull ().is_external (), false);
+  EXPECT_EQ (pc.to_string (), refs [0].ptr ()->to_string ());
+
+  //  copies of the shapes into another layout remain valid when the repository is gone
+  db::Layout layout;
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &cell = layout.cell (layout.add_cell ());
+  db::Shapes shapes (db::default_editable_mode ());
+  for (std::vector<db::PolygonRef>::const_iterator r = refs.begin (); r != refs.end (); ++r) {
+    shapes.insert (*r);
+  }
+  cell.shapes (l1) = shapes;
+  shapes.clear ();
+  refs.clear ();
+
+  *rep = db::GenericRepository ();
+  EXPECT_EQ (rep->use_arena (), false);
+  EXPECT_EQ (rep->repository (db::Polygon::tag ()).size (), size_t (0));
+
+  delete rep;
+  rep = 0;
+
+  EXPECT_EQ (layout.shape_repository ().repository (db::Polygon::tag ()).size (), size_t (101));
+  EXPECT_EQ (layout.shape_repository ().use_arena (), false);
+  EXPECT_EQ (cell.shapes (l1).size (), size_t (200));
+  cell.shapes (l1).update ();
+  EXPECT_EQ (cell.shapes (l1).bbox ().to_string (), "(0,0;99500,1000)");
+}
+
+TEST(8)
+{
+  //  hash quality: small, structured coordinate changes must not produce identical hashes
+
+  EXPECT_EQ (db::repository_hash (db::Box (0, 0, 100, 100)) != db::repository_hash (db::Box (1, 16, 100, 100)), true);
+  EXPECT_EQ (db::repository_hash (db::Polygon (db::Box (0, 0, 100, 100))) != db::repository_hash (db::Polygon (db::Box (1, 16, 100, 100))), true);
+
+  db::repository<db::Polygon> rep;
+  const db::Polygon *r1 = rep.insert (db::Polygon (db::Box (0, 0, 100, 100)));
+  const db::Polygon *r2 = rep.insert (db::Polygon (db::Box (1, 16, 100, 100)));
+  EXPECT_EQ (r1 != r2, true);
+  EXPECT_EQ (rep.size (), size_t (2));
+
+  //  floating-point shapes: equality is exact, so shapes differing below the fuzzy
+  //  precision are kept separately (hash and equality need to be consistent)
+
+  db::DPolygon p1 (db::DBox (0.000004, 0, 1, 1));
+  db::DPolygon p2 (db::DBox (0.000006, 0, 1, 1));
+  EXPECT_EQ (p1 == p2, false);
+  EXPECT_EQ (p1 == db::DPolygon (p1), true);
+  EXPECT_EQ (db::repository_hash (p1) == db::repository_hash (db::DPolygon (p1)), true);
+  EXPECT_EQ (db::repository_hash (db::DBox (0.0, 0, 1, 1)) == db::repository_hash (db::DBox (-0.0, 0, 1, 1)), true);
+
+  db::repository<db::DPolygon> drep;
+  const db::DPolygon *d1 = drep.insert (p1);
+  const db::DPolygon *d2 = drep.insert (p2);
+  EXPECT_EQ (d1 != d2, true);
+  EXPECT_EQ (drep.insert (p1) == d1, true);
+  EXPECT_EQ (drep.insert (p2) == d2, true);
+  EXPECT_EQ (drep.size (), size_t (2));
+
+  db::repository<db::DText> dtrep;
+  const db::DText *t1 = dtrep.insert (db::DText ("A", db::DTrans (db::DVector (0.000004, 0))));
+  const db::DText *t2 = dtrep.insert (db::DText ("A", db::DTrans (db::DVector (0.000006, 0))));
+  EXPECT_EQ (t1 != t2, true);
+  EXPECT_EQ (dtrep.insert (db::DText ("A", db::DTrans (db::DVector (0.000004, 0)))) == t1, true);
+  EXPECT_EQ (dtrep.size (), size_t (2));
+}
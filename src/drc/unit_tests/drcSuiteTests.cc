@@ -25,7 +25,7 @@
 #include "dbTestSupport.h"
 #include "lymMacro.h"
 
-void runtest (tl::TestBase *_this, int mode)
+void runtest (tl::TestBase *_this, int mode, int au_mode = 0)
 {
   std::string rs = tl::testsrc ();
   rs += "/testdata/drc/drcSuiteTests.drc";
@@ -35,7 +35,7 @@ void runtest (tl::TestBase *_this, int mode)
 
   std::string au = tl::testsrc ();
   au += "/testdata/drc/drcSuiteTests_au";
-  au += tl::to_string (mode);
+  au += tl::to_string (au_mode > 0 ? au_mode : mode);
   au += ".oas";
 
   std::string output = _this->tmp_file ("tmp.gds");
@@ -94,3 +94,38 @@ TEST(4)
   test_is_long_runner ();
   runtest (_this, 4);
 }
+
+//  deferred mode must render the same results as flat mode
+TEST(5)
+{
+  runtest (_this, 5, 1);
+}
+
+//  raw layers are not deferred: the script checks deferred vs. eager results
+TEST(6)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/drcSuiteTests.drc";
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string output = this->tmp_file ("tmp.gds");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = '%s'\n"
+        "$drc_test_target = '%s'\n"
+        "$drc_test_mode = %d\n"
+      , input, output, 6)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+}
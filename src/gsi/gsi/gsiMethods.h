@@ -186,6 +186,31 @@ public:
     return m_protected;
   }
 
+  /**
+   *  @brief Returns a value indicating whether the method may run concurrently with other script threads
+   *
+   *  Such methods do not touch script objects except through callbacks. Interpreters with a
+   *  global lock (i.e. Python) can release the lock while such a method executes.
+   *  Callbacks into the interpreter need to acquire the lock again.
+   *  This flag is set with "gsi::allow_threads".
+   *
+   *  NOTE: while the lock is released, other script threads may modify the objects
+   *  passed to the method (including "self"). There is no protection against this:
+   *  scripts must not modify these objects while the method executes.
+   */
+  bool allows_threads () const
+  {
+    return m_allows_threads;
+  }
+
+  /**
+   *  @brief Sets a value indicating whether the method may run concurrently with other script threads
+   */
+  void set_allows_threads (bool f)
+  {
+    m_allows_threads = f;
+  }
+
   /**
    *  @brief Returns the documentation string
    */
@@ -525,6 +550,7 @@ private:
   bool m_const : 1;
   bool m_static : 1;
   bool m_protected : 1;
+  bool m_allows_threads : 1;
   unsigned int m_argsize;
   std::vector<MethodSynonym> m_method_synonyms;
 
@@ -685,6 +711,21 @@ inline Methods operator+ (const Methods &a, const Methods &b)
   return Methods (a) + b;
 }
 
+/**
+ *  @brief Marks the given methods as being able to run concurrently with other script threads
+ *
+ *  Use this function on declarations of long-running methods which do not access script
+ *  objects other than through callbacks. See MethodBase::allows_threads for details.
+ */
+inline Methods allow_threads (const Methods &methods)
+{
+  Methods m (methods);
+  for (Methods::iterator i = m.begin (); i != m.end (); ++i) {
+    (*i)->set_allows_threads (true);
+  }
+  return m;
+}
+
 template <class X>
 class MethodSpecificBase 
   : public MethodBase
@@ -25,6 +25,7 @@
 #include "dbGDS2Reader.h"
 #include "dbGDS2.h"
 #include "dbArray.h"
+#include "dbLayoutUtils.h"
 
 #include "tlException.h"
 #include "tlString.h"
@@ -64,7 +65,13 @@ GDS2Reader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
   --m_recnum;
   m_reclen = 0;
 
-  return basic_read (layout, m_common_options.layer_map, m_common_options.create_other_layers, m_common_options.enable_text_objects, m_common_options.enable_properties, m_options.allow_multi_xy_records, m_options.box_mode);
+  const db::LayerMap &lm = basic_read (layout, m_common_options.layer_map, m_common_options.create_other_layers, m_common_options.enable_text_objects, m_common_options.enable_properties, m_options.allow_multi_xy_records, m_options.box_mode, m_common_options.pcell_threads, m_common_options.pack_polygons);
+
+  if (m_common_options.deduplicate_cells) {
+    db::deduplicate_cells (layout);
+  }
+
+  return lm;
 }
 
 const LayerMap &
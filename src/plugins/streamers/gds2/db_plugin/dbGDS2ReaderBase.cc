@@ -73,7 +73,9 @@ GDS2ReaderBase::GDS2ReaderBase ()
     m_read_texts (true),
     m_read_properties (true),
     m_allow_multi_xy_records (false),
-    m_box_mode (0)
+    m_box_mode (0),
+    m_pcell_threads (0),
+    m_pack_polygons (false)
 {
   // .. nothing yet ..
 }
@@ -84,7 +86,7 @@ GDS2ReaderBase::~GDS2ReaderBase ()
 }
 
 const LayerMap &
-GDS2ReaderBase::basic_read (db::Layout &layout, const LayerMap &layer_map, bool create_other_layers, bool enable_text_objects, bool enable_properties, bool allow_multi_xy_records, unsigned int box_mode)
+GDS2ReaderBase::basic_read (db::Layout &layout, const LayerMap &layer_map, bool create_other_layers, bool enable_text_objects, bool enable_properties, bool allow_multi_xy_records, unsigned int box_mode, unsigned int pcell_threads, bool pack_polygons)
 {
   m_layer_map = layer_map;
   m_layer_map.prepare (layout);
@@ -93,6 +95,8 @@ GDS2ReaderBase::basic_read (db::Layout &layout, const LayerMap &layer_map, bool
 
   m_allow_multi_xy_records = allow_multi_xy_records;
   m_box_mode = box_mode;
+  m_pcell_threads = pcell_threads;
+  m_pack_polygons = pack_polygons;
   m_create_layers = create_other_layers;
 
   layout.start_changes ();
@@ -349,6 +353,16 @@ GDS2ReaderBase::do_read (db::Layout &layout)
 
       read_context_info_cell ();
 
+      //  produce the library PCell variants referenced in one go, so they can be produced in parallel
+      if (m_pcell_threads > 0) {
+        std::vector<std::vector<std::string> > contexts;
+        contexts.reserve (m_context_info.size ());
+        for (std::map <tl::string, std::vector <std::string> >::const_iterator ctx = m_context_info.begin (); ctx != m_context_info.end (); ++ctx) {
+          contexts.push_back (ctx->second);
+        }
+        db::Layout::prepare_proxies (contexts, m_pcell_threads);
+      }
+
     } else {
 
       db::cell_index_type cell_index = make_cell (layout, m_cellname.c_str (), false);
@@ -640,6 +654,9 @@ GDS2ReaderBase::read_boundary (db::Layout &layout, db::Cell &cell, bool from_box
         warn (tl::to_string (tr ("BOUNDARY with less than 3 points ignored")));
         finish_element ();
       } else {
+        if (m_pack_polygons) {
+          poly.pack ();
+        }
         //  this will copy the polyon:
         std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
         if (pp.first) {
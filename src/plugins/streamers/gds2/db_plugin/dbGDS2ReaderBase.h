@@ -86,9 +86,11 @@ protected:
    *  @param enable_properties A flag indicating whether to read user properties
    *  @param allow_multi_xy_records If true, tries to check for multiple XY records for BOUNDARY elements
    *  @param box_mode How to treat BOX records (0: ignore, 1: as rectangles, 2: as boundaries, 3: error)
+   *  @param pcell_threads The number of threads to use for producing library PCell variants (0: no threads)
+   *  @param pack_polygons If true, the polygons are stored in packed form
    *  @return The LayerMap object that tells where which layer was loaded
    */
-  const LayerMap &basic_read (db::Layout &layout, const LayerMap &layer_map, bool create_other_layers, bool enable_text_objects, bool enable_properties, bool allow_multi_xy_records, unsigned int box_mode);
+  const LayerMap &basic_read (db::Layout &layout, const LayerMap &layer_map, bool create_other_layers, bool enable_text_objects, bool enable_properties, bool allow_multi_xy_records, unsigned int box_mode, unsigned int pcell_threads, bool pack_polygons);
 
   /**
    *  @brief Accessor method to the current cellname
@@ -107,6 +109,8 @@ private:
   bool m_read_properties;
   bool m_allow_multi_xy_records;
   unsigned int m_box_mode;
+  unsigned int m_pcell_threads;
+  bool m_pack_polygons;
   std::map <tl::string, std::vector<std::string> > m_context_info;
   std::vector <db::Point> m_all_points;
   std::map <tl::string, tl::string> m_mapped_cellnames;
@@ -21,6 +21,7 @@
 */
 
 #include "dbGDS2Reader.h"
+#include "dbWriter.h"
 #include "dbLayoutDiff.h"
 #include "dbTestSupport.h"
 #include "tlUnitTest.h"
@@ -391,3 +392,132 @@ TEST(Bug_121_2)
   db::compare_layouts (_this, layout, fn_au, db::WriteGDS2, 1);
 }
 
+
+//  packed polygons
+
+TEST(3)
+{
+  db::Manager m;
+  db::Layout layout_org (&m);
+  db::Cell &top = layout_org.cell (layout_org.add_cell ("TOP"));
+  unsigned int l1 = layout_org.insert_layer (db::LayerProperties (1, 0));
+
+  //  OPC-like polygons with many small jogs
+  for (int n = 0; n < 10; ++n) {
+    std::vector<db::Point> pts;
+    for (int i = 0; i < 100; ++i) {
+      pts.push_back (db::Point (n * 5000 + i * 20, (i % 2) * 3 + n));
+      pts.push_back (db::Point (n * 5000 + i * 20 + 10, (i % 2) * 3 + n + 1));
+    }
+    pts.push_back (db::Point (n * 5000 + 2000, 1000));
+    pts.push_back (db::Point (n * 5000, 1000));
+    db::Polygon poly;
+    poly.assign_hull (pts.begin (), pts.end ());
+    top.shapes (l1).insert (poly);
+  }
+  top.shapes (l1).insert (db::Box (0, 0, 100, 200));
+
+  std::string tmp_file = _this->tmp_file ("tmp.gds");
+  {
+    tl::OutputStream stream (tmp_file);
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+    db::Writer writer (options);
+    writer.write (layout_org, stream);
+  }
+
+  db::Layout layout (&m), layout_packed (&m);
+
+  {
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (layout);
+  }
+
+  {
+    db::LoadLayoutOptions options;
+    options.get_options<db::CommonReaderOptions> ().pack_polygons = true;
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (layout_packed, options);
+  }
+
+  size_t packed = 0;
+  for (db::Layout::const_iterator c = layout_packed.begin (); c != layout_packed.end (); ++c) {
+    for (db::Layout::layer_iterator l = layout_packed.begin_layers (); l != layout_packed.end_layers (); ++l) {
+      for (db::ShapeIterator s = c->shapes ((*l).first).begin (db::ShapeIterator::Polygons); ! s.at_end (); ++s) {
+        if (s->type () == db::Shape::SimplePolygonRef && s->simple_polygon_ref ().obj ().hull ().is_packed ()) {
+          ++packed;
+        }
+      }
+    }
+  }
+
+  EXPECT_EQ (packed, size_t (10));
+  EXPECT_EQ (db::compare_layouts (layout_packed, layout, db::layout_diff::f_verbose, 0, 100), true);
+  EXPECT_EQ (db::compare_layouts (layout_packed, layout_org, db::layout_diff::f_verbose, 0, 100), true);
+}
+
+//  arena allocation
+
+TEST(4)
+{
+  db::Manager m;
+  db::Layout layout_org (&m);
+  db::Cell &top = layout_org.cell (layout_org.add_cell ("TOP"));
+  unsigned int l1 = layout_org.insert_layer (db::LayerProperties (1, 0));
+
+  for (int n = 0; n < 10; ++n) {
+    std::vector<db::Point> pts;
+    for (int i = 0; i < 20; ++i) {
+      pts.push_back (db::Point (n * 1000 + i * 20, (i % 2) * 3 + n));
+    }
+    pts.push_back (db::Point (n * 1000 + 400, 1000));
+    pts.push_back (db::Point (n * 1000, 1000));
+    db::Polygon poly;
+    poly.assign_hull (pts.begin (), pts.end ());
+    top.shapes (l1).insert (poly);
+  }
+
+  std::string tmp_file = _this->tmp_file ("tmp.gds");
+  {
+    tl::OutputStream stream (tmp_file);
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+    db::Writer writer (options);
+    writer.write (layout_org, stream);
+  }
+
+  db::Layout layout (&m), layout_arena (&m);
+
+  {
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (layout);
+  }
+
+  {
+    db::LoadLayoutOptions options;
+    options.get_options<db::CommonReaderOptions> ().arena_allocation = true;
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (layout_arena, options);
+  }
+
+  //  arena mode is enabled during reading only
+  EXPECT_EQ (layout_arena.shape_repository ().use_arena (), false);
+
+  size_t polygons = 0, external = 0;
+  const db::repository<db::SimplePolygon> &rep = layout_arena.shape_repository ().repository (db::SimplePolygon::tag ());
+  for (db::repository<db::SimplePolygon>::iterator p = rep.begin (); p != rep.end (); ++p) {
+    ++polygons;
+    if (p->hull ().is_external ()) {
+      ++external;
+    }
+  }
+
+  EXPECT_EQ (polygons, size_t (10));
+  EXPECT_EQ (external, polygons);
+  EXPECT_EQ (db::compare_layouts (layout_arena, layout, db::layout_diff::f_verbose, 0, 100), true);
+  EXPECT_EQ (db::compare_layouts (layout_arena, layout_org, db::layout_diff::f_verbose, 0, 100), true);
+}
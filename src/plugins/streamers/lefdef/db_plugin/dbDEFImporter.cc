@@ -24,8 +24,10 @@
 #include "dbDEFImporter.h"
 #include "dbPolygonTools.h"
 #include "tlGlobPattern.h"
+#include "tlThreadedWorkers.h"
 
 #include <cmath>
+#include <list>
 
 namespace db
 {
@@ -136,13 +138,693 @@ struct Group
   std::vector<tl::GlobPattern> comp_match;
 };
 
+// -----------------------------------------------------------------------------------
+//  Reading of NETS and SPECIALNETS sections
+
+/**
+ *  @brief The context for reading nets
+ */
+struct DEFNetsContext
+{
+  DEFNetsContext ()
+    : specialnets (false), scale (1.0), dbu (0.001), styles (0), via_desc (0), importer (0)
+  { }
+
+  bool specialnets;
+  double scale;
+  double dbu;
+  const std::map<int, db::Polygon> *styles;
+  const std::unordered_map<std::string, ViaDesc> *via_desc;
+  const DEFImporter *importer;
+};
+
+/**
+ *  @brief The shapes and via instances of a sequence of nets
+ *
+ *  The nets are read into a batch first and are put into the layout by
+ *  DEFImporter::insert_nets. That way, nets can be read in parallel. The
+ *  batch keeps the order in which the shapes were produced.
+ */
+class DEFNetsBatch
+{
+public:
+  enum entry_kind { BoxShape, PathShape, PolygonShape, ViaInstance };
+
+  struct Entry
+  {
+    Entry (entry_kind k, size_t n, size_t l, size_t i)
+      : kind (k), net (n), layer (l), index (i)
+    { }
+
+    entry_kind kind;
+    size_t net, layer, index;
+  };
+
+  void clear ()
+  {
+    m_nets.clear ();
+    m_layers.clear ();
+    m_layer_ids.clear ();
+    m_boxes.clear ();
+    m_paths.clear ();
+    m_polygons.clear ();
+    m_vias.clear ();
+    m_entries.clear ();
+  }
+
+  void begin_net (const std::string &net)
+  {
+    m_nets.push_back (net);
+  }
+
+  void add (const std::string &ln, const db::Box &box)
+  {
+    m_entries.push_back (Entry (BoxShape, current_net (), layer_id (ln), m_boxes.size ()));
+    m_boxes.push_back (box);
+  }
+
+  void add (const std::string &ln, const db::Path &path)
+  {
+    m_entries.push_back (Entry (PathShape, current_net (), layer_id (ln), m_paths.size ()));
+    m_paths.push_back (path);
+  }
+
+  void add (const std::string &ln, const db::Polygon &polygon)
+  {
+    m_entries.push_back (Entry (PolygonShape, current_net (), layer_id (ln), m_polygons.size ()));
+    m_polygons.push_back (polygon);
+  }
+
+  void add_via (const db::CellInstArray &inst)
+  {
+    m_entries.push_back (Entry (ViaInstance, current_net (), 0, m_vias.size ()));
+    m_vias.push_back (inst);
+  }
+
+  const std::vector<std::string> &nets () const { return m_nets; }
+  const std::vector<std::string> &layers () const { return m_layers; }
+  const std::vector<db::Box> &boxes () const { return m_boxes; }
+  const std::vector<db::Path> &paths () const { return m_paths; }
+  const std::vector<db::Polygon> &polygons () const { return m_polygons; }
+  const std::vector<db::CellInstArray> &vias () const { return m_vias; }
+  const std::vector<Entry> &entries () const { return m_entries; }
+
+  /**
+   *  @brief Stores the error which happened while reading the nets of this batch
+   */
+  void set_error (const LEFDEFReaderException &ex)
+  {
+    m_error.clear ();
+    m_error.push_back (ex);
+  }
+
+  /**
+   *  @brief Gets the error which happened while reading this batch or 0 if there was none
+   */
+  const LEFDEFReaderException *error () const
+  {
+    return m_error.empty () ? 0 : &m_error.front ();
+  }
+
+private:
+  std::vector<LEFDEFReaderException> m_error;
+  std::vector<std::string> m_nets;
+  std::vector<std::string> m_layers;
+  std::unordered_map<std::string, size_t> m_layer_ids;
+  std::vector<db::Box> m_boxes;
+  std::vector<db::Path> m_paths;
+  std::vector<db::Polygon> m_polygons;
+  std::vector<db::CellInstArray> m_vias;
+  std::vector<Entry> m_entries;
+
+  size_t current_net () const
+  {
+    return m_nets.empty () ? 0 : m_nets.size () - 1;
+  }
+
+  size_t layer_id (const std::string &ln)
+  {
+    std::unordered_map<std::string, size_t>::const_iterator l = m_layer_ids.find (ln);
+    if (l == m_layer_ids.end ()) {
+      l = m_layer_ids.insert (std::make_pair (ln, m_layers.size ())).first;
+      m_layers.push_back (ln);
+    }
+    return l->second;
+  }
+};
+
+/**
+ *  @brief A task for reading a chunk of nets in a worker thread
+ */
+class DEFNetsTask
+  : public tl::Task
+{
+public:
+  DEFNetsTask (size_t line, DEFNetsBatch *batch)
+    : line (line), batch (batch)
+  { }
+
+  std::string text;
+  size_t line;
+  DEFNetsBatch *batch;
+};
+
+class DEFNetsWorker;
+
+/**
+ *  @brief The job for reading nets in parallel
+ */
+class DEFNetsJob
+  : public tl::JobBase
+{
+public:
+  DEFNetsJob (int nworkers, const DEFNetsContext &ctx)
+    : tl::JobBase (nworkers), m_ctx (ctx)
+  { }
+
+  const DEFNetsContext &context () const
+  {
+    return m_ctx;
+  }
+
+protected:
+  virtual tl::Worker *create_worker ();
+
+private:
+  DEFNetsContext m_ctx;
+};
+
+/**
+ *  @brief The worker for reading nets
+ */
+class DEFNetsWorker
+  : public tl::Worker
+{
+public:
+  DEFNetsWorker (DEFNetsJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    DEFNetsTask *nets_task = dynamic_cast<DEFNetsTask *> (task);
+    if (nets_task) {
+      try {
+        DEFImporter importer;
+        importer.read_nets_from_text (nets_task->text, nets_task->line, mp_job->context (), *nets_task->batch);
+      } catch (LEFDEFReaderException &ex) {
+        //  keep the error with its batch, so it is reported with file, line and cell context
+        //  and errors are reported in the order of the file
+        nets_task->batch->set_error (ex);
+      }
+    }
+  }
+
+private:
+  DEFNetsJob *mp_job;
+};
+
+tl::Worker *
+DEFNetsJob::create_worker ()
+{
+  return new DEFNetsWorker (this);
+}
+
+//  The number of nets per task for parallel reading
+static const size_t nets_per_task = 1000;
+
+void
+DEFImporter::read_nets (db::Layout &layout, db::Cell &design, const DEFNetsContext &ctx)
+{
+  if (threads () <= 0) {
+
+    DEFNetsBatch batch;
+
+    while (test ("-")) {
+      batch.clear ();
+      read_net (ctx, batch);
+      insert_nets (layout, design, batch);
+    }
+
+  } else {
+
+    //  Split the section into chunks of nets by a raw text scan. The workers parse the text
+    //  of the chunks and the results are put into the layout in the order of the file.
+
+    DEFNetsJob job (threads (), ctx);
+    std::list<DEFNetsBatch> batches;
+
+    while (peek ("-")) {
+
+      tokenizer ().start_capture ();
+      tokenizer ().skip_statements (nets_per_task);
+
+      batches.push_back (DEFNetsBatch ());
+      DEFNetsTask *task = new DEFNetsTask (tokenizer ().capture_line (), &batches.back ());
+      tokenizer ().stop_capture (task->text);
+      job.schedule (task);
+
+    }
+
+    job.start ();
+    job.wait ();
+
+    for (std::list<DEFNetsBatch>::const_iterator b = batches.begin (); b != batches.end (); ++b) {
+      if (b->error ()) {
+        throw *b->error ();
+      }
+    }
+
+    if (job.has_error ()) {
+      throw db::ReaderException (job.error_messages ().front ());
+    }
+
+    for (std::list<DEFNetsBatch>::const_iterator b = batches.begin (); b != batches.end (); ++b) {
+      insert_nets (layout, design, *b);
+    }
+
+  }
+}
+
+void
+DEFImporter::read_nets_from_text (const std::string &text, size_t line, const DEFNetsContext &ctx, DEFNetsBatch &batch)
+{
+  LEFDEFTokenizer tokenizer (text, line);
+  attach (&tokenizer, *ctx.importer, false /*no progress from workers*/);
+
+  while (! at_end ()) {
+    expect ("-");
+    read_net (ctx, batch);
+  }
+}
+
+template <class Sh>
+static void insert_shape (db::Shapes &shapes, const Sh &sh, db::properties_id_type prop_id)
+{
+  if (prop_id != 0) {
+    shapes.insert (db::object_with_properties<Sh> (sh, prop_id));
+  } else {
+    shapes.insert (sh);
+  }
+}
+
+void
+DEFImporter::insert_nets (db::Layout &layout, db::Cell &design, const DEFNetsBatch &batch)
+{
+  std::vector<db::properties_id_type> prop_ids (batch.nets ().size (), 0);
+  if (produce_net_props ()) {
+    for (size_t i = 0; i < batch.nets ().size (); ++i) {
+      db::PropertiesRepository::properties_set props;
+      props.insert (std::make_pair (net_prop_name_id (), tl::Variant (batch.nets () [i])));
+      prop_ids [i] = layout.properties_repository ().properties_id (props);
+    }
+  }
+
+  //  layers are opened on first use, so they are created in the order of the file
+  std::vector<std::pair<bool, unsigned int> > layers (batch.layers ().size (), std::make_pair (false, 0));
+  std::vector<bool> layer_opened (batch.layers ().size (), false);
+
+  for (std::vector<DEFNetsBatch::Entry>::const_iterator e = batch.entries ().begin (); e != batch.entries ().end (); ++e) {
+
+    if (e->kind == DEFNetsBatch::ViaInstance) {
+      design.insert (batch.vias () [e->index]);
+      continue;
+    }
+
+    if (! layer_opened [e->layer]) {
+      layers [e->layer] = open_layer (layout, batch.layers () [e->layer], Routing);
+      layer_opened [e->layer] = true;
+    }
+
+    if (! layers [e->layer].first) {
+      continue;
+    }
+
+    db::Shapes &shapes = design.shapes (layers [e->layer].second);
+    db::properties_id_type prop_id = prop_ids [e->net];
+
+    //  On request, wires and polygons are stored as references: routing segments of the same
+    //  length and width share their geometry in the layout's shape repository.
+    if (e->kind == DEFNetsBatch::BoxShape) {
+      insert_shape (shapes, batch.boxes () [e->index], prop_id);
+    } else if (e->kind == DEFNetsBatch::PathShape) {
+      if (routing_shape_refs ()) {
+        insert_shape (shapes, db::PathRef (batch.paths () [e->index], layout.shape_repository ()), prop_id);
+      } else {
+        insert_shape (shapes, batch.paths () [e->index], prop_id);
+      }
+    } else {
+      if (routing_shape_refs ()) {
+        insert_shape (shapes, db::PolygonRef (batch.polygons () [e->index], layout.shape_repository ()), prop_id);
+      } else {
+        insert_shape (shapes, batch.polygons () [e->index], prop_id);
+      }
+    }
+
+  }
+}
+
+void
+DEFImporter::read_net (const DEFNetsContext &ctx, DEFNetsBatch &batch)
+{
+  std::string net = get ();
+  std::string nondefaultrule;
+  std::string stored_netname, stored_nondefaultrule;
+  std::string taperrule;
+  bool in_subnet = false;
+
+  //  the net's properties are assigned from the original name, even if a subnet changes it
+  batch.begin_net (net);
+
+  while (test ("(")) {
+    while (! test (")")) {
+      take ();
+    }
+  }
+
+  while (test ("+")) {
+
+    bool was_shield = false;
+
+    if (! ctx.specialnets && test ("SUBNET")) {
+
+      while (test ("(")) {
+        while (! test (")")) {
+          take ();
+        }
+      }
+
+      if (! in_subnet) {
+        stored_netname = net;
+        stored_nondefaultrule = nondefaultrule;
+        in_subnet = true;
+      }
+
+    } else if (! ctx.specialnets && test ("NONDEFAULTRULE")) {
+
+      nondefaultrule = get ();
+
+    } else if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
+
+      if (was_shield) {
+        take ();
+      }
+
+      taperrule.clear ();
+
+      do {
+
+        std::string ln = get ();
+
+        db::Coord w = 0;
+        if (ctx.specialnets) {
+          w = db::coord_traits<db::Coord>::rounded (get_double () * ctx.scale);
+        } 
+
+        const db::Polygon *style = 0;
+
+        int sn = std::numeric_limits<int>::max ();
+
+        if (ctx.specialnets) {
+
+          while (test ("+")) {
+
+            if (test ("STYLE")) {
+              sn = get_long ();
+            } else if (test ("SHAPE")) {
+              take ();
+            }
+
+          }
+
+        } else {
+
+          while (true) {
+            if (test ("TAPER")) {
+              taperrule.clear ();
+            } else if (test ("TAPERRULE")) {
+              taperrule = get ();
+            } else if (test ("STYLE")) {
+              sn = get_long ();
+            } else {
+              break;
+            }
+          }
+
+        }
+
+        if (! ctx.specialnets) {
+
+          const std::string *rulename = &taperrule;
+          if (rulename->empty ()) {
+            rulename = &nondefaultrule;
+          }
+
+          w = db::coord_traits<db::Coord>::rounded (ctx.importer->m_lef_importer.layer_width (ln, *rulename, 0.0) / ctx.dbu);
+
+          //  try to find local nondefault rule
+          if (! rulename->empty ()) {
+            std::unordered_map<std::string, std::unordered_map<std::string, double> >::const_iterator nd = ctx.importer->m_nondefault_widths.find (*rulename);
+            if (nd != ctx.importer->m_nondefault_widths.end ()) {
+              std::unordered_map<std::string, double>::const_iterator ld = nd->second.find (ln);
+              if (ld != nd->second.end ()) {
+                w = ld->second;
+              }
+            }
+          }
+
+        }
+
+        db::Coord def_ext = 0;
+        if (! ctx.specialnets) {
+          def_ext = db::coord_traits<db::Coord>::rounded (ctx.importer->m_lef_importer.layer_ext (ln, w * 0.5 * ctx.dbu) / ctx.dbu);
+        }
+
+        std::map<int, db::Polygon>::const_iterator s = ctx.styles->find (sn);
+        if (s != ctx.styles->end ()) {
+          style = &s->second;
+        }
+
+        std::vector<db::Coord> ext;
+        std::vector<db::Point> pts;
+
+        double x = 0.0, y = 0.0;
+
+        while (true) {
+
+          if (test ("MASK")) {
+            //  ignore mask spec
+            get_long ();
+          }
+
+          if (test ("RECT")) {
+
+            if (! test ("(")) {
+              error (tl::to_string (tr ("RECT routing specification not followed by coordinate list")));
+            }
+
+            //  breaks wiring
+            pts.clear ();
+
+            //  rect spec
+
+            double x1 = get_double ();
+            double y1 = get_double ();
+            double x2 = get_double ();
+            double y2 = get_double ();
+
+            test (")");
+
+            db::Box rect (db::Point (db::DPoint ((x + x1) * ctx.scale, (y + y1) * ctx.scale)),
+                          db::Point (db::DPoint ((x + x2) * ctx.scale, (y + y2) * ctx.scale)));
+
+            batch.add (ln, rect);
+
+          } else if (test ("VIRTUAL")) {
+
+            //  virtual specs simply create a new segment
+            pts.clear ();
+
+          } else if (peek ("(")) {
+
+            ext.clear ();
+
+            while (peek ("(") || peek ("MASK")) {
+
+              if (test ("MASK")) {
+                //  ignore MASK spec
+                get_long ();
+              } 
+
+              if (! test ("(")) {
+                //  We could have a via here: in that case we have swallowed MASK already, but
+                //  since we don't do anything with that, this does not hurt for now.
+                break;
+              }
+
+              if (! test ("*")) {
+                x = get_double ();
+              }
+              if (! test ("*")) {
+                y = get_double ();
+              }
+              pts.push_back (db::Point (db::DPoint (x * ctx.scale, y * ctx.scale)));
+              db::Coord e = def_ext;
+              if (! peek (")")) {
+                e = db::coord_traits<db::Coord>::rounded (get_double () * ctx.scale);
+              }
+              ext.push_back (e);
+
+              test (")");
+
+            }
+
+            if (pts.size () > 1) {
+
+              if (! style) {
+
+                //  Use the default style (octagon "pen" for non-manhattan segments, paths for 
+                //  horizontal/vertical segments).
+
+                db::Coord e = std::max (ext.front (), ext.back ());
+
+                std::vector<db::Point>::const_iterator pt = pts.begin ();
+                while (pt != pts.end ()) {
+
+                  std::vector<db::Point>::const_iterator pt0 = pt;
+                  do {
+                    ++pt;
+                  } while (pt != pts.end () && (pt[-1].x () == pt[0].x () || pt[-1].y () == pt[0].y()));
+
+                  if (pt - pt0 > 1) {
+
+                    db::Path p (pt0, pt, w, pt0 == pts.begin () ? e : 0, pt == pts.end () ? e : 0, false);
+                    batch.add (ln, p);
+
+                    if (pt == pts.end ()) {
+                      break;
+                    }
+
+                    --pt;
+
+                  } else if (pt != pts.end ()) {
+
+                    db::Coord s = (w + 1) / 2;
+                    db::Coord t = db::Coord (ceil (w * (M_SQRT2 - 1) / 2));
+
+                    db::Point octagon[8] = {
+                      db::Point (-s, t),
+                      db::Point (-t, s),
+                      db::Point (t, s),
+                      db::Point (s, t),
+                      db::Point (s, -t),
+                      db::Point (t, -s),
+                      db::Point (-t, -s),
+                      db::Point (-s, -t)
+                    };
+
+                    db::Polygon k;
+                    k.assign_hull (octagon, octagon + sizeof (octagon) / sizeof (octagon[0]));
+
+                    db::Polygon p = db::minkowsky_sum (k, db::Edge (*pt0, *pt));
+                    batch.add (ln, p);
+
+                  }
+
+                }
+
+              } else {
+
+                for (size_t i = 0; i < pts.size () - 1; ++i) {
+                  db::Polygon p = db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1]));
+                  batch.add (ln, p);
+                }
+
+              }
+              
+            }
+
+          } else if (! peek ("NEW") && ! peek ("+") && ! peek ("-") && ! peek (";")) {
+
+            //  indicates a via
+            std::string vn = get ();
+            db::FTrans ft = get_orient (true /*optional*/);
+
+            //  vias from the VIAS section take precedence over LEF vias
+            const ViaDesc *vd = 0;
+            std::unordered_map<std::string, ViaDesc>::const_iterator v = ctx.via_desc->find (vn);
+            if (v != ctx.via_desc->end ()) {
+              vd = &v->second;
+            } else {
+              vd = ctx.importer->m_lef_importer.via_by_name (vn);
+            }
+
+            if (vd && ! pts.empty ()) {
+              batch.add_via (db::CellInstArray (db::CellInst (vd->cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ()))));
+              if (ln == vd->m1) {
+                ln = vd->m2;
+              } else if (ln == vd->m2) {
+                ln = vd->m1;
+              }
+            }
+
+            //  continue a segment with the current point and the new layer
+            if (pts.size () > 1) {
+              pts.erase (pts.begin (), pts.end () - 1);
+            }
+
+          } else {
+            break;
+          }
+
+        }
+
+      } while (test ("NEW"));
+
+      if (in_subnet) {
+        in_subnet = false;
+        net = stored_netname;
+        stored_netname.clear ();
+        nondefaultrule = stored_nondefaultrule;
+        stored_nondefaultrule.clear ();
+      }
+
+    } else if (test ("POLYGON")) {
+
+      std::string ln = get ();
+
+      db::Polygon p;
+      read_polygon (p, ctx.scale);
+
+      batch.add (ln, p);
+
+    } else if (test ("RECT")) {
+
+      std::string ln = get ();
+
+      db::Polygon p;
+      read_rect (p, ctx.scale);
+
+      batch.add (ln, p);
+
+    } else {
+      while (! peek ("+") && ! peek ("-") && ! peek (";")) {
+        take ();
+      }
+    }
+
+  }
+
+  expect (";");
+}
+
 void 
 DEFImporter::do_read (db::Layout &layout)
 {
   double dbu_mic = 1000.0;
   double scale = 1.0 / (dbu_mic * layout.dbu ());
   std::map<int, db::Polygon> styles;
-  std::map<std::string, ViaDesc> via_desc = m_lef_importer.vias ();
+  std::unordered_map<std::string, ViaDesc> via_desc;
   std::map<std::string, std::vector<db::Polygon> > regions;
   std::list<Group> groups;
   std::list<std::pair<std::string, db::CellInstArray> > instances;
@@ -426,375 +1108,15 @@ DEFImporter::do_read (db::Layout &layout)
       get_long ();
       expect (";");
 
-      while (test ("-")) {
-
-        std::string net = get ();
-        std::string nondefaultrule;
-        std::string stored_netname, stored_nondefaultrule;
-        std::string taperrule;
-        bool in_subnet = false;
-
-        db::properties_id_type prop_id = 0;
-        if (produce_net_props ()) {
-          db::PropertiesRepository::properties_set props;
-          props.insert (std::make_pair (net_prop_name_id (), tl::Variant (net)));
-          prop_id = layout.properties_repository ().properties_id (props);
-        }
-
-        while (test ("(")) {
-          while (! test (")")) {
-            take ();
-          }
-        }
-
-        while (test ("+")) {
-
-          bool was_shield = false;
-
-          if (! specialnets && test ("SUBNET")) {
-
-            while (test ("(")) {
-              while (! test (")")) {
-                take ();
-              }
-            }
-
-            if (! in_subnet) {
-              stored_netname = net;
-              stored_nondefaultrule = nondefaultrule;
-              in_subnet = true;
-            }
-
-          } else if (! specialnets && test ("NONDEFAULTRULE")) {
-
-            nondefaultrule = get ();
-
-          } else if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
-
-            if (was_shield) {
-              take ();
-            }
-
-            taperrule.clear ();
-
-            do {
+      DEFNetsContext ctx;
+      ctx.specialnets = specialnets;
+      ctx.scale = scale;
+      ctx.dbu = layout.dbu ();
+      ctx.styles = &styles;
+      ctx.via_desc = &via_desc;
+      ctx.importer = this;
 
-              std::string ln = get ();
-
-              db::Coord w = 0;
-              if (specialnets) {
-                w = db::coord_traits<db::Coord>::rounded (get_double () * scale);
-              } 
-
-              const db::Polygon *style = 0;
-
-              int sn = std::numeric_limits<int>::max ();
-
-              if (specialnets) {
-
-                while (test ("+")) {
-
-                  if (test ("STYLE")) {
-                    sn = get_long ();
-                  } else if (test ("SHAPE")) {
-                    take ();
-                  }
-
-                }
-
-              } else {
-
-                while (true) {
-                  if (test ("TAPER")) {
-                    taperrule.clear ();
-                  } else if (test ("TAPERRULE")) {
-                    taperrule = get ();
-                  } else if (test ("STYLE")) {
-                    sn = get_long ();
-                  } else {
-                    break;
-                  }
-                }
-
-              }
-
-              if (! specialnets) {
-
-                const std::string *rulename = &taperrule;
-                if (rulename->empty ()) {
-                  rulename = &nondefaultrule;
-                }
-
-                w = db::coord_traits<db::Coord>::rounded (m_lef_importer.layer_width (ln, *rulename, 0.0) / layout.dbu ());
-
-                //  try to find local nondefault rule
-                if (! rulename->empty ()) {
-                  std::map<std::string, std::map<std::string, double> >::const_iterator nd = m_nondefault_widths.find (*rulename);
-                  if (nd != m_nondefault_widths.end ()) {
-                    std::map<std::string, double>::const_iterator ld = nd->second.find (ln);
-                    if (ld != nd->second.end ()) {
-                      w = ld->second;
-                    }
-                  }
-                }
-
-              }
-
-              db::Coord def_ext = 0;
-              if (! specialnets) {
-                def_ext = db::coord_traits<db::Coord>::rounded (m_lef_importer.layer_ext (ln, w * 0.5 * layout.dbu ()) / layout.dbu ());
-              }
-
-              std::map<int, db::Polygon>::const_iterator s = styles.find (sn);
-              if (s != styles.end ()) {
-                style = &s->second;
-              }
-
-              std::vector<db::Coord> ext;
-              std::vector<db::Point> pts;
-
-              double x = 0.0, y = 0.0;
-
-              while (true) {
-
-                if (test ("MASK")) {
-                  //  ignore mask spec
-                  get_long ();
-                }
-
-                if (test ("RECT")) {
-
-                  if (! test ("(")) {
-                    error (tl::to_string (tr ("RECT routing specification not followed by coordinate list")));
-                  }
-
-                  //  breaks wiring
-                  pts.clear ();
-
-                  //  rect spec
-
-                  double x1 = get_double ();
-                  double y1 = get_double ();
-                  double x2 = get_double ();
-                  double y2 = get_double ();
-
-                  test (")");
-
-                  std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-                  if (dl.first) {
-
-                    db::Box rect (db::Point (db::DPoint ((x + x1) * scale, (y + y1) * scale)),
-                                  db::Point (db::DPoint ((x + x2) * scale, (y + y2) * scale)));
-
-                    if (prop_id != 0) {
-                      design.shapes (dl.second).insert (db::object_with_properties<db::Box> (rect, prop_id));
-                    } else {
-                      design.shapes (dl.second).insert (rect);
-                    }
-
-                  }
-
-                } else if (test ("VIRTUAL")) {
-
-                  //  virtual specs simply create a new segment
-                  pts.clear ();
-
-                } else if (peek ("(")) {
-
-                  ext.clear ();
-
-                  while (peek ("(") || peek ("MASK")) {
-
-                    if (test ("MASK")) {
-                      //  ignore MASK spec
-                      get_long ();
-                    } 
-
-                    if (! test ("(")) {
-                      //  We could have a via here: in that case we have swallowed MASK already, but
-                      //  since we don't do anything with that, this does not hurt for now.
-                      break;
-                    }
-
-                    if (! test ("*")) {
-                      x = get_double ();
-                    }
-                    if (! test ("*")) {
-                      y = get_double ();
-                    }
-                    pts.push_back (db::Point (db::DPoint (x * scale, y * scale)));
-                    db::Coord e = def_ext;
-                    if (! peek (")")) {
-                      e = db::coord_traits<db::Coord>::rounded (get_double () * scale);
-                    }
-                    ext.push_back (e);
-
-                    test (")");
-
-                  }
-
-                  if (pts.size () > 1) {
-
-                    std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-                    if (dl.first) {
-
-                      if (! style) {
-
-                        //  Use the default style (octagon "pen" for non-manhattan segments, paths for 
-                        //  horizontal/vertical segments).
-
-                        db::Coord e = std::max (ext.front (), ext.back ());
-
-                        std::vector<db::Point>::const_iterator pt = pts.begin ();
-                        while (pt != pts.end ()) {
-
-                          std::vector<db::Point>::const_iterator pt0 = pt;
-                          do {
-                            ++pt;
-                          } while (pt != pts.end () && (pt[-1].x () == pt[0].x () || pt[-1].y () == pt[0].y()));
-
-                          if (pt - pt0 > 1) {
-
-                            db::Path p (pt0, pt, w, pt0 == pts.begin () ? e : 0, pt == pts.end () ? e : 0, false);
-                            if (prop_id != 0) {
-                              design.shapes (dl.second).insert (db::object_with_properties<db::Path> (p, prop_id));
-                            } else {
-                              design.shapes (dl.second).insert (p);
-                            }
-
-                            if (pt == pts.end ()) {
-                              break;
-                            }
-
-                            --pt;
-
-                          } else if (pt != pts.end ()) {
-
-                            db::Coord s = (w + 1) / 2;
-                            db::Coord t = db::Coord (ceil (w * (M_SQRT2 - 1) / 2));
-
-                            db::Point octagon[8] = {
-                              db::Point (-s, t),
-                              db::Point (-t, s),
-                              db::Point (t, s),
-                              db::Point (s, t),
-                              db::Point (s, -t),
-                              db::Point (t, -s),
-                              db::Point (-t, -s),
-                              db::Point (-s, -t)
-                            };
-
-                            db::Polygon k;
-                            k.assign_hull (octagon, octagon + sizeof (octagon) / sizeof (octagon[0]));
-
-                            db::Polygon p = db::minkowsky_sum (k, db::Edge (*pt0, *pt));
-                            if (prop_id != 0) {
-                              design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-                            } else {
-                              design.shapes (dl.second).insert (p);
-                            }
-
-                          }
-
-                        }
-
-                      } else {
-
-                        for (size_t i = 0; i < pts.size () - 1; ++i) {
-                          db::Polygon p = db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1]));
-                          if (prop_id != 0) {
-                            design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-                          } else {
-                            design.shapes (dl.second).insert (p);
-                          }
-                        }
-
-                      }
-
-                    }
-                    
-                  }
-
-                } else if (! peek ("NEW") && ! peek ("+") && ! peek ("-") && ! peek (";")) {
-
-                  //  indicates a via
-                  std::string vn = get ();
-                  db::FTrans ft = get_orient (true /*optional*/);
-
-                  std::map<std::string, ViaDesc>::const_iterator vd = via_desc.find (vn);
-                  if (vd != via_desc.end () && ! pts.empty ()) {
-                    design.insert (db::CellInstArray (db::CellInst (vd->second.cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ()))));
-                    if (ln == vd->second.m1) {
-                      ln = vd->second.m2;
-                    } else if (ln == vd->second.m2) {
-                      ln = vd->second.m1;
-                    }
-                  }
-
-                  //  continue a segment with the current point and the new layer
-                  if (pts.size () > 1) {
-                    pts.erase (pts.begin (), pts.end () - 1);
-                  }
-
-                } else {
-                  break;
-                }
-
-              }
-
-            } while (test ("NEW"));
-
-            if (in_subnet) {
-              in_subnet = false;
-              net = stored_netname;
-              stored_netname.clear ();
-              nondefaultrule = stored_nondefaultrule;
-              stored_nondefaultrule.clear ();
-            }
-
-          } else if (test ("POLYGON")) {
-
-            std::string ln = get ();
-
-            db::Polygon p;
-            read_polygon (p, scale);
-
-            std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-            if (dl.first) {
-              if (prop_id != 0) {
-                design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-              } else {
-                design.shapes (dl.second).insert (p);
-              }
-            }
-
-          } else if (test ("RECT")) {
-
-            std::string ln = get ();
-
-            db::Polygon p;
-            read_rect (p, scale);
-
-            std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-            if (dl.first) {
-              if (prop_id != 0) {
-                design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-              } else {
-                design.shapes (dl.second).insert (p);
-              }
-            }
-
-          } else {
-            while (! peek ("+") && ! peek ("-") && ! peek (";")) {
-              take ();
-            }
-          }
-
-        }
-
-        expect (";");
-
-      }
+      read_nets (layout, design, ctx);
 
       test ("END");
       if (specialnets) {
@@ -811,7 +1133,13 @@ DEFImporter::do_read (db::Layout &layout)
       while (test ("-")) {
 
         std::string n = get ();
-        ViaDesc &vd = via_desc.insert (std::make_pair (n, ViaDesc ())).first->second;
+        //  a DEF via overrides a LEF via with the same name, but starts from the LEF description
+        std::unordered_map<std::string, ViaDesc>::iterator v = via_desc.find (n);
+        if (v == via_desc.end ()) {
+          const ViaDesc *lef_vd = m_lef_importer.via_by_name (n);
+          v = via_desc.insert (std::make_pair (n, lef_vd ? *lef_vd : ViaDesc ())).first;
+        }
+        ViaDesc &vd = v->second;
 
         //  produce a cell for vias
         std::string cellname = "VIA_" + n;
@@ -32,10 +32,14 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace db
 {
 
+struct DEFNetsContext;
+class DEFNetsBatch;
+
 /**
  *  @brief The DEF importer object
  */
@@ -60,12 +64,18 @@ protected:
   void do_read (db::Layout &layout);
 
 private:
+  friend class DEFNetsWorker;
+
   LEFImporter m_lef_importer;
-  std::map<std::string, std::map<std::string, double> > m_nondefault_widths;
+  std::unordered_map<std::string, std::unordered_map<std::string, double> > m_nondefault_widths;
 
   db::FTrans get_orient (bool optional);
   void read_polygon (db::Polygon &poly, double scale);
   void read_rect (db::Polygon &poly, double scale);
+  void read_nets (db::Layout &layout, db::Cell &design, const DEFNetsContext &ctx);
+  void read_nets_from_text (const std::string &text, size_t line, const DEFNetsContext &ctx, DEFNetsBatch &batch);
+  void read_net (const DEFNetsContext &ctx, DEFNetsBatch &batch);
+  void insert_nets (db::Layout &layout, db::Cell &design, const DEFNetsBatch &batch);
 };
 
 }
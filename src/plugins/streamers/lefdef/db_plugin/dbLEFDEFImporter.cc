@@ -27,6 +27,7 @@
 #include "tlProgress.h"
 
 #include <cctype>
+#include <cmath>
 
 namespace db
 {
@@ -64,7 +65,9 @@ LEFDEFReaderOptions::LEFDEFReaderOptions ()
     m_labels_datatype (1),
     m_produce_routing (true),
     m_routing_suffix (""),
-    m_routing_datatype (0)
+    m_routing_datatype (0),
+    m_threads (0),
+    m_routing_shape_refs (false)
 {
   //  .. nothing yet ..
 }
@@ -101,7 +104,9 @@ LEFDEFReaderOptions::LEFDEFReaderOptions (const LEFDEFReaderOptions &d)
     m_produce_routing (d.m_produce_routing),
     m_routing_suffix (d.m_routing_suffix),
     m_routing_datatype (d.m_routing_datatype),
-    m_lef_files (d.m_lef_files)
+    m_lef_files (d.m_lef_files),
+    m_threads (d.m_threads),
+    m_routing_shape_refs (d.m_routing_shape_refs)
 {
   //  .. nothing yet ..
 }
@@ -351,13 +356,396 @@ LEFDEFLayerDelegate::finish (db::Layout &layout)
   }
 }
 
+// -----------------------------------------------------------------------------------
+//  LEFDEFTokenizer implementation
+
+//  The number of bytes read from the stream at once
+static const size_t tokenizer_block_size = 65536;
+
+LEFDEFTokenizer::LEFDEFTokenizer (tl::InputStream &stream)
+  : mp_stream (&stream), m_pos (0), m_token_start (0), m_token_begin (0), m_token_end (0),
+    m_line (1), m_token_line (1), m_has_token (false), m_escaped (false),
+    m_capturing (false), m_capture_start (0), m_capture_line (0)
+{
+  //  .. nothing yet ..
+}
+
+LEFDEFTokenizer::LEFDEFTokenizer (const std::string &text, size_t line)
+  : mp_stream (0), m_buffer (text), m_pos (0), m_token_start (0), m_token_begin (0), m_token_end (0),
+    m_line (line), m_token_line (line), m_has_token (false), m_escaped (false),
+    m_capturing (false), m_capture_start (0), m_capture_line (0)
+{
+  //  .. nothing yet ..
+}
+
+bool
+LEFDEFTokenizer::fill (size_t keep)
+{
+  if (! mp_stream) {
+    return false;
+  }
+
+  //  drop the part of the buffer which is no longer needed
+  if (m_capturing) {
+    m_captured.append (m_buffer, m_capture_start, keep - m_capture_start);
+    m_capture_start = keep;
+  }
+
+  m_buffer.erase (0, keep);
+  m_pos -= keep;
+  m_token_start = m_token_start < keep ? 0 : m_token_start - keep;
+  m_token_begin = m_token_begin < keep ? 0 : m_token_begin - keep;
+  m_capture_start = m_capture_start < keep ? 0 : m_capture_start - keep;
+
+  std::string block = mp_stream->read_all (tokenizer_block_size);
+  if (block.empty ()) {
+    return false;
+  }
+
+  m_buffer += block;
+  return true;
+}
+
+void
+LEFDEFTokenizer::unescape_from (size_t pos)
+{
+  if (! m_escaped) {
+    m_escaped = true;
+    m_unescaped.assign (m_buffer, m_token_begin, pos - m_token_begin);
+  }
+}
+
+bool
+LEFDEFTokenizer::next ()
+{
+  m_escaped = false;
+  m_unescaped.clear ();
+
+  while (true) {
+
+    //  skip whitespace
+    while (true) {
+      if (m_pos == m_buffer.size () && ! fill (m_pos)) {
+        m_token_begin = m_token_end = m_pos;
+        return false;
+      }
+      char c = m_buffer [m_pos];
+      if (! isspace ((unsigned char) c)) {
+        break;
+      }
+      if (c == '\012') {
+        ++m_line;
+      }
+      ++m_pos;
+    }
+
+    char c = m_buffer [m_pos];
+
+    if (c == '#') {
+
+      //  skip comments up to the end of the line
+      while ((m_pos < m_buffer.size () || fill (m_pos)) && m_buffer [m_pos] != '\015' && m_buffer [m_pos] != '\012') {
+        ++m_pos;
+      }
+
+      continue;
+
+    }
+
+    m_token_start = m_pos;
+    m_token_line = m_line;
+
+    bool quoted = (c == '\'' || c == '"');
+    char quot = c;
+
+    if (quoted) {
+      //  skip the quote
+      ++m_pos;
+    }
+
+    m_token_begin = m_pos;
+
+    if (! quoted) {
+      //  the first character is always taken literally
+      ++m_pos;
+    }
+
+    while (m_pos < m_buffer.size () || fill (m_token_start)) {
+
+      c = m_buffer [m_pos];
+      if (quoted ? c == quot : isspace ((unsigned char) c) != 0) {
+        break;
+      }
+
+      if (c == '\\') {
+        unescape_from (m_pos);
+        ++m_pos;
+        if (m_pos == m_buffer.size () && ! fill (m_token_start)) {
+          break;
+        }
+        c = m_buffer [m_pos];
+      }
+
+      if (c == '\012') {
+        ++m_line;
+      }
+      if (m_escaped) {
+        m_unescaped += c;
+      }
+
+      ++m_pos;
+
+    }
+
+    m_token_end = m_pos;
+
+    if (quoted && m_pos < m_buffer.size ()) {
+      //  skip the closing quote
+      ++m_pos;
+    }
+
+    return true;
+
+  }
+}
+
+bool
+LEFDEFTokenizer::token_equals (const std::string &s) const
+{
+  size_t n = token_size ();
+  if (n != s.size ()) {
+    return false;
+  }
+
+  const char *a = token_begin ();
+  const char *b = s.c_str ();
+  for ( ; n > 0; --n, ++a, ++b) {
+    if (*a != *b && std::toupper (*a) != std::toupper (*b)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+LEFDEFTokenizer::token_to_double (double &d) const
+{
+  //  fast path for plain decimal numbers (same arithmetics than tl::from_string)
+  const char *cp = token_begin ();
+  const char *cp_end = cp + token_size ();
+
+  double s = 1.0;
+  if (cp != cp_end && *cp == '-') {
+    s = -1.0;
+    ++cp;
+  }
+
+  int exponent = 0;
+  double mant = 0.0;
+  bool any_digit = false;
+
+  while (cp != cp_end && *cp >= '0' && *cp <= '9') {
+    mant = mant * 10.0 + double (*cp - '0');
+    any_digit = true;
+    ++cp;
+  }
+
+  if (cp != cp_end && *cp == '.') {
+    ++cp;
+    while (cp != cp_end && *cp >= '0' && *cp <= '9') {
+      mant = mant * 10.0 + double (*cp - '0');
+      any_digit = true;
+      ++cp;
+      --exponent;
+    }
+  }
+
+  if (any_digit && cp == cp_end) {
+    d = s * mant * pow (10.0, exponent);
+    return true;
+  }
+
+  //  general case: exponents, expressions etc.
+  try {
+    tl::from_string (token (), d);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool
+LEFDEFTokenizer::token_to_long (long &l) const
+{
+  //  fast path for plain integer numbers
+  const char *cp = token_begin ();
+  const char *cp_end = cp + token_size ();
+
+  bool neg = false;
+  if (cp != cp_end && *cp == '-') {
+    neg = true;
+    ++cp;
+  }
+
+  if (cp != cp_end && cp_end - cp <= 18) {
+
+    long v = 0;
+    while (cp != cp_end && *cp >= '0' && *cp <= '9') {
+      v = v * 10 + long (*cp - '0');
+      ++cp;
+    }
+
+    if (cp == cp_end) {
+      l = neg ? -v : v;
+      return true;
+    }
+
+  }
+
+  //  general case
+  try {
+    tl::from_string (token (), l);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+void
+LEFDEFTokenizer::start_capture ()
+{
+  m_capturing = true;
+  m_captured.clear ();
+
+  if (m_has_token) {
+    m_capture_start = m_token_start;
+    m_capture_line = m_token_line;
+  } else {
+    m_capture_start = m_pos;
+    m_capture_line = m_line;
+  }
+}
+
+void
+LEFDEFTokenizer::stop_capture (std::string &text)
+{
+  //  a token which has not been consumed yet is not included
+  size_t end = m_has_token ? m_token_start : m_pos;
+
+  m_captured.append (m_buffer, m_capture_start, end - m_capture_start);
+  text.swap (m_captured);
+  m_captured.clear ();
+  m_capturing = false;
+}
+
+bool
+LEFDEFTokenizer::at_single_char_token ()
+{
+  if (m_pos + 1 == m_buffer.size () && ! fill (m_pos)) {
+    return true;
+  }
+  return isspace ((unsigned char) m_buffer [m_pos + 1]) != 0;
+}
+
+size_t
+LEFDEFTokenizer::skip_statements (size_t n)
+{
+  if (m_has_token) {
+    //  rescan from the beginning of the current token
+    m_pos = m_token_start;
+    m_line = m_token_line;
+    m_has_token = false;
+  }
+
+  size_t count = 0;
+  bool in_statement = false;
+
+  while (count < n && (m_pos < m_buffer.size () || fill (m_pos))) {
+
+    char c = m_buffer [m_pos];
+
+    if (isspace ((unsigned char) c)) {
+
+      if (c == '\012') {
+        ++m_line;
+      }
+      ++m_pos;
+
+    } else if (c == '#') {
+
+      //  skip comments up to the end of the line
+      while ((m_pos < m_buffer.size () || fill (m_pos)) && m_buffer [m_pos] != '\015' && m_buffer [m_pos] != '\012') {
+        ++m_pos;
+      }
+
+    } else if (! in_statement) {
+
+      if (c != '-' || ! at_single_char_token ()) {
+        //  not a statement: stop before this token
+        break;
+      }
+
+      in_statement = true;
+      ++m_pos;
+
+    } else if (c == ';' && at_single_char_token ()) {
+
+      in_statement = false;
+      ++count;
+      ++m_pos;
+
+    } else {
+
+      //  skip a token inside the statement - same rules than "next"
+      bool quoted = (c == '\'' || c == '"');
+      char quot = c;
+
+      ++m_pos;
+
+      while (m_pos < m_buffer.size () || fill (m_pos)) {
+
+        c = m_buffer [m_pos];
+        if (quoted ? c == quot : isspace ((unsigned char) c) != 0) {
+          break;
+        }
+
+        if (c == '\\') {
+          ++m_pos;
+          if (m_pos == m_buffer.size () && ! fill (m_pos)) {
+            break;
+          }
+          c = m_buffer [m_pos];
+        }
+
+        if (c == '\012') {
+          ++m_line;
+        }
+
+        ++m_pos;
+
+      }
+
+      if (quoted && m_pos < m_buffer.size ()) {
+        //  skip the closing quote
+        ++m_pos;
+      }
+
+    }
+
+  }
+
+  return count;
+}
+
 // -----------------------------------------------------------------------------------
 //  LEFDEFImporter implementation
 
 LEFDEFImporter::LEFDEFImporter ()
-  : mp_progress (0), mp_stream (0), mp_layer_delegate (0),
+  : mp_progress (0), mp_tokenizer (0), mp_layer_delegate (0),
     m_produce_net_props (false), m_net_prop_name_id (0),
-    m_produce_inst_props (false), m_inst_prop_name_id (0)
+    m_produce_inst_props (false), m_inst_prop_name_id (0),
+    m_threads (0), m_routing_shape_refs (false), m_last_line (0)
 {
   //  .. nothing yet ..
 }
@@ -393,37 +781,58 @@ LEFDEFImporter::read (tl::InputStream &stream, db::Layout &layout, LEFDEFLayerDe
     m_inst_prop_name_id = layout.properties_repository ().prop_name_id (ld.tech_comp ()->inst_property_name ());
   }
 
+  m_threads = ld.tech_comp () ? ld.tech_comp ()->threads () : 0;
+  m_routing_shape_refs = ld.tech_comp () ? ld.tech_comp ()->routing_shape_refs () : false;
+
+  LEFDEFTokenizer tokenizer (stream);
+
   try {
 
     mp_progress = &progress;
     mp_layer_delegate = &ld;
-    mp_stream = new tl::TextInputStream (stream);
+    mp_tokenizer = &tokenizer;
+    m_last_line = tokenizer.line_number ();
 
     do_read (layout); 
 
-    delete mp_stream;
-    mp_stream = 0;
+    mp_tokenizer = 0;
     mp_progress = 0;
 
   } catch (...) {
-    delete mp_stream;
-    mp_stream = 0;
+    mp_tokenizer = 0;
     mp_progress = 0;
     throw;
   }
 }
 
+void
+LEFDEFImporter::attach (LEFDEFTokenizer *tokenizer, const LEFDEFImporter &other, bool with_progress)
+{
+  mp_tokenizer = tokenizer;
+  mp_progress = with_progress ? other.mp_progress : 0;
+  mp_layer_delegate = other.mp_layer_delegate;
+  m_cellname = other.m_cellname;
+  m_fn = other.m_fn;
+  m_produce_net_props = other.m_produce_net_props;
+  m_net_prop_name_id = other.m_net_prop_name_id;
+  m_produce_inst_props = other.m_produce_inst_props;
+  m_inst_prop_name_id = other.m_inst_prop_name_id;
+  m_threads = other.m_threads;
+  m_routing_shape_refs = other.m_routing_shape_refs;
+  m_last_line = tokenizer->line_number ();
+}
+
 void 
 LEFDEFImporter::error (const std::string &msg)
 {
-  throw LEFDEFReaderException (msg, int (mp_stream->line_number ()), m_cellname, m_fn);
+  throw LEFDEFReaderException (msg, int (mp_tokenizer->line_number ()), m_cellname, m_fn);
 }
 
 void 
 LEFDEFImporter::warn (const std::string &msg)
 {
   tl::warn << msg 
-           << tl::to_string (tr (" (line=")) << mp_stream->line_number ()
+           << tl::to_string (tr (" (line=")) << mp_tokenizer->line_number ()
            << tl::to_string (tr (", cell=")) << m_cellname
            << tl::to_string (tr (", file=")) << m_fn
            << ")";
@@ -432,32 +841,17 @@ LEFDEFImporter::warn (const std::string &msg)
 bool
 LEFDEFImporter::at_end ()
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      return true;
-    }
-  }
-  return false;
+  return ! next ();
 }
 
 bool  
 LEFDEFImporter::peek (const std::string &token)
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      error ("Unexpected end of file");
-    }
+  if (! next ()) {
+    error ("Unexpected end of file");
   }
 
-  const char *a = m_last_token.c_str ();
-  const char *b = token.c_str ();
-  while (*a && *b) {
-    if (std::toupper (*a) != std::toupper (*b)) {
-      return false;
-    }
-    ++a, ++b;
-  }
-  return *a == *b;
+  return mp_tokenizer->token_equals (token);
 }
 
 bool  
@@ -465,7 +859,7 @@ LEFDEFImporter::test (const std::string &token)
 {
   if (peek (token)) {
     //  consume when successful
-    m_last_token.clear ();
+    mp_tokenizer->consume ();
     return true;
   } else {
     return false;
@@ -483,20 +877,16 @@ LEFDEFImporter::expect (const std::string &token)
 double  
 LEFDEFImporter::get_double ()
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      error ("Unexpected end of file");
-    }
+  if (! next ()) {
+    error ("Unexpected end of file");
   }
 
   double d = 0;
-  try {
-    tl::from_string (m_last_token, d);
-  } catch (...) {
-    error ("Not a floating-point value: " + m_last_token);
+  if (! mp_tokenizer->token_to_double (d)) {
+    error ("Not a floating-point value: " + mp_tokenizer->token ());
   }
 
-  m_last_token.clear ();
+  mp_tokenizer->consume ();
 
   return d;
 }
@@ -504,20 +894,16 @@ LEFDEFImporter::get_double ()
 long  
 LEFDEFImporter::get_long ()
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      error ("Unexpected end of file");
-    }
+  if (! next ()) {
+    error ("Unexpected end of file");
   }
 
   long l = 0;
-  try {
-    tl::from_string (m_last_token, l);
-  } catch (...) {
-    error ("Not an integer value: " + m_last_token);
+  if (! mp_tokenizer->token_to_long (l)) {
+    error ("Not an integer value: " + mp_tokenizer->token ());
   }
 
-  m_last_token.clear ();
+  mp_tokenizer->consume ();
 
   return l;
 }
@@ -525,85 +911,33 @@ LEFDEFImporter::get_long ()
 void
 LEFDEFImporter::take ()
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      error ("Unexpected end of file");
-    }
+  if (! next ()) {
+    error ("Unexpected end of file");
   }
-  m_last_token.clear ();
+  mp_tokenizer->consume ();
 }
 
 std::string 
 LEFDEFImporter::get ()
 {
-  if (m_last_token.empty ()) {
-    if (next ().empty ()) {
-      error ("Unexpected end of file");
-    }
+  if (! next ()) {
+    error ("Unexpected end of file");
   }
-  std::string r;
-  r.swap (m_last_token);
-  return r;
+  mp_tokenizer->consume ();
+  return mp_tokenizer->token ();
 }
 
-const std::string &
+bool
 LEFDEFImporter::next ()
 {
-  unsigned int last_line = (unsigned int) mp_stream->line_number ();
-
-  m_last_token.clear ();
-
-  char c;
-
-  do {
-
-    while ((c = mp_stream->get_char ()) != 0 && isspace (c)) 
-      ;
-
-    if (c == '#') {
-
-      while ((c = mp_stream->get_char ()) != 0 && (c != '\015' && c != '\012')) 
-        ;
-
-    } else if (c == '\'' || c == '"') {
-
-      char quot = c;
-
-      while ((c = mp_stream->get_char ()) != 0 && c != quot) {
-        if (c == '\\') {
-          c = mp_stream->get_char ();
-        }
-        if (c) {
-          m_last_token += c;
-        }
-      }
-
-      break;
-
-    } else if (c) {
-
-      m_last_token += c; 
-
-      while ((c = mp_stream->get_char ()) != 0 && ! isspace (c)) {
-        if (c == '\\') {
-          c = mp_stream->get_char ();
-        }
-        if (c) {
-          m_last_token += c;
-        }
-      }
-
-      break;
-
-    }
-
-  } while (c);
+  bool has_token = mp_tokenizer->fetch ();
 
-  if (mp_stream->line_number () != last_line) {
+  if (mp_progress && mp_tokenizer->line_number () != m_last_line) {
+    m_last_line = mp_tokenizer->line_number ();
     ++*mp_progress;
   }
 
-  return m_last_token;
+  return has_token;
 }
 
 static bool is_hex_digit (char c)
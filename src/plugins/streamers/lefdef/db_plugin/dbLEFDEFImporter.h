@@ -415,6 +415,26 @@ public:
     m_lef_files = lf;
   }
 
+  int threads () const
+  {
+    return m_threads;
+  }
+
+  void set_threads (int n)
+  {
+    m_threads = n;
+  }
+
+  bool routing_shape_refs () const
+  {
+    return m_routing_shape_refs;
+  }
+
+  void set_routing_shape_refs (bool f)
+  {
+    m_routing_shape_refs = f;
+  }
+
 private:
   bool m_read_all_layers;
   db::LayerMap m_layer_map;
@@ -448,6 +468,8 @@ private:
   std::string m_routing_suffix;
   int m_routing_datatype;
   std::vector<std::string> m_lef_files;
+  int m_threads;
+  bool m_routing_shape_refs;
 };
 
 /**
@@ -551,6 +573,161 @@ struct DB_PLUGIN_PUBLIC ViaDesc
   std::string m1, m2;
 };
 
+/**
+ *  @brief A buffered tokenizer for LEF and DEF files
+ *
+ *  The tokenizer reads the input in blocks and delivers the tokens as character
+ *  ranges inside its buffer. Hence no string needs to be built for tokens which
+ *  are just compared or converted to numbers. A token is valid until the next
+ *  one is read. Tokens with escapes are unescaped into a separate buffer.
+ *
+ *  The tokenizer reads either from a stream or from a text in memory. The raw
+ *  text of a sequence of tokens can be captured, so it can be handed over to
+ *  another tokenizer.
+ */
+class DB_PLUGIN_PUBLIC LEFDEFTokenizer
+{
+public:
+  /**
+   *  @brief Creates a tokenizer reading from the given stream
+   */
+  LEFDEFTokenizer (tl::InputStream &stream);
+
+  /**
+   *  @brief Creates a tokenizer reading from the given text
+   *
+   *  "line" is the line number of the first line of the text.
+   */
+  LEFDEFTokenizer (const std::string &text, size_t line);
+
+  /**
+   *  @brief Makes a token available if there is none
+   *
+   *  Returns false if the end of the input is reached.
+   */
+  bool fetch ()
+  {
+    if (! m_has_token) {
+      m_has_token = next ();
+    }
+    return m_has_token;
+  }
+
+  /**
+   *  @brief Marks the current token as consumed
+   */
+  void consume ()
+  {
+    m_has_token = false;
+  }
+
+  /**
+   *  @brief Gets a pointer to the first character of the current token
+   */
+  const char *token_begin () const
+  {
+    return m_escaped ? m_unescaped.c_str () : m_buffer.c_str () + m_token_begin;
+  }
+
+  /**
+   *  @brief Gets the length of the current token
+   */
+  size_t token_size () const
+  {
+    return m_escaped ? m_unescaped.size () : m_token_end - m_token_begin;
+  }
+
+  /**
+   *  @brief Gets the current token as a string
+   */
+  std::string token () const
+  {
+    return std::string (token_begin (), token_size ());
+  }
+
+  /**
+   *  @brief Returns true if the current token is equal to the given string (case insensitive)
+   */
+  bool token_equals (const std::string &s) const;
+
+  /**
+   *  @brief Converts the current token to a double value
+   *
+   *  Returns false if the token is not a valid number.
+   */
+  bool token_to_double (double &d) const;
+
+  /**
+   *  @brief Converts the current token to a long value
+   *
+   *  Returns false if the token is not a valid integer number.
+   */
+  bool token_to_long (long &l) const;
+
+  /**
+   *  @brief Gets the current line number
+   */
+  size_t line_number () const
+  {
+    return m_line;
+  }
+
+  /**
+   *  @brief Starts capturing the raw text
+   *
+   *  The captured text will begin with the current token if there is one
+   *  which has not been consumed yet.
+   */
+  void start_capture ();
+
+  /**
+   *  @brief Stops capturing and delivers the raw text captured
+   *
+   *  The text extends up to the end of the last token consumed.
+   */
+  void stop_capture (std::string &text);
+
+  /**
+   *  @brief Gets the line number where the capture started
+   */
+  size_t capture_line () const
+  {
+    return m_capture_line;
+  }
+
+  /**
+   *  @brief Skips up to n statements of the form "- ... ;" by a raw text scan
+   *
+   *  This method is much cheaper than reading the tokens: it only looks for the
+   *  "-" and ";" tokens, stepping over comments and quoted strings. The scan starts
+   *  at the current token if it has not been consumed yet. It stops after the n-th
+   *  statement or before the first token which does not start a statement.
+   *  Returns the number of statements skipped.
+   */
+  size_t skip_statements (size_t n);
+
+private:
+  tl::InputStream *mp_stream;
+  std::string m_buffer;
+  size_t m_pos;
+  size_t m_token_start, m_token_begin, m_token_end;
+  size_t m_line, m_token_line;
+  bool m_has_token;
+  bool m_escaped;
+  std::string m_unescaped;
+  bool m_capturing;
+  size_t m_capture_start, m_capture_line;
+  std::string m_captured;
+
+  bool next ();
+  bool fill (size_t keep);
+  void unescape_from (size_t pos);
+  bool at_single_char_token ();
+
+  LEFDEFTokenizer (const LEFDEFTokenizer &);
+  LEFDEFTokenizer &operator= (const LEFDEFTokenizer &);
+};
+
 /**
  *  @brief The LEF importer object
  */
@@ -582,6 +759,25 @@ protected:
    */
   virtual void do_read (db::Layout &layout) = 0;
 
+  /**
+   *  @brief Reads from the given tokenizer
+   *
+   *  This method allows a helper importer to continue reading from the tokenizer of
+   *  another importer or to read from a separate one. The tokenizer is not owned by
+   *  this importer. The file and cell name, the layer delegate and the property settings
+   *  are taken from "other". If "with_progress" is true, the progress reporter is
+   *  shared too.
+   */
+  void attach (LEFDEFTokenizer *tokenizer, const LEFDEFImporter &other, bool with_progress);
+
+  /**
+   *  @brief Gets the tokenizer
+   */
+  LEFDEFTokenizer &tokenizer ()
+  {
+    return *mp_tokenizer;
+  }
+
   /**
    *  @brief Issue an error at the current location
    */
@@ -696,6 +892,22 @@ protected:
     return m_inst_prop_name_id;
   }
 
+  /**
+   *  @brief Gets the number of threads to use for reading (0 for reading in the current thread)
+   */
+  int threads () const
+  {
+    return m_threads;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether routing paths and polygons are stored as shape references
+   */
+  bool routing_shape_refs () const
+  {
+    return m_routing_shape_refs;
+  }
+
 protected:
   void create_generated_via (std::vector<db::Polygon> &bottom,
                              std::vector<db::Polygon> &cut,
@@ -710,17 +922,19 @@ protected:
 
 private:
   tl::AbsoluteProgress *mp_progress;
-  tl::TextInputStream *mp_stream;
+  LEFDEFTokenizer *mp_tokenizer;
   LEFDEFLayerDelegate *mp_layer_delegate;
   std::string m_cellname;
   std::string m_fn;
-  std::string m_last_token;
   bool m_produce_net_props;
   db::property_names_id_type m_net_prop_name_id;
   bool m_produce_inst_props;
   db::property_names_id_type m_inst_prop_name_id;
+  int m_threads;
+  bool m_routing_shape_refs;
+  size_t m_last_line;
 
-  const std::string &next ();
+  bool next ();
 };
 
 }
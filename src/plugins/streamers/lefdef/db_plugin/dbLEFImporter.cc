@@ -46,7 +46,7 @@ LEFImporter::~LEFImporter ()
 db::Box
 LEFImporter::macro_bbox_by_name (const std::string &name) const
 {
-  std::map<std::string, db::Box>::const_iterator m = m_macro_bboxes_by_name.find (name);
+  std::unordered_map<std::string, db::Box>::const_iterator m = m_macro_bboxes_by_name.find (name);
   if (m != m_macro_bboxes_by_name.end ()) {
     return m->second;
   } else {
@@ -57,7 +57,7 @@ LEFImporter::macro_bbox_by_name (const std::string &name) const
 double 
 LEFImporter::layer_ext (const std::string &layer, double def_ext) const
 {
-  std::map<std::string, double>::const_iterator l = m_default_ext.find (layer);
+  std::unordered_map<std::string, double>::const_iterator l = m_default_ext.find (layer);
   if (l != m_default_ext.end ()) {
     return l->second;
   } else {
@@ -68,9 +68,9 @@ LEFImporter::layer_ext (const std::string &layer, double def_ext) const
 double 
 LEFImporter::layer_width (const std::string &layer, const std::string &nondefaultrule, double def_width) const
 {
-  std::map<std::string, std::map<std::string, double> >::const_iterator nd = m_nondefault_widths.find (nondefaultrule);
+  std::unordered_map<std::string, std::unordered_map<std::string, double> >::const_iterator nd = m_nondefault_widths.find (nondefaultrule);
 
-  std::map<std::string, double>::const_iterator l;
+  std::unordered_map<std::string, double>::const_iterator l;
   bool has_width = false;
 
   if (! nondefaultrule.empty () && nd != m_nondefault_widths.end ()) {
@@ -97,7 +97,7 @@ LEFImporter::layer_width (const std::string &layer, const std::string &nondefaul
 db::Cell *
 LEFImporter::macro_by_name (const std::string &name) const
 {
-  std::map<std::string, db::Cell *>::const_iterator m = m_macros_by_name.find (name);
+  std::unordered_map<std::string, db::Cell *>::const_iterator m = m_macros_by_name.find (name);
   if (m != m_macros_by_name.end ()) {
     return m->second;
   } else {
@@ -105,6 +105,17 @@ LEFImporter::macro_by_name (const std::string &name) const
   }
 }
 
+const ViaDesc *
+LEFImporter::via_by_name (const std::string &name) const
+{
+  std::unordered_map<std::string, ViaDesc>::const_iterator v = m_vias.find (name);
+  if (v != m_vias.end ()) {
+    return &v->second;
+  } else {
+    return 0;
+  }
+}
+
 std::vector <db::Trans> 
 LEFImporter::get_iteration (db::Layout &layout)
 {
@@ -154,7 +165,7 @@ LEFImporter::read_geometries (db::Layout &layout, db::Cell &cell, LayerPurpose p
       }
 
       w = 0.0;
-      std::map<std::string, double>::const_iterator dw = m_default_widths.find (layer_name);
+      std::unordered_map<std::string, double>::const_iterator dw = m_default_widths.find (layer_name);
       if (dw != m_default_widths.end ()) {
         w = dw->second;
       }
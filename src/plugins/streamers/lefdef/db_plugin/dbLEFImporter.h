@@ -36,6 +36,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 namespace db
 {
@@ -91,21 +92,28 @@ public:
    *
    *  The map maps the via name to the via description.
    */
-  const std::map<std::string, ViaDesc> &vias () const
+  const std::unordered_map<std::string, ViaDesc> &vias () const
   {
     return m_vias;
   }
 
+  /**
+   *  @brief Gets the via description for the given via name
+   *
+   *  Returns 0 if there is no via with that name.
+   */
+  const ViaDesc *via_by_name (const std::string &name) const;
+
 protected:
   void do_read (db::Layout &layout);
 
 private:
-  std::map<std::string, std::map<std::string, double> > m_nondefault_widths;
-  std::map<std::string, double> m_default_widths;
-  std::map<std::string, double> m_default_ext;
-  std::map<std::string, db::Cell *> m_macros_by_name;
-  std::map<std::string, db::Box> m_macro_bboxes_by_name;
-  std::map<std::string, ViaDesc> m_vias;
+  std::unordered_map<std::string, std::unordered_map<std::string, double> > m_nondefault_widths;
+  std::unordered_map<std::string, double> m_default_widths;
+  std::unordered_map<std::string, double> m_default_ext;
+  std::unordered_map<std::string, db::Cell *> m_macros_by_name;
+  std::unordered_map<std::string, db::Box> m_macro_bboxes_by_name;
+  std::unordered_map<std::string, ViaDesc> m_vias;
 
   std::vector <db::Trans> get_iteration (db::Layout &layout);
   void read_geometries (db::Layout &layout, db::Cell &cell, LayerPurpose purpose, std::map<std::string, db::Box> *collect_bboxes = 0);
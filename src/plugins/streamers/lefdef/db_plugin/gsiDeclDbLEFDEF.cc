@@ -328,6 +328,38 @@ gsi::Class<db::LEFDEFReaderOptions> decl_lefdef_config ("db", "LEFDEFReaderConfi
   gsi::method ("lef_files=", &db::LEFDEFReaderOptions::set_lef_files,
     "@brief Sets the list technology LEF files to additionally import\n"
     "See \\lef_files for details."
+  ) +
+  gsi::method ("threads", &db::LEFDEFReaderOptions::threads,
+    "@brief Gets the number of threads used for reading the NETS and SPECIALNETS sections of DEF files\n"
+    "With a value of 0 (the default), the nets are read in the reader's thread. With a positive value, "
+    "the net specifications are parsed by the given number of worker threads and the results are "
+    "put into the layout in the order of the file. The result is the same in both cases.\n"
+    "\n"
+    "The setter for this property is \\threads=.\n"
+    "\n"
+    "This property has been added in version 0.26."
+  ) +
+  gsi::method ("threads=", &db::LEFDEFReaderOptions::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used for reading the NETS and SPECIALNETS sections of DEF files\n"
+    "See \\threads for details.\n"
+    "\n"
+    "This property has been added in version 0.26."
+  ) +
+  gsi::method ("routing_shape_refs", &db::LEFDEFReaderOptions::routing_shape_refs,
+    "@brief Gets a value indicating whether routing paths and polygons are stored as shape references\n"
+    "If this property is true, the wires and polygons of the NETS and SPECIALNETS sections are stored as "
+    "path and polygon references. Segments of the same shape then share their geometry, which saves memory "
+    "for large designs. By default, plain paths and polygons are produced.\n"
+    "\n"
+    "The setter for this property is \\routing_shape_refs=.\n"
+    "\n"
+    "This property has been added in version 0.26."
+  ) +
+  gsi::method ("routing_shape_refs=", &db::LEFDEFReaderOptions::set_routing_shape_refs, gsi::arg ("f"),
+    "@brief Sets a value indicating whether routing paths and polygons are stored as shape references\n"
+    "See \\routing_shape_refs for details.\n"
+    "\n"
+    "This property has been added in version 0.26."
   ),
   "@brief Detailed LEF/DEF reader options\n"
   "This class is a aggregate belonging to the \\LoadLayoutOptions class. It provides options for the LEF/DEF reader. "
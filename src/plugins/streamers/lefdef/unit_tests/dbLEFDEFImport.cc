@@ -29,6 +29,7 @@
 #include "tlUnitTest.h"
 
 #include <cstdlib>
+#include <set>
 
 static void run_test (tl::TestBase *_this, const char *lef_dir, const char *filename, const char *au, bool priv = true)
 {
@@ -238,3 +239,191 @@ TEST(20)
   run_test (_this, "issue-172", "lef:in.lef+def:in.def", "au.oas.gz", false);
 }
 
+
+static void read_def_text (const std::string &lef_file, const std::string &def_file, int threads, db::Layout &layout, bool net_names = false, bool shape_refs = false)
+{
+  db::LEFDEFReaderOptions tc;
+  tc.set_threads (threads);
+  tc.set_produce_net_names (net_names);
+  tc.set_routing_shape_refs (shape_refs);
+  db::LEFDEFLayerDelegate ld (&tc);
+
+  ld.prepare (layout);
+
+  db::DEFImporter imp;
+
+  {
+    tl::InputStream stream (lef_file);
+    imp.read_lef (stream, layout, ld);
+  }
+
+  {
+    tl::InputStream stream (def_file);
+    imp.read (stream, layout, ld);
+  }
+
+  ld.finish (layout);
+}
+
+static void count_paths (const db::Layout &layout, size_t &npaths, size_t &npathrefs)
+{
+  npaths = npathrefs = 0;
+  for (db::Layout::layer_iterator l = layout.begin_layers (); l != layout.end_layers (); ++l) {
+    const db::Shapes &shapes = layout.cell (*layout.begin_top_down ()).shapes ((*l).first);
+    for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::Paths); ! s.at_end (); ++s) {
+      ++npaths;
+      if (s->type () == db::Shape::PathRef) {
+        ++npathrefs;
+      }
+    }
+  }
+}
+
+TEST(21)
+{
+  //  parallel reading of NETS and SPECIALNETS renders the same layout than serial reading
+  std::string lef_file = tl::testsrc () + "/testdata/lefdef/issue-172/in.lef";
+  std::string def_file = _this->tmp_file ("nets.def");
+
+  {
+    tl::OutputStream os (def_file);
+    os << "VERSION 5.6 ;\n"
+          "DESIGN NETS ;\n"
+          "UNITS DISTANCE MICRONS 100 ;\n"
+          "DIEAREA ( 0 0 ) ( 100000 100000 ) ;\n"
+          "# a comment with ; and - inside\n"
+          "SPECIALNETS 50 ;\n";
+    for (int i = 0; i < 50; ++i) {
+      os << "- VDD" << i << "\n"
+            "  + ROUTED M1 40 ( " << i * 200 << " 0 ) ( * 5000 )\n"
+            "    NEW M2 20 ( 0 " << i * 200 << " ) ( 5000 * )\n"
+            "  + RECT M2 ( 0 0 ) ( 10 " << i + 10 << " ) ;\n";
+    }
+    os << "END SPECIALNETS\n"
+          "NETS 2500 ;\n";
+    for (int i = 0; i < 2500; ++i) {
+      int x = (i % 50) * 1000, y = (i / 50) * 1000;
+      os << "- \"net " << i << "\" ( C" << i << " A ) # routing follows\n"
+            "  + ROUTED M1 ( " << x << " " << y << " ) ( " << x + 500 << " * ) M2_M1\n"
+            "    NEW M2 ( " << x + 500 << " " << y << " ) ( * " << y + 700 << " )\n"
+            "    NEW M1 ( " << x << " " << y << " ) ( " << x + 300 << " " << y + 300 << " ) ;\n";
+    }
+    os << "END NETS\n"
+          "END DESIGN\n";
+  }
+
+  db::Manager m;
+  db::Layout layout_serial (&m), layout_parallel (&m);
+
+  read_def_text (lef_file, def_file, 0, layout_serial);
+  read_def_text (lef_file, def_file, 4, layout_parallel);
+
+  size_t nshapes = 0;
+  for (db::Layout::layer_iterator l = layout_serial.begin_layers (); l != layout_serial.end_layers (); ++l) {
+    nshapes += layout_serial.cell (*layout_serial.begin_top_down ()).shapes ((*l).first).size ();
+  }
+  //  + 1 for the die area
+  EXPECT_EQ (nshapes, size_t (50 * 3 + 2500 * 3 + 1));
+
+  //  wires are stored as plain paths by default
+  size_t npaths = 0, npathrefs = 0;
+  count_paths (layout_serial, npaths, npathrefs);
+  EXPECT_EQ (npaths > 0, true);
+  EXPECT_EQ (npathrefs, size_t (0));
+
+  bool equal = db::compare_layouts (layout_serial, layout_parallel, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+
+  //  on request, wires are stored as path references
+  {
+    db::Layout layout_serial_refs (&m), layout_parallel_refs (&m);
+
+    read_def_text (lef_file, def_file, 0, layout_serial_refs, false, true);
+    read_def_text (lef_file, def_file, 4, layout_parallel_refs, false, true);
+
+    size_t npaths_refs = 0;
+    count_paths (layout_serial_refs, npaths_refs, npathrefs);
+    EXPECT_EQ (npaths_refs, npaths);
+    EXPECT_EQ (npathrefs, npaths);
+    count_paths (layout_parallel_refs, npaths_refs, npathrefs);
+    EXPECT_EQ (npathrefs, npaths);
+
+    equal = db::compare_layouts (layout_serial, layout_serial_refs, db::layout_diff::f_verbose, 0);
+    EXPECT_EQ (equal, true);
+    equal = db::compare_layouts (layout_serial, layout_parallel_refs, db::layout_diff::f_verbose, 0);
+    EXPECT_EQ (equal, true);
+  }
+
+  //  with net names as properties
+  db::Layout layout_serial_props (&m), layout_parallel_props (&m);
+
+  read_def_text (lef_file, def_file, 0, layout_serial_props, true);
+  read_def_text (lef_file, def_file, 4, layout_parallel_props, true);
+
+  std::set<std::string> net_names;
+  size_t nshapes_with_props = 0;
+  for (db::Layout::layer_iterator l = layout_parallel_props.begin_layers (); l != layout_parallel_props.end_layers (); ++l) {
+    const db::Shapes &shapes = layout_parallel_props.cell (*layout_parallel_props.begin_top_down ()).shapes ((*l).first);
+    for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+      if (s->prop_id () != 0) {
+        ++nshapes_with_props;
+        const db::PropertiesRepository::properties_set &props = layout_parallel_props.properties_repository ().properties (s->prop_id ());
+        for (db::PropertiesRepository::properties_set::const_iterator p = props.begin (); p != props.end (); ++p) {
+          net_names.insert (p->second.to_string ());
+        }
+      }
+    }
+  }
+  //  all net shapes carry the net name, the die area does not
+  EXPECT_EQ (nshapes_with_props, size_t (50 * 3 + 2500 * 3));
+  EXPECT_EQ (net_names.size (), size_t (50 + 2500));
+  EXPECT_EQ (net_names.find ("net 1234") != net_names.end (), true);
+  EXPECT_EQ (net_names.find ("VDD49") != net_names.end (), true);
+
+  equal = db::compare_layouts (layout_serial_props, layout_parallel_props, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+
+  //  an error inside a net is reported with the same file and line context in both modes
+  std::string def_file_err = _this->tmp_file ("nets_err.def");
+
+  {
+    tl::OutputStream os (def_file_err);
+    os << "VERSION 5.6 ;\n"
+          "DESIGN NETS ;\n"
+          "UNITS DISTANCE MICRONS 100 ;\n"
+          "NETS 2500 ;\n";
+    for (int i = 0; i < 2500; ++i) {
+      int x = (i % 50) * 1000, y = (i / 50) * 1000;
+      os << "- \"net " << i << "\" ( C" << i << " A )\n"
+            "  + ROUTED M1 ( " << x << " " << y << " ) ( " << x + 500 << " * )\n";
+      if (i == 1700) {
+        //  line 4 + 1700 * 3 + 3 = 5107
+        os << "    NEW M2 ( " << x + 500 << " " << y << " ) ( * NOTANUMBER ) ;\n";
+      } else {
+        os << "    NEW M2 ( " << x + 500 << " " << y << " ) ( * " << y + 700 << " ) ;\n";
+      }
+    }
+    os << "END NETS\n"
+          "END DESIGN\n";
+  }
+
+  std::string msg_serial, msg_parallel;
+
+  try {
+    db::Layout layout (&m);
+    read_def_text (lef_file, def_file_err, 0, layout);
+  } catch (db::LEFDEFReaderException &ex) {
+    msg_serial = ex.msg ();
+  }
+
+  try {
+    db::Layout layout (&m);
+    read_def_text (lef_file, def_file_err, 4, layout);
+  } catch (db::LEFDEFReaderException &ex) {
+    msg_parallel = ex.msg ();
+  }
+
+  EXPECT_EQ (msg_serial.find ("line=5107,") != std::string::npos, true);
+  EXPECT_EQ (msg_serial.find ("nets_err.def") != std::string::npos, true);
+  EXPECT_EQ (msg_parallel, msg_serial);
+}
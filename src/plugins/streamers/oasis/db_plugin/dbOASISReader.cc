@@ -27,6 +27,7 @@
 #include "dbStream.h"
 #include "dbObjectWithProperties.h"
 #include "dbArray.h"
+#include "dbLayoutUtils.h"
 #include "dbStatic.h"
 
 #include "tlException.h"
@@ -105,6 +106,7 @@ OASISReader::OASISReader (tl::InputStream &s)
     m_read_texts (true),
     m_read_properties (true),
     m_read_all_properties (false),
+    m_pack_polygons (false),
     m_s_gds_property_name_id (0),
     m_klayout_context_property_name_id (0)
 {
@@ -141,6 +143,7 @@ OASISReader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
   m_read_texts = common_options.enable_text_objects;
   m_read_properties = common_options.enable_properties;
   m_create_layers = common_options.create_other_layers;
+  m_pack_polygons = common_options.pack_polygons;
   m_read_all_properties = oasis_options.read_all_properties;
   m_expect_strict_mode = oasis_options.expect_strict_mode;
 
@@ -153,6 +156,10 @@ OASISReader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
     throw;
   }
 
+  if (common_options.deduplicate_cells) {
+    db::deduplicate_cells (layout);
+  }
+
   return m_layer_map;
 }
 
@@ -1324,6 +1331,9 @@ OASISReader::do_read (db::Layout &layout)
 
     }
 
+    //  the property sets have been modified in place - update the lookup tables
+    layout.properties_repository ().rehash ();
+
     m_propvalue_forward_references.clear ();
 
   }
@@ -2441,6 +2451,9 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
         //  convert the OASIS record into the polygon.
         db::SimplePolygon poly;
         poly.assign_hull (mm_polygon_point_list.get ().begin (), mm_polygon_point_list.get ().end (), false /*no compression*/);
+        if (m_pack_polygons) {
+          poly.pack ();
+        }
 
         const std::vector<db::Vector> *points = 0;
 
@@ -2513,6 +2526,9 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
         //  convert the OASIS record into the polygon.
         db::SimplePolygon poly;
         poly.assign_hull (mm_polygon_point_list.get ().begin (), mm_polygon_point_list.get ().end (), false /*no compression*/);
+        if (m_pack_polygons) {
+          poly.pack ();
+        }
         db::SimplePolygonRef poly_ref (poly, layout.shape_repository ());
 
         if (pp.first) {
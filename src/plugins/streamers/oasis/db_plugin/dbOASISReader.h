@@ -212,6 +212,7 @@ private:
   bool m_read_texts;
   bool m_read_properties;
   bool m_read_all_properties;
+  bool m_pack_polygons;
 
   std::set <unsigned long> m_defined_cells_by_id;
   std::set <std::string> m_defined_cells_by_name;
@@ -26,8 +26,12 @@
 #include "dbRecursiveShapeIterator.h"
 #include "dbPolygonTools.h"
 #include "dbShapeProcessor.h"
+#include "dbBoxScanner.h"
+#include "rdb.h"
 #include "tlLog.h"
 
+#include <algorithm>
+
 //  -O3 appears not to work properly for gcc 4.4.7 (RHEL 6)
 //  In that case, the net tracer function crashes.
 #if defined(__GNUC__) && __GNUC__ == 4 && __GNUC_MINOR == 4 && defined(__OPTIMIZE__)
@@ -125,7 +129,7 @@ NetTracerShapeHeap::NetTracerShapeHeap ()
 db::Shape 
 NetTracerShapeHeap::insert (const db::Polygon &p)
 {
-  std::map<db::Polygon, db::Shape>::const_iterator c = m_cache.find (p);
+  std::unordered_map<db::Polygon, db::Shape>::const_iterator c = m_cache.find (p);
   if (c == m_cache.end ()) {
     c = m_cache.insert (std::make_pair (p, m_container.insert (p))).first;
   }
@@ -139,6 +143,61 @@ NetTracerShapeHeap::clear ()
   m_cache.clear ();
 }
 
+// -----------------------------------------------------------------------------------
+//  NetTracerShapeArena implementation
+
+//  The number of shapes per block
+const size_t net_tracer_arena_block_size = 1024;
+
+NetTracerShapeArena::NetTracerShapeArena ()
+{
+  //  .. nothing yet ..
+}
+
+std::pair<const NetTracerShape *, bool>
+NetTracerShapeArena::insert (const NetTracerShape &shape)
+{
+  const NetTracerShape *f = find (shape);
+  if (f) {
+    return std::make_pair (f, false);
+  }
+
+  if (m_blocks.empty () || m_blocks.back ().size () == m_blocks.back ().capacity ()) {
+    //  NOTE: moving the blocks does not move the shapes, hence the pointers stay valid
+    m_blocks.push_back (block_type ());
+    m_blocks.back ().reserve (net_tracer_arena_block_size);
+  }
+
+  m_blocks.back ().push_back (shape);
+  const NetTracerShape *s = &m_blocks.back ().back ();
+  m_index.insert (s);
+
+  return std::make_pair (s, true);
+}
+
+const NetTracerShape *
+NetTracerShapeArena::find (const NetTracerShape &shape) const
+{
+  std::unordered_set<const NetTracerShape *, NetTracerShapePtrHash, NetTracerShapePtrEqual>::const_iterator i = m_index.find (&shape);
+  return i != m_index.end () ? *i : 0;
+}
+
+void 
+NetTracerShapeArena::get_shapes (std::vector<NetTracerShape> &shapes) const
+{
+  shapes.reserve (shapes.size () + size ());
+  for (std::vector<block_type>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    shapes.insert (shapes.end (), b->begin (), b->end ());
+  }
+}
+
+void
+NetTracerShapeArena::clear ()
+{
+  m_index.clear ();
+  m_blocks.clear ();
+}
+
 // -----------------------------------------------------------------------------------
 //  NetTracerData implementation
 
@@ -334,6 +393,30 @@ NetTracerData::requires_booleans (unsigned int from_layer) const
   return r->second;
 }
 
+bool
+NetTracerData::has_boolean_layers () const
+{
+  for (std::map <unsigned int, std::set <unsigned int> >::const_iterator g = m_log_connection_graph.begin (); g != m_log_connection_graph.end (); ++g) {
+    if (! expression (g->first).is_alias ()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::map <unsigned int, std::set <unsigned int> >
+NetTracerData::original_layer_connections () const
+{
+  std::map <unsigned int, std::set <unsigned int> > oc;
+  for (std::map <unsigned int, std::set <unsigned int> >::const_iterator ol = m_original_layers.begin (); ol != m_original_layers.end (); ++ol) {
+    const std::set<unsigned int> &c = connections (ol->first);
+    for (std::set <unsigned int>::const_iterator l = ol->second.begin (); l != ol->second.end (); ++l) {
+      oc [*l].insert (c.begin (), c.end ());
+    }
+  }
+  return oc;
+}
+
 // -----------------------------------------------------------------------------------
 //  NetTracerLayerExpression implementation
 
@@ -728,11 +811,495 @@ NetTracerLayerExpression::to_string () const
   return s;
 }
 
+// -----------------------------------------------------------------------------------
+//  NetTracerClusters implementation
+
+static const size_t no_cluster = std::numeric_limits<size_t>::max ();
+
+static const unsigned int cluster_shape_flags = db::ShapeIterator::Polygons | db::ShapeIterator::Boxes | db::ShapeIterator::Paths | db::ShapeIterator::Texts;
+
+static db::Polygon
+polygon_of (const NetTracerShape &net_shape)
+{
+  db::Polygon p;
+  net_shape.shape ().polygon (p);
+  p.transform (net_shape.trans ());
+  return p;
+}
+
+/**
+ *  @brief A helper class to compute the clusters of one cell
+ *
+ *  The nodes are the local shapes and the child cell instance clusters. The clusters
+ *  are computed by joining the nodes with a union-find scheme.
+ */
+class NetTracerClusterBuilder
+{
+public:
+  NetTracerClusterBuilder (NetTracerClusters *clusters, db::cell_index_type ci)
+    : mp_clusters (clusters), m_ci (ci)
+  {
+    //  .. nothing yet ..
+  }
+
+  void build ()
+  {
+    const db::Layout &layout = *mp_clusters->mp_layout;
+    const db::Cell &cell = layout.cell (m_ci);
+
+    //  collect the local shapes
+    for (std::set<unsigned int>::const_iterator l = mp_clusters->m_layers.begin (); l != mp_clusters->m_layers.end (); ++l) {
+      for (db::ShapeIterator s = cell.shapes (*l).begin (cluster_shape_flags); ! s.at_end (); ++s) {
+        if (s->is_text ()) {
+          m_local_texts.push_back (std::make_pair (*l, *s));
+        } else {
+          m_local_nodes.insert (std::make_pair (std::make_pair (*l, *s), m_nodes.size ()));
+          m_nodes.push_back (Node (*l, *s));
+        }
+      }
+    }
+
+    size_t nlocal = m_nodes.size ();
+
+    //  local to local interactions
+    for (size_t i = 0; i < nlocal; ++i) {
+
+      NetTracerShape seed (db::ICplxTrans (), m_nodes [i].shape, m_nodes [i].layer, m_ci);
+      db::Polygon p = polygon_of (seed);
+
+      const std::set<unsigned int> &cl = mp_clusters->connected_layers (m_nodes [i].layer);
+      for (std::set<unsigned int>::const_iterator l = cl.begin (); l != cl.end (); ++l) {
+        for (db::ShapeIterator s = cell.shapes (*l).begin_touching (seed.bbox (), cluster_shape_flags); ! s.at_end (); ++s) {
+          NetTracerShape net_shape (db::ICplxTrans (), *s, *l, m_ci);
+          if (interacts (p, net_shape)) {
+            if (s->is_text ()) {
+              m_texts.push_back (std::make_pair (i, NetTracerClusters::AttachedText (net_shape, 0)));
+            } else {
+              join (i, m_local_nodes [std::make_pair (*l, *s)]);
+            }
+          }
+        }
+      }
+
+    }
+
+    //  local to instance interactions
+    for (size_t i = 0; i < nlocal; ++i) {
+      NetTracerShape seed (db::ICplxTrans (), m_nodes [i].shape, m_nodes [i].layer, m_ci);
+      local_to_instances (seed);
+    }
+    for (std::vector<std::pair<unsigned int, db::Shape> >::const_iterator t = m_local_texts.begin (); t != m_local_texts.end (); ++t) {
+      NetTracerShape seed (db::ICplxTrans (), t->second, t->first, m_ci);
+      local_to_instances (seed);
+    }
+
+    //  instance to instance interactions
+    db::box_convert<db::CellInst> bc (layout);
+
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+
+      const db::CellInstArray &inst = i->cell_inst ();
+      db::cell_index_type ca = inst.object ().cell_index ();
+      const db::Box &box_a = layout.cell (ca).bbox ();
+      if (box_a.empty ()) {
+        continue;
+      }
+
+      for (db::CellInstArray::iterator a = inst.begin (); ! a.at_end (); ++a) {
+
+        db::ICplxTrans ta = inst.complex_trans (*a);
+        db::ICplxTrans ta_inv = ta.inverted ();
+        db::Box ba = box_a.transformed (ta);
+
+        for (db::Cell::touching_iterator j = cell.begin_touching (ba); ! j.at_end (); ++j) {
+
+          const db::CellInstArray &inst2 = j->cell_inst ();
+          db::cell_index_type cb = inst2.object ().cell_index ();
+
+          for (db::CellInstArray::iterator b = inst2.begin_touching (ba, bc); ! b.at_end (); ++b) {
+
+            //  consider each pair once
+            if (std::make_pair (&inst2, (*b).disp ()) <= std::make_pair (&inst, (*a).disp ())) {
+              continue;
+            }
+
+            db::ICplxTrans tb = inst2.complex_trans (*b);
+            const NetTracerClusters::PairInteractions &pi = mp_clusters->pair_interactions (ca, cb, ta_inv * tb);
+
+            for (std::vector<std::pair<size_t, size_t> >::const_iterator jj = pi.joins.begin (); jj != pi.joins.end (); ++jj) {
+              join (instance_node (&inst, ta, (*a).disp (), jj->first), instance_node (&inst2, tb, (*b).disp (), jj->second));
+            }
+
+            for (std::vector<std::pair<std::pair<bool, size_t>, NetTracerClusters::AttachedText> >::const_iterator tt = pi.texts.begin (); tt != pi.texts.end (); ++tt) {
+              size_t n = tt->first.first ? instance_node (&inst2, tb, (*b).disp (), tt->first.second) : instance_node (&inst, ta, (*a).disp (), tt->first.second);
+              const NetTracerShape &ts = tt->second.shape;
+              m_texts.push_back (std::make_pair (n, NetTracerClusters::AttachedText (NetTracerShape (ta * ts.trans (), ts.shape (), ts.layer (), ts.cell_index ()), tt->second.depth + 1)));
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+    //  form the clusters
+    NetTracerClusters::CellClusters &cc = mp_clusters->m_cells [m_ci];
+
+    std::vector<size_t> cluster_for_root (m_nodes.size (), no_cluster);
+
+    for (size_t i = 0; i < m_nodes.size (); ++i) {
+
+      size_t r = find (i);
+      if (cluster_for_root [r] == no_cluster) {
+        cluster_for_root [r] = cc.clusters.size ();
+        cc.clusters.push_back (NetTracerClusters::Cluster ());
+      }
+
+      size_t c = cluster_for_root [r];
+      const Node &n = m_nodes [i];
+      if (n.inst) {
+        cc.clusters [c].instances.push_back (NetTracerClusters::InstanceMember (n.inst, n.trans, n.child_cluster));
+        cc.instance_clusters.insert (std::make_pair (std::make_pair (std::make_pair (n.inst, n.disp), n.child_cluster), c));
+      } else {
+        cc.clusters [c].shapes.push_back (std::make_pair (n.layer, n.shape));
+        cc.shape_clusters.insert (std::make_pair (std::make_pair (n.layer, n.shape), c));
+      }
+
+    }
+
+    for (std::vector<std::pair<size_t, NetTracerClusters::AttachedText> >::const_iterator t = m_texts.begin (); t != m_texts.end (); ++t) {
+      cc.clusters [cluster_for_root [find (t->first)]].texts.push_back (t->second);
+    }
+  }
+
+private:
+  struct Node
+  {
+    Node (unsigned int l, const db::Shape &s)
+      : layer (l), shape (s), inst (0), child_cluster (0)
+    { }
+
+    Node (const db::CellInstArray *i, const db::ICplxTrans &t, const db::Vector &d, size_t c)
+      : layer (0), inst (i), trans (t), disp (d), child_cluster (c)
+    { }
+
+    unsigned int layer;
+    db::Shape shape;
+    const db::CellInstArray *inst;
+    db::ICplxTrans trans;
+    db::Vector disp;
+    size_t child_cluster;
+  };
+
+  NetTracerClusters *mp_clusters;
+  db::cell_index_type m_ci;
+  std::vector<Node> m_nodes;
+  std::vector<size_t> m_parent;
+  std::map<std::pair<unsigned int, db::Shape>, size_t> m_local_nodes;
+  std::map<NetTracerClusters::instance_key_type, size_t> m_instance_nodes;
+  std::vector<std::pair<unsigned int, db::Shape> > m_local_texts;
+  std::vector<std::pair<size_t, NetTracerClusters::AttachedText> > m_texts;
+
+  size_t find (size_t n)
+  {
+    if (n >= m_parent.size ()) {
+      return n;
+    }
+    while (m_parent [n] != n) {
+      m_parent [n] = m_parent [m_parent [n]];
+      n = m_parent [n];
+    }
+    return n;
+  }
+
+  void join (size_t a, size_t b)
+  {
+    if (m_parent.size () < m_nodes.size ()) {
+      size_t n = m_parent.size ();
+      m_parent.resize (m_nodes.size ());
+      for ( ; n < m_parent.size (); ++n) {
+        m_parent [n] = n;
+      }
+    }
+
+    a = find (a);
+    b = find (b);
+    if (a != b) {
+      m_parent [std::max (a, b)] = std::min (a, b);
+    }
+  }
+
+  size_t instance_node (const db::CellInstArray *inst, const db::ICplxTrans &t, const db::Vector &disp, size_t child_cluster)
+  {
+    NetTracerClusters::instance_key_type key (std::make_pair (inst, disp), child_cluster);
+    std::map<NetTracerClusters::instance_key_type, size_t>::const_iterator n = m_instance_nodes.find (key);
+    if (n != m_instance_nodes.end ()) {
+      return n->second;
+    }
+
+    size_t id = m_nodes.size ();
+    m_nodes.push_back (Node (inst, t, disp, child_cluster));
+    m_instance_nodes.insert (std::make_pair (key, id));
+    return id;
+  }
+
+  void local_to_instances (const NetTracerShape &seed)
+  {
+    const db::Layout &layout = *mp_clusters->mp_layout;
+    const db::Cell &cell = layout.cell (m_ci);
+    db::box_convert<db::CellInst> bc (layout);
+
+    bool is_text = seed.shape ().is_text ();
+    db::Polygon p;
+    if (! is_text) {
+      p = polygon_of (seed);
+    }
+
+    size_t seed_node = 0;
+    if (! is_text) {
+      seed_node = m_local_nodes [std::make_pair (seed.layer (), seed.shape ())];
+    }
+
+    const std::set<unsigned int> &cl = mp_clusters->connected_layers (seed.layer ());
+
+    std::vector<NetTracerClusters::SubtreeShape> found;
+
+    for (db::Cell::touching_iterator i = cell.begin_touching (seed.bbox ()); ! i.at_end (); ++i) {
+
+      const db::CellInstArray &inst = i->cell_inst ();
+
+      for (db::CellInstArray::iterator a = inst.begin_touching (seed.bbox (), bc); ! a.at_end (); ++a) {
+
+        db::ICplxTrans t = inst.complex_trans (*a);
+
+        found.clear ();
+        mp_clusters->collect (inst.object ().cell_index (), t, seed.bbox (), cl, found, 1);
+
+        for (std::vector<NetTracerClusters::SubtreeShape>::const_iterator f = found.begin (); f != found.end (); ++f) {
+          if (is_text) {
+            if (f->cluster != no_cluster && interacts (polygon_of (f->shape), seed)) {
+              m_texts.push_back (std::make_pair (instance_node (&inst, t, (*a).disp (), f->cluster), NetTracerClusters::AttachedText (seed, 0)));
+            }
+          } else if (interacts (p, f->shape)) {
+            if (f->cluster == no_cluster) {
+              m_texts.push_back (std::make_pair (seed_node, NetTracerClusters::AttachedText (f->shape, f->depth)));
+            } else {
+              join (seed_node, instance_node (&inst, t, (*a).disp (), f->cluster));
+            }
+          }
+        }
+
+      }
+
+    }
+  }
+};
+
+NetTracerClusters::NetTracerClusters (const db::Layout &layout, const NetTracerData &data)
+  : mp_layout (&layout)
+{
+  m_connections = data.original_layer_connections ();
+  for (std::map<unsigned int, std::set<unsigned int> >::const_iterator c = m_connections.begin (); c != m_connections.end (); ++c) {
+    if (layout.is_valid_layer (c->first)) {
+      m_layers.insert (c->first);
+    }
+  }
+}
+
+void
+NetTracerClusters::clear ()
+{
+  m_cells.clear ();
+  m_pair_cache.clear ();
+}
+
+const std::set<unsigned int> &
+NetTracerClusters::connected_layers (unsigned int l) const
+{
+  std::map<unsigned int, std::set<unsigned int> >::const_iterator c = m_connections.find (l);
+  if (c != m_connections.end ()) {
+    return c->second;
+  } else {
+    static std::set<unsigned int> empty;
+    return empty;
+  }
+}
+
+const std::vector<NetTracerClusters::Cluster> &
+NetTracerClusters::clusters (db::cell_index_type ci)
+{
+  return build (ci).clusters;
+}
+
+NetTracerClusters::CellClusters &
+NetTracerClusters::build (db::cell_index_type ci)
+{
+  CellClusters &cc = m_cells [ci];
+  if (cc.built) {
+    return cc;
+  }
+
+  //  the child cells are built first
+  const db::Cell &cell = mp_layout->cell (ci);
+  for (db::Cell::child_cell_iterator c = cell.begin_child_cells (); ! c.at_end (); ++c) {
+    build (*c);
+  }
+
+  NetTracerClusterBuilder builder (this, ci);
+  builder.build ();
+
+  cc.built = true;
+  return cc;
+}
+
+void
+NetTracerClusters::clusters_interacting (db::cell_index_type ci, const db::Polygon &poly, const std::set<unsigned int> &layers, std::set<size_t> &result)
+{
+  std::vector<SubtreeShape> found;
+  collect (ci, db::ICplxTrans (), poly.box (), layers, found, 0);
+
+  for (std::vector<SubtreeShape>::const_iterator f = found.begin (); f != found.end (); ++f) {
+    if (f->cluster != no_cluster && interacts (poly, f->shape)) {
+      result.insert (f->cluster);
+    }
+  }
+}
+
+void
+NetTracerClusters::collect (db::cell_index_type ci, const db::ICplxTrans &t, const db::Box &box, const std::set<unsigned int> &layers, std::vector<SubtreeShape> &shapes, unsigned int depth)
+{
+  CellClusters &cc = build (ci);
+
+  const db::Cell &cell = mp_layout->cell (ci);
+  db::Box local_box = box.transformed (t.inverted ());
+
+  for (std::set<unsigned int>::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    for (db::ShapeIterator s = cell.shapes (*l).begin_touching (local_box, cluster_shape_flags); ! s.at_end (); ++s) {
+
+      NetTracerShape net_shape (t, *s, *l, ci);
+      if (! net_shape.bbox ().touches (box)) {
+        continue;
+      }
+
+      size_t c = no_cluster;
+      if (! s->is_text ()) {
+        std::map<std::pair<unsigned int, db::Shape>, size_t>::const_iterator sc = cc.shape_clusters.find (std::make_pair (*l, *s));
+        tl_assert (sc != cc.shape_clusters.end ());
+        c = sc->second;
+      }
+
+      shapes.push_back (SubtreeShape (net_shape, c, depth));
+
+    }
+  }
+
+  db::box_convert<db::CellInst> bc (*mp_layout);
+
+  for (db::Cell::touching_iterator i = cell.begin_touching (local_box); ! i.at_end (); ++i) {
+
+    const db::CellInstArray &inst = i->cell_inst ();
+
+    for (db::CellInstArray::iterator a = inst.begin_touching (local_box, bc); ! a.at_end (); ++a) {
+
+      size_t n0 = shapes.size ();
+      collect (inst.object ().cell_index (), t * inst.complex_trans (*a), box, layers, shapes, depth + 1);
+
+      //  map the child clusters to the clusters of this cell
+      for (std::vector<SubtreeShape>::iterator s = shapes.begin () + n0; s != shapes.end (); ++s) {
+        if (s->cluster != no_cluster) {
+          s->cluster = cluster_for_instance (cc, &inst, inst.complex_trans (*a), (*a).disp (), s->cluster);
+        }
+      }
+
+    }
+
+  }
+}
+
+size_t
+NetTracerClusters::cluster_for_instance (CellClusters &cc, const db::CellInstArray *inst, const db::ICplxTrans &t, const db::Vector &disp, size_t child_cluster)
+{
+  instance_key_type key (std::make_pair (inst, disp), child_cluster);
+  std::map<instance_key_type, size_t>::const_iterator ic = cc.instance_clusters.find (key);
+  if (ic != cc.instance_clusters.end ()) {
+    return ic->second;
+  }
+
+  //  a child cluster not connected to anything inside this cell forms a cluster of its own
+  size_t c = cc.clusters.size ();
+  cc.clusters.push_back (Cluster ());
+  cc.clusters.back ().instances.push_back (InstanceMember (inst, t, child_cluster));
+  cc.instance_clusters.insert (std::make_pair (key, c));
+  return c;
+}
+
+const NetTracerClusters::PairInteractions &
+NetTracerClusters::pair_interactions (db::cell_index_type a, db::cell_index_type b, const db::ICplxTrans &rel)
+{
+  PairKey key (a, b, rel);
+  std::map<PairKey, PairInteractions>::const_iterator pc = m_pair_cache.find (key);
+  if (pc != m_pair_cache.end ()) {
+    return pc->second;
+  }
+
+  PairInteractions &pi = m_pair_cache [key];
+
+  db::Box box = mp_layout->cell (a).bbox ().enlarged (db::Vector (1, 1)) & mp_layout->cell (b).bbox ().transformed (rel).enlarged (db::Vector (1, 1));
+  if (box.empty ()) {
+    return pi;
+  }
+
+  //  shapes of a inside the overlap region are checked against b
+  std::vector<SubtreeShape> shapes_a;
+  collect (a, db::ICplxTrans (), box, m_layers, shapes_a, 0);
+
+  std::vector<SubtreeShape> shapes_b;
+
+  for (std::vector<SubtreeShape>::const_iterator sa = shapes_a.begin (); sa != shapes_a.end (); ++sa) {
+
+    shapes_b.clear ();
+    collect (b, rel, sa->shape.bbox (), connected_layers (sa->shape.layer ()), shapes_b, 0);
+
+    if (sa->cluster == no_cluster) {
+
+      //  a text in a attaches to the clusters of b
+      for (std::vector<SubtreeShape>::const_iterator sb = shapes_b.begin (); sb != shapes_b.end (); ++sb) {
+        if (sb->cluster != no_cluster && interacts (polygon_of (sb->shape), sa->shape)) {
+          pi.texts.push_back (std::make_pair (std::make_pair (true, sb->cluster), AttachedText (sa->shape, sa->depth)));
+        }
+      }
+
+    } else {
+
+      db::Polygon p = polygon_of (sa->shape);
+
+      for (std::vector<SubtreeShape>::const_iterator sb = shapes_b.begin (); sb != shapes_b.end (); ++sb) {
+        if (interacts (p, sb->shape)) {
+          if (sb->cluster == no_cluster) {
+            pi.texts.push_back (std::make_pair (std::make_pair (false, sa->cluster), AttachedText (sb->shape, sb->depth)));
+          } else {
+            pi.joins.push_back (std::make_pair (sa->cluster, sb->cluster));
+          }
+        }
+      }
+
+    }
+
+  }
+
+  std::sort (pi.joins.begin (), pi.joins.end ());
+  pi.joins.erase (std::unique (pi.joins.begin (), pi.joins.end ()), pi.joins.end ());
+
+  return pi;
+}
+
 // -----------------------------------------------------------------------------------
 //  NetTracer implementation
 
 NetTracer::NetTracer ()
-  : mp_layout (0), mp_cell (0), mp_progress (0), m_name_hier_depth (-1), m_incomplete (false)
+  : mp_layout (0), mp_cell (0), mp_progress (0), m_name_hier_depth (-1), m_incomplete (false), m_hierarchical (false)
 {
   //  .. nothing yet ..
 }
@@ -742,6 +1309,7 @@ NetTracer::clear ()
 {
   m_shapes_graph.clear ();
   m_shapes_found.clear ();
+  m_shape_store.clear ();
   m_shape_heap.clear ();
 }
 
@@ -766,13 +1334,13 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const db::Poin
   trace (layout, cell, start, data);
 
   //  remove the artificial point-like seed from the shape list
-  for (std::set <NetTracerShape>::iterator s = m_shapes_found.begin (); s != m_shapes_found.end (); ) {
-    std::set <NetTracerShape>::iterator s1 = s;
-    ++s;
-    if (s1->shape () == s_start) {
-      m_shapes_found.erase (s1);
+  std::vector <NetTracerShape>::iterator sw = m_shapes_found.begin ();
+  for (std::vector <NetTracerShape>::const_iterator s = m_shapes_found.begin (); s != m_shapes_found.end (); ++s) {
+    if (s->shape () != s_start) {
+      *sw++ = *s;
     }
   }
+  m_shapes_found.erase (sw, m_shapes_found.end ());
 
   m_shapes_graph.clear ();
 }
@@ -794,13 +1362,13 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const db::Poin
   trace (layout, cell, start, stop, data);
 
   //  remove the artificial point-like seeds from the shape list
-  for (std::set <NetTracerShape>::iterator s = m_shapes_found.begin (); s != m_shapes_found.end (); ) {
-    std::set <NetTracerShape>::iterator s1 = s;
-    ++s;
-    if (s1->shape () == s_start || s1->shape () == s_stop) {
-      m_shapes_found.erase (s1);
+  std::vector <NetTracerShape>::iterator sw = m_shapes_found.begin ();
+  for (std::vector <NetTracerShape>::const_iterator s = m_shapes_found.begin (); s != m_shapes_found.end (); ++s) {
+    if (s->shape () != s_start && s->shape () != s_stop) {
+      *sw++ = *s;
     }
   }
+  m_shapes_found.erase (sw, m_shapes_found.end ());
 
   m_shapes_graph.clear ();
 }
@@ -871,6 +1439,12 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
 
   m_shapes_graph.clear ();
   m_shapes_found.clear ();
+  m_shape_store.clear ();
+
+  if (m_hierarchical && ! stop.is_valid () && NetTracerClusters::is_applicable (data)) {
+    trace_hierarchical (start, data);
+    return;
+  }
 
   try {
 
@@ -1082,6 +1656,7 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
   } catch (...) {
 
     m_shapes_graph.clear ();
+    commit_shapes_found ();
 
     m_hit_test_queue.clear ();
     m_incomplete = true;
@@ -1099,8 +1674,8 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
       search_progress.set_format (tl::to_string (tr ("Iteration %.0f00")));
       search_progress.set_unit (100);
 
-      const NetTracerShape *stop = &m_shapes_graph.find (m_stop_shape)->first;
-      const NetTracerShape *start = &m_shapes_graph.find (m_start_shape)->first;
+      const NetTracerShape *stop = m_shape_store.find (m_stop_shape);
+      const NetTracerShape *start = m_shape_store.find (m_start_shape);
 
       //  find the shortest path with Dijkstras algorithm
 
@@ -1136,7 +1711,7 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
           break; 
         }
 
-        const std::vector <const NetTracerShape *> &adj = m_shapes_graph[*current];
+        const std::vector <const NetTracerShape *> &adj = m_shapes_graph[current];
         for (std::vector <const NetTracerShape *>::const_iterator a = adj.begin (); a != adj.end (); ++a) {
           if (visited.find (*a) == visited.end ()) {
             std::map<const NetTracerShape *, size_t>::iterator ac = cost.find (*a);
@@ -1165,7 +1740,7 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
 
       const NetTracerShape *s = start;
       while (s) {
-        m_shapes_found.insert (*s);
+        m_shapes_found.push_back (*s);
         std::map<const NetTracerShape *, const NetTracerShape *>::const_iterator p = previous.find (s);
         if (p == previous.end ()) {
           s = 0;
@@ -1174,77 +1749,148 @@ NetTracer::trace (const db::Layout &layout, const db::Cell &cell, const NetTrace
         }
       }
 
+      std::sort (m_shapes_found.begin (), m_shapes_found.end ());
+
       m_shapes_graph.clear ();
+      m_shape_store.clear ();
 
+    } else {
+      commit_shapes_found ();
     }
 
   } catch (...) {
     m_shapes_found.clear ();
     m_shapes_graph.clear ();
+    m_shape_store.clear ();
     throw;
   }
 }
 
-void 
-NetTracer::evaluate_text (const db::RecursiveShapeIterator &iter)
+void
+NetTracer::trace_hierarchical (const NetTracerShape &start, const NetTracerData &data)
 {
-  if (iter.shape ().is_text ()) {
-    if (m_name.empty () || m_name_hier_depth < 0 || m_name_hier_depth > int (iter.depth ())) {
-      m_name = iter.shape ().text_string ();
-      m_name_hier_depth = int (iter.depth ());
+  try {
+
+    tl::AbsoluteProgress progress (tl::to_string (tr ("Tracing Net")), 1);
+    progress.set_format (tl::to_string (tr ("%.0f shapes")));
+    progress.set_unit (100);
+    progress.set_format_unit (1);
+
+    mp_progress = &progress;
+
+    tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (tr ("Net Tracing (hierarchical)")));
+
+    m_stop_shape = NetTracerShape ();
+    m_start_shape = start;
+
+    deliver_shape (m_start_shape, (const NetTracerShape *) 0);
+
+    NetTracerClusters clusters (layout (), data);
+
+    //  the net is formed by the clusters interacting with the start shape on the start layer
+    std::set<unsigned int> start_layers;
+    start_layers.insert (start.layer ());
+
+    db::Polygon start_poly;
+    start.shape ().polygon (start_poly);
+    start_poly.transform (start.trans ());
+
+    std::set<size_t> start_clusters;
+    clusters.clusters_interacting (cell ().cell_index (), start_poly, start_layers, start_clusters);
+
+    for (std::set<size_t>::const_iterator c = start_clusters.begin (); c != start_clusters.end (); ++c) {
+      deliver_cluster (clusters, cell ().cell_index (), *c, db::ICplxTrans (), 0);
     }
+
+    commit_shapes_found ();
+
+    m_incomplete = false;
+    mp_progress = 0;
+
+  } catch (...) {
+
+    m_shapes_found.clear ();
+    m_shape_store.clear ();
+    m_incomplete = true;
+    mp_progress = 0;
+
+    throw;
+
   }
 }
 
-const NetTracerShape *
-NetTracer::deliver_shape (const NetTracerShape &net_shape, const NetTracerShape *adjacent)
+void
+NetTracer::deliver_cluster (NetTracerClusters &clusters, db::cell_index_type ci, size_t cluster, const db::ICplxTrans &trans, unsigned int depth)
 {
-  const NetTracerShape *ret = 0;
+  const NetTracerClusters::Cluster &c = clusters.clusters (ci) [cluster];
 
-  if (! m_stop_shape.is_valid ()) {
+  for (std::vector<std::pair<unsigned int, db::Shape> >::const_iterator s = c.shapes.begin (); s != c.shapes.end (); ++s) {
+    deliver_shape (NetTracerShape (trans, s->second, s->first, ci), (const NetTracerShape *) 0);
+  }
 
-    std::pair<std::set <NetTracerShape>::iterator, bool> f = m_shapes_found.insert (net_shape);
-    if (f.second) {
-      if (mp_progress) {
-        ++(*mp_progress);
-      }
-      ret = &*f.first;
-    } else if (f.first->is_pseudo ()) {
-      ret = &*f.first;
-    }
+  for (std::vector<NetTracerClusters::AttachedText>::const_iterator t = c.texts.begin (); t != c.texts.end (); ++t) {
 
-  } else {
-    
-    std::map <NetTracerShape, std::vector<const NetTracerShape *> >::iterator n = m_shapes_graph.find (net_shape);
-    if (n == m_shapes_graph.end ()) {
+    deliver_shape (NetTracerShape (trans * t->shape.trans (), t->shape.shape (), t->shape.layer (), t->shape.cell_index ()), (const NetTracerShape *) 0);
 
-      n = m_shapes_graph.insert (std::make_pair (net_shape, std::vector<const NetTracerShape *> ())).first;
+    unsigned int d = depth + t->depth;
+    if (m_name.empty () || m_name_hier_depth < 0 || m_name_hier_depth > int (d)) {
+      m_name = t->shape.shape ().text_string ();
+      m_name_hier_depth = int (d);
+    }
 
-      if (mp_progress) {
-        ++(*mp_progress);
-      }
+  }
 
-      ret = &n->first;
+  for (std::vector<NetTracerClusters::InstanceMember>::const_iterator i = c.instances.begin (); i != c.instances.end (); ++i) {
+    deliver_cluster (clusters, i->inst->object ().cell_index (), i->cluster, trans * i->trans, depth + 1);
+  }
+}
 
-    } else if (n->first.is_pseudo ()) {
-      ret = &n->first;
+void 
+NetTracer::evaluate_text (const db::RecursiveShapeIterator &iter)
+{
+  if (iter.shape ().is_text ()) {
+    if (m_name.empty () || m_name_hier_depth < 0 || m_name_hier_depth > int (iter.depth ())) {
+      m_name = iter.shape ().text_string ();
+      m_name_hier_depth = int (iter.depth ());
     }
+  }
+}
 
-    if (adjacent) {
-
-      n->second.push_back (adjacent);
-
-      //  Record the reverse interaction
-      std::map <NetTracerShape, std::vector<const NetTracerShape *> >::iterator m = m_shapes_graph.find (*adjacent);
-      m->second.push_back (&n->first);
+const NetTracerShape *
+NetTracer::deliver_shape (const NetTracerShape &net_shape, const NetTracerShape *adjacent)
+{
+  std::pair<const NetTracerShape *, bool> f = m_shape_store.insert (net_shape);
 
+  const NetTracerShape *ret = 0;
+  if (f.second) {
+    if (mp_progress) {
+      ++(*mp_progress);
     }
+    ret = f.first;
+  } else if (f.first->is_pseudo ()) {
+    ret = f.first;
+  }
 
-  } 
+  if (m_stop_shape.is_valid () && adjacent) {
+    //  Record the interaction in both directions
+    m_shapes_graph [f.first].push_back (adjacent);
+    m_shapes_graph [adjacent].push_back (f.first);
+  }
 
   return ret;
 }
 
+void
+NetTracer::commit_shapes_found ()
+{
+  //  Transfers the shapes from the store into the flat result vector. 
+  //  The vector is sorted to provide a deterministic order.
+  m_shapes_found.clear ();
+  m_shape_store.get_shapes (m_shapes_found);
+  std::sort (m_shapes_found.begin (), m_shapes_found.end ());
+  m_shape_store.clear ();
+}
+
 void
 NetTracer::determine_interactions (const std::vector<const NetTracerShape *> &seeds, const db::Box &combined_box, const std::set<unsigned int> &layers, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &delivery, bool do_seed_assignment)
 {
@@ -1363,5 +2009,318 @@ NetTracer::determine_interactions (const db::Polygon &seed, const NetTracerShape
   }
 }
 
+// -----------------------------------------------------------------------------------
+//  NetTracerBatch implementation
+
+namespace
+{
+
+/**
+ *  @brief The flat shape object the box scanner operates on
+ */
+struct NetTracerBatchNode
+{
+  NetTracerBatchNode (const NetTracerShape &s, unsigned int d)
+    : shape (s), depth (d), is_text (s.shape ().is_text ())
+  {
+    if (! is_text) {
+      polygon = polygon_of (s);
+    }
+  }
+
+  NetTracerShape shape;
+  db::Polygon polygon;
+  unsigned int depth;
+  bool is_text;
+};
+
+struct NetTracerBatchNodeBoxConvert
+{
+  typedef db::Box box_type;
+  typedef db::simple_bbox_tag complexity;
+
+  db::Box operator() (const NetTracerBatchNode &n) const
+  {
+    return n.shape.bbox ();
+  }
+};
+
+/**
+ *  @brief The cluster type: a cluster forms a net
+ */
+class NetTracerBatchCluster
+  : public db::cluster<NetTracerBatchNode, size_t>
+{
+public:
+  typedef db::cluster<NetTracerBatchNode, size_t> base_class;
+  typedef NetTracerBatch::Net Net;
+
+  NetTracerBatchCluster (std::vector<Net> *nets, std::vector<size_t> *net_of_node)
+    : mp_nets (nets), mp_net_of_node (net_of_node)
+  {
+    //  .. nothing yet ..
+  }
+
+  void finish ()
+  {
+    //  single texts do not form nets
+    if (end () - begin () == 1 && begin ()->first->is_text) {
+      return;
+    }
+
+    size_t net_id = mp_nets->size ();
+    mp_nets->push_back (Net ());
+    Net &net = mp_nets->back ();
+    net.shapes.reserve (end () - begin ());
+
+    for (iterator i = begin (); i != end (); ++i) {
+      (*mp_net_of_node) [i->second] = net_id;
+      net.shapes.push_back (i->first->shape);
+      net.bbox += i->first->shape.bbox ();
+    }
+  }
+
+private:
+  std::vector<Net> *mp_nets;
+  std::vector<size_t> *mp_net_of_node;
+};
+
+/**
+ *  @brief The cluster collector: joins connected and interacting shapes and records the text attachments
+ */
+class NetTracerBatchClusterCollector
+  : public db::cluster_collector<NetTracerBatchNode, size_t, NetTracerBatchCluster>
+{
+public:
+  typedef db::cluster_collector<NetTracerBatchNode, size_t, NetTracerBatchCluster> base_class;
+
+  NetTracerBatchClusterCollector (const NetTracerBatchCluster &cl, const std::map<unsigned int, std::set<unsigned int> > &connections, std::vector<std::pair<size_t, size_t> > &text_attachments)
+    : base_class (cl, true /*report single*/), mp_connections (&connections), mp_text_attachments (&text_attachments)
+  {
+    //  .. nothing yet ..
+  }
+
+  void add (const NetTracerBatchNode *o1, size_t p1, const NetTracerBatchNode *o2, size_t p2)
+  {
+    if (o1->is_text && o2->is_text) {
+      return;
+    }
+
+    if (! connected (o1->shape.layer (), o2->shape.layer ())) {
+      return;
+    }
+
+    if (o1->is_text) {
+      if (db::interact (o2->polygon, o1->shape.bbox ())) {
+        mp_text_attachments->push_back (std::make_pair (p1, p2));
+      }
+    } else if (o2->is_text) {
+      if (db::interact (o1->polygon, o2->shape.bbox ())) {
+        mp_text_attachments->push_back (std::make_pair (p2, p1));
+      }
+    } else if (db::interact (o1->polygon, o2->polygon)) {
+      base_class::add (o1, p1, o2, p2);
+    }
+  }
+
+private:
+  const std::map<unsigned int, std::set<unsigned int> > *mp_connections;
+  std::vector<std::pair<size_t, size_t> > *mp_text_attachments;
+
+  bool connected (unsigned int la, unsigned int lb) const
+  {
+    std::map<unsigned int, std::set<unsigned int> >::const_iterator c = mp_connections->find (la);
+    return c != mp_connections->end () && c->second.find (lb) != c->second.end ();
+  }
+};
+
+struct NetBBoxLess
+{
+  bool operator() (const NetTracerBatch::Net &a, const NetTracerBatch::Net &b) const
+  {
+    return a.bbox < b.bbox;
+  }
+};
+
+}
+
+NetTracerBatch::NetTracerBatch ()
+  : mp_layout (0), mp_cell (0)
+{
+  //  .. nothing yet ..
 }
 
+void
+NetTracerBatch::clear ()
+{
+  m_nets.clear ();
+}
+
+void
+NetTracerBatch::extract (const db::Layout &layout, const db::Cell &cell, const NetTracerData &data)
+{
+  if (data.has_boolean_layers ()) {
+    throw tl::Exception (tl::to_string (tr ("Batch net extraction does not support computed layers")));
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (tr ("Net extraction (batch)")));
+
+  mp_layout = &layout;
+  mp_cell = &cell;
+  m_nets.clear ();
+
+  std::map<unsigned int, std::set<unsigned int> > connections = data.original_layer_connections ();
+
+  std::set<unsigned int> layers;
+  for (std::map<unsigned int, std::set<unsigned int> >::const_iterator c = connections.begin (); c != connections.end (); ++c) {
+    if (layout.is_valid_layer (c->first)) {
+      layers.insert (c->first);
+    }
+  }
+
+  if (layers.empty ()) {
+    return;
+  }
+
+  //  collect the flat shapes
+
+  std::vector<NetTracerBatchNode> nodes;
+
+  db::RecursiveShapeIterator s (layout, cell, layers);
+  s.shape_flags (cluster_shape_flags);
+  while (! s.at_end ()) {
+    nodes.push_back (NetTracerBatchNode (NetTracerShape (s.trans (), s.shape (), s.layer (), s.cell_index ()), s.depth ()));
+    ++s;
+  }
+
+  //  form the nets
+
+  std::vector<size_t> net_of_node (nodes.size (), std::numeric_limits<size_t>::max ());
+  std::vector<std::pair<size_t, size_t> > text_attachments;
+
+  {
+    db::box_scanner<NetTracerBatchNode, size_t> scanner (true, tl::to_string (tr ("Extracting nets")));
+    scanner.reserve (nodes.size ());
+    for (std::vector<NetTracerBatchNode>::const_iterator n = nodes.begin (); n != nodes.end (); ++n) {
+      scanner.insert (n.operator-> (), size_t (n - nodes.begin ()));
+    }
+
+    NetTracerBatchClusterCollector collector (NetTracerBatchCluster (&m_nets, &net_of_node), connections, text_attachments);
+    scanner.process (collector, 1, NetTracerBatchNodeBoxConvert ());
+  }
+
+  //  attach the texts to the nets
+
+  std::sort (text_attachments.begin (), text_attachments.end ());
+  text_attachments.erase (std::unique (text_attachments.begin (), text_attachments.end ()), text_attachments.end ());
+
+  std::set<std::pair<size_t, size_t> > texts_seen;
+
+  for (std::vector<std::pair<size_t, size_t> >::const_iterator a = text_attachments.begin (); a != text_attachments.end (); ++a) {
+
+    size_t net_id = net_of_node [a->second];
+    if (net_id == std::numeric_limits<size_t>::max () || ! texts_seen.insert (std::make_pair (net_id, a->first)).second) {
+      continue;
+    }
+
+    const NetTracerBatchNode &t = nodes [a->first];
+    Net &net = m_nets [net_id];
+
+    net.shapes.push_back (t.shape);
+    net.labels.insert (t.shape.shape ().text_string ());
+
+    if (net.name_depth < 0 || net.name_depth > int (t.depth)) {
+      net.name = t.shape.shape ().text_string ();
+      net.name_depth = int (t.depth);
+    }
+
+  }
+
+  //  deliver the nets in a reproducible order
+  std::sort (m_nets.begin (), m_nets.end (), NetBBoxLess ());
+}
+
+size_t
+NetTracerBatch::report (rdb::Database &rdb) const
+{
+  if (! mp_layout || ! mp_cell) {
+    return 0;
+  }
+
+  double dbu = mp_layout->dbu ();
+  db::CplxTrans t (dbu);
+
+  std::string top_cell_name = mp_layout->cell_name (mp_cell->cell_index ());
+  if (rdb.top_cell_name ().empty ()) {
+    rdb.set_top_cell_name (top_cell_name);
+  }
+
+  const rdb::Cell *rdb_cell = rdb.cell_by_qname (top_cell_name);
+  if (! rdb_cell) {
+    rdb_cell = rdb.create_cell (top_cell_name);
+  }
+
+  const rdb::Category *shorts = rdb.category_by_name ("shorts");
+  if (! shorts) {
+    rdb::Category *cat = rdb.create_category ("shorts");
+    cat->set_description (tl::to_string (tr ("Nets with different labels")));
+    shorts = cat;
+  }
+
+  const rdb::Category *opens = rdb.category_by_name ("opens");
+  if (! opens) {
+    rdb::Category *cat = rdb.create_category ("opens");
+    cat->set_description (tl::to_string (tr ("Labels found on different nets")));
+    opens = cat;
+  }
+
+  size_t n = 0;
+
+  std::map<std::string, std::vector<size_t> > nets_by_label;
+
+  for (std::vector<Net>::const_iterator net = m_nets.begin (); net != m_nets.end (); ++net) {
+
+    for (std::set<std::string>::const_iterator l = net->labels.begin (); l != net->labels.end (); ++l) {
+      nets_by_label [*l].push_back (size_t (net - m_nets.begin ()));
+    }
+
+    if (net->labels.size () > 1) {
+
+      rdb::Item *item = rdb.create_item (rdb_cell->id (), shorts->id ());
+      item->add_value (tl::to_string (tr ("Short between labels ")) + tl::join (std::vector<std::string> (net->labels.begin (), net->labels.end ()), ", "));
+      item->add_value (t * net->bbox);
+
+      for (std::vector<NetTracerShape>::const_iterator s = net->shapes.begin (); s != net->shapes.end (); ++s) {
+        if (s->shape ().is_text ()) {
+          db::Text text;
+          s->shape ().text (text);
+          item->add_value (t * text.transformed (s->trans ()));
+        }
+      }
+
+      ++n;
+
+    }
+
+  }
+
+  for (std::map<std::string, std::vector<size_t> >::const_iterator l = nets_by_label.begin (); l != nets_by_label.end (); ++l) {
+
+    if (l->second.size () > 1) {
+
+      rdb::Item *item = rdb.create_item (rdb_cell->id (), opens->id ());
+      item->add_value (tl::sprintf (tl::to_string (tr ("Label %s found on %d nets")), l->first, int (l->second.size ())));
+      for (std::vector<size_t>::const_iterator i = l->second.begin (); i != l->second.end (); ++i) {
+        item->add_value (t * m_nets [*i].bbox);
+      }
+
+      ++n;
+
+    }
+
+  }
+
+  return n;
+}
+
+}
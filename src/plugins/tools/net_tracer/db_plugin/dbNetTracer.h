@@ -30,13 +30,22 @@
 #include "dbShapes.h"
 #include "dbShape.h"
 #include "dbEdgeProcessor.h"
+#include "dbInstances.h"
 
 #include "tlProgress.h"
 #include "tlFixedVector.h"
+#include "dbHash.h"
 
 #include <vector>
 #include <map>
 #include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rdb
+{
+  class Database;
+}
 
 namespace db
 {
@@ -72,7 +81,7 @@ public:
 
 private:
   db::Shapes m_container;
-  std::map<db::Polygon, db::Shape> m_cache;
+  std::unordered_map<db::Polygon, db::Shape> m_cache;
 };
 
 /**
@@ -249,6 +258,95 @@ struct HitTestDataBoxConverter
 
 typedef db::box_tree<db::Box, const NetTracerShape *, HitTestDataBoxConverter, 1> HitTestDataBoxTree;
 
+/**
+ *  @brief A hash function for NetTracerShape pointers
+ *
+ *  The hash value is computed from the shape and is compatible with NetTracerShape::operator==.
+ *  Like for the comparison, the pseudo flag does not contribute.
+ */
+struct NetTracerShapePtrHash
+{
+  size_t operator() (const NetTracerShape *s) const
+  {
+    return std::hfunc (s->bbox (), std::hfunc (s->layer (), std::hfunc (s->cell_index ())));
+  }
+};
+
+/**
+ *  @brief An equality predicate for NetTracerShape pointers which compares the shapes
+ */
+struct NetTracerShapePtrEqual
+{
+  bool operator() (const NetTracerShape *a, const NetTracerShape *b) const
+  {
+    return *a == *b;
+  }
+};
+
+/**
+ *  @brief A store for the shapes found by the net tracer
+ *
+ *  The shapes are kept in blocks of fixed capacity, so the shape pointers delivered are 
+ *  stable as long as the store is not cleared. Identical shapes are stored only once:
+ *  a hash index is used to look up shapes which have been stored already.
+ */
+class DB_PLUGIN_PUBLIC NetTracerShapeArena
+{
+public:
+  typedef std::vector<NetTracerShape> block_type;
+
+  /**
+   *  @brief Constructor
+   */
+  NetTracerShapeArena ();
+
+  /**
+   *  @brief Inserts a shape 
+   *
+   *  Returns the pointer to the stored shape and a flag indicating whether the shape
+   *  was new. If an identical shape was stored already, the pointer to this shape 
+   *  is returned.
+   */
+  std::pair<const NetTracerShape *, bool> insert (const NetTracerShape &shape);
+
+  /**
+   *  @brief Finds a shape 
+   *
+   *  Returns 0 if there is no such shape.
+   */
+  const NetTracerShape *find (const NetTracerShape &shape) const;
+
+  /**
+   *  @brief Returns the number of shapes stored
+   */
+  size_t size () const
+  {
+    return m_index.size ();
+  }
+
+  /**
+   *  @brief Returns true, if the store is empty
+   */
+  bool empty () const
+  {
+    return m_index.empty ();
+  }
+
+  /**
+   *  @brief Copies the shapes stored into the given vector
+   */
+  void get_shapes (std::vector<NetTracerShape> &shapes) const;
+
+  /**
+   *  @brief Clears the store
+   */
+  void clear ();
+
+private:
+  std::vector<block_type> m_blocks;
+  std::unordered_set<const NetTracerShape *, NetTracerShapePtrHash, NetTracerShapePtrEqual> m_index;
+};
+
 /**
  *  @brief Describes a boolean expression for computed layers
  */
@@ -571,6 +669,19 @@ public:
     return m_connections.empty ();
   }
 
+  /**
+   *  @brief Returns true, if the connections involve computed (boolean) layers
+   */
+  bool has_boolean_layers () const;
+
+  /**
+   *  @brief Returns the connection graph in terms of original layers
+   *
+   *  The keys of the map are all original layers involved in connections. The values
+   *  are the original layers connected to the respective key layer.
+   */
+  std::map <unsigned int, std::set <unsigned int> > original_layer_connections () const;
+
 private:
   unsigned int m_next_log_layer;
   std::vector <NetTracerConnection> m_connections;
@@ -585,6 +696,172 @@ private:
   void add_layers (unsigned int a, unsigned int b);
 };
 
+/**
+ *  @brief The connectivity clusters of a cell hierarchy
+ *
+ *  This object computes the connected clusters of shapes per cell. A cluster of a cell
+ *  is formed by the shapes of the cell itself and the clusters of the child cell instances.
+ *  The clusters of a cell are computed once and are reused for every instance of this cell.
+ *  Interactions between two child cells are cached per pair of cells and relative 
+ *  transformation, so regular structures are analyzed only once.
+ *
+ *  Texts are not part of the connectivity. They are attached to the clusters they touch.
+ *
+ *  This scheme requires a connectivity without computed (boolean) layers. See
+ *  NetTracerData::has_boolean_layers.
+ */
+class DB_PLUGIN_PUBLIC NetTracerClusters
+{
+public:
+  /**
+   *  @brief A text attached to a cluster
+   *
+   *  The shape's transformation is relative to the cell of the cluster.
+   *  "depth" is the hierarchy depth of the text relative to this cell.
+   */
+  struct AttachedText
+  {
+    AttachedText () : depth (0) { }
+    AttachedText (const NetTracerShape &s, unsigned int d) : shape (s), depth (d) { }
+
+    NetTracerShape shape;
+    unsigned int depth;
+  };
+
+  /**
+   *  @brief A cluster member which is a cluster of a child cell instance
+   */
+  struct InstanceMember
+  {
+    InstanceMember () : inst (0), cluster (0) { }
+    InstanceMember (const db::CellInstArray *i, const db::ICplxTrans &t, size_t c) : inst (i), trans (t), cluster (c) { }
+
+    const db::CellInstArray *inst;
+    db::ICplxTrans trans;
+    size_t cluster;
+  };
+
+  /**
+   *  @brief A connectivity cluster
+   *
+   *  The cluster is formed by the local shapes (layer and shape), the clusters of the
+   *  child cell instances and the attached texts.
+   */
+  struct Cluster
+  {
+    std::vector<std::pair<unsigned int, db::Shape> > shapes;
+    std::vector<InstanceMember> instances;
+    std::vector<AttachedText> texts;
+  };
+
+  /**
+   *  @brief Constructor
+   *
+   *  The layout and the data must not be changed while this object is in use.
+   */
+  NetTracerClusters (const db::Layout &layout, const NetTracerData &data);
+
+  /**
+   *  @brief Returns true, if the cluster scheme is applicable for the given data
+   */
+  static bool is_applicable (const NetTracerData &data)
+  {
+    return ! data.has_boolean_layers ();
+  }
+
+  /**
+   *  @brief Clears the cached clusters
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the clusters of the given cell
+   *
+   *  The clusters are computed on demand. Initially, clusters of child cell instances which
+   *  are not connected to anything inside this cell are not listed. Such a child cluster is
+   *  appended as a cluster of its own when a later query (e.g. "clusters_interacting") hits
+   *  it. Hence the vector may grow and references to it are valid until the next query only.
+   */
+  const std::vector<Cluster> &clusters (db::cell_index_type ci);
+
+  /**
+   *  @brief Gets the clusters of the given cell which interact with the given polygon
+   *
+   *  Only shapes on the given (original) layers are considered. The polygon is given in the 
+   *  coordinates of the cell. The cluster ids are added to "result".
+   */
+  void clusters_interacting (db::cell_index_type ci, const db::Polygon &poly, const std::set<unsigned int> &layers, std::set<size_t> &result);
+
+  /**
+   *  @brief Gets the layers involved in the connectivity
+   */
+  const std::set<unsigned int> &layers () const
+  {
+    return m_layers;
+  }
+
+private:
+  typedef std::pair<std::pair<const db::CellInstArray *, db::Vector>, size_t> instance_key_type;
+
+  struct CellClusters
+  {
+    CellClusters () : built (false) { }
+
+    bool built;
+    std::vector<Cluster> clusters;
+    std::map<std::pair<unsigned int, db::Shape>, size_t> shape_clusters;
+    std::map<instance_key_type, size_t> instance_clusters;
+  };
+
+  struct SubtreeShape
+  {
+    SubtreeShape (const NetTracerShape &s, size_t c, unsigned int d) : shape (s), cluster (c), depth (d) { }
+
+    NetTracerShape shape;
+    size_t cluster;
+    unsigned int depth;
+  };
+
+  struct PairKey
+  {
+    PairKey (db::cell_index_type _a, db::cell_index_type _b, const db::ICplxTrans &_rel) : a (_a), b (_b), rel (_rel) { }
+
+    bool operator< (const PairKey &other) const
+    {
+      if (a != other.a) {
+        return a < other.a;
+      }
+      if (b != other.b) {
+        return b < other.b;
+      }
+      return rel.less (other.rel);
+    }
+
+    db::cell_index_type a, b;
+    db::ICplxTrans rel;
+  };
+
+  struct PairInteractions
+  {
+    std::vector<std::pair<size_t, size_t> > joins;
+    std::vector<std::pair<std::pair<bool, size_t>, AttachedText> > texts;
+  };
+
+  friend class NetTracerClusterBuilder;
+
+  const db::Layout *mp_layout;
+  std::set<unsigned int> m_layers;
+  std::map<unsigned int, std::set<unsigned int> > m_connections;
+  std::map<db::cell_index_type, CellClusters> m_cells;
+  std::map<PairKey, PairInteractions> m_pair_cache;
+
+  CellClusters &build (db::cell_index_type ci);
+  const std::set<unsigned int> &connected_layers (unsigned int l) const;
+  void collect (db::cell_index_type ci, const db::ICplxTrans &t, const db::Box &box, const std::set<unsigned int> &layers, std::vector<SubtreeShape> &shapes, unsigned int depth);
+  size_t cluster_for_instance (CellClusters &cc, const db::CellInstArray *inst, const db::ICplxTrans &t, const db::Vector &disp, size_t child_cluster);
+  const PairInteractions &pair_interactions (db::cell_index_type a, db::cell_index_type b, const db::ICplxTrans &rel);
+};
+
 /**
  *  @brief The net tracer
  *
@@ -595,7 +872,7 @@ private:
 class DB_PLUGIN_PUBLIC NetTracer
 {
 public:
-  typedef std::set <NetTracerShape>::const_iterator iterator;
+  typedef std::vector <NetTracerShape>::const_iterator iterator;
 
   /**
    *  @brief Construct a net tracer on the given cellview.
@@ -675,6 +952,29 @@ public:
    */
   void set_name (const std::string &n);
 
+  /**
+   *  @brief Enables or disables hierarchical mode
+   *
+   *  In hierarchical mode, the connectivity clusters are computed once per cell and
+   *  reused for every instance (see NetTracerClusters). This mode is much faster for 
+   *  nets spanning a large part of the layout (i.e. power nets).
+   *  Hierarchical mode is only applied for net tracing (not for path tracing) and
+   *  if the connectivity does not involve computed (boolean) layers. Otherwise the
+   *  tracer falls back to the flat scheme.
+   */
+  void set_hierarchical (bool f)
+  {
+    m_hierarchical = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether hierarchical mode is enabled
+   */
+  bool hierarchical () const
+  {
+    return m_hierarchical;
+  }
+
   /**
    *  @brief Get the layout from which this net was taken
    */
@@ -694,9 +994,10 @@ public:
 private:
   const db::Layout *mp_layout;
   const db::Cell *mp_cell;
-  std::set <NetTracerShape> m_shapes_found;
+  std::vector <NetTracerShape> m_shapes_found;
+  NetTracerShapeArena m_shape_store;
   NetTracerShapeHeap m_shape_heap;
-  std::map <NetTracerShape, std::vector<const NetTracerShape *> > m_shapes_graph;
+  std::unordered_map <const NetTracerShape *, std::vector<const NetTracerShape *> > m_shapes_graph;
   tl::AbsoluteProgress *mp_progress;
   std::set <std::pair<NetTracerShape, const NetTracerShape *> > m_hit_test_queue;
   std::string m_name;
@@ -705,15 +1006,149 @@ private:
   NetTracerShape m_stop_shape; 
   NetTracerShape m_start_shape;
   db::EdgeProcessor m_ep;
+  bool m_hierarchical;
+
+  void trace_hierarchical (const NetTracerShape &start, const NetTracerData &data);
+  void deliver_cluster (NetTracerClusters &clusters, db::cell_index_type ci, size_t cluster, const db::ICplxTrans &trans, unsigned int depth);
 
   void determine_interactions (const db::Box &seed, const NetTracerShape *shape, const std::set<unsigned int> &layers, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &delivery);
   void determine_interactions (const db::Polygon &seed, const NetTracerShape *shape, const std::set<unsigned int> &layers, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &delivery);
   void determine_interactions (const std::vector<const NetTracerShape *> &seeds, const db::Box &combined_box, const std::set<unsigned int> &layers, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &delivery, bool do_seed_assignment = true);
   void evaluate_text (const db::RecursiveShapeIterator &iter);
   const NetTracerShape *deliver_shape (const NetTracerShape &shape, const NetTracerShape *adjacent);
+  void commit_shapes_found ();
   void compute_results_for_next_iteration (const std::vector <const NetTracerShape *> &new_seeds, unsigned int seed_layer, const std::set<unsigned int> &output_layers, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &current, std::set <std::pair<NetTracerShape, const NetTracerShape *> > &output, const NetTracerData &data);
 };
 
+/**
+ *  @brief A batch net extractor
+ *
+ *  This object extracts all nets formed by the shapes on the connectivity layers in a 
+ *  single pass. It uses the box scanner to detect the interactions of the flattened 
+ *  shapes and a cluster collector to form the nets. Texts on connected layers are 
+ *  attached to the nets they touch and provide the net names.
+ *
+ *  Contrary to NetTracer, this scheme does not support computed (boolean) layers. 
+ *  See NetTracerData::has_boolean_layers.
+ */
+class DB_PLUGIN_PUBLIC NetTracerBatch
+{
+public:
+  /**
+   *  @brief Describes one net
+   */
+  struct Net
+  {
+    Net () : name_depth (-1) { }
+
+    /**
+     *  @brief The shapes of the net including the texts
+     */
+    std::vector<NetTracerShape> shapes;
+
+    /**
+     *  @brief The distinct label strings found on the net
+     */
+    std::set<std::string> labels;
+
+    /**
+     *  @brief The net name (the label found on the top-most hierarchy level)
+     */
+    std::string name;
+
+    /**
+     *  @brief The hierarchy depth of the label giving the name or -1 if there is no name
+     */
+    int name_depth;
+
+    /**
+     *  @brief The bounding box of the net
+     */
+    db::Box bbox;
+  };
+
+  typedef std::vector<Net>::const_iterator iterator;
+
+  /**
+   *  @brief Constructor
+   */
+  NetTracerBatch ();
+
+  /**
+   *  @brief Extracts all nets from the given cell with the given data
+   *
+   *  This method throws an exception if the connectivity involves computed (boolean) layers.
+   */
+  void extract (const db::Layout &layout, const db::Cell &cell, const NetTracerData &data);
+
+  /**
+   *  @brief Reports label conflicts into the given report database
+   *
+   *  Two categories are created: "shorts" lists the nets carrying more than one 
+   *  distinct label and "opens" lists the labels found on more than one net.
+   *  Returns the number of items created.
+   */
+  size_t report (rdb::Database &rdb) const;
+
+  /**
+   *  @brief Begin iterator for the nets
+   */
+  iterator begin () const
+  {
+    return m_nets.begin ();
+  }
+
+  /**
+   *  @brief End iterator for the nets
+   */
+  iterator end () const
+  {
+    return m_nets.end ();
+  }
+
+  /**
+   *  @brief Returns the number of nets
+   */
+  size_t size () const
+  {
+    return m_nets.size ();
+  }
+
+  /**
+   *  @brief Gets the net with the given index
+   */
+  const Net &net (size_t index) const
+  {
+    return m_nets [index];
+  }
+
+  /**
+   *  @brief Clears the nets extracted so far
+   */
+  void clear ();
+
+  /**
+   *  @brief Get the layout from which the nets were taken
+   */
+  const db::Layout &layout () const
+  {
+    return *mp_layout;
+  }
+
+  /**
+   *  @brief Get the cell from which the nets were taken
+   */
+  const db::Cell &cell () const
+  {
+    return *mp_cell;
+  }
+
+private:
+  const db::Layout *mp_layout;
+  const db::Cell *mp_cell;
+  std::vector<Net> m_nets;
+};
+
 }
 
 #endif
@@ -4,6 +4,10 @@ DESTDIR = $$OUT_PWD/../../../../db_plugins
 
 include($$PWD/../../../db_plugin.pri)
 
+INCLUDEPATH += $$RDB_INC
+DEPENDPATH += $$RDB_INC
+LIBS += -L$$DESTDIR/.. -lklayout_rdb
+
 HEADERS = \
   dbNetTracer.h \
   dbNetTracerIO.h \
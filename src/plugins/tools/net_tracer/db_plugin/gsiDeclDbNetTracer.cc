@@ -23,6 +23,8 @@
 #include "dbNetTracer.h"
 #include "dbNetTracerIO.h"
 
+#include "rdb.h"
+
 #include "gsiDecl.h"
 
 namespace gsi
@@ -227,6 +229,21 @@ gsi::Class<db::NetTracer> decl_NetTracer ("db", "NetTracer",
     "The net name is extracted from labels found during the extraction. "
     "This attribute is useful only after the extraction has been performed."
   ) +
+  gsi::method ("hierarchical=", &db::NetTracer::set_hierarchical, gsi::arg ("flag"),
+    "@brief Enables or disables hierarchical mode\n"
+    "In hierarchical mode, the connectivity inside a cell is computed once and reused for every instance of that cell. "
+    "This mode is much faster for large nets such as power nets. It applies to net extraction only and requires "
+    "a technology without computed layers (i.e. without boolean expressions in the connections or symbols). "
+    "Otherwise, the tracer falls back to flat mode.\n"
+    "\n"
+    "This attribute has been introduced in version 0.26."
+  ) +
+  gsi::method ("hierarchical?", &db::NetTracer::hierarchical,
+    "@brief Gets a value indicating whether hierarchical mode is enabled\n"
+    "See \\hierarchical= for details about this attribute.\n"
+    "\n"
+    "This attribute has been introduced in version 0.26."
+  ) +
   gsi::method ("incomplete?", &db::NetTracer::incomplete,
     "@brief Returns a value indicating whether the net is incomplete\n"
     "A net may be incomplete if the extraction has been stopped by the user for example. "
@@ -263,4 +280,109 @@ gsi::Class<db::NetTracer> decl_NetTracer ("db", "NetTracer",
   "This class has been introduced in version 0.25."
 );
 
+
+static void extract_batch (db::NetTracerBatch *batch, const db::NetTracerTechnologyComponent &tech, const db::Layout &layout, const db::Cell &cell)
+{
+  db::NetTracerData tracer_data = tech.get_tracer_data (layout);
+  batch->extract (layout, cell, tracer_data);
+}
+
+static void extract_batch_tn (db::NetTracerBatch *batch, const std::string &tech, const db::Layout &layout, const db::Cell &cell)
+{
+  db::NetTracerData tracer_data = get_tracer_data_from_tech (tech, layout);
+  batch->extract (layout, cell, tracer_data);
+}
+
+static const db::NetTracerBatch::Net &batch_net (const db::NetTracerBatch *batch, size_t index)
+{
+  if (index >= batch->size ()) {
+    throw tl::Exception (tl::to_string (tr ("Net index out of range: %d")), int (index));
+  }
+  return batch->net (index);
+}
+
+static std::string batch_net_name (const db::NetTracerBatch *batch, size_t index)
+{
+  return batch_net (batch, index).name;
+}
+
+static std::vector<std::string> batch_net_labels (const db::NetTracerBatch *batch, size_t index)
+{
+  const db::NetTracerBatch::Net &net = batch_net (batch, index);
+  return std::vector<std::string> (net.labels.begin (), net.labels.end ());
+}
+
+static std::vector<db::NetTracerShape> batch_net_elements (const db::NetTracerBatch *batch, size_t index)
+{
+  return batch_net (batch, index).shapes;
+}
+
+static db::Box batch_net_bbox (const db::NetTracerBatch *batch, size_t index)
+{
+  return batch_net (batch, index).bbox;
+}
+
+gsi::Class<db::NetTracerBatch> decl_NetTracerBatch ("db", "NetTracerBatch",
+  gsi::method_ext ("extract", &extract_batch, gsi::arg ("tech"), gsi::arg ("layout"), gsi::arg ("cell"),
+    "@brief Extracts all nets of the given cell\n"
+    "\n"
+    "@param tech The technology definition\n"
+    "@param layout The layout on which to run the extraction\n"
+    "@param cell The cell on which to run the extraction (child cells will be included)\n"
+    "\n"
+    "The technology must not use computed layers (i.e. boolean expressions in the connections or symbols). "
+    "An exception is thrown otherwise."
+  ) +
+  gsi::method_ext ("extract", &extract_batch_tn, gsi::arg ("tech"), gsi::arg ("layout"), gsi::arg ("cell"),
+    "@brief Extracts all nets of the given cell using the net tracer setup of the given technology\n"
+    "This method behaves identical as the version with a technology object, except that it will look for a technology "
+    "with the given name to obtain the extraction setup."
+  ) +
+  gsi::method ("num_nets", &db::NetTracerBatch::size,
+    "@brief Returns the number of nets found during extraction\n"
+  ) +
+  gsi::method_ext ("net_name", &batch_net_name, gsi::arg ("index"),
+    "@brief Returns the name of the net with the given index\n"
+    "The name is taken from the label on the top-most hierarchy level. It is empty if the net does not carry a label."
+  ) +
+  gsi::method_ext ("net_labels", &batch_net_labels, gsi::arg ("index"),
+    "@brief Returns the distinct label strings found on the net with the given index\n"
+  ) +
+  gsi::method_ext ("net_elements", &batch_net_elements, gsi::arg ("index"),
+    "@brief Returns the elements of the net with the given index\n"
+  ) +
+  gsi::method_ext ("net_bbox", &batch_net_bbox, gsi::arg ("index"),
+    "@brief Returns the bounding box of the net with the given index\n"
+  ) +
+  gsi::method ("report", &db::NetTracerBatch::report, gsi::arg ("rdb"),
+    "@brief Reports label conflicts into the given report database\n"
+    "This method creates two categories: \"shorts\" lists the nets carrying more than one distinct label "
+    "and \"opens\" lists the labels found on more than one net. It returns the number of items created."
+  ) +
+  gsi::method ("clear", &db::NetTracerBatch::clear,
+    "@brief Clears the data from the last extraction\n"
+  ),
+  "@brief Extracts all nets of a layout in a single pass\n"
+  "\n"
+  "Using \\NetTracer to extract all nets of a layout requires one trace per net. This class extracts all nets "
+  "formed by the shapes on the connectivity layers of a net tracer technology in a single pass. The nets "
+  "are named after the labels they carry. Label conflicts (nets with different labels or labels on different nets) "
+  "can be reported into a report database.\n"
+  "\n"
+  "@code\n"
+  "ly = RBA::CellView::active.layout\n"
+  "\n"
+  "tech = RBA::NetTracerTechnology::new\n"
+  "tech.connection(\"1/0\", \"2/0\", \"3/0\")\n"
+  "\n"
+  "batch = RBA::NetTracerBatch::new\n"
+  "batch.extract(tech, ly, ly.top_cell)\n"
+  "\n"
+  "rdb = RBA::ReportDatabase::new(\"Label check\")\n"
+  "batch.report(rdb)\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.26."
+);
+
 }
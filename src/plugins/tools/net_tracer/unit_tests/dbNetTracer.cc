@@ -30,6 +30,7 @@
 #include "dbTestSupport.h"
 #include "dbWriter.h"
 #include "dbReader.h"
+#include "rdb.h"
 
 static db::NetTracerConnectionInfo connection (const std::string &a, const std::string &v, const std::string &b)
 {
@@ -90,7 +91,7 @@ static db::Net trace (db::NetTracer &tracer, const db::Layout &layout, const db:
   return db::Net (tracer, db::ICplxTrans (), layout, cell.cell_index (), std::string (), std::string (), tracer_data);
 }
 
-void run_test (tl::TestBase *_this, const std::string &file, const db::NetTracerTechnologyComponent &tc, const db::LayerProperties &lp_start, const db::Point &p_start, const std::string &file_au, const char *net_name = 0)
+void run_test (tl::TestBase *_this, const std::string &file, const db::NetTracerTechnologyComponent &tc, const db::LayerProperties &lp_start, const db::Point &p_start, const std::string &file_au, const char *net_name = 0, bool hierarchical = false)
 {
   db::Manager m;
 
@@ -107,6 +108,7 @@ void run_test (tl::TestBase *_this, const std::string &file, const db::NetTracer
   const db::Cell &cell = layout_org.cell (*layout_org.begin_top_down ());
 
   db::NetTracer tracer;
+  tracer.set_hierarchical (hierarchical);
   db::Net net = trace (tracer, layout_org, cell, tc, layer_for (layout_org, lp_start), p_start);
 
   if (net_name) {
@@ -376,3 +378,237 @@ TEST(9)
   run_test (_this, file, tc, db::LayerProperties (8, 0), db::Point (3000, 6800), file_au, "A");
 }
 
+//  hierarchical mode: same results as flat mode
+TEST(10)
+{
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "2/0", "3/0"));
+
+  run_test (_this, "t1.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 1500), "t1_net.oas.gz", "THE_NAME", true);
+  run_test (_this, "t1.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 15000), "t1b_net.oas.gz", 0, true);
+}
+
+TEST(10b)
+{
+  db::NetTracerTechnologyComponent tc;
+  tc.add_symbol (symbol ("a", "1/0"));
+  tc.add_symbol (symbol ("c", "cc"));
+  tc.add_symbol (symbol ("cc", "3/0"));
+  tc.add (connection ("a", "2/0", "cc"));
+
+  run_test (_this, "t1.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 1500), "t1_net.oas.gz", "THE_NAME", true);
+}
+
+TEST(10c)
+{
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "10/0", "11/0"));
+
+  run_test (_this, "t1.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 1500), "t1d_net.oas.gz", 0, true);
+}
+
+TEST(10d)
+{
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "2/0", "3/0"));
+
+  run_test (_this, "t4.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 1500), "t4_net.oas.gz", "", true);
+
+  db::NetTracerTechnologyComponent tc2;
+  tc2.add (connection ("1/0", "3/0"));
+
+  run_test (_this, "t4.oas.gz", tc2, db::LayerProperties (1, 0), db::Point (7000, 1500), "t4b_net.oas.gz", "THE_NAME", true);
+}
+
+TEST(10e)
+{
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("15", "14", "7"));
+
+  run_test (_this, "t8.oas.gz", tc, db::LayerProperties (15, 0), db::Point (4000, 10000), "t8_net.oas.gz", "", true);
+}
+
+TEST(10f)
+{
+  //  computed layers: falls back to flat mode
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0*10/0", "2/0", "3/0"));
+
+  run_test (_this, "t5.oas.gz", tc, db::LayerProperties (1, 0), db::Point (7000, 1500), "t5_net.oas.gz", "THE_NAME", true);
+}
+
+static void run_batch_test (tl::TestBase *_this, const std::string &file, const db::NetTracerTechnologyComponent &tc, size_t nets_expected)
+{
+  db::Layout layout;
+  {
+    std::string fn (tl::testsrc ());
+    fn += "/testdata/net_tracer/";
+    fn += file;
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  const db::Cell &cell = layout.cell (*layout.begin_top_down ());
+  db::NetTracerData tracer_data = tc.get_tracer_data (layout);
+
+  db::NetTracerBatch batch;
+  batch.extract (layout, cell, tracer_data);
+
+  EXPECT_EQ (batch.size (), nets_expected);
+
+  //  each net must be identical to the one found by a single trace
+  for (db::NetTracerBatch::iterator n = batch.begin (); n != batch.end (); ++n) {
+
+    db::NetTracerShape start;
+    for (std::vector<db::NetTracerShape>::const_iterator s = n->shapes.begin (); s != n->shapes.end () && ! start.is_valid (); ++s) {
+      if (! s->shape ().is_text ()) {
+        start = *s;
+      }
+    }
+    tl_assert (start.is_valid ());
+
+    db::NetTracer tracer;
+    tracer.trace (layout, cell, start, tracer_data);
+
+    std::set<db::NetTracerShape> shapes (n->shapes.begin (), n->shapes.end ());
+    EXPECT_EQ (shapes.size (), n->shapes.size ());
+
+    std::set<std::pair<unsigned int, db::Box> > boxes;
+    for (std::set<db::NetTracerShape>::const_iterator s = shapes.begin (); s != shapes.end (); ++s) {
+      boxes.insert (std::make_pair (s->layer (), s->bbox ()));
+    }
+
+    //  NOTE: the single trace may deliver copies of the start shape, so we compare layers and boxes
+    std::set<std::pair<unsigned int, db::Box> > traced_boxes;
+    for (db::NetTracer::iterator s = tracer.begin (); s != tracer.end (); ++s) {
+      traced_boxes.insert (std::make_pair (s->layer (), s->bbox ()));
+    }
+
+    EXPECT_EQ (boxes == traced_boxes, true);
+    EXPECT_EQ (n->name, tracer.name ());
+
+  }
+}
+
+TEST(11)
+{
+  //  batch extraction: same nets as single traces
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "2/0", "3/0"));
+  run_batch_test (_this, "t1.oas.gz", tc, 1);
+
+  db::NetTracerTechnologyComponent tc2;
+  tc2.add (connection ("1/0", "3/0"));
+  run_batch_test (_this, "t1.oas.gz", tc2, 1);
+  run_batch_test (_this, "t4.oas.gz", tc, 2);
+  run_batch_test (_this, "t4.oas.gz", tc2, 1);
+
+  db::NetTracerTechnologyComponent tc3;
+  tc3.add (connection ("15", "14", "7"));
+  run_batch_test (_this, "t8.oas.gz", tc3, 6);
+}
+
+TEST(12)
+{
+  //  batch extraction: label conflict report
+  db::Layout layout;
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = layout.insert_layer (db::LayerProperties (2, 0));
+  unsigned int l3 = layout.insert_layer (db::LayerProperties (3, 0));
+  db::Cell &top = layout.cell (layout.add_cell ("TOP"));
+
+  //  net 1: A and B shorted through a via
+  top.shapes (l1).insert (db::Box (0, 0, 1000, 100));
+  top.shapes (l2).insert (db::Box (900, 0, 1000, 100));
+  top.shapes (l3).insert (db::Box (900, 0, 2000, 100));
+  top.shapes (l1).insert (db::Text ("A", db::Trans (db::Vector (50, 50))));
+  top.shapes (l3).insert (db::Text ("B", db::Trans (db::Vector (1950, 50))));
+
+  //  net 2 and 3: C split into two parts
+  top.shapes (l1).insert (db::Box (0, 1000, 1000, 1100));
+  top.shapes (l1).insert (db::Box (1100, 1000, 2000, 1100));
+  top.shapes (l1).insert (db::Text ("C", db::Trans (db::Vector (50, 1050))));
+  top.shapes (l1).insert (db::Text ("C", db::Trans (db::Vector (1950, 1050))));
+
+  //  a text not touching any shape
+  top.shapes (l1).insert (db::Text ("D", db::Trans (db::Vector (5000, 5000))));
+
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "2/0", "3/0"));
+
+  db::NetTracerBatch batch;
+  batch.extract (layout, top, tc.get_tracer_data (layout));
+
+  EXPECT_EQ (batch.size (), size_t (3));
+  EXPECT_EQ (batch.net (0).name, "A");
+  EXPECT_EQ (batch.net (0).labels.size (), size_t (2));
+  EXPECT_EQ (batch.net (0).shapes.size (), size_t (5));
+  EXPECT_EQ (batch.net (1).name, "C");
+  EXPECT_EQ (batch.net (2).name, "C");
+
+  rdb::Database rdb;
+  EXPECT_EQ (batch.report (rdb), size_t (2));
+
+  const rdb::Category *shorts = rdb.category_by_name ("shorts");
+  const rdb::Category *opens = rdb.category_by_name ("opens");
+  tl_assert (shorts != 0 && opens != 0);
+  EXPECT_EQ (shorts->num_items (), size_t (1));
+  EXPECT_EQ (opens->num_items (), size_t (1));
+
+  const rdb::Item &short_item = **rdb.items_by_category (shorts->id ()).first;
+  EXPECT_EQ (short_item.values ().to_string (&rdb), "text: 'Short between labels A, B';box: (0,0;2,0.1);label: ('A',r0 0.05,0.05);label: ('B',r0 1.95,0.05)");
+
+  const rdb::Item &open_item = **rdb.items_by_category (opens->id ()).first;
+  EXPECT_EQ (open_item.values ().to_string (&rdb), "text: 'Label C found on 2 nets';box: (0,1;1,1.1);box: (1.1,1;2,1.1)");
+
+  //  computed layers are not supported
+  db::NetTracerTechnologyComponent tc2;
+  tc2.add (connection ("1/0*10/0", "2/0", "3/0"));
+
+  std::string err;
+  try {
+    batch.extract (layout, top, tc2.get_tracer_data (layout));
+  } catch (tl::Exception &) {
+    err = "error";
+  }
+  EXPECT_EQ (err, "error");
+}
+
+TEST(13)
+{
+  //  tracing benchmark: a mesh of horizontal and vertical wires connected by vias at every crossing
+  db::Layout layout;
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = layout.insert_layer (db::LayerProperties (2, 0));
+  unsigned int l3 = layout.insert_layer (db::LayerProperties (3, 0));
+  db::Cell &top = layout.cell (layout.add_cell ("TOP"));
+
+  const int n = 60;
+  for (int i = 0; i < n; ++i) {
+    top.shapes (l1).insert (db::Box (0, i * 1000, n * 1000, i * 1000 + 200));
+    top.shapes (l3).insert (db::Box (i * 1000, 0, i * 1000 + 200, n * 1000));
+    for (int j = 0; j < n; ++j) {
+      top.shapes (l2).insert (db::Box (j * 1000 + 50, i * 1000 + 50, j * 1000 + 150, i * 1000 + 150));
+    }
+  }
+
+  db::NetTracerTechnologyComponent tc;
+  tc.add (connection ("1/0", "2/0", "3/0"));
+
+  {
+    tl::SelfTimer timer ("net tracing");
+    db::NetTracer tracer;
+    db::Net net = trace (tracer, layout, top, tc, l1, db::Point (500, 100));
+    EXPECT_EQ (tracer.size (), size_t (2 * n + n * n));
+    EXPECT_EQ (net.size (), size_t (2 * n + n * n));
+  }
+
+  {
+    tl::SelfTimer timer ("path tracing");
+    db::NetTracer tracer;
+    db::Net net = trace (tracer, layout, top, tc, l1, db::Point (500, 100), l1, db::Point (500, (n - 1) * 1000 + 100));
+    //  row 0, via, column 0, via, row n-1
+    EXPECT_EQ (tracer.size (), size_t (5));
+  }
+}
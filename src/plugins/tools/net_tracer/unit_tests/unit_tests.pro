@@ -8,10 +8,10 @@ include($$PWD/../../../../lib_ut.pri)
 SOURCES = \
   dbNetTracer.cc \
 
-INCLUDEPATH += $$LAY_INC $$TL_INC $$DB_INC $$GSI_INC $$PWD/../db_plugin $$PWD/../../../common
-DEPENDPATH += $$LAY_INC $$TL_INC $$DB_INC $$GSI_INC $$PWD/../db_plugin $$PWD/../../../common
+INCLUDEPATH += $$LAY_INC $$TL_INC $$DB_INC $$RDB_INC $$GSI_INC $$PWD/../db_plugin $$PWD/../../../common
+DEPENDPATH += $$LAY_INC $$TL_INC $$DB_INC $$RDB_INC $$GSI_INC $$PWD/../db_plugin $$PWD/../../../common
 
-LIBS += -L$$DESTDIR_UT -lklayout_db -lklayout_tl -lklayout_gsi
+LIBS += -L$$DESTDIR_UT -lklayout_db -lklayout_rdb -lklayout_tl -lklayout_gsi
 
 # This makes the test pull the mebes library for testing (not installed)
 PLUGINPATH = $$OUT_PWD/../../../../db_plugins
@@ -1161,7 +1161,12 @@ method_adaptor (int mid, PyObject *self, PyObject *args)
 
       }
 
-      meth->call (obj, arglist, retlist);
+      if (meth->allows_threads ()) {
+        PythonThreadsAllowed threads_allowed;
+        meth->call (obj, arglist, retlist);
+      } else {
+        meth->call (obj, arglist, retlist);
+      }
 
       ret = get_return_value (p, retlist, meth, heap);
 
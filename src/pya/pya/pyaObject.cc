@@ -124,6 +124,9 @@ Callee::call (int id, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
   const gsi::MethodBase *meth = m_cbfuncs [id].method ();
 
+  //  the callback may arrive while the GIL is released (see PythonThreadsAllowed)
+  PythonGILLock gil_lock;
+
   try {
 
     PythonRef callable (m_cbfuncs [id].callable ());
@@ -123,6 +123,8 @@ SignalHandler::~SignalHandler ()
 
 void SignalHandler::call (const gsi::MethodBase *meth, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  PythonGILLock gil_lock;
+
   PYTHON_BEGIN_EXEC
 
     tl::Heap heap;
@@ -22,6 +22,7 @@
 
 #include "pyaStatusChangedListener.h"
 #include "pyaObject.h"
+#include "pyaUtils.h"
 
 namespace pya
 {
@@ -37,6 +38,8 @@ StatusChangedListener::StatusChangedListener (PYAObjectBase *pya_object)
 void
 StatusChangedListener::object_status_changed (gsi::ObjectBase::StatusEventType type)
 {
+  PythonGILLock gil_lock;
+
   if (type == gsi::ObjectBase::ObjectDestroyed) {
     mp_pya_object->object_destroyed ();
   } else if (type == gsi::ObjectBase::ObjectKeep) {
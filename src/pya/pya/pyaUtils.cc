@@ -25,6 +25,8 @@
 #include <frameobject.h>   //  Python - for traceback
 
 #include "tlString.h"
+#include "tlThreads.h"
+#include "tlThreadedWorkers.h"
 
 #include "pyaUtils.h"
 #include "pyaConvert.h"
@@ -132,5 +134,80 @@ void check_error ()
   }
 }
 
+// --------------------------------------------------------------------------
+//  PythonThreadsAllowed implementation
+
+//  The job context (see tl::job_context) of threads which have released the GIL.
+//  Jobs started from such a thread hand this context over to their worker threads.
+//  A thread acquiring the GIL for a callback resets the context while it holds the
+//  GIL, so jobs started from the callback do not attempt to acquire it.
+static char s_gil_released_context = 0;
+
+PythonThreadsAllowed::PythonThreadsAllowed ()
+  : mp_state (0), mp_job_context (0)
+{
+#if PY_VERSION_HEX < 0x03070000
+  //  before 3.7, the GIL needs to be created explicitly before it can be released
+  if (! PyEval_ThreadsInitialized ()) {
+    PyEval_InitThreads ();
+  }
+#endif
+  mp_job_context = tl::job_context ();
+  tl::set_job_context (&s_gil_released_context);
+  mp_state = (void *) PyEval_SaveThread ();
+}
+
+PythonThreadsAllowed::~PythonThreadsAllowed ()
+{
+  PyEval_RestoreThread ((PyThreadState *) mp_state);
+  tl::set_job_context (mp_job_context);
+}
+
+// --------------------------------------------------------------------------
+//  PythonGILLock implementation
+
+/**
+ *  @brief Returns true, if the current thread needs to acquire the GIL for a callback
+ *
+ *  This is decided per thread: the GIL is acquired if the callback happens in a thread 
+ *  which has released the GIL through a flagged method or in a worker thread of a job 
+ *  started from such a thread.
+ *
+ *  In all other cases, the GIL is not acquired. Callbacks from worker threads of other 
+ *  methods behave as before: the thread which called the method holds the GIL and 
+ *  waiting for it in the worker thread would deadlock.
+ */
+static bool
+needs_gil_lock ()
+{
+#if PY_VERSION_HEX >= 0x03040000
+  if (PyGILState_Check ()) {
+    //  this thread holds the GIL already
+    return false;
+  }
+#endif
+
+  return tl::job_context () == &s_gil_released_context;
+}
+
+PythonGILLock::PythonGILLock ()
+  : m_locked (false), m_state (0), mp_job_context (0)
+{
+  if (Py_IsInitialized () && needs_gil_lock ()) {
+    m_state = int (PyGILState_Ensure ());
+    m_locked = true;
+    mp_job_context = tl::job_context ();
+    tl::set_job_context (0);
+  }
+}
+
+PythonGILLock::~PythonGILLock ()
+{
+  if (m_locked) {
+    tl::set_job_context (mp_job_context);
+    PyGILState_Release ((PyGILState_STATE) m_state);
+  }
+}
+
 }
 
@@ -70,6 +70,51 @@ namespace pya
  */
 void check_error ();
 
+/**
+ *  @brief Releases the global interpreter lock for the lifetime of this object
+ *
+ *  Use this object around calls into C++ code which may take a long time and do not
+ *  access Python objects. Other Python threads can run in the meantime. Hence these 
+ *  threads may modify the objects the C++ code works on - there is no protection 
+ *  against this.
+ */
+class PythonThreadsAllowed
+{
+public:
+  PythonThreadsAllowed ();
+  ~PythonThreadsAllowed ();
+
+private:
+  void *mp_state;
+  void *mp_job_context;
+
+  PythonThreadsAllowed (const PythonThreadsAllowed &);
+  PythonThreadsAllowed &operator= (const PythonThreadsAllowed &);
+};
+
+/**
+ *  @brief Acquires the global interpreter lock for the lifetime of this object
+ *
+ *  Use this object when entering Python from C++ code which may run while the lock
+ *  is released (see PythonThreadsAllowed). The lock is only acquired if the current
+ *  thread has released the lock or if it is a worker thread of a job started from
+ *  such a thread. This is a no-op if the interpreter is not initialized.
+ */
+class PythonGILLock
+{
+public:
+  PythonGILLock ();
+  ~PythonGILLock ();
+
+private:
+  bool m_locked;
+  int m_state;
+  void *mp_job_context;
+
+  PythonGILLock (const PythonGILLock &);
+  PythonGILLock &operator= (const PythonGILLock &);
+};
+
 }
 
 #endif
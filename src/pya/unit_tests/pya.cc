@@ -102,6 +102,7 @@ PYTHONTEST (dbReaders, "dbReaders.py")
 PYTHONTEST (dbPCellsTest, "dbPCells.py")
 PYTHONTEST (dbPolygonTest, "dbPolygonTest.py")
 PYTHONTEST (dbTransTest, "dbTransTest.py")
+PYTHONTEST (dbThreadsTest, "dbThreadsTest.py")
 PYTHONTEST (tlTest, "tlTest.py")
 #if defined(HAVE_QT) && defined(HAVE_QTBINDINGS)
 PYTHONTEST (qtbinding, "qtbinding.py")
@@ -26,6 +26,7 @@
 #include "rdb.h"
 #include "rdbUtils.h"
 #include "rdbTiledRdbOutputReceiver.h"
+#include "rdbFile.h"
 
 #include "dbPolygon.h"
 #include "dbEdge.h"
@@ -45,47 +46,87 @@ namespace gsi
 // ---------------------------------------------------------------
 //  Utilities
 
-class ItemRefUnwrappingIterator
+/**
+ *  @brief An iterator delivering the items of one of the database's item lists
+ *
+ *  The item lists of the database are invalidated when items are added. Scripts may 
+ *  create items while iterating, so this iterator does not keep list iterators. 
+ *  Instead it keeps the position and looks up the list again on each access. The
+ *  items themselves do not move. Items added while iterating are not delivered.
+ *  Looking up the list costs a map lookup per step, but no memory per item.
+ */
+class ItemListIterator
 {
 public:
-  typedef rdb::Database::const_item_ref_iterator::iterator_category iterator_category;
-  typedef rdb::Database::const_item_ref_iterator::difference_type difference_type;
+  typedef std::forward_iterator_tag iterator_category;
+  typedef void difference_type;
   typedef rdb::Item value_type;
   typedef const rdb::Item &reference;
   typedef const rdb::Item *pointer;
 
-  ItemRefUnwrappingIterator (rdb::Database::const_item_ref_iterator i)
-    : m_iter (i)
-  { }
+  enum list_type { AllItems, ByCell, ByCategory, ByCellAndCategory };
 
-  bool operator== (const ItemRefUnwrappingIterator &d) const
+  ItemListIterator (const rdb::Database *db, list_type list, rdb::id_type cell_id = 0, rdb::id_type category_id = 0)
+    : mp_db (db), m_list (list), m_cell_id (cell_id), m_category_id (category_id), m_index (0)
   {
-    return m_iter == d.m_iter;
+    m_count = size ();
   }
 
-  bool operator!= (const ItemRefUnwrappingIterator &d) const
+  bool at_end () const
   {
-    return m_iter != d.m_iter;
+    return m_index >= m_count || m_index >= size ();
   }
 
-  ItemRefUnwrappingIterator &operator++ () 
+  void operator++ () 
   {
-    ++m_iter;
-    return *this;
+    ++m_index;
   }
 
   const rdb::Item &operator* () const
   {
-    return (*m_iter).operator* ();
+    return *item ();
   }
 
   const rdb::Item *operator-> () const
   {
-    return (*m_iter).operator-> ();
+    return item ();
   }
 
 private:
-  rdb::Database::const_item_ref_iterator m_iter;
+  const rdb::Database *mp_db;
+  list_type m_list;
+  rdb::id_type m_cell_id, m_category_id;
+  size_t m_index, m_count;
+
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> refs () const
+  {
+    if (m_list == ByCell) {
+      return mp_db->items_by_cell (m_cell_id);
+    } else if (m_list == ByCategory) {
+      return mp_db->items_by_category (m_category_id);
+    } else {
+      return mp_db->items_by_cell_and_category (m_cell_id, m_category_id);
+    }
+  }
+
+  size_t size () const
+  {
+    if (m_list == AllItems) {
+      return size_t (std::distance (mp_db->items ().begin (), mp_db->items ().end ()));
+    } else {
+      std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> r = refs ();
+      return size_t (r.second - r.first);
+    }
+  }
+
+  const rdb::Item *item () const
+  {
+    if (m_list == AllItems) {
+      return &*(mp_db->items ().begin () + m_index);
+    } else {
+      return (refs ().first + m_index)->operator-> ();
+    }
+  }
 };
 
 // ---------------------------------------------------------------
@@ -154,16 +195,10 @@ static void clear_references (rdb::Cell *cell)
   cell->references ().clear ();
 }
 
-ItemRefUnwrappingIterator cell_items_begin (const rdb::Cell *cell)
-{
-  tl_assert (cell->database ());
-  return cell->database ()->items_by_cell (cell->id ()).first;
-}
-
-ItemRefUnwrappingIterator cell_items_end (const rdb::Cell *cell)
+static ItemListIterator cell_items (const rdb::Cell *cell)
 {
   tl_assert (cell->database ());
-  return cell->database ()->items_by_cell (cell->id ()).second;
+  return ItemListIterator (cell->database (), ItemListIterator::ByCell, cell->id ());
 }
 
 Class<rdb::Cell> decl_RdbCell ("rdb", "RdbCell",
@@ -178,7 +213,7 @@ Class<rdb::Cell> decl_RdbCell ("rdb", "RdbCell",
     "\n"
     "This method has been introduced in version 0.23."
   ) +
-  gsi::iterator_ext ("each_item", &cell_items_begin, &cell_items_end,
+  gsi::iterator_ext ("each_item", &cell_items,
     "@brief Iterates over all iterms inside the database which are associated with this cell\n"
     "\n"
     "This method has been introduced in version 0.23."
@@ -240,16 +275,10 @@ static rdb::Categories::iterator end_sub_categories (rdb::Category *cat)
   return cat->sub_categories ().end ();
 }
 
-ItemRefUnwrappingIterator category_items_begin (const rdb::Category *cat)
+static ItemListIterator category_items (const rdb::Category *cat)
 {
   tl_assert (cat->database ());
-  return cat->database ()->items_by_category (cat->id ()).first;
-}
-
-ItemRefUnwrappingIterator category_items_end (const rdb::Category *cat)
-{
-  tl_assert (cat->database ());
-  return cat->database ()->items_by_category (cat->id ()).second;
+  return ItemListIterator (cat->database (), ItemListIterator::ByCategory, 0, cat->id ());
 }
 
 static void scan_layer1 (rdb::Category *cat, const db::Layout &layout, unsigned int layer)
@@ -284,7 +313,7 @@ Class<rdb::Category> decl_RdbCategory ("rdb", "RdbCategory",
     "\n"
     "This method has been introduced in version 0.23."
   ) +
-  gsi::iterator_ext ("each_item", &category_items_begin, &category_items_end,
+  gsi::iterator_ext ("each_item", &category_items,
     "@brief Iterates over all iterms inside the database which are associated with this category\n"
     "\n"
     "This method has been introduced in version 0.23."
@@ -891,44 +920,31 @@ rdb::id_type database_user_tag_id (const rdb::Database *db, const std::string &n
   return db->tags ().tag (name, true).id ();
 }
 
-rdb::Items::const_iterator database_items_begin (const rdb::Database *db)
+static ItemListIterator database_items (const rdb::Database *db)
 {
-  return db->items ().begin ();
+  return ItemListIterator (db, ItemListIterator::AllItems);
 }
 
-rdb::Items::const_iterator database_items_end (const rdb::Database *db)
+static ItemListIterator database_items_cell (const rdb::Database *db, rdb::id_type cell_id)
 {
-  return db->items ().end ();
+  return ItemListIterator (db, ItemListIterator::ByCell, cell_id);
 }
 
-ItemRefUnwrappingIterator database_items_begin_cell (const rdb::Database *db, rdb::id_type cell_id)
+static ItemListIterator database_items_cat (const rdb::Database *db, rdb::id_type cat_id)
 {
-  return db->items_by_cell (cell_id).first;
+  return ItemListIterator (db, ItemListIterator::ByCategory, 0, cat_id);
 }
 
-ItemRefUnwrappingIterator database_items_end_cell (const rdb::Database *db, rdb::id_type cell_id)
+static ItemListIterator database_items_cc (const rdb::Database *db, rdb::id_type cell_id, rdb::id_type cat_id)
 {
-  return db->items_by_cell (cell_id).second;
+  return ItemListIterator (db, ItemListIterator::ByCellAndCategory, cell_id, cat_id);
 }
 
-ItemRefUnwrappingIterator database_items_begin_cat (const rdb::Database *db, rdb::id_type cat_id)
+std::vector<const rdb::Item *> database_items_touching (const rdb::Database *db, rdb::id_type cell_id, const db::DBox &box)
 {
-  return db->items_by_category (cat_id).first;
-}
-
-ItemRefUnwrappingIterator database_items_end_cat (const rdb::Database *db, rdb::id_type cat_id)
-{
-  return db->items_by_category (cat_id).second;
-}
-
-ItemRefUnwrappingIterator database_items_begin_cc (const rdb::Database *db, rdb::id_type cell_id, rdb::id_type cat_id)
-{
-  return db->items_by_cell_and_category (cell_id, cat_id).first;
-}
-
-ItemRefUnwrappingIterator database_items_end_cc (const rdb::Database *db, rdb::id_type cell_id, rdb::id_type cat_id)
-{
-  return db->items_by_cell_and_category (cell_id, cat_id).second;
+  std::vector<const rdb::Item *> items;
+  db->items_touching (cell_id, box, items);
+  return items;
 }
 
 rdb::Categories::const_iterator database_begin_categories (const rdb::Database *db)
@@ -1418,25 +1434,41 @@ Class<rdb::Database> decl_ReportDatabase ("rdb", "ReportDatabase",
   gsi::method ("reset_modified", &rdb::Database::reset_modified,
     "@brief Reset the modified flag\n"
   ) +
-  gsi::iterator_ext ("each_item", &database_items_begin, &database_items_end,
+  gsi::iterator_ext ("each_item", &database_items,
     "@brief Iterates over all iterms inside the database\n"
   ) +
-  gsi::iterator_ext ("each_item_per_cell", &database_items_begin_cell, &database_items_end_cell,
+  gsi::iterator_ext ("each_item_per_cell", &database_items_cell,
     "@brief Iterates over all iterms inside the database which are associated with the given cell\n"
     "@args cell_id\n"
     "@param cell_id The ID of the cell for which all associated items should be retrieved\n"
   ) +
-  gsi::iterator_ext ("each_item_per_category", &database_items_begin_cat, &database_items_end_cat,
+  gsi::iterator_ext ("each_item_per_category", &database_items_cat,
     "@brief Iterates over all iterms inside the database which are associated with the given category\n"
     "@args category_id\n"
     "@param category_id The ID of the category for which all associated items should be retrieved\n"
   ) +
-  gsi::iterator_ext ("each_item_per_cell_and_category", &database_items_begin_cc, &database_items_end_cc,
+  gsi::iterator_ext ("each_item_per_cell_and_category", &database_items_cc,
     "@brief Iterates over all iterms inside the database which are associated with the given cell and category\n"
     "@args cell_id,category_id\n"
     "@param cell_id The ID of the cell for which all associated items should be retrieved\n"
     "@param category_id The ID of the category for which all associated items should be retrieved\n"
   ) +
+  gsi::method_ext ("items_touching", &database_items_touching,
+    "@brief Gets the items of the given cell whose geometrical values touch the given box\n"
+    "@args cell_id,box\n"
+    "@param cell_id The ID of the cell for which the items should be retrieved\n"
+    "@param box The search box in micrometer units of the cell's coordinate system\n"
+    "Items without geometrical values are not reported. This method uses a spatial index which is built on "
+    "the first request for a cell. If item values are changed after that, use \\invalidate_spatial_index "
+    "to update the index.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
+  gsi::method ("invalidate_spatial_index", &rdb::Database::invalidate_spatial_index,
+    "@brief Invalidates the spatial index used by \\items_touching\n"
+    "\n"
+    "This method has been introduced in version 0.26."
+  ) +
   gsi::method ("set_item_visited", &rdb::Database::set_item_visited,
     "@brief Modifies the visited state of an item\n"
     "@args item,visited\n"
@@ -1469,11 +1501,83 @@ Class<rdb::Database> decl_ReportDatabase ("rdb", "ReportDatabase",
   "ReportDatabase object and use the methods provided to perform queries or to populate it.\n"
 );
   
+// ---------------------------------------------------------------
+//  rdb::StreamWriter and rdb::PagedReader binding
+
+static rdb::StreamWriter *new_stream_writer (rdb::Database *rdb, const std::string &filename)
+{
+  return new rdb::StreamWriter (rdb, filename);
+}
+
+Class<rdb::StreamWriter> decl_RdbStreamWriter ("rdb", "RdbStreamWriter",
+  gsi::constructor ("new", &new_stream_writer,
+    "@brief Creates a streaming writer for the given database and file\n"
+    "@args rdb, filename\n"
+    "The header (tags, categories and cells) is taken from the database when \\begin is called. "
+    "The database must not be destroyed before the writer is finished."
+  ) +
+  gsi::method ("begin", &rdb::StreamWriter::begin,
+    "@brief Writes the header\n"
+    "All categories and cells must have been created in the database before this method is called."
+  ) +
+  gsi::method ("finish", &rdb::StreamWriter::finish,
+    "@brief Finishes the file and writes the index\n"
+  ) +
+  gsi::method ("num_items", &rdb::StreamWriter::num_items,
+    "@brief Gets the number of items written\n"
+  ) +
+  gsi::method ("has_index?", &rdb::StreamWriter::has_index,
+    "@brief Gets a value indicating whether an index file is written\n"
+    "An index (file name + \".idx\") is written for uncompressed files only. It is required by \\RdbPagedReader."
+  ),
+  "@brief A writer that streams items into a report database file\n"
+  "This object is used together with the report database output of \\TilingProcessor. The items are written to "
+  "the file as the tiles are completed, so they do not need to be kept in memory. The file can be read "
+  "with \\ReportDatabase#load or paged in with \\RdbPagedReader.\n"
+  "\n"
+  "This class has been introduced in version 0.26."
+);
+
+static rdb::PagedReader *new_paged_reader (const std::string &filename)
+{
+  return new rdb::PagedReader (filename);
+}
+
+Class<rdb::PagedReader> decl_RdbPagedReader ("rdb", "RdbPagedReader",
+  gsi::constructor ("new", &new_paged_reader,
+    "@brief Opens the given file\n"
+    "@args filename\n"
+    "The file must have been written with \\RdbStreamWriter with an index."
+  ) +
+  gsi::method ("read_header", &rdb::PagedReader::read_header,
+    "@brief Reads tags, categories and cells into the given database\n"
+    "@args rdb\n"
+    "The database is cleared before."
+  ) +
+  gsi::method ("num_items", &rdb::PagedReader::num_items,
+    "@brief Gets the number of items for the given cell and category\n"
+    "@args cell_qname, category_path\n"
+  ) +
+  gsi::method ("read_items", &rdb::PagedReader::read_items,
+    "@brief Reads the items for the given cell and category into the database\n"
+    "@args rdb, cell_id, category_id\n"
+    "Items which have been read already are not read again. Returns the number of items read."
+  ),
+  "@brief A reader that pages in items of a report database file on demand\n"
+  "\n"
+  "This class has been introduced in version 0.26."
+);
+
 static void tp_output_rdb (db::TilingProcessor *proc, const std::string &name, rdb::Database &rdb, rdb::id_type cell_id, rdb::id_type category_id)
 {
   proc->output (name, 0, new rdb::TiledRdbOutputReceiver (&rdb, cell_id, category_id), db::ICplxTrans ());
 }
 
+static void tp_output_rdb_stream (db::TilingProcessor *proc, const std::string &name, rdb::StreamWriter &writer, rdb::id_type cell_id, rdb::id_type category_id)
+{
+  proc->output (name, 0, new rdb::TiledRdbOutputReceiver (&writer, cell_id, category_id), db::ICplxTrans ());
+}
+
 //  extend the db::TilingProcessor with the ability to feed images
 static
 gsi::ClassExt<db::TilingProcessor> tiling_processor_ext (
@@ -1486,6 +1590,15 @@ gsi::ClassExt<db::TilingProcessor> tiling_processor_ext (
     "\n"
     "The name is the name which must be used in the _output function of the scripts in order to "
     "address that channel.\n"
+  ) +
+  method_ext ("output", &tp_output_rdb_stream,
+    "@brief Specifies output to a streamed report database file\n"
+    "@args name, writer, cell_id, category_id\n"
+    "This method will establish an output channel for the processor. The output sent to that channel "
+    "will be written to the file of the given \\RdbStreamWriter as the tiles are completed. The items are not kept in memory. "
+    "\"cell_id\" specifies the cell and \"category_id\" the category to use.\n"
+    "\n"
+    "This method has been introduced in version 0.26."
   ),
   ""
 );
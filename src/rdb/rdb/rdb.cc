@@ -34,6 +34,8 @@
 #include "dbPath.h"
 #include "dbText.h"
 #include "dbShape.h"
+#include "dbBoxTree.h"
+#include "dbBoxConvert.h"
 
 #if defined(HAVE_QT)
 #  include <QByteArray>
@@ -347,6 +349,37 @@ Values::operator= (const Values &d)
   return *this;
 }
 
+db::DBox
+Values::bbox () const
+{
+  db::DBox box;
+
+  for (const_iterator v = begin (); v != end (); ++v) {
+
+    const ValueBase *value = v->get ();
+    if (! value) {
+      continue;
+    }
+
+    if (dynamic_cast<const Value<db::DPolygon> *> (value)) {
+      box += static_cast<const Value<db::DPolygon> *> (value)->value ().box ();
+    } else if (dynamic_cast<const Value<db::DBox> *> (value)) {
+      box += static_cast<const Value<db::DBox> *> (value)->value ();
+    } else if (dynamic_cast<const Value<db::DEdge> *> (value)) {
+      box += static_cast<const Value<db::DEdge> *> (value)->value ().bbox ();
+    } else if (dynamic_cast<const Value<db::DEdgePair> *> (value)) {
+      box += static_cast<const Value<db::DEdgePair> *> (value)->value ().bbox ();
+    } else if (dynamic_cast<const Value<db::DPath> *> (value)) {
+      box += static_cast<const Value<db::DPath> *> (value)->value ().box ();
+    } else if (dynamic_cast<const Value<db::DText> *> (value)) {
+      box += static_cast<const Value<db::DText> *> (value)->value ().box ();
+    }
+
+  }
+
+  return box;
+}
+
 std::string 
 Values::to_string (const Database *rdb) const
 {
@@ -988,6 +1021,67 @@ Item::set_image_str (const std::string &s)
 }
 #endif
 
+// ------------------------------------------------------------------------------------------
+//  ItemSpatialIndex definition
+
+namespace
+{
+
+/**
+ *  @brief An entry for the spatial index: the item's bounding box and the item
+ */
+struct ItemBoxEntry
+{
+  ItemBoxEntry (const db::DBox &b, const Item *i)
+    : box (b), item (i)
+  { }
+
+  db::DBox box;
+  const Item *item;
+};
+
+struct ItemBoxConverter
+{
+  typedef db::complex_bbox_tag complexity;
+
+  const db::DBox &operator() (const ItemBoxEntry &e) const
+  {
+    return e.box;
+  }
+};
+
+}
+
+/**
+ *  @brief The spatial index for the items of one cell
+ */
+class ItemSpatialIndex
+{
+public:
+  typedef db::box_tree<db::DBox, ItemBoxEntry, ItemBoxConverter> tree_type;
+
+  ItemSpatialIndex (Database::const_item_ref_iterator from, Database::const_item_ref_iterator to)
+  {
+    for (Database::const_item_ref_iterator i = from; i != to; ++i) {
+      db::DBox b = (*i)->values ().bbox ();
+      if (! b.empty ()) {
+        m_tree.insert (ItemBoxEntry (b, (*i).operator-> ()));
+      }
+    }
+    m_tree.sort (ItemBoxConverter ());
+  }
+
+  void collect (const db::DBox &box, std::vector<const Item *> &items) const
+  {
+    for (tree_type::touching_iterator t = m_tree.begin_touching (box, ItemBoxConverter ()); ! t.at_end (); ++t) {
+      items.push_back (t->item);
+    }
+  }
+
+private:
+  tree_type m_tree;
+};
+
 // ------------------------------------------------------------------------------------------
 //  Database implementation
 
@@ -1005,6 +1099,8 @@ Database::Database ()
 
 Database::~Database ()
 {
+  invalidate_spatial_index ();
+
   m_items_by_cell_id.clear ();
   m_items_by_cell_and_category_id.clear ();
   m_items_by_category_id.clear ();
@@ -1026,6 +1122,8 @@ Database::set_items (Items *items)
   mp_items = items;
   mp_items->set_database (this);
 
+  invalidate_spatial_index ();
+
   m_items_by_cell_and_category_id.clear ();
   m_num_items_by_cell_and_category.clear ();
   m_num_items_visited_by_cell_and_category.clear ();
@@ -1060,14 +1158,14 @@ Database::set_items (Items *items)
 
       cell->add_to_num_items (1);
 
-      m_items_by_cell_id.insert (std::make_pair (cell_id, std::list<ItemRef> ())).first->second.push_back (ItemRef (&*i));
+      m_items_by_cell_id.insert (std::make_pair (cell_id, std::vector<ItemRef> ())).first->second.push_back (ItemRef (&*i));
 
       if (i->visited ()) {
         cell->add_to_num_items_visited (1);
       }
 
-      m_items_by_category_id.insert (std::make_pair (category_id, std::list<ItemRef> ())).first->second.push_back (ItemRef (&*i));
-      m_items_by_cell_and_category_id.insert (std::make_pair (std::make_pair (cell_id, category_id), std::list<ItemRef> ())).first->second.push_back (ItemRef (&*i));
+      m_items_by_category_id.insert (std::make_pair (category_id, std::vector<ItemRef> ())).first->second.push_back (ItemRef (&*i));
+      m_items_by_cell_and_category_id.insert (std::make_pair (std::make_pair (cell_id, category_id), std::vector<ItemRef> ())).first->second.push_back (ItemRef (&*i));
 
       while (category) {
 
@@ -1384,19 +1482,46 @@ Database::create_item (id_type cell_id, id_type category_id)
   item->set_cell_id (cell_id);
   item->set_category_id (category_id);
 
-  m_items_by_cell_id.insert (std::make_pair (cell_id, std::list<ItemRef> ())).first->second.push_back (ItemRef (item));
-  m_items_by_category_id.insert (std::make_pair (category_id, std::list<ItemRef> ())).first->second.push_back (ItemRef (item));
-  m_items_by_cell_and_category_id.insert (std::make_pair (std::make_pair (cell_id, category_id), std::list<ItemRef> ())).first->second.push_back (ItemRef (item));
+  m_items_by_cell_id.insert (std::make_pair (cell_id, std::vector<ItemRef> ())).first->second.push_back (ItemRef (item));
+  m_items_by_category_id.insert (std::make_pair (category_id, std::vector<ItemRef> ())).first->second.push_back (ItemRef (item));
+  m_items_by_cell_and_category_id.insert (std::make_pair (std::make_pair (cell_id, category_id), std::vector<ItemRef> ())).first->second.push_back (ItemRef (item));
+
+  std::map <id_type, ItemSpatialIndex *>::iterator si = m_spatial_index_by_cell_id.find (cell_id);
+  if (si != m_spatial_index_by_cell_id.end ()) {
+    delete si->second;
+    m_spatial_index_by_cell_id.erase (si);
+  }
 
   return item;
 }
 
-static std::list<ItemRef> empty_list;
+void
+Database::items_touching (id_type cell_id, const db::DBox &box, std::vector<const Item *> &items) const
+{
+  std::map <id_type, ItemSpatialIndex *>::const_iterator si = m_spatial_index_by_cell_id.find (cell_id);
+  if (si == m_spatial_index_by_cell_id.end ()) {
+    std::pair<const_item_ref_iterator, const_item_ref_iterator> be = items_by_cell (cell_id);
+    si = m_spatial_index_by_cell_id.insert (std::make_pair (cell_id, new ItemSpatialIndex (be.first, be.second))).first;
+  }
+
+  si->second->collect (box, items);
+}
+
+void
+Database::invalidate_spatial_index ()
+{
+  for (std::map <id_type, ItemSpatialIndex *>::iterator si = m_spatial_index_by_cell_id.begin (); si != m_spatial_index_by_cell_id.end (); ++si) {
+    delete si->second;
+  }
+  m_spatial_index_by_cell_id.clear ();
+}
+
+static std::vector<ItemRef> empty_list;
 
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_cell_and_category (id_type cell_id, id_type category_id) const
 {
-  std::map <std::pair <id_type, id_type>, std::list<ItemRef> >::const_iterator i = m_items_by_cell_and_category_id.find (std::make_pair (cell_id, category_id));
+  std::map <std::pair <id_type, id_type>, std::vector<ItemRef> >::const_iterator i = m_items_by_cell_and_category_id.find (std::make_pair (cell_id, category_id));
   if (i != m_items_by_cell_and_category_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
   } else {
@@ -1407,7 +1532,7 @@ Database::items_by_cell_and_category (id_type cell_id, id_type category_id) cons
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_cell (id_type cell_id) const
 {
-  std::map <id_type, std::list<ItemRef> >::const_iterator i = m_items_by_cell_id.find (cell_id);
+  std::map <id_type, std::vector<ItemRef> >::const_iterator i = m_items_by_cell_id.find (cell_id);
   if (i != m_items_by_cell_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
   } else {
@@ -1418,7 +1543,7 @@ Database::items_by_cell (id_type cell_id) const
 std::pair<Database::const_item_ref_iterator, Database::const_item_ref_iterator> 
 Database::items_by_category (id_type category_id) const
 {
-  std::map <id_type, std::list<ItemRef> >::const_iterator i = m_items_by_category_id.find (category_id);
+  std::map <id_type, std::vector<ItemRef> >::const_iterator i = m_items_by_category_id.find (category_id);
   if (i != m_items_by_category_id.end ()) {
     return std::make_pair (i->second.begin (), i->second.end ());
   } else {
@@ -1464,6 +1589,7 @@ Database::clear ()
   m_cell_variants.clear ();
   m_cells_by_id.clear ();
   m_categories_by_id.clear ();
+  invalidate_spatial_index ();
   m_items_by_cell_and_category_id.clear ();
   m_num_items_by_cell_and_category.clear ();
   m_num_items_visited_by_cell_and_category.clear ();
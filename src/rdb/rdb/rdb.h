@@ -27,15 +27,18 @@
 #include "rdbCommon.h"
 
 #include "dbTrans.h"
+#include "dbBox.h"
 #include "gsi.h"
 #include "tlObject.h"
 #include "tlObjectCollection.h"
+#include "tlThreads.h"
 
 #include <string>
 #include <list>
 #include <map>
 #include <set>
 #include <vector>
+#include <deque>
 
 #if defined(HAVE_QT)
 class QImage;
@@ -62,6 +65,7 @@ class Database;
 class Cells;
 class Cell;
 class Items;
+class ItemSpatialIndex;
 
 /**
  *  @brief A report item's category
@@ -553,6 +557,18 @@ public:
     //  .. nothing yet ..
   }
 
+  /**
+   *  @brief Move constructor
+   *
+   *  NOTE: the move operations must not throw, so vectors of values use them on reallocation
+   *  instead of cloning every value.
+   */
+  ValueWrapper (ValueWrapper &&d) noexcept
+    : mp_ptr (d.mp_ptr), m_tag_id (d.m_tag_id)
+  {
+    d.mp_ptr = 0;
+  }
+
   /**
    *  @brief Destructor
    */
@@ -577,6 +593,23 @@ public:
     return *this;
   }
 
+  /**
+   *  @brief Move assignment
+   */
+  ValueWrapper &operator= (ValueWrapper &&d) noexcept
+  {
+    if (this != &d) {
+      if (mp_ptr) {
+        delete mp_ptr;
+      }
+      mp_ptr = d.mp_ptr;
+      m_tag_id = d.m_tag_id;
+      d.mp_ptr = 0;
+    }
+
+    return *this;
+  }
+
   /**
    *  @brief Get the pointer
    */
@@ -640,8 +673,8 @@ private:
 class RDB_PUBLIC Values
 {
 public:
-  typedef std::list<ValueWrapper>::const_iterator const_iterator;
-  typedef std::list<ValueWrapper>::iterator iterator;
+  typedef std::vector<ValueWrapper>::const_iterator const_iterator;
+  typedef std::vector<ValueWrapper>::iterator iterator;
 
   /**
    *  @brief The default constructor
@@ -724,6 +757,22 @@ public:
     m_values.swap (other.m_values);
   }
 
+  /**
+   *  @brief Returns the number of values 
+   */
+  size_t size () const
+  {
+    return m_values.size ();
+  }
+
+  /**
+   *  @brief Gets the bounding box of the geometrical values
+   *
+   *  Non-geometrical values such as strings or numbers do not contribute.
+   *  If there are no geometrical values, an empty box is returned.
+   */
+  db::DBox bbox () const;
+
   /**
    *  @brief Convert the values collection to a string 
    */
@@ -735,7 +784,7 @@ public:
   void from_string (Database *rdb, const std::string &s);  
 
 private:
-  std::list <ValueWrapper> m_values;
+  std::vector <ValueWrapper> m_values;
 };
 
 /**
@@ -1067,8 +1116,8 @@ public:
 class RDB_PUBLIC Items
 {
 public:
-  typedef std::list<Item>::const_iterator const_iterator;
-  typedef std::list<Item>::iterator iterator;
+  typedef std::deque<Item>::const_iterator const_iterator;
+  typedef std::deque<Item>::iterator iterator;
 
   /**
    *  @brief Construct an item list with a database reference
@@ -1144,7 +1193,9 @@ private:
   friend class Cell;
   friend class Database;
 
-  std::list <Item> m_items;
+  //  NOTE: a deque allocates the items in chunks and keeps the item addresses
+  //  stable when new items are added.
+  std::deque <Item> m_items;
   Database *mp_database;
 
   Items (const Items &d);
@@ -1912,8 +1963,8 @@ class RDB_PUBLIC Database
 public:
   typedef Items::const_iterator const_item_iterator;
   typedef Items::iterator item_iterator;
-  typedef std::list<ItemRef>::const_iterator const_item_ref_iterator;
-  typedef std::list<ItemRef>::iterator item_ref_iterator;
+  typedef std::vector<ItemRef>::const_iterator const_item_ref_iterator;
+  typedef std::vector<ItemRef>::iterator item_ref_iterator;
   typedef Cells::const_iterator const_cell_iterator;
   typedef Cells::iterator cell_iterator;
 
@@ -2256,6 +2307,33 @@ public:
    */
   std::pair<const_item_ref_iterator, const_item_ref_iterator> items_by_cell_and_category (id_type cell_id, id_type category_id) const; 
 
+  /**
+   *  @brief Collects the items of the given cell whose geometrical values touch the given box
+   *
+   *  The box is given in the coordinate system of the cell. Items without geometrical 
+   *  values are not reported. The items are appended to the "items" vector. 
+   *  A spatial index is built per cell on the first request. It is invalidated when 
+   *  items are added to that cell. When the values of items are changed after the 
+   *  index was built, "invalidate_spatial_index" needs to be called.
+   */
+  void items_touching (id_type cell_id, const db::DBox &box, std::vector<const Item *> &items) const;
+
+  /**
+   *  @brief Invalidates the spatial index for all cells
+   */
+  void invalidate_spatial_index ();
+
+  /**
+   *  @brief Gets the lock which serializes concurrent producers of items
+   *
+   *  The database itself is not thread safe. Producers which create items from
+   *  multiple threads (i.e. the tiled output receivers) use this lock.
+   */
+  tl::Mutex &merge_lock ()
+  {
+    return m_merge_lock;
+  }
+
   /**
    *  @brief Returns true, if the database was modified
    */
@@ -2285,6 +2363,8 @@ public:
   void load (const std::string &filename);
 
 private:
+  friend class PagedReader;
+
   std::string m_generator;
   std::string m_filename;
   std::string m_description;
@@ -2298,16 +2378,18 @@ private:
   std::map <std::string, std::vector <id_type> > m_cell_variants;
   std::map <id_type, Cell *> m_cells_by_id;
   std::map <id_type, Category *> m_categories_by_id;
-  std::map <std::pair <id_type, id_type>, std::list<ItemRef> > m_items_by_cell_and_category_id;
+  std::map <std::pair <id_type, id_type>, std::vector<ItemRef> > m_items_by_cell_and_category_id;
   std::map <std::pair <id_type, id_type>, size_t> m_num_items_by_cell_and_category;
   std::map <std::pair <id_type, id_type>, size_t> m_num_items_visited_by_cell_and_category;
-  std::map <id_type, std::list<ItemRef> > m_items_by_cell_id;
-  std::map <id_type, std::list<ItemRef> > m_items_by_category_id;
+  std::map <id_type, std::vector<ItemRef> > m_items_by_cell_id;
+  std::map <id_type, std::vector<ItemRef> > m_items_by_category_id;
+  mutable std::map <id_type, ItemSpatialIndex *> m_spatial_index_by_cell_id;
   Items *mp_items;
   Cells m_cells;
   size_t m_num_items;
   size_t m_num_items_visited;
   bool m_modified;
+  tl::Mutex m_merge_lock;
 
   void clear ();
 
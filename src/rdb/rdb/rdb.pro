@@ -22,6 +22,7 @@ SOURCES = \
 
 HEADERS = \
   rdb.h \
+  rdbFile.h \
   rdbForceLink.h \
   rdbReader.h \
   rdbTiledRdbOutputReceiver.h \
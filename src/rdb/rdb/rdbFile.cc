@@ -23,15 +23,19 @@
 
 #include "rdb.h"
 #include "rdbReader.h"
+#include "rdbFile.h"
 #include "rdbCommon.h"
 
 #include "tlTimer.h"
 #include "tlProgress.h"
 #include "tlXMLParser.h"
 #include "tlClassRegistry.h"
+#include "tlLog.h"
 
 #include <fstream>
 #include <string>
+#include <map>
+#include <string.h>
 
 namespace rdb
 {
@@ -68,11 +72,30 @@ tl::XMLElementList categories_format =
   ) 
 ;
 
-//  generation of the RDB file XML structure
-static tl::XMLStruct <rdb::Database> 
-make_rdb_structure (rdb::Database *rdb)
+//  generation of the RDB file XML structure: the members of an item
+static tl::XMLElementList
+make_item_members (rdb::Database *rdb)
+{
+  tl::XMLElementList members;
+  members.append (tl::make_member<std::string, rdb::Item> (&rdb::Item::tag_str, &rdb::Item::set_tag_str, "tags"));
+  members.append (tl::make_member<std::string, rdb::Item> (&rdb::Item::category_name, &rdb::Item::set_category_name, "category"));
+  members.append (tl::make_member<std::string, rdb::Item> (&rdb::Item::cell_qname, &rdb::Item::set_cell_qname, "cell"));
+  members.append (tl::make_member<bool, rdb::Item> (&rdb::Item::visited, &rdb::Item::set_visited, "visited"));
+  members.append (tl::make_member<size_t, rdb::Item> (&rdb::Item::multiplicity, &rdb::Item::set_multiplicity, "multiplicity"));
+#if defined(HAVE_QT)
+  members.append (tl::make_member<std::string, rdb::Item> (&rdb::Item::image_str, &rdb::Item::set_image_str, "image"));
+#endif
+  members.append (tl::make_element<rdb::Values, rdb::Item> (&rdb::Item::values, &rdb::Item::set_values, "values", 
+    tl::make_member<rdb::ValueWrapper, rdb::Values::const_iterator, rdb::Values> (&rdb::Values::begin, &rdb::Values::end, &rdb::Values::add, "value", ValueConverter (rdb)) 
+  ));
+  return members;
+}
+
+//  generation of the RDB file XML structure: everything except the items
+static tl::XMLElementList
+make_header_elements ()
 {
-  return tl::XMLStruct <rdb::Database>("report-database", 
+  return 
     tl::make_member<std::string, rdb::Database> (&rdb::Database::description, &rdb::Database::set_description, "description") +
     tl::make_member<std::string, rdb::Database> (&rdb::Database::original_file, &rdb::Database::set_original_file, "original-file") +
     tl::make_member<std::string, rdb::Database> (&rdb::Database::generator, &rdb::Database::set_generator, "generator") +
@@ -98,23 +121,23 @@ make_rdb_structure (rdb::Database *rdb)
           )
         )
       )
-    ) + 
+    );
+}
+
+//  generation of the RDB file XML structure
+static tl::XMLStruct <rdb::Database> 
+make_rdb_structure (rdb::Database *rdb)
+{
+  tl::XMLElementList elements = make_header_elements ();
+  elements.append (
     tl::make_element_with_parent_ref<rdb::Items, rdb::Database> (&rdb::Database::items, &rdb::Database::set_items, "items",
       tl::make_element_with_parent_ref<rdb::Item, rdb::Items::const_iterator, rdb::Items> (&rdb::Items::begin, &rdb::Items::end, &rdb::Items::add_item, "item", 
-        tl::make_member<std::string, rdb::Item> (&rdb::Item::tag_str, &rdb::Item::set_tag_str, "tags") + 
-        tl::make_member<std::string, rdb::Item> (&rdb::Item::category_name, &rdb::Item::set_category_name, "category") + 
-        tl::make_member<std::string, rdb::Item> (&rdb::Item::cell_qname, &rdb::Item::set_cell_qname, "cell") +
-        tl::make_member<bool, rdb::Item> (&rdb::Item::visited, &rdb::Item::set_visited, "visited") +
-        tl::make_member<size_t, rdb::Item> (&rdb::Item::multiplicity, &rdb::Item::set_multiplicity, "multiplicity") +
-#if defined(HAVE_QT)
-        tl::make_member<std::string, rdb::Item> (&rdb::Item::image_str, &rdb::Item::set_image_str, "image") +
-#endif
-        tl::make_element<rdb::Values, rdb::Item> (&rdb::Item::values, &rdb::Item::set_values, "values", 
-          tl::make_member<rdb::ValueWrapper, rdb::Values::const_iterator, rdb::Values> (&rdb::Values::begin, &rdb::Values::end, &rdb::Values::add, "value", ValueConverter (rdb)) 
-        )
+        make_item_members (rdb)
       )
     )
   );
+
+  return tl::XMLStruct <rdb::Database>("report-database", elements);
 }
 
 // -------------------------------------------------------------
@@ -191,4 +214,356 @@ class StandardFormatDeclaration
 
 static tl::RegisteredClass<rdb::FormatDeclaration> format_decl (new StandardFormatDeclaration (), 0, "KLayout-RDB");
 
+// -------------------------------------------------------------
+//  Implementation of rdb::StreamWriter
+
+static const char *stream_index_magic = "KLRDBIDX";
+static const uint32_t stream_index_version = 1;
+
+static std::string
+index_file_name (const std::string &fn)
+{
+  return fn + ".idx";
+}
+
+static void
+write_index_uint (tl::OutputStream &os, uint64_t v)
+{
+  char b [8];
+  for (unsigned int i = 0; i < 8; ++i) {
+    b [i] = char (v & 0xff);
+    v >>= 8;
+  }
+  os.put (b, sizeof (b));
+}
+
+static void
+write_index_string (tl::OutputStream &os, const std::string &s)
+{
+  write_index_uint (os, s.size ());
+  os.put (s.c_str (), s.size ());
+}
+
+StreamWriter::StreamWriter (rdb::Database *db, const std::string &filename, size_t chunk_size)
+  : mp_db (db), m_filename (filename), m_chunk_size (std::max (size_t (1), chunk_size)), mp_stream (0), m_items (db), 
+    m_pos (0), m_header_size (0), m_num_items (0), m_has_index (false), m_finished (false),
+    m_chunk_cell_id (0), m_chunk_category_id (0)
+{
+  m_item_members = make_item_members (db);
+  m_has_index = (tl::OutputStream::output_mode_from_filename (filename) != tl::OutputStream::OM_Zlib);
+}
+
+StreamWriter::~StreamWriter ()
+{
+  try {
+    finish ();
+  } catch (...) {
+    //  .. ignore exceptions in the destructor ..
+  }
+  delete mp_stream;
+  mp_stream = 0;
+}
+
+void
+StreamWriter::put (const std::string &s)
+{
+  mp_stream->put (s);
+  m_pos += s.size ();
+}
+
+void
+StreamWriter::begin ()
+{
+  if (mp_stream) {
+    return;
+  }
+
+  mp_stream = new tl::OutputStream (m_filename, tl::OutputStream::OM_Auto);
+
+  tl::OutputStringStream header_stream;
+  {
+    tl::OutputStream os (header_stream);
+
+    tl::XMLWriterState writer_state;
+    writer_state.push (mp_db);
+
+    os << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    os << "<report-database>\n";
+    tl::XMLElementList header = make_header_elements ();
+    for (tl::XMLElementList::iterator c = header.begin (); c != header.end (); ++c) {
+      c->get ()->write (0, os, 1, writer_state);
+    }
+    os.flush ();
+  }
+
+  put (header_stream.string ());
+  m_header_size = m_pos;
+  put (" <items>\n");
+}
+
+rdb::Item 
+StreamWriter::create_item (id_type cell_id, id_type category_id)
+{
+  rdb::Item item (&m_items);
+  item.set_cell_id (cell_id);
+  item.set_category_id (category_id);
+  return item;
+}
+
+void
+StreamWriter::write_item (const rdb::Item &item)
+{
+  tl_assert (! m_finished);
+  begin ();
+
+  tl::OutputStringStream item_stream;
+  {
+    tl::OutputStream os (item_stream);
+
+    tl::XMLWriterState writer_state;
+    writer_state.push (&item);
+
+    tl::XMLElementBase::write_indent (os, 2);
+    os << "<item>\n";
+    for (tl::XMLElementList::iterator c = m_item_members.begin (); c != m_item_members.end (); ++c) {
+      c->get ()->write (0, os, 3, writer_state);
+    }
+    tl::XMLElementBase::write_indent (os, 2);
+    os << "</item>\n";
+    os.flush ();
+  }
+
+  if (m_chunks.empty () || m_chunks.back ().count >= m_chunk_size || m_chunk_cell_id != item.cell_id () || m_chunk_category_id != item.category_id ()) {
+    m_chunks.push_back (StreamChunk ());
+    m_chunks.back ().offset = m_pos;
+    m_chunks.back ().cell_qname = item.cell_qname ();
+    m_chunks.back ().category_path = item.category_name ();
+    m_chunk_cell_id = item.cell_id ();
+    m_chunk_category_id = item.category_id ();
+  }
+
+  std::string s = item_stream.string ();
+  put (s);
+
+  m_chunks.back ().size += s.size ();
+  m_chunks.back ().count += 1;
+  ++m_num_items;
+}
+
+void
+StreamWriter::finish ()
+{
+  if (m_finished) {
+    return;
+  }
+
+  begin ();
+
+  put (" </items>\n");
+  put ("</report-database>\n");
+  mp_stream->flush ();
+
+  delete mp_stream;
+  mp_stream = 0;
+
+  m_finished = true;
+
+  if (m_has_index) {
+    write_index ();
+  }
+
+  if (tl::verbosity () >= 10) {
+    tl::log << "Streamed " << m_num_items << " items to RDB " << m_filename;
+  }
+}
+
+void
+StreamWriter::write_index ()
+{
+  tl::OutputStream os (index_file_name (m_filename), tl::OutputStream::OM_Plain);
+
+  os.put (stream_index_magic, strlen (stream_index_magic));
+  write_index_uint (os, stream_index_version);
+  write_index_uint (os, m_header_size);
+  write_index_uint (os, m_chunks.size ());
+
+  for (std::vector<StreamChunk>::const_iterator c = m_chunks.begin (); c != m_chunks.end (); ++c) {
+    write_index_uint (os, c->offset);
+    write_index_uint (os, c->size);
+    write_index_uint (os, c->count);
+    write_index_string (os, c->cell_qname);
+    write_index_string (os, c->category_path);
+  }
+
+  os.flush ();
+}
+
+// -------------------------------------------------------------
+//  Implementation of rdb::PagedReader
+
+static uint64_t
+read_index_uint (tl::InputStream &is)
+{
+  const char *b = is.get (8);
+  if (! b) {
+    throw tl::Exception (tl::to_string (tr ("Unexpected end of RDB index file %s")), is.source ());
+  }
+
+  uint64_t v = 0;
+  for (unsigned int i = 8; i > 0; ) {
+    --i;
+    v = (v << 8) | uint64_t ((unsigned char) b [i]);
+  }
+  return v;
+}
+
+static std::string
+read_index_string (tl::InputStream &is)
+{
+  size_t n = size_t (read_index_uint (is));
+  const char *b = n > 0 ? is.get (n) : "";
+  if (! b) {
+    throw tl::Exception (tl::to_string (tr ("Unexpected end of RDB index file %s")), is.source ());
+  }
+  return std::string (b, n);
+}
+
+PagedReader::PagedReader (const std::string &filename)
+  : m_filename (filename), m_header_size (0)
+{
+  tl::InputStream is (index_file_name (filename));
+
+  size_t nmagic = strlen (stream_index_magic);
+  const char *magic = is.get (nmagic);
+  if (! magic || strncmp (magic, stream_index_magic, nmagic) != 0) {
+    throw tl::Exception (tl::to_string (tr ("%s is not a valid RDB index file")), index_file_name (filename));
+  }
+
+  if (read_index_uint (is) != stream_index_version) {
+    throw tl::Exception (tl::to_string (tr ("Unsupported version of RDB index file %s")), index_file_name (filename));
+  }
+
+  m_header_size = size_t (read_index_uint (is));
+
+  size_t n = size_t (read_index_uint (is));
+  m_chunks.reserve (n);
+  for (size_t i = 0; i < n; ++i) {
+    m_chunks.push_back (StreamChunk ());
+    m_chunks.back ().offset = size_t (read_index_uint (is));
+    m_chunks.back ().size = size_t (read_index_uint (is));
+    m_chunks.back ().count = size_t (read_index_uint (is));
+    m_chunks.back ().cell_qname = read_index_string (is);
+    m_chunks.back ().category_path = read_index_string (is);
+  }
+
+  m_loaded.resize (m_chunks.size (), false);
+}
+
+std::string 
+PagedReader::read_range (size_t offset, size_t size) const
+{
+  std::ifstream is (m_filename.c_str (), std::ios::in | std::ios::binary);
+  if (! is.good ()) {
+    throw tl::Exception (tl::to_string (tr ("Unable to open file %s")), m_filename);
+  }
+
+  std::string s;
+  s.resize (size);
+  is.seekg (offset);
+  if (size > 0) {
+    is.read (&s [0], size);
+  }
+  if (size_t (is.gcount ()) != size) {
+    throw tl::Exception (tl::to_string (tr ("RDB file %s does not match its index")), m_filename);
+  }
+
+  return s;
+}
+
+void
+PagedReader::read_header (rdb::Database &db)
+{
+  db.clear ();
+
+  std::string header = read_range (0, m_header_size);
+  header += "</report-database>\n";
+
+  tl::XMLStringSource source (header);
+  make_rdb_structure (&db).parse (source, db);
+
+  db.set_filename (m_filename);
+  db.reset_modified ();
+}
+
+size_t 
+PagedReader::num_items (const std::string &cell_qname, const std::string &category_path) const
+{
+  size_t n = 0;
+  for (std::vector<StreamChunk>::const_iterator c = m_chunks.begin (); c != m_chunks.end (); ++c) {
+    if (c->cell_qname == cell_qname && c->category_path == category_path) {
+      n += c->count;
+    }
+  }
+  return n;
+}
+
+size_t 
+PagedReader::read_items (rdb::Database &db, id_type cell_id, id_type category_id)
+{
+  const rdb::Cell *cell = db.cell_by_id (cell_id);
+  const rdb::Category *category = db.category_by_id (category_id);
+  if (! cell || ! category) {
+    return 0;
+  }
+
+  std::string cell_qname = cell->qname ();
+  std::string category_path = category->path ();
+
+  tl::XMLStruct <rdb::Items> items_structure ("items",
+    tl::make_element_with_parent_ref<rdb::Item, rdb::Items::const_iterator, rdb::Items> (&rdb::Items::begin, &rdb::Items::end, &rdb::Items::add_item, "item", 
+      make_item_members (&db)
+    )
+  );
+
+  //  paging in items is not considered a modification
+  bool was_modified = db.is_modified ();
+
+  size_t n = 0;
+
+  for (std::vector<StreamChunk>::const_iterator c = m_chunks.begin (); c != m_chunks.end (); ++c) {
+
+    size_t index = c - m_chunks.begin ();
+    if (m_loaded [index] || c->cell_qname != cell_qname || c->category_path != category_path) {
+      continue;
+    }
+
+    std::string text = "<items>\n";
+    text += read_range (c->offset, c->size);
+    text += "</items>\n";
+
+    rdb::Items items (&db);
+    tl::XMLStringSource source (text);
+    items_structure.parse (source, items);
+
+    for (rdb::Items::const_iterator i = items.begin (); i != items.end (); ++i) {
+      rdb::Item *item = db.create_item (cell_id, category_id);
+      *item = *i;
+      item->set_visited (false);
+      if (i->visited ()) {
+        db.set_item_visited (item, true);
+      }
+      ++n;
+    }
+
+    m_loaded [index] = true;
+
+  }
+
+  if (! was_modified) {
+    db.reset_modified ();
+  }
+
+  return n;
+}
+
 }
@@ -0,0 +1,232 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_rdbFile
+#define HDR_rdbFile
+
+#include "rdbCommon.h"
+#include "rdb.h"
+
+#include "tlStream.h"
+#include "tlXMLParser.h"
+
+#include <string>
+#include <vector>
+
+namespace rdb
+{
+
+/**
+ *  @brief Describes a chunk of items inside a streamed RDB file
+ *
+ *  A chunk is a contiguous range of bytes inside the XML file which holds
+ *  items of the same cell and category.
+ */
+struct RDB_PUBLIC StreamChunk
+{
+  StreamChunk ()
+    : offset (0), size (0), count (0)
+  { }
+
+  size_t offset;
+  size_t size;
+  size_t count;
+  std::string cell_qname;
+  std::string category_path;
+};
+
+/**
+ *  @brief A streaming writer for report databases
+ *
+ *  This writer produces a file in the standard KLayout RDB format, but writes the items
+ *  as they are delivered instead of taking them from the database. That way, the items
+ *  do not need to be kept in memory. The header (tags, categories and cells) is taken
+ *  from the database when "begin" is called, hence all categories and cells need to
+ *  be present at that time.
+ *
+ *  For uncompressed files, the writer also produces a binary sidecar index
+ *  (file name + ".idx") which lists the chunks of items per cell and category.
+ *  rdb::PagedReader uses this index to load items on demand.
+ */
+class RDB_PUBLIC StreamWriter
+{
+public:
+  /**
+   *  @brief Creates a writer for the given database and file
+   *
+   *  The chunk size is the maximum number of items per chunk in the index.
+   */
+  StreamWriter (rdb::Database *db, const std::string &filename, size_t chunk_size = 1000);
+
+  /**
+   *  @brief Destructor
+   *
+   *  The destructor will finish the file if this has not been done yet.
+   */
+  ~StreamWriter ();
+
+  /**
+   *  @brief Writes the header
+   */
+  void begin ();
+
+  /**
+   *  @brief Creates an item for the given cell and category
+   *
+   *  The item is not stored in the database. It can be filled and written with "write_item".
+   */
+  rdb::Item create_item (id_type cell_id, id_type category_id);
+
+  /**
+   *  @brief Writes the given item
+   *
+   *  "begin" is called implicitly if required.
+   */
+  void write_item (const rdb::Item &item);
+
+  /**
+   *  @brief Finishes the file and writes the index
+   */
+  void finish ();
+
+  /**
+   *  @brief Gets the number of items written
+   */
+  size_t num_items () const
+  {
+    return m_num_items;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether an index is written
+   */
+  bool has_index () const
+  {
+    return m_has_index;
+  }
+
+  /**
+   *  @brief Gets the database
+   */
+  rdb::Database *database () const
+  {
+    return mp_db;
+  }
+
+private:
+  rdb::Database *mp_db;
+  std::string m_filename;
+  size_t m_chunk_size;
+  tl::OutputStream *mp_stream;
+  rdb::Items m_items;
+  tl::XMLElementList m_item_members;
+  size_t m_pos;
+  size_t m_header_size;
+  size_t m_num_items;
+  bool m_has_index;
+  bool m_finished;
+  std::vector<StreamChunk> m_chunks;
+  id_type m_chunk_cell_id, m_chunk_category_id;
+
+  void put (const std::string &s);
+  void write_index ();
+
+  StreamWriter (const StreamWriter &);
+  StreamWriter &operator= (const StreamWriter &);
+};
+
+/**
+ *  @brief A reader for report database files with a sidecar index
+ *
+ *  This reader loads the header of a file written by StreamWriter first and
+ *  then pages in the items of a cell and category on demand.
+ */
+class RDB_PUBLIC PagedReader
+{
+public:
+  /**
+   *  @brief Opens the given file
+   *
+   *  This will read the index. An exception is thrown if the index is not present or invalid.
+   */
+  PagedReader (const std::string &filename);
+
+  /**
+   *  @brief Reads the header (tags, categories, cells and general information) into the database
+   *
+   *  The database is cleared before.
+   */
+  void read_header (rdb::Database &db);
+
+  /**
+   *  @brief Gets the number of items for the given cell and category path
+   */
+  size_t num_items (const std::string &cell_qname, const std::string &category_path) const;
+
+  /**
+   *  @brief Reads the items for the given cell and category into the database
+   *
+   *  The header must have been read into the database before. Items which have
+   *  been read already are not read again. Returns the number of items read.
+   */
+  size_t read_items (rdb::Database &db, id_type cell_id, id_type category_id);
+
+  /**
+   *  @brief Gets the chunks from the index
+   */
+  const std::vector<StreamChunk> &chunks () const
+  {
+    return m_chunks;
+  }
+
+private:
+  std::string m_filename;
+  size_t m_header_size;
+  std::vector<StreamChunk> m_chunks;
+  std::vector<bool> m_loaded;
+
+  std::string read_range (size_t offset, size_t size) const;
+};
+
+}
+
+namespace tl
+{
+  /**
+   *  @brief Type traits for StreamWriter
+   */
+  template <> struct type_traits<rdb::StreamWriter> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
+
+  /**
+   *  @brief Type traits for PagedReader
+   */
+  template <> struct type_traits<rdb::PagedReader> : public type_traits<void> {
+    typedef tl::false_tag has_default_constructor;
+  };
+}
+
+#endif
@@ -31,38 +31,203 @@ namespace rdb
 //  RdbInserter implementation
 
 RdbInserter::RdbInserter (rdb::Database *rdb, rdb::id_type cell_id, rdb::id_type category_id, const db::CplxTrans &trans)
-  : mp_rdb (rdb), m_cell_id (cell_id), m_category_id (category_id), m_trans (trans)
+  : mp_rdb (rdb), mp_writer (0), mp_buffer (0), m_cell_id (cell_id), m_category_id (category_id), m_trans (trans)
+{
+  //  .. nothing yet ..
+}
+
+RdbInserter::RdbInserter (rdb::StreamWriter *writer, rdb::id_type cell_id, rdb::id_type category_id, const db::CplxTrans &trans)
+  : mp_rdb (writer->database ()), mp_writer (writer), mp_buffer (0), m_cell_id (cell_id), m_category_id (category_id), m_trans (trans)
+{
+  //  .. nothing yet ..
+}
+
+RdbInserter::RdbInserter (std::vector<rdb::ValueBase *> *buffer, const db::CplxTrans &trans)
+  : mp_rdb (0), mp_writer (0), mp_buffer (buffer), m_cell_id (0), m_category_id (0), m_trans (trans)
 {
   //  .. nothing yet ..
 }
 
 void RdbInserter::operator() (const db::SimplePolygon &t)
 {
-  rdb::Item *item = mp_rdb->create_item (m_cell_id, m_category_id);
-  item->add_value (db::simple_polygon_to_polygon (t).transformed (m_trans));
+  insert (db::simple_polygon_to_polygon (t).transformed (m_trans));
+}
+
+// -------------------------------------------------------------------------
+//  PendingItemBatch implementation
+
+PendingItemBatch::~PendingItemBatch ()
+{
+  for (std::vector<rdb::ValueBase *>::const_iterator v = values.begin (); v != values.end (); ++v) {
+    delete *v;
+  }
+  values.clear ();
+}
+
+static void delete_batches (PendingItemBatch *batches)
+{
+  while (batches) {
+    PendingItemBatch *b = batches;
+    batches = b->next;
+    delete b;
+  }
 }
 
 // -------------------------------------------------------------------------
 //  TiledRdbOutputReceiver implementation
 
+//  The number of pending values which trigger a merge by default
+static const size_t default_batch_size = 1000;
+
 TiledRdbOutputReceiver::TiledRdbOutputReceiver (rdb::Database *rdb, size_t cell_id, size_t category_id)
-  : mp_rdb (rdb), m_cell_id (cell_id), m_category_id (category_id)
+  : mp_rdb (rdb), mp_writer (0), m_cell_id (cell_id), m_category_id (category_id),
+    m_batch_size (default_batch_size), mp_pending_first (0), mp_pending_last (0), m_pending_count (0)
 {
   //  .. nothing yet ..
 }
 
+TiledRdbOutputReceiver::TiledRdbOutputReceiver (rdb::StreamWriter *writer, size_t cell_id, size_t category_id)
+  : mp_rdb (writer->database ()), mp_writer (writer), m_cell_id (cell_id), m_category_id (category_id),
+    m_batch_size (default_batch_size), mp_pending_first (0), mp_pending_last (0), m_pending_count (0)
+{
+  //  .. nothing yet ..
+}
+
+TiledRdbOutputReceiver::~TiledRdbOutputReceiver ()
+{
+  //  NOTE: the database or writer may be gone already at this point (i.e. if owned by
+  //  a script object), so values not merged by "finish" are discarded.
+  delete_batches (mp_pending_first);
+  mp_pending_first = mp_pending_last = 0;
+}
+
 void TiledRdbOutputReceiver::put (size_t /*ix*/, size_t /*iy*/, const db::Box &tile, size_t /*id*/, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip)
 {
   db::CplxTrans t (db::CplxTrans (dbu) * db::CplxTrans (trans));
-  RdbInserter inserter (mp_rdb, m_cell_id, m_category_id, t);
 
-  if (! db::insert_var (inserter, obj, tile, clip)) {
-    //  try to_string as the last resort
-    rdb::Item *item = mp_rdb->create_item (m_cell_id, m_category_id);
-    item->add_value (std::string (obj.to_string ()));
+  //  the conversion happens outside any lock into a batch private to this call
+  PendingItemBatch *batch = new PendingItemBatch ();
+
+  try {
+
+    RdbInserter inserter (&batch->values, t);
+
+    if (! db::insert_var (inserter, obj, tile, clip)) {
+      //  try to_string as the last resort
+      inserter.insert (std::string (obj.to_string ()));
+    }
+
+  } catch (...) {
+    delete batch;
+    throw;
+  }
+
+  if (batch->values.empty ()) {
+    delete batch;
+  } else if (push (batch)) {
+    try_merge (false);
   }
 }
 
+void TiledRdbOutputReceiver::finish (bool /*success*/)
+{
+  flush ();
 }
 
+void TiledRdbOutputReceiver::flush ()
+{
+  try_merge (true);
+}
+
+bool TiledRdbOutputReceiver::push (PendingItemBatch *batch)
+{
+  tl::MutexLocker locker (&m_pending_lock);
+
+  if (mp_pending_last) {
+    mp_pending_last->next = batch;
+  } else {
+    mp_pending_first = batch;
+  }
+  mp_pending_last = batch;
 
+  m_pending_count += batch->values.size ();
+  return m_pending_count >= m_batch_size;
+}
+
+bool TiledRdbOutputReceiver::try_merge (bool wait)
+{
+  {
+    tl::MutexLocker locker (&m_pending_lock);
+    if (! mp_pending_first) {
+      //  nothing to merge - don't touch the database
+      return true;
+    }
+  }
+
+  //  merges are serialized per database - receivers may share a database or writer
+  tl::Mutex &lock = mp_rdb->merge_lock ();
+
+  if (wait) {
+    lock.lock ();
+  } else if (! lock.try_lock ()) {
+    //  another thread is merging - leave the values to it or to a later merge
+    return false;
+  }
+
+  PendingItemBatch *batches = 0;
+
+  {
+    tl::MutexLocker locker (&m_pending_lock);
+    batches = mp_pending_first;
+    mp_pending_first = mp_pending_last = 0;
+    m_pending_count = 0;
+  }
+
+  try {
+    merge (batches);
+  } catch (...) {
+    lock.unlock ();
+    throw;
+  }
+
+  lock.unlock ();
+  return true;
+}
+
+void TiledRdbOutputReceiver::merge (PendingItemBatch *batches)
+{
+  while (batches) {
+
+    PendingItemBatch *b = batches;
+    batches = b->next;
+
+    try {
+
+      for (std::vector<rdb::ValueBase *>::iterator v = b->values.begin (); v != b->values.end (); ++v) {
+
+        //  the item takes over the value - the batch gives up the value only after that,
+        //  so it is not lost if the item cannot be created
+        if (mp_writer) {
+          rdb::Item item = mp_writer->create_item (m_cell_id, m_category_id);
+          item.values ().add (*v);
+          *v = 0;
+          mp_writer->write_item (item);
+        } else {
+          mp_rdb->create_item (m_cell_id, m_category_id)->values ().add (*v);
+          *v = 0;
+        }
+
+      }
+
+    } catch (...) {
+      delete b;
+      delete_batches (batches);
+      throw;
+    }
+
+    delete b;
+
+  }
+}
+
+}
@@ -26,8 +26,12 @@
 #define HDR_rdbTiledRdbOutputReceiver
 
 #include "rdb.h"
+#include "rdbFile.h"
 
 #include "dbTilingProcessor.h"
+#include "tlThreads.h"
+
+#include <vector>
 
 namespace rdb
 {
@@ -35,40 +39,132 @@ namespace rdb
 /**
  *  @brief A helper class for the generic implementation of the insert functionality
  */
-class RdbInserter
+class RDB_PUBLIC RdbInserter
 {
 public:
   RdbInserter (rdb::Database *rdb, rdb::id_type cell_id, rdb::id_type category_id, const db::CplxTrans &trans);
+  RdbInserter (rdb::StreamWriter *writer, rdb::id_type cell_id, rdb::id_type category_id, const db::CplxTrans &trans);
+  RdbInserter (std::vector<rdb::ValueBase *> *buffer, const db::CplxTrans &trans);
 
   template <class T>
   void operator() (const T &t)
   {
-    rdb::Item *item = mp_rdb->create_item (m_cell_id, m_category_id);
-    item->add_value (t.transformed (m_trans));
+    insert (t.transformed (m_trans));
   }
 
   void operator() (const db::SimplePolygon &t);
 
+  /**
+   *  @brief Creates an item with the given value
+   *
+   *  In streaming mode, the item is written to the stream rather than put into the database.
+   *  In buffered mode, only the value is collected. Each value makes one item later.
+   */
+  template <class V>
+  void insert (const V &v)
+  {
+    if (mp_buffer) {
+      mp_buffer->push_back (new rdb::Value<V> (v));
+    } else if (mp_writer) {
+      rdb::Item item = mp_writer->create_item (m_cell_id, m_category_id);
+      item.add_value (v);
+      mp_writer->write_item (item);
+    } else {
+      rdb::Item *item = mp_rdb->create_item (m_cell_id, m_category_id);
+      item->add_value (v);
+    }
+  }
+
 private:
   rdb::Database *mp_rdb;
+  rdb::StreamWriter *mp_writer;
+  std::vector<rdb::ValueBase *> *mp_buffer;
   rdb::id_type m_cell_id, m_category_id;
   const db::CplxTrans m_trans;
 };
 
+/**
+ *  @brief A batch of values waiting for being turned into items
+ */
+struct RDB_PUBLIC PendingItemBatch
+{
+  PendingItemBatch () : next (0) { }
+  ~PendingItemBatch ();
+
+  std::vector<rdb::ValueBase *> values;
+  PendingItemBatch *next;
+};
+
 /**
  *  @brief A receiver for the db::TilingProcessor putting the output to the given RDB
+ *
+ *  If a stream writer is given, the items are not stored in the database but
+ *  appended to the writer's file as the tiles are completed.
+ *
+ *  The receiver accepts concurrent deliveries: each "put" converts the object into
+ *  a private batch of values without holding a lock. Handing off the batch is a
+ *  pointer append only. The thread which finds enough values pending merges them
+ *  into the database or writer unless another merge into the same database is in
+ *  progress, in which case it does not wait. The remaining values are merged in
+ *  "finish" or by calling "flush". Values still pending when the receiver is
+ *  destroyed are discarded - the database or writer may not exist anymore then.
  */
-class TiledRdbOutputReceiver
+class RDB_PUBLIC TiledRdbOutputReceiver
   : public db::TileOutputReceiver
 {
 public:
   TiledRdbOutputReceiver (rdb::Database *rdb, size_t cell_id, size_t category_id);
+  TiledRdbOutputReceiver (rdb::StreamWriter *writer, size_t cell_id, size_t category_id);
+  ~TiledRdbOutputReceiver ();
+
+  bool concurrent_put () const
+  {
+    return true;
+  }
 
   void put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip);
+  void finish (bool success);
+
+  /**
+   *  @brief Sets the number of pending values which trigger a merge
+   *
+   *  A batch size of 0 will make every "put" merge immediately if possible.
+   */
+  void set_batch_size (size_t n)
+  {
+    m_batch_size = n;
+  }
+
+  /**
+   *  @brief Gets the number of pending values which trigger a merge
+   */
+  size_t batch_size () const
+  {
+    return m_batch_size;
+  }
+
+  /**
+   *  @brief Merges all pending values into the database or writer
+   *
+   *  This method will wait for a merge into the same database to finish.
+   */
+  void flush ();
 
 private:
   rdb::Database *mp_rdb;
+  rdb::StreamWriter *mp_writer;
   size_t m_cell_id, m_category_id;
+  size_t m_batch_size;
+  tl::Mutex m_pending_lock;
+  PendingItemBatch *mp_pending_first, *mp_pending_last;
+  size_t m_pending_count;
+
+  bool push (PendingItemBatch *batch);
+  bool try_merge (bool wait);
+  void merge (PendingItemBatch *batches);
+
+  TiledRdbOutputReceiver (const TiledRdbOutputReceiver &);
+  TiledRdbOutputReceiver &operator= (const TiledRdbOutputReceiver &);
 };
 
 }
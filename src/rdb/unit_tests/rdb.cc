@@ -23,11 +23,17 @@
 
 
 #include "rdb.h"
+#include "rdbFile.h"
+#include "rdbTiledRdbOutputReceiver.h"
 #include "tlUnitTest.h"
 #include "dbBox.h"
 #include "dbEdge.h"
+#include "dbLayout.h"
+#include "dbTilingProcessor.h"
 #include "tlXMLParser.h"
 
+#include <algorithm>
+
 TEST(1) 
 {
   rdb::Database db;
@@ -554,3 +560,295 @@ TEST(6)
 }
 
 
+
+TEST(7)
+{
+  //  spatial queries and item counts
+  rdb::Database db;
+  rdb::Category *cat1 = db.create_category ("cat1");
+  rdb::Category *cat2 = db.create_category ("cat2");
+  rdb::Cell *c1 = db.create_cell ("c1");
+  rdb::Cell *c2 = db.create_cell ("c2");
+
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      rdb::Item *item = db.create_item (c1->id (), ((i + j) % 2) == 0 ? cat1->id () : cat2->id ());
+      item->add_value (db::DBox (i * 10.0, j * 10.0, i * 10.0 + 1.0, j * 10.0 + 1.0));
+      item->add_value (std::string ("a string"));
+    }
+  }
+
+  rdb::Item *t = db.create_item (c2->id (), cat1->id ());
+  t->add_value (std::string ("no geometry"));
+  t = db.create_item (c2->id (), cat1->id ());
+  t->add_value (db::DEdge (0.0, 0.0, 100.0, 100.0));
+
+  EXPECT_EQ (db.num_items (), size_t (10002));
+  EXPECT_EQ (db.num_items (c1->id (), cat1->id ()), size_t (5000));
+  EXPECT_EQ (db.num_items (c1->id (), cat2->id ()), size_t (5000));
+  EXPECT_EQ (db.num_items (c2->id (), cat1->id ()), size_t (2));
+  EXPECT_EQ (t->values ().size (), size_t (1));
+  EXPECT_EQ (t->values ().bbox ().to_string (), "(0,0;100,100)");
+
+  std::vector<const rdb::Item *> items;
+  db.items_touching (c1->id (), db::DBox (5.0, 0.0, 25.0, 15.0), items);
+  EXPECT_EQ (items.size (), size_t (4));
+
+  std::set<std::string> boxes;
+  for (std::vector<const rdb::Item *>::const_iterator i = items.begin (); i != items.end (); ++i) {
+    boxes.insert ((*i)->values ().bbox ().to_string ());
+  }
+  EXPECT_EQ (tl::join (std::vector<std::string> (boxes.begin (), boxes.end ()), ","), "(10,0;11,1),(10,10;11,11),(20,0;21,1),(20,10;21,11)");
+
+  items.clear ();
+  db.items_touching (c1->id (), db::DBox (-100.0, -100.0, 2000.0, 2000.0), items);
+  EXPECT_EQ (items.size (), size_t (10000));
+
+  items.clear ();
+  db.items_touching (c2->id (), db::DBox (40.0, 40.0, 41.0, 41.0), items);
+  EXPECT_EQ (items.size (), size_t (1));
+
+  //  adding an item invalidates the index
+  t = db.create_item (c2->id (), cat2->id ());
+  t->add_value (db::DBox (40.0, 40.0, 50.0, 50.0));
+
+  items.clear ();
+  db.items_touching (c2->id (), db::DBox (40.0, 40.0, 41.0, 41.0), items);
+  EXPECT_EQ (items.size (), size_t (2));
+  EXPECT_EQ (db.num_items (c2->id (), cat2->id ()), size_t (1));
+}
+
+static std::string read_file (const std::string &fn)
+{
+  tl::InputStream is (fn);
+  return is.read_all ();
+}
+
+TEST(8)
+{
+  //  streaming writer and paged reader
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_8.lyrdb");
+  std::string tmp_file_ref = tl::TestBase::tmp_file ("tmp_8_ref.lyrdb");
+
+  rdb::Database db;
+  db.set_description ("streamed");
+  db.set_top_cell_name ("TOP");
+  rdb::Category *cat1 = db.create_category ("cat1");
+  rdb::Category *cat2 = db.create_category ("cat2");
+  rdb::Category *cat2a = db.create_category (cat2, "a");
+  rdb::Cell *c1 = db.create_cell ("c1");
+  rdb::Cell *c2 = db.create_cell ("c2");
+
+  //  the reference: the same items in memory
+  rdb::Database db_ref;
+  db_ref.set_description ("streamed");
+  db_ref.set_top_cell_name ("TOP");
+  db_ref.create_category ("cat1");
+  db_ref.create_category (db_ref.create_category ("cat2"), "a");
+  db_ref.create_cell ("c1");
+  db_ref.create_cell ("c2");
+
+  {
+    rdb::StreamWriter writer (&db, tmp_file, 3);
+    writer.begin ();
+
+    for (int i = 0; i < 10; ++i) {
+      rdb::id_type cell_id = (i % 2) == 0 ? c1->id () : c2->id ();
+      rdb::id_type cat_id = i < 5 ? cat1->id () : cat2a->id ();
+      rdb::Item item = writer.create_item (cell_id, cat_id);
+      item.add_value (db::DBox (i, 0, i + 1, 1));
+      writer.write_item (item);
+      rdb::Item *item_ref = db_ref.create_item (cell_id, cat_id);
+      item_ref->add_value (db::DBox (i, 0, i + 1, 1));
+    }
+
+    //  tile output receiver in streaming mode
+    rdb::TiledRdbOutputReceiver rec (&writer, c1->id (), cat1->id ());
+    rec.put (0, 0, db::Box (), 0, tl::Variant (db::Box (0, 0, 1000, 2000)), 0.001, db::ICplxTrans (), false);
+    rec.finish (true);
+    rdb::Item *item_ref = db_ref.create_item (c1->id (), cat1->id ());
+    item_ref->add_value (db::DBox (0, 0, 1, 2));
+
+    writer.finish ();
+
+    EXPECT_EQ (writer.num_items (), size_t (11));
+    EXPECT_EQ (writer.has_index (), true);
+  }
+
+  //  nothing was put into the database
+  EXPECT_EQ (db.num_items (), size_t (0));
+
+  //  the streamed file is identical to the one written the standard way
+  db_ref.save (tmp_file_ref);
+  EXPECT_EQ (read_file (tmp_file) == read_file (tmp_file_ref), true);
+
+  //  standard reading
+  rdb::Database db2;
+  db2.load (tmp_file);
+  EXPECT_EQ (db2.num_items (), size_t (11));
+  EXPECT_EQ (db2.num_items (db2.cell_by_qname ("c1")->id (), db2.category_by_name ("cat1")->id ()), size_t (4));
+
+  //  paged reading
+  rdb::PagedReader reader (tmp_file);
+  EXPECT_EQ (reader.num_items ("c1", "cat1"), size_t (4));
+  EXPECT_EQ (reader.num_items ("c2", "cat2.a"), size_t (3));
+  EXPECT_EQ (reader.num_items ("c2", "cat1"), size_t (2));
+
+  rdb::Database db3;
+  reader.read_header (db3);
+  EXPECT_EQ (db3.description (), "streamed");
+  EXPECT_EQ (db3.top_cell_name (), "TOP");
+  EXPECT_EQ (db3.num_items (), size_t (0));
+  tl_assert (db3.category_by_name ("cat2.a") != 0);
+  tl_assert (db3.cell_by_qname ("c2") != 0);
+
+  rdb::id_type c2_id = db3.cell_by_qname ("c2")->id ();
+  rdb::id_type cat2a_id = db3.category_by_name ("cat2.a")->id ();
+  EXPECT_EQ (reader.read_items (db3, c2_id, cat2a_id), size_t (3));
+  EXPECT_EQ (db3.num_items (), size_t (3));
+
+  //  items are not read twice
+  EXPECT_EQ (reader.read_items (db3, c2_id, cat2a_id), size_t (0));
+  EXPECT_EQ (db3.num_items (), size_t (3));
+
+  std::vector<std::string> values;
+  std::pair<rdb::Database::const_item_ref_iterator, rdb::Database::const_item_ref_iterator> be = db3.items_by_cell_and_category (c2_id, cat2a_id);
+  for (rdb::Database::const_item_ref_iterator i = be.first; i != be.second; ++i) {
+    values.push_back ((*i)->values ().to_string (&db3));
+  }
+  EXPECT_EQ (tl::join (values, ";"), "box: (5,0;6,1);box: (7,0;8,1);box: (9,0;10,1)");
+
+  rdb::id_type c1_id = db3.cell_by_qname ("c1")->id ();
+  rdb::id_type cat1_id = db3.category_by_name ("cat1")->id ();
+  EXPECT_EQ (reader.read_items (db3, c1_id, cat1_id), size_t (4));
+  EXPECT_EQ (db3.num_items (), size_t (7));
+  EXPECT_EQ (db3.num_items (c1_id, cat1_id), size_t (4));
+  EXPECT_EQ (db3.is_modified (), false);
+}
+
+static std::string tiled_rdb_output (tl::TestBase *_this, size_t threads, size_t batch_size)
+{
+  db::Layout ly;
+  db::cell_index_type top = ly.add_cell ("TOP");
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+
+  //  50x50 boxes of 1x1 um on a 2 um pitch - none of them crosses a tile boundary
+  for (int x = 0; x < 50; ++x) {
+    for (int y = 0; y < 50; ++y) {
+      ly.cell (top).shapes (l1).insert (db::Box (x * 2000, y * 2000, x * 2000 + 1000, y * 2000 + 1000));
+    }
+  }
+
+  rdb::Database db;
+  rdb::Cell *cell = db.create_cell ("TOP");
+  rdb::Category *cat = db.create_category ("boxes");
+
+  rdb::TiledRdbOutputReceiver *rec = new rdb::TiledRdbOutputReceiver (&db, cell->id (), cat->id ());
+  rec->set_batch_size (batch_size);
+
+  db::TilingProcessor tp;
+  tp.set_threads (threads);
+  tp.tile_size (10.0, 10.0);
+  tp.input ("i", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+  tp.output ("o", 0, rec, db::ICplxTrans ());
+  tp.queue ("_output(o, i & _tile)");
+  tp.execute ("test");
+
+  std::vector<std::string> values;
+  for (rdb::Database::const_item_iterator i = db.items ().begin (); i != db.items ().end (); ++i) {
+    EXPECT_EQ (i->cell_id (), cell->id ());
+    EXPECT_EQ (i->category_id (), cat->id ());
+    values.push_back (i->values ().to_string (&db));
+  }
+
+  std::sort (values.begin (), values.end ());
+  return tl::to_string (values.size ()) + ":" + tl::join (values, ";");
+}
+
+TEST(9)
+{
+  std::string ref = tiled_rdb_output (_this, 0, 1000);
+  EXPECT_EQ (std::string (ref, 0, 5), "2500:");
+
+  //  concurrent delivery with different batch sizes renders the same items
+  EXPECT_EQ (tiled_rdb_output (_this, 4, 1000) == ref, true);
+  EXPECT_EQ (tiled_rdb_output (_this, 4, 7) == ref, true);
+  EXPECT_EQ (tiled_rdb_output (_this, 4, 0) == ref, true);
+}
+
+TEST(10)
+{
+  //  value wrappers are moved, not cloned, when the value vector grows
+
+  rdb::ValueWrapper w1 (new rdb::Value<std::string> ("abc"));
+  w1.set_tag_id (17);
+  const rdb::ValueBase *p1 = w1.get ();
+
+  rdb::ValueWrapper w2 (std::move (w1));
+  EXPECT_EQ (w1.get () == 0, true);
+  EXPECT_EQ (w2.get () == p1, true);
+  EXPECT_EQ (w2.tag_id (), rdb::id_type (17));
+
+  rdb::ValueWrapper w3;
+  w3 = std::move (w2);
+  EXPECT_EQ (w2.get () == 0, true);
+  EXPECT_EQ (w3.get () == p1, true);
+
+  std::vector<rdb::ValueWrapper> v;
+  v.push_back (rdb::ValueWrapper (new rdb::Value<double> (1.0)));
+  const rdb::ValueBase *p0 = v.front ().get ();
+  for (int i = 0; i < 100; ++i) {
+    v.push_back (rdb::ValueWrapper (new rdb::Value<double> (double (i))));
+  }
+  EXPECT_EQ (v.front ().get () == p0, true);
+  EXPECT_EQ (v.size (), size_t (101));
+}
+
+TEST(11)
+{
+  rdb::Database db;
+  rdb::Cell *cell = db.create_cell ("TOP");
+  rdb::Category *cat = db.create_category ("boxes");
+
+  //  values not merged yet are merged by "finish"
+  {
+    rdb::TiledRdbOutputReceiver rec (&db, cell->id (), cat->id ());
+    rec.set_batch_size (1000);
+    rec.put (0, 0, db::Box (), 0, tl::Variant (db::Box (0, 0, 1000, 2000)), 0.001, db::ICplxTrans (), false);
+    EXPECT_EQ (db.num_items (), size_t (0));
+    rec.finish (true);
+    EXPECT_EQ (db.num_items (), size_t (1));
+  }
+
+  EXPECT_EQ (db.num_items (), size_t (1));
+
+  //  the receiver may outlive the database: the destructor does not touch it and
+  //  discards values still pending
+  {
+    rdb::Database *db2 = new rdb::Database ();
+    rdb::Cell *cell2 = db2->create_cell ("TOP");
+    rdb::Category *cat2 = db2->create_category ("boxes");
+
+    rdb::TiledRdbOutputReceiver *rec = new rdb::TiledRdbOutputReceiver (db2, cell2->id (), cat2->id ());
+    rec->set_batch_size (1000);
+    rec->put (0, 0, db::Box (), 0, tl::Variant (db::Box (0, 0, 1000, 2000)), 0.001, db::ICplxTrans (), false);
+    EXPECT_EQ (db2->num_items (), size_t (0));
+
+    delete db2;
+    delete rec;
+  }
+
+  //  a merge into the same database in progress makes "put" leave the values pending
+  {
+    rdb::TiledRdbOutputReceiver rec (&db, cell->id (), cat->id ());
+    rec.set_batch_size (0);
+
+    db.merge_lock ().lock ();
+    rec.put (0, 0, db::Box (), 0, tl::Variant (db::Box (0, 0, 1000, 2000)), 0.001, db::ICplxTrans (), false);
+    EXPECT_EQ (db.num_items (), size_t (1));
+    db.merge_lock ().unlock ();
+
+    rec.put (0, 0, db::Box (), 0, tl::Variant (db::Box (0, 0, 2000, 2000)), 0.001, db::ICplxTrans (), false);
+    EXPECT_EQ (db.num_items (), size_t (3));
+  }
+}
@@ -40,6 +40,12 @@ public:
       ;
   }
 
+  /// @brief Try to acquire the lock (non-blocking).
+  /// @return true if the lock was taken.
+  bool try_lock() {
+    return value_.compare_exchange(UNLOCKED, LOCKED);
+  }
+
   /// @brief Release the lock.
   /// @note It is an error to release a lock that has not been previously
   /// acquired.
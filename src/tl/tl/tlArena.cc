@@ -0,0 +1,96 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlArena.h"
+
+#include <algorithm>
+
+namespace tl
+{
+
+static const size_t arena_alignment = 8;
+
+Arena::Arena (size_t chunk_size)
+  : mp_current (0), m_left (0), m_chunk_size (chunk_size), m_used (0), m_reserved (0)
+{
+  //  .. nothing yet ..
+}
+
+Arena::~Arena ()
+{
+  clear ();
+}
+
+void *
+Arena::allocate (size_t n)
+{
+  n = (n + arena_alignment - 1) & ~(arena_alignment - 1);
+  m_used += n;
+
+  if (n > m_chunk_size / 4) {
+    //  big blocks get a chunk of their own - the current chunk stays active
+    char *chunk = new char [n];
+    m_chunks.push_back (chunk);
+    m_reserved += n;
+    return chunk;
+  }
+
+  if (n > m_left) {
+    mp_current = new char [m_chunk_size];
+    m_chunks.push_back (mp_current);
+    m_left = m_chunk_size;
+    m_reserved += m_chunk_size;
+  }
+
+  char *p = mp_current;
+  mp_current += n;
+  m_left -= n;
+  return p;
+}
+
+void
+Arena::clear ()
+{
+  for (std::vector<char *>::const_iterator c = m_chunks.begin (); c != m_chunks.end (); ++c) {
+    delete [] *c;
+  }
+  m_chunks.clear ();
+  mp_current = 0;
+  m_left = 0;
+  m_used = 0;
+  m_reserved = 0;
+}
+
+void
+Arena::swap (Arena &other)
+{
+  m_chunks.swap (other.m_chunks);
+  std::swap (mp_current, other.mp_current);
+  std::swap (m_left, other.m_left);
+  std::swap (m_chunk_size, other.m_chunk_size);
+  std::swap (m_used, other.m_used);
+  std::swap (m_reserved, other.m_reserved);
+}
+
+}
+
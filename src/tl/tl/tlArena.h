@@ -0,0 +1,111 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlArena
+#define HDR_tlArena
+
+#include "tlCommon.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace tl
+{
+
+/**
+ *  @brief A simple arena allocator
+ *
+ *  The arena hands out memory blocks from big chunks. The blocks cannot be freed 
+ *  individually - all memory is released at once when the arena is cleared or destroyed.
+ *  This avoids the per-allocation overhead of the system allocator and the heap 
+ *  fragmentation for many small, long-living objects.
+ *
+ *  The blocks delivered are aligned to 8 bytes. Big blocks are allocated in chunks
+ *  of their own.
+ *
+ *  The arena is not thread-safe.
+ */
+class TL_PUBLIC Arena
+{
+public:
+  /**
+   *  @brief Creates an arena with the given chunk size
+   */
+  Arena (size_t chunk_size = 65536);
+
+  /**
+   *  @brief Destructor
+   *
+   *  Releases all memory.
+   */
+  ~Arena ();
+
+  /**
+   *  @brief Allocates a block of the given size
+   */
+  void *allocate (size_t n);
+
+  /**
+   *  @brief Releases all memory
+   *
+   *  All blocks delivered by "allocate" become invalid.
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of bytes handed out by "allocate"
+   */
+  size_t used () const
+  {
+    return m_used;
+  }
+
+  /**
+   *  @brief Gets the number of bytes allocated from the system
+   */
+  size_t reserved () const
+  {
+    return m_reserved;
+  }
+
+  /**
+   *  @brief Swaps the memory of two arenas
+   */
+  void swap (Arena &other);
+
+private:
+  std::vector<char *> m_chunks;
+  char *mp_current;
+  size_t m_left;
+  size_t m_chunk_size;
+  size_t m_used, m_reserved;
+
+  //  no copying
+  Arena (const Arena &);
+  Arena &operator= (const Arena &);
+};
+
+}
+
+#endif
+
@@ -399,19 +399,19 @@ ArrayClass ArrayClass::instance;
 //  ExpressionNode implementation
 
 ExpressionNode::ExpressionNode (const ExpressionParserContext &context)
-  : m_context (context)
+  : m_context (context), m_pure (false)
 {
   // .. nothing yet ..
 }
 
-ExpressionNode::ExpressionNode (const ExpressionParserContext &context, size_t children)
-  : m_context (context)
+ExpressionNode::ExpressionNode (const ExpressionParserContext &context, size_t children, bool pure)
+  : m_context (context), m_pure (pure)
 {
   m_c.reserve (children);
 }
 
 ExpressionNode::ExpressionNode (const ExpressionNode &other, const tl::Expression *expr)
-  : m_context (other.m_context)
+  : m_context (other.m_context), m_pure (other.m_pure)
 {
   m_context.set_expr (expr);
   m_c.reserve (other.m_c.size ());
@@ -484,7 +484,7 @@ class TL_PUBLIC LessExpressionNode
 {
 public:
   LessExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -534,7 +534,7 @@ class TL_PUBLIC LessOrEqualExpressionNode
 {
 public:
   LessOrEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -584,7 +584,7 @@ class TL_PUBLIC GreaterExpressionNode
 {
 public:
   GreaterExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -634,7 +634,7 @@ class TL_PUBLIC GreaterOrEqualExpressionNode
 {
 public:
   GreaterOrEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -684,7 +684,7 @@ class TL_PUBLIC EqualExpressionNode
 {
 public:
   EqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -734,7 +734,7 @@ class TL_PUBLIC NotEqualExpressionNode
 {
 public:
   NotEqualExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -931,7 +931,7 @@ class TL_PUBLIC LogAndExpressionNode
 {
 public:
   LogAndExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -973,7 +973,7 @@ class TL_PUBLIC LogOrExpressionNode
 {
 public:
   LogOrExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1014,7 +1014,7 @@ class TL_PUBLIC IfExpressionNode
 {
 public:
   IfExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b, ExpressionNode *c)
-    : ExpressionNode (context, 3)
+    : ExpressionNode (context, 3, true)
   {
     add_child (a);
     add_child (b);
@@ -1052,7 +1052,7 @@ class TL_PUBLIC ShiftLeftExpressionNode
 {
 public:
   ShiftLeftExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1108,7 +1108,7 @@ class TL_PUBLIC ShiftRightExpressionNode
 {
 public:
   ShiftRightExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1164,7 +1164,7 @@ class TL_PUBLIC PlusExpressionNode
 {
 public:
   PlusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1187,6 +1187,15 @@ public:
     m_c[0]->execute (v);
     m_c[1]->execute (b);
 
+    //  fast paths for the most frequent cases
+    if (v->is_double () && b->is_double ()) {
+      v.set (tl::Variant (v->to_double () + b->to_double ()));
+      return;
+    } else if (v->is_long () && b->is_long ()) {
+      v.set (tl::Variant (v->to_long () + b->to_long ()));
+      return;
+    }
+
     if (v->is_user ()) {
 
       const EvalClass *c = v->user_cls () ? v->user_cls ()->eval_cls () : 0;
@@ -1226,7 +1235,7 @@ class TL_PUBLIC MinusExpressionNode
 {
 public:
   MinusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1249,6 +1258,15 @@ public:
     m_c[0]->execute (v);
     m_c[1]->execute (b);
 
+    //  fast paths for the most frequent cases
+    if (v->is_double () && b->is_double ()) {
+      v.set (tl::Variant (v->to_double () - b->to_double ()));
+      return;
+    } else if (v->is_long () && b->is_long ()) {
+      v.set (tl::Variant (v->to_long () - b->to_long ()));
+      return;
+    }
+
     if (v->is_user ()) {
 
       const EvalClass *c = v->user_cls () ? v->user_cls ()->eval_cls () : 0;
@@ -1286,7 +1304,7 @@ class TL_PUBLIC StarExpressionNode
 {
 public:
   StarExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1309,6 +1327,15 @@ public:
     m_c[0]->execute (v);
     m_c[1]->execute (b);
 
+    //  fast paths for the most frequent cases
+    if (v->is_double () && b->is_double ()) {
+      v.set (tl::Variant (v->to_double () * b->to_double ()));
+      return;
+    } else if (v->is_long () && b->is_long ()) {
+      v.set (tl::Variant (v->to_long () * b->to_long ()));
+      return;
+    }
+
     if (v->is_user ()) {
 
       const EvalClass *c = v->user_cls () ? v->user_cls ()->eval_cls () : 0;
@@ -1376,7 +1403,7 @@ class TL_PUBLIC SlashExpressionNode
 {
 public:
   SlashExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1460,7 +1487,7 @@ class TL_PUBLIC PercentExpressionNode
 {
 public:
   PercentExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1532,7 +1559,7 @@ class TL_PUBLIC AmpersandExpressionNode
 {
 public:
   AmpersandExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1588,7 +1615,7 @@ class TL_PUBLIC PipeExpressionNode
 {
 public:
   PipeExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1644,7 +1671,7 @@ class TL_PUBLIC AcuteExpressionNode
 {
 public:
   AcuteExpressionNode (const ExpressionParserContext &context, ExpressionNode *a, ExpressionNode *b)
-    : ExpressionNode (context, 2)
+    : ExpressionNode (context, 2, true)
   {
     add_child (a);
     add_child (b);
@@ -1782,7 +1809,7 @@ class TL_PUBLIC UnaryMinusExpressionNode
 {
 public:
   UnaryMinusExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1839,7 +1866,7 @@ class TL_PUBLIC UnaryTildeExpressionNode
 {
 public:
   UnaryTildeExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1894,7 +1921,7 @@ class TL_PUBLIC UnaryNotExpressionNode
 {
 public:
   UnaryNotExpressionNode (const ExpressionParserContext &context, ExpressionNode *a)
-    : ExpressionNode (context, 1)
+    : ExpressionNode (context, 1, true)
   {
     add_child (a);
   }
@@ -1947,6 +1974,11 @@ public:
     return new ConstantExpressionNode (*this, expr);
   }
 
+  bool is_constant () const
+  {
+    return true;
+  }
+
   void execute (EvalTarget &v) const 
   {
     v.set (m_value);
@@ -1956,6 +1988,44 @@ private:
   tl::Variant m_value;
 };
 
+// ----------------------------------------------------------------------------
+//  Constant folding
+
+ExpressionNode *
+ExpressionNode::fold_constants ()
+{
+  bool all_constant = true;
+
+  for (std::vector <ExpressionNode *>::iterator c = m_c.begin (); c != m_c.end (); ++c) {
+    ExpressionNode *f = (*c)->fold_constants ();
+    if (f) {
+      delete *c;
+      *c = f;
+    }
+    if (! (*c)->is_constant ()) {
+      all_constant = false;
+    }
+  }
+
+  if (! all_constant || ! is_pure () || m_c.empty ()) {
+    return 0;
+  }
+
+  //  Errors are not reported here: they are raised when the expression is executed
+  EvalTarget v;
+  try {
+    execute (v);
+  } catch (tl::Exception &) {
+    return 0;
+  }
+
+  if (v->is_user ()) {
+    return 0;
+  }
+
+  return new ConstantExpressionNode (m_context, *v);
+}
+
 /**
  *  @brief Evaluates a bracket expression in the context
  */
@@ -3122,13 +3192,24 @@ Expression::execute (EvalTarget &v) const
   } 
 }
 
+void
+Expression::fold_constants ()
+{
+  if (m_root.get ()) {
+    ExpressionNode *f = m_root->fold_constants ();
+    if (f) {
+      m_root.reset (f);
+    }
+  }
+}
+
 // ----------------------------------------------------------------------------
 //  Implementation of Eval
 
 Eval Eval::m_global;
 
 Eval::Eval (const Eval *parent, bool sloppy)
-  : mp_parent (parent), m_sloppy (sloppy), mp_ctx_handler (0)
+  : mp_parent (parent), m_sloppy (sloppy), m_fold_constants (true), mp_ctx_handler (0)
 {
   // .. nothing yet ..
 }
@@ -3990,6 +4071,10 @@ Eval::parse (Expression &expr, const std::string &s, bool top)
     eval_atomic (context, expr.root (), 0);
   }
 
+  if (m_fold_constants) {
+    expr.fold_constants ();
+  }
+
   context.expect_end ();
 }
 
@@ -4007,6 +4092,10 @@ Eval::parse (Expression &expr, tl::Extractor &ex, bool top)
     eval_atomic (context, expr.root (), 0);
   }
 
+  if (m_fold_constants) {
+    expr.fold_constants ();
+  }
+
   expr.set_text (std::string (ex0.get (), ex.get () - ex0.get ())); 
 
   ex = context;
@@ -170,8 +170,11 @@ public:
 
   /**
    *  @brief Constructor with reservation of a certain number of child nodes
+   *
+   *  "pure" indicates that the node's value only depends on the values of its
+   *  children (see is_pure).
    */
-  ExpressionNode (const ExpressionParserContext &context, size_t children);
+  ExpressionNode (const ExpressionParserContext &context, size_t children, bool pure = false);
 
   /**
    *  @brief Copy ctor
@@ -198,9 +201,52 @@ public:
    */
   virtual ExpressionNode *clone (const tl::Expression *expr) const = 0;
 
+  /**
+   *  @brief Returns true, if the node is a constant
+   */
+  virtual bool is_constant () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Returns true, if the node's value only depends on the values of its children
+   *
+   *  Such nodes can be replaced by a constant if all children are constants.
+   */
+  bool is_pure () const
+  {
+    return m_pure;
+  }
+
+  /**
+   *  @brief Gets the number of child nodes
+   */
+  size_t children () const
+  {
+    return m_c.size ();
+  }
+
+  /**
+   *  @brief Gets the child node with the given index
+   */
+  const ExpressionNode *child (size_t index) const
+  {
+    return m_c [index];
+  }
+
+  /**
+   *  @brief Replaces constant subexpressions by constants
+   *
+   *  This method returns a new node if this node can be replaced by a constant.
+   *  Otherwise it returns 0. Child nodes are replaced in-place.
+   */
+  ExpressionNode *fold_constants ();
+
 protected:
   std::vector <ExpressionNode *> m_c;
   ExpressionParserContext m_context;
+  bool m_pure;
 
   /**
    *  @brief Sets the expression parent
@@ -328,6 +374,17 @@ public:
     mp_text = s;
   }
 
+  /**
+   *  @brief Gets the root node of the parsed expression
+   *
+   *  This method is provided for test and diagnostic purposes. It returns 0 if the
+   *  expression is empty.
+   */
+  const ExpressionNode *root_node () const
+  {
+    return m_root.get ();
+  }
+
 private:
   const char *mp_text;
   std::string m_local_text;
@@ -353,6 +410,11 @@ private:
   {
     return m_root;
   }
+
+  /**
+   *  @brief Replaces constant subexpressions by constants
+   */
+  void fold_constants ();
 };
 
 /**
@@ -385,6 +447,25 @@ public:
     mp_ctx_handler = ctx_handler;
   }
 
+  /**
+   *  @brief Enables or disables constant folding
+   *
+   *  With constant folding enabled (the default), subexpressions made only of
+   *  operators on constants are evaluated once when the expression is parsed.
+   */
+  void set_fold_constants (bool f)
+  {
+    m_fold_constants = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether constant folding is enabled
+   */
+  bool fold_constants () const
+  {
+    return m_fold_constants;
+  }
+
   /**
    *  @brief Gets the context handler
    *
@@ -512,6 +593,7 @@ private:
   std::map <std::string, tl::Variant> m_local_vars;
   std::map <std::string, EvalFunction *> m_local_functions;
   bool m_sloppy;
+  bool m_fold_constants;
   const ContextHandler *mp_ctx_handler;
   std::vector<std::string> m_match_substrings;
 
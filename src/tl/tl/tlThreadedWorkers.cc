@@ -51,13 +51,35 @@ public:
 class StartTask : public Task 
 {
 public:
-  StartTask ()
+  StartTask (void *context)
+    : context (context)
   { }
+
+  void *context;
 };
 
 struct WorkerTerminatedException { };
 struct TaskTerminatedException { };
 
+// -----------------------------------------------------------------------------
+//  The job context
+
+static tl::ThreadStorage<void *> s_job_context;
+
+void set_job_context (void *context)
+{
+  if (! s_job_context.hasLocalData ()) {
+    s_job_context.setLocalData (context);
+  } else {
+    s_job_context.localData () = context;
+  }
+}
+
+void *job_context ()
+{
+  return s_job_context.hasLocalData () ? s_job_context.localData () : 0;
+}
+
 // -----------------------------------------------------------------------------
 //  tl::Boss implementation
 
@@ -254,7 +276,7 @@ JobBase::start ()
   //  This serves as a synchronization measure such that each task gets called once and
   //  the empty queue detection works properly.
   for (int i = 0; i < m_nworkers; ++i) {
-    mp_per_worker_task_lists[i].put_front (new StartTask ());
+    mp_per_worker_task_lists[i].put_front (new StartTask (job_context ()));
   }
 
   m_task_available_condition.wakeAll ();
@@ -490,8 +512,10 @@ JobBase::get_task (int worker)
       //  stops the thread
       throw WorkerTerminatedException ();
     } else if (dynamic_cast <StartTask *> (task) != 0) {
-      delete task;
       //  dummy task for synchronization - wait for new tasks to arrive.
+      //  The worker takes over the job context of the thread which started the job.
+      set_job_context (static_cast<StartTask *> (task)->context);
+      delete task;
     } else if (task) {
       return task;
     }
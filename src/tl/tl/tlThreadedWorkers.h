@@ -116,6 +116,25 @@ private:
   TaskList &operator= (const TaskList &);
 };
 
+/**
+ *  @brief Sets the job context of the current thread
+ *
+ *  The job context is an opaque value which the worker threads of a job receive
+ *  from the thread which starts the job (see JobBase::start). Code executed inside 
+ *  the tasks can use it to learn about the state of the thread which started the job. 
+ *  The script interpreters for example use it to tell whether the starting thread 
+ *  holds the interpreter lock.
+ */
+TL_PUBLIC void set_job_context (void *context);
+
+/**
+ *  @brief Gets the job context of the current thread
+ *
+ *  The context is 0 unless set with set_job_context or received from the thread
+ *  which started the job the current thread is working on.
+ */
+TL_PUBLIC void *job_context ();
+
 /**
  *  @brief This object represents a job
  *
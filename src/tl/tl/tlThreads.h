@@ -53,6 +53,7 @@ class TL_PUBLIC Mutex
 {
 public:
   Mutex () : QMutex () { }
+  bool try_lock () { return QMutex::tryLock (); }
 };
 
 #else
@@ -63,6 +64,7 @@ class TL_PUBLIC Mutex
 public:
   Mutex () : m_spinlock () { }
   void lock() { m_spinlock.lock(); }
+  bool try_lock() { return m_spinlock.try_lock(); }
   void unlock() { m_spinlock.unlock(); }
 private:
   atomic::spinlock m_spinlock;
@@ -0,0 +1,76 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlArena.h"
+#include "tlUnitTest.h"
+
+#include <cstring>
+
+TEST(1)
+{
+  tl::Arena arena (1024);
+  EXPECT_EQ (arena.used (), size_t (0));
+  EXPECT_EQ (arena.reserved (), size_t (0));
+
+  char *p1 = (char *) arena.allocate (3);
+  char *p2 = (char *) arena.allocate (16);
+  EXPECT_EQ (((size_t) p1 & 7), size_t (0));
+  EXPECT_EQ (((size_t) p2 & 7), size_t (0));
+  EXPECT_EQ (p2 - p1, 8);
+  EXPECT_EQ (arena.used (), size_t (24));
+  EXPECT_EQ (arena.reserved (), size_t (1024));
+
+  memset (p1, 1, 3);
+  memset (p2, 2, 16);
+
+  //  big blocks get a chunk of their own
+  char *p3 = (char *) arena.allocate (1000);
+  EXPECT_EQ (arena.reserved (), size_t (2024));
+  memset (p3, 3, 1000);
+
+  //  the current chunk is continued
+  char *p4 = (char *) arena.allocate (8);
+  EXPECT_EQ (p4 - p2, 16);
+  EXPECT_EQ (arena.used (), size_t (1032));
+
+  //  a new chunk is started if the current one is full
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate (100);
+  }
+  EXPECT_EQ (arena.used (), size_t (1032 + 100 * 104));
+  EXPECT_EQ (arena.reserved () >= arena.used (), true);
+
+  EXPECT_EQ (int (p1 [2]), 1);
+  EXPECT_EQ (int (p2 [15]), 2);
+  EXPECT_EQ (int (p3 [999]), 3);
+
+  tl::Arena other;
+  arena.swap (other);
+  EXPECT_EQ (arena.used (), size_t (0));
+  EXPECT_EQ (other.used (), size_t (1032 + 100 * 104));
+
+  other.clear ();
+  EXPECT_EQ (other.used (), size_t (0));
+  EXPECT_EQ (other.reserved (), size_t (0));
+}
+
@@ -1189,3 +1189,68 @@ TEST(19)
   v = e.parse ("# A comment\nvar i=CellInstArray.new(17,tr,a,b,100,200); i.to_s(); # A final comment").execute ();
   EXPECT_EQ (v.to_string (), std::string ("#17 r90 10,20 [1,2*100;11,22*200]"));
 }
+
+// constant subexpressions
+TEST(20)
+{
+  tl::Eval e;
+  tl::Variant v;
+
+  v = e.parse ("1+2*3").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("7"));
+  v = e.parse ("-2.5*2").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("-5"));
+  v = e.parse ("7/2+to_i(1)").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("4.5"));
+  v = e.parse ("1+1==2 ? 'a'+'b' : 'c'").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("ab"));
+  v = e.parse ("var x=1; x+2*3").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("7"));
+  v = e.parse ("var y=[1,2]; y[1+0]*(3-1)").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("4"));
+
+  //  errors in constant subexpressions are reported on execution
+  tl::Expression ex = e.parse ("1/0");
+  std::string msg;
+  try {
+    ex.execute ();
+  } catch (tl::Exception &ex) {
+    msg = ex.msg ();
+  }
+  EXPECT_EQ (msg.empty (), false);
+
+  //  expressions with side effects are not folded
+  e.parse ("'abc' ~ '(*)c'").execute ();
+  v = e.parse ("$1").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("ab"));
+
+  //  constant subexpressions are replaced by constant nodes
+  tl::Expression cx = e.parse ("1+2*3");
+  EXPECT_EQ (cx.root_node ()->is_constant (), true);
+  EXPECT_EQ (cx.root_node ()->children (), size_t (0));
+
+  //  variables are not folded, but constant subexpressions next to them are
+  e.set_var ("x", tl::Variant (1));
+  tl::Expression vx = e.parse ("x+2*3");
+  EXPECT_EQ (vx.root_node ()->is_constant (), false);
+  EXPECT_EQ (vx.root_node ()->children (), size_t (2));
+  EXPECT_EQ (vx.root_node ()->child (0)->is_constant (), false);
+  EXPECT_EQ (vx.root_node ()->child (1)->is_constant (), true);
+  EXPECT_EQ (vx.execute ().to_string (), std::string ("7"));
+  e.set_var ("x", tl::Variant (2));
+  EXPECT_EQ (vx.execute ().to_string (), std::string ("8"));
+
+  //  function calls are not folded
+  tl::Expression fx = e.parse ("to_i(1)+1");
+  EXPECT_EQ (fx.root_node ()->is_constant (), false);
+  EXPECT_EQ (fx.root_node ()->child (0)->is_constant (), false);
+
+  //  constant folding can be disabled
+  tl::Eval enf;
+  enf.set_fold_constants (false);
+  tl::Expression nx = enf.parse ("1+2*3");
+  EXPECT_EQ (nx.root_node ()->is_constant (), false);
+  EXPECT_EQ (nx.root_node ()->children (), size_t (2));
+  EXPECT_EQ (nx.root_node ()->child (1)->is_constant (), false);
+  EXPECT_EQ (nx.execute ().to_string (), std::string ("7"));
+}
@@ -639,3 +639,73 @@ TEST(29)
   }
 }
 
+
+class ContextTask : public tl::Task
+{
+public:
+  ContextTask () { }
+};
+
+class ContextWorker : public tl::Worker
+{
+public:
+  ContextWorker () : tl::Worker () { }
+
+  static tl::Mutex lock;
+  static std::vector<void *> contexts;
+
+protected:
+  void perform_task (tl::Task *)
+  {
+    tl::MutexLocker locker (&lock);
+    contexts.push_back (tl::job_context ());
+  }
+};
+
+tl::Mutex ContextWorker::lock;
+std::vector<void *> ContextWorker::contexts;
+
+//  job context propagation to the worker threads
+TEST(30)
+{
+  int a = 0, b = 0;
+
+  EXPECT_EQ (tl::job_context () == 0, true);
+
+  tl::Job<ContextWorker> job (2);
+
+  for (int l = 0; l < 2; ++l) {
+
+    //  the context is taken at the time the job is started
+    tl::set_job_context (l == 0 ? (void *) &a : (void *) &b);
+
+    ContextWorker::contexts.clear ();
+    for (int i = 0; i < 10; ++i) {
+      job.schedule (new ContextTask ());
+    }
+
+    job.start ();
+    job.wait ();
+
+    EXPECT_EQ (ContextWorker::contexts.size (), size_t (10));
+    for (std::vector<void *>::const_iterator c = ContextWorker::contexts.begin (); c != ContextWorker::contexts.end (); ++c) {
+      EXPECT_EQ (*c == (l == 0 ? (void *) &a : (void *) &b), true);
+    }
+
+  }
+
+  //  synchronous execution happens in the calling thread
+  tl::Job<ContextWorker> sync_job (0);
+  tl::set_job_context (&a);
+
+  ContextWorker::contexts.clear ();
+  sync_job.schedule (new ContextTask ());
+  sync_job.start ();
+  sync_job.wait ();
+
+  EXPECT_EQ (ContextWorker::contexts.size (), size_t (1));
+  EXPECT_EQ (ContextWorker::contexts.front () == (void *) &a, true);
+
+  tl::set_job_context (0);
+  EXPECT_EQ (tl::job_context () == 0, true);
+}
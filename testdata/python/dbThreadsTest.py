@@ -0,0 +1,153 @@
+# KLayout Layout Viewer
+# Copyright (C) 2006-2018 Matthias Koefferlein
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+import pya
+import unittest
+import threading
+import tempfile
+import shutil
+import os
+import sys
+
+# Runs the given function in n Python threads concurrently and 
+# returns the results in thread order
+def run_in_threads(n, func):
+
+  results = [ None ] * n
+  errors = []
+
+  def work(i):
+    try:
+      results[i] = func(i)
+    except Exception as ex:
+      errors.append(ex)
+
+  threads = [ threading.Thread(target = work, args = (i,)) for i in range(0, n) ]
+  for t in threads:
+    t.start()
+  for t in threads:
+    t.join()
+
+  if len(errors) > 0:
+    raise errors[0]
+
+  return results
+
+class CollectingReceiver(pya.TileOutputReceiver):
+
+  def put(self, ix, iy, tile, obj, dbu, clip):
+    # called from the tiling processor's worker threads
+    if not hasattr(self, "data"):
+      self.data = []
+    self.data.append("%d,%d:%s" % (ix, iy, str(obj)))
+
+class DBThreadsTest(unittest.TestCase):
+
+  # Region booleans and sizing from two Python threads
+  def test_1(self):
+
+    def booleans(i):
+
+      r1 = pya.Region()
+      r2 = pya.Region()
+      for j in range(0, 5000):
+        r1.insert(pya.Box(j * 10, 0, j * 10 + 8, 100))
+        r2.insert(pya.Box(j * 10 + 4, 50, j * 10 + 12, 150))
+
+      res = []
+      for n in range(0, 5):
+        res.append(((r1 & r2).area(), (r1 - r2).area(), (r1 ^ r2).area(), r1.sized(1).merged().area()))
+      return res
+
+    ref = booleans(0)
+    self.assertEqual(ref[0], (1499900, 2500100, 5000200, 5100000))
+
+    results = run_in_threads(2, booleans)
+    self.assertEqual(results[0], ref)
+    self.assertEqual(results[1], ref)
+
+  # Layout#write and Layout#read from two Python threads
+  def test_2(self):
+
+    tmp_dir = tempfile.mkdtemp()
+
+    try:
+
+      def write_and_read(i):
+
+        ly = pya.Layout()
+        top = ly.create_cell("TOP")
+        l1 = ly.layer(1, 0)
+        for j in range(0, 10000):
+          top.shapes(l1).insert(pya.Box(j * 10, i, j * 10 + 5, 100))
+
+        fn = os.path.join(tmp_dir, "t%d.gds" % i)
+        ly.write(fn)
+
+        res = []
+        for n in range(0, 5):
+          ly2 = pya.Layout()
+          ly2.read(fn)
+          res.append((ly2.top_cell().name, ly2.top_cell().shapes(ly2.layer(1, 0)).size(), str(ly2.top_cell().bbox())))
+        return res
+
+      results = run_in_threads(2, write_and_read)
+      self.assertEqual(results[0][0], ("TOP", 10000, "(0,0;99995,100)"))
+      self.assertEqual(results[0][4], results[0][0])
+      self.assertEqual(results[1][0], ("TOP", 10000, "(0,1;99995,100)"))
+      self.assertEqual(results[1][4], results[1][0])
+
+    finally:
+      shutil.rmtree(tmp_dir)
+
+  # Callbacks from the worker threads of a method which has released the GIL
+  def test_3(self):
+
+    def tiles(i):
+
+      rin = pya.Region()
+      rin.insert(pya.Box(0, 0, 10000, 10000))
+
+      tp = pya.TilingProcessor()
+      tp.input("in", rin)
+      tp.dbu = 0.001
+      tp.tile_size(1.0, 1.0)
+      tp.threads = 2
+
+      rec = CollectingReceiver()
+      tp.output("out", rec)
+      tp.queue("_output(out, (in & _tile).area)")
+      tp.execute("Job %d" % i)
+
+      return sorted(rec.data)
+
+    ref = tiles(0)
+    self.assertEqual(len(ref), 100)
+    self.assertEqual(ref[0], "0,0:1000000")
+
+    results = run_in_threads(2, tiles)
+    self.assertEqual(results[0], ref)
+    self.assertEqual(results[1], ref)
+
+# run unit tests
+if __name__ == '__main__':
+  suite = unittest.TestLoader().loadTestsFromTestCase(DBThreadsTest)
+
+  if not unittest.TextTestRunner(verbosity = 1).run(suite).wasSuccessful():
+    sys.exit(1)
+
@@ -761,6 +761,39 @@ class DBPolygon_TestClass < TestBase
 
   end
 
+  # bulk coordinate access
+  def test_coords
+
+    p = RBA::Polygon::new(RBA::Box::new(0, 0, 10, 20))
+    assert_equal(p.hull_coords, [ 0, 0, 0, 20, 10, 20, 10, 0 ])
+    p.insert_hole_coords([ 1, 1, 1, 2, 2, 2, 2, 1 ])
+    assert_equal(p.hole_coords(0), [ 1, 1, 2, 1, 2, 2, 1, 2 ])
+    assert_equal(p.hole_coords(1), [])
+    assert_equal(p.to_s, "(0,0;0,20;10,20;10,0/1,1;2,1;2,2;1,2)")
+
+    p = RBA::Polygon::new
+    p.set_hull_coords([ 0, 0, 0, 10, 10, 10, 10, 0 ])
+    assert_equal(p.to_s, "(0,0;0,10;10,10;10,0)")
+
+    p.set_hull_coords([ 0, 0, 0, 5, 0, 20, 20, 20, 20, 0 ], true)
+    assert_equal(p.to_s, "(0,0;0,5;0,20;20,20;20,0)")
+    p.set_hull_coords([ 0, 0, 0, 5, 0, 20, 20, 20, 20, 0 ])
+    assert_equal(p.to_s, "(0,0;0,20;20,20;20,0)")
+
+    p = RBA::DPolygon::new
+    p.set_hull_coords([ 0, 0, 0, 1.5, 1, 1, 1, 0 ])
+    assert_equal(p.hull_coords, [ 0, 0, 0, 1.5, 1, 1, 1, 0 ])
+
+    error = false
+    begin
+      p.set_hull_coords([ 0, 0, 1 ])
+    rescue => ex
+      error = true
+    end
+    assert_equal(error, true)
+
+  end
+
 end
 
 load("test_epilogue.rb")
@@ -1378,6 +1378,104 @@ class DBShapes_TestClass < TestBase
 
   end
 
+  # bulk box access
+  def test_11
+
+    s = RBA::Shapes::new
+    s.insert_boxes([ 0, 0, 10, 10, 5, 5, 1, 1 ])
+    s.insert(RBA::Polygon::new(RBA::Box::new(0, 0, 1, 1)))
+    assert_equal(s.size, 3)
+    assert_equal(s.box_coords, [ 0, 0, 10, 10, 1, 1, 5, 5 ])
+
+    error = false
+    begin
+      s.insert_boxes([ 0, 0, 10 ])
+    rescue => ex
+      error = true
+    end
+    assert_equal(error, true)
+
+  end
+
+  # bulk polygon, path and edge access
+  def test_12
+
+    # a box-like polygon and one with a hole
+    pc = [ 1, 4, 0, 0, 0, 10, 10, 10, 10, 0, 
+           2, 4, 0, 0, 0, 10, 10, 10, 10, 0, 4, 2, 2, 8, 2, 8, 8, 2, 8 ]
+    # a path with extensions and a round one
+    wc = [ 10, 5, 5, 0, 2, 0, 0, 100, 0, 
+           20, 10, 10, 1, 3, 0, 0, 0, 100, 100, 100 ]
+    ec = [ 0, 0, 100, 100, 10, 0, 10, 10 ]
+
+    s = RBA::Shapes::new
+    s.insert_polygons(pc)
+    s.insert_paths(wc)
+    s.insert_edges(ec)
+    s.insert(RBA::Box::new(0, 0, 1, 1))
+    assert_equal(s.size, 7)
+
+    assert_equal(s.polygon_coords, pc)
+    assert_equal(s.path_coords, wc)
+    assert_equal(s.edge_coords, ec)
+
+    polygons = []
+    s.each(RBA::Shapes::SPolygons) { |sh| polygons << sh.polygon.to_s }
+    assert_equal(polygons.join(";"), "(0,0;0,10;10,10;10,0);(0,0;0,10;10,10;10,0/2,2;8,2;8,8;2,8)")
+    paths = []
+    s.each(RBA::Shapes::SPaths) { |sh| paths << sh.path.to_s }
+    assert_equal(paths.join(";"), "(0,0;100,0) w=10 bx=5 ex=5 r=false;(0,0;0,100;100,100) w=20 bx=10 ex=10 r=true")
+
+    [ [ 1, 3, 0, 0 ], [ 0 ], [ 1, -1 ] ].each do |c|
+      error = false
+      begin
+        s.insert_polygons(c)
+      rescue => ex
+        error = true
+      end
+      assert_equal(error, true)
+    end
+
+    [ [ 10, 0, 0 ], [ 10, 0, 0, 0, 2, 0, 0 ] ].each do |c|
+      error = false
+      begin
+        s.insert_paths(c)
+      rescue => ex
+        error = true
+      end
+      assert_equal(error, true)
+    end
+
+    error = false
+    begin
+      s.insert_edges([ 0, 0, 10 ])
+    rescue => ex
+      error = true
+    end
+    assert_equal(error, true)
+
+    # the same through a recursive shape iterator
+    ly = RBA::Layout::new
+    top = ly.create_cell("TOP")
+    child = ly.create_cell("CHILD")
+    l1 = ly.layer(1, 0)
+    child.shapes(l1).insert_polygons(pc)
+    child.shapes(l1).insert_paths(wc)
+    child.shapes(l1).insert_edges(ec)
+    top.insert(RBA::CellInstArray::new(child.cell_index, RBA::Trans::new(1000, 0)))
+
+    it = ly.begin_shapes(top.cell_index, l1)
+    assert_equal(it.polygon_coords, [ 1, 4, 1000, 0, 1000, 10, 1010, 10, 1010, 0, 
+                                      2, 4, 1000, 0, 1000, 10, 1010, 10, 1010, 0, 4, 1002, 2, 1008, 2, 1008, 8, 1002, 8 ])
+    assert_equal(it.path_coords, [ 10, 5, 5, 0, 2, 1000, 0, 1100, 0, 
+                                   20, 10, 10, 1, 3, 1000, 0, 1000, 100, 1100, 100 ])
+    assert_equal(it.edge_coords, [ 1000, 0, 1100, 100, 1010, 0, 1010, 10 ])
+
+    # the iterator itself is not consumed
+    assert_equal(it.at_end?, false)
+
+  end
+
 end
 
 load("test_epilogue.rb")
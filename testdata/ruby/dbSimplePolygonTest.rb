@@ -384,6 +384,24 @@ class DBSimplePolygon_TestClass < TestBase
 
   end
 
+  # bulk coordinate access
+  def test_coords
+
+    p = RBA::SimplePolygon::new(RBA::Box::new(0, 0, 10, 20))
+    assert_equal(p.coords, [ 0, 0, 0, 20, 10, 20, 10, 0 ])
+
+    p = RBA::SimplePolygon::new
+    p.set_coords([ 0, 0, 0, 5, 0, 20, 20, 20, 20, 0 ], true)
+    assert_equal(p.coords, [ 0, 0, 0, 5, 0, 20, 20, 20, 20, 0 ])
+    p.set_coords([ 0, 0, 0, 5, 0, 20, 20, 20, 20, 0 ])
+    assert_equal(p.to_s, "(0,0;0,20;20,20;20,0)")
+
+    p = RBA::DSimplePolygon::new
+    p.set_coords([ 0, 0, 0, 1.5, 1, 1, 1, 0 ])
+    assert_equal(p.coords, [ 0, 0, 0, 1.5, 1, 1, 1, 0 ])
+
+  end
+
 end
 
 load("test_epilogue.rb")
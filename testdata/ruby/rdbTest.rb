@@ -838,6 +838,47 @@ class RDB_TestClass < TestBase
 
   end
 
+  # creating items while iterating
+  def test_13
+
+    rdb = RBA::ReportDatabase.new("neu")
+    cat1 = rdb.create_category("l1")
+    cell1 = rdb.create_cell("c1")
+    10.times do |i|
+      rdb.create_item(cell1.rdb_id, cat1.rdb_id).add_value(i.to_s)
+    end
+
+    # the iterators deliver the items present when the iteration started
+    n = 0
+    rdb.each_item_per_cell(cell1.rdb_id) do |i|
+      100.times { rdb.create_item(cell1.rdb_id, cat1.rdb_id).add_value("x") }
+      n += 1
+    end
+    assert_equal(n, 10)
+    assert_equal(cell1.num_items, 1010)
+
+    n = 0
+    rdb.each_item_per_category(cat1.rdb_id) do |i|
+      rdb.create_item(cell1.rdb_id, cat1.rdb_id)
+      n += 1
+    end
+    assert_equal(n, 1010)
+
+    n = 0
+    rdb.each_item do |i|
+      rdb.create_item(cell1.rdb_id, cat1.rdb_id)
+      n += 1
+    end
+    assert_equal(n, 2020)
+    assert_equal(rdb.num_items, 4040)
+
+    vv = []
+    rdb.each_item_per_cell_and_category(cell1.rdb_id, cat1.rdb_id) { |i| i.each_value { |v| vv << v.string } }
+    assert_equal(vv[0..2].join(","), "0,1,2")
+    assert_equal(vv.size, 1010)
+
+  end
+
 end
 
 load("test_epilogue.rb")